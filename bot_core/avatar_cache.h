@@ -0,0 +1,143 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "utility/log.h"
+
+// A cache of user avatars saved as '<dir>/<user_id>.png'.
+//
+// A downloaded avatar is reused until |ttl| passes. If the download fails, the fallback image is saved instead and the
+// download is not retried until |negative_ttl| passes. Only one thread downloads the avatar of a user at the same time,
+// other threads requiring the same avatar wait for the result.
+class UserAvatarCache
+{
+  public:
+    // Save the image to |path|. Return true if succeed.
+    using DownloadFn = std::function<bool(const std::string& path)>;
+    using FallbackFn = std::function<void(const std::string& path)>;
+
+    using Duration = std::chrono::steady_clock::duration;
+
+    struct Stats
+    {
+        uint64_t hit_count_ = 0;           // the cached avatar is downloaded successfully
+        uint64_t negative_hit_count_ = 0;  // the cached avatar is the fallback image
+        uint64_t miss_count_ = 0;
+        uint64_t wait_count_ = 0;          // waiting for the download of another thread
+        uint64_t download_failed_count_ = 0;
+        uint64_t total_download_latency_us_ = 0;
+        uint64_t max_download_latency_us_ = 0;
+    };
+
+    static constexpr const uint32_t k_default_ttl_sec = 3600;
+    static constexpr const uint32_t k_default_negative_ttl_sec = 300;
+
+    UserAvatarCache(std::filesystem::path dir, const Duration ttl = std::chrono::seconds(k_default_ttl_sec),
+            const Duration negative_ttl = std::chrono::seconds(k_default_negative_ttl_sec))
+        : dir_(std::move(dir)), ttl_(ttl), negative_ttl_(negative_ttl)
+    {
+    }
+
+    UserAvatarCache(const UserAvatarCache&) = delete;
+    UserAvatarCache(UserAvatarCache&&) = delete;
+
+    // Return the path of the avatar. The avatar is downloaded by |download| only when it is not cached or expired, and
+    // is generated by |fallback| when the download fails.
+    std::string GetOrDownload(const std::string& user_id, const DownloadFn& download, const FallbackFn& fallback)
+    {
+        const std::string path = (dir_ / user_id).string() + ".png";
+        std::unique_lock<std::mutex> l(mutex_);
+        auto& entry = entries_[user_id]; // elements of unordered_map are never moved
+        if (entry.is_downloading_) {
+            ++stats_.wait_count_;
+            cv_.wait(l, [&entry] { return !entry.is_downloading_; });
+            return path; // use the result even if it is already expired, or the avatar may be downloaded repeatedly
+        }
+        if (entry.expire_time_ && std::chrono::steady_clock::now() < *entry.expire_time_) {
+            ++(entry.is_downloaded_ ? stats_.hit_count_ : stats_.negative_hit_count_);
+            return path;
+        }
+        ++stats_.miss_count_;
+        entry.is_downloading_ = true;
+        l.unlock();
+
+        const bool is_downloaded = Download_(path, download, fallback);
+
+        l.lock();
+        entry.is_downloading_ = false;
+        entry.is_downloaded_ = is_downloaded;
+        entry.expire_time_ = std::chrono::steady_clock::now() + (is_downloaded ? ttl_ : negative_ttl_);
+        l.unlock();
+        cv_.notify_all();
+        return path;
+    }
+
+    Stats GetStats() const
+    {
+        std::lock_guard<std::mutex> l(mutex_);
+        return stats_;
+    }
+
+  private:
+    struct Entry
+    {
+        std::optional<std::chrono::steady_clock::time_point> expire_time_;
+        bool is_downloaded_ = false;
+        bool is_downloading_ = false;
+    };
+
+    bool Download_(const std::string& path, const DownloadFn& download, const FallbackFn& fallback)
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(dir_, ec);
+
+        // Save to a temporary file and rename it, so that the avatar being rendered by others is always complete.
+        const std::string tmp_path = path + "." + std::to_string(tmp_no_++) + ".tmp";
+        const auto begin = std::chrono::steady_clock::now();
+        const bool is_downloaded = download(tmp_path);
+        const uint64_t latency_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - begin).count();
+        {
+            std::lock_guard<std::mutex> l(mutex_);
+            stats_.total_download_latency_us_ += latency_us;
+            stats_.max_download_latency_us_ = std::max(stats_.max_download_latency_us_, latency_us);
+            stats_.download_failed_count_ += !is_downloaded;
+        }
+        if (!is_downloaded) {
+            DebugLog() << "Download avatar failed path=" << path << " latency_us=" << latency_us;
+            if (std::filesystem::exists(path, ec)) {
+                std::filesystem::remove(tmp_path, ec);
+                return false; // the outdated avatar is better than the fallback image
+            }
+            fallback(tmp_path);
+        }
+        std::filesystem::rename(tmp_path, path, ec);
+        if (ec) {
+            DebugLog() << "Avatar is not saved path=" << path << " reason=" << ec.message();
+            std::filesystem::remove(tmp_path, ec);
+        }
+        return is_downloaded;
+    }
+
+    const std::filesystem::path dir_;
+    const Duration ttl_;
+    const Duration negative_ttl_;
+    std::atomic<uint64_t> tmp_no_{0};
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::unordered_map<std::string, Entry> entries_;
+    Stats stats_;
+};
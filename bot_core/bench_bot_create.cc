@@ -0,0 +1,69 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+// Measure the time cost of `LGTBot_Create` with the game modules in |game_path| loaded by different numbers of threads.
+// Loading modules one by one (thread number 0) is the former implementation.
+//
+// Usage: ./bench_bot_create --game_path=./plugins --threads=0,4,16 --repeat=10
+
+#include <gflags/gflags.h>
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "bot_core/bot_core.h"
+
+DEFINE_string(game_path, "./plugins", "The directory of game modules");
+DEFINE_string(threads, "0,4,16", "The numbers of threads which load game modules, separated by comma");
+DEFINE_uint32(repeat, 10, "The number of times to create the bot for each number of threads");
+
+static void GetUserName(void* const handler, char* const buffer, const size_t size, const char* const user_id) {}
+
+static void GetUserNameInGroup(void* const handler, char* const buffer, const size_t size, const char* const group_id,
+        const char* const user_id) {}
+
+static int DownloadUserAvatar(void* const handler, const char* const user_id, const char* const dest_filename)
+{
+    return 0;
+}
+
+static void HandleMessages(void* const handler, const char* const id, const int is_to_user,
+        const LGTBot_Message* const messages, const size_t size) {}
+
+int main(int argc, char** argv)
+{
+    gflags::ParseCommandLineFlags(&argc, &argv, true);
+    std::istringstream threads_ss(FLAGS_threads);
+    for (uint32_t thread_num = 0; threads_ss >> thread_num; threads_ss.ignore()) {
+        LGTBot_Option options = LGTBot_InitOptions();
+        options.game_path_ = FLAGS_game_path.c_str();
+        options.callbacks_ = LGTBot_Callback{
+            .get_user_name = GetUserName,
+            .get_user_name_in_group = GetUserNameInGroup,
+            .download_user_avatar = DownloadUserAvatar,
+            .handle_messages = HandleMessages,
+        };
+        options.load_module_thread_num_ = thread_num;
+        double total_sec = 0;
+        double max_sec = 0;
+        for (uint32_t i = 0; i < FLAGS_repeat; ++i) {
+            const auto begin = std::chrono::steady_clock::now();
+            const char* errmsg = nullptr;
+            void* const bot = LGTBot_Create(&options, &errmsg);
+            const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            if (!bot) {
+                std::cerr << "create bot failed: " << errmsg << std::endl;
+                return 1;
+            }
+            LGTBot_Release(bot);
+            total_sec += sec;
+            max_sec = std::max(max_sec, sec);
+        }
+        std::cout << "threads=" << thread_num << ": avg_ms=" << total_sec * 1000 / FLAGS_repeat
+                  << " max_ms=" << max_sec * 1000 << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,121 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+// Compare the time cost to dispatch messages between checking all commands one by one (the former implementation of
+// `HandleRequest`) and checking only the commands indexed by the first argument of the message, over the meta commands
+// and the admin commands of the bot.
+//
+// Each message starts with the keyword of a command followed by arguments which the command rejects, so the cost is
+// spent in dispatching rather than in the callbacks. The few commands accepting any arguments are invoked on a bot
+// without database, which fail at once. Some messages match no command, like chats in a group.
+//
+// The stage commands of a game are measured by bench_command_dispatch_<game> in the same way.
+//
+// Usage: ./bench_command_dispatch --game_path=./plugins --msg_num=1000000
+
+#include <gflags/gflags.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bot_core/bot_ctx.h"
+#include "bot_core/message_handlers.h"
+
+DEFINE_string(game_path, "./plugins", "The directory of game modules");
+DEFINE_uint32(msg_num, 1000000, "The number of dispatched messages for each command table");
+DEFINE_double(miss_ratio, 0.2, "The ratio of messages which match no command");
+
+static void GetUserName(void* const handler, char* const buffer, const size_t size, const char* const user_id) {}
+
+static void GetUserNameInGroup(void* const handler, char* const buffer, const size_t size, const char* const group_id,
+        const char* const user_id) {}
+
+static int DownloadUserAvatar(void* const handler, const char* const user_id, const char* const dest_filename)
+{
+    return 0;
+}
+
+static void HandleMessages(void* const handler, const char* const id, const int is_to_user,
+        const LGTBot_Message* const messages, const size_t size) {}
+
+static std::vector<std::string> MakeMessages(const IndexedMetaCommands& cmds)
+{
+    std::vector<std::string> keywords;
+    for (const MetaCommand& cmd : cmds) {
+        if (const auto cmd_keywords = cmd.LeadingKeywords()) {
+            keywords.insert(keywords.end(), cmd_keywords->begin(), cmd_keywords->end());
+        }
+    }
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<uint32_t> keyword_dist(0, keywords.size() - 1);
+    std::bernoulli_distribution miss_dist(FLAGS_miss_ratio);
+    std::vector<std::string> msgs;
+    for (uint32_t i = 0; i < FLAGS_msg_num; ++i) {
+        msgs.emplace_back((miss_dist(rng) ? "随便聊聊" : keywords[keyword_dist(rng)]) + " 无效参数 " + std::to_string(i));
+    }
+    return msgs;
+}
+
+template <typename Dispatch>
+static void Benchmark(const char* const name, const std::vector<std::string>& msgs, Dispatch&& dispatch)
+{
+    uint64_t matched_count = 0;
+    const auto begin = std::chrono::steady_clock::now();
+    for (const auto& msg : msgs) {
+        MsgReader reader(msg);
+        matched_count += dispatch(reader).has_value();
+    }
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << name << ": matched=" << matched_count << " sec=" << sec
+              << " ns/msg=" << sec * 1e9 / msgs.size() << std::endl;
+}
+
+static void Benchmark(const char* const name, BotCtx& bot, const bool is_admin)
+{
+    const IndexedMetaCommands& cmds = GetIndexedMetaCommands(is_admin);
+    const auto msgs = MakeMessages(cmds);
+    const UserID uid("bench_user");
+    const std::optional<GroupID> gid;
+    std::cout << name << ": command_num=" << cmds.size() << std::endl;
+    Benchmark("linear", msgs, [&](MsgReader& reader)
+            {
+                for (const MetaCommand& cmd : cmds) {
+                    if (const auto ret = cmd.CallIfValid(reader, bot, uid, gid, EmptyMsgSender::Get()); ret.has_value()) {
+                        return ret;
+                    }
+                }
+                return std::optional<ErrCode>();
+            });
+    Benchmark("indexed", msgs, [&](MsgReader& reader)
+            {
+                return cmds.CallIfValid(reader, bot, uid, gid, EmptyMsgSender::Get());
+            });
+}
+
+int main(int argc, char** argv)
+{
+    gflags::ParseCommandLineFlags(&argc, &argv, true);
+    LGTBot_Option options = LGTBot_InitOptions();
+    options.game_path_ = FLAGS_game_path.c_str();
+    options.callbacks_ = LGTBot_Callback{
+        .get_user_name = GetUserName,
+        .get_user_name_in_group = GetUserNameInGroup,
+        .download_user_avatar = DownloadUserAvatar,
+        .handle_messages = HandleMessages,
+    };
+    options.log_level_ = LOG_LEVEL_NONE;
+    const char* errmsg = nullptr;
+    void* const bot = LGTBot_Create(&options, &errmsg);
+    if (!bot) {
+        std::cerr << "create bot failed: " << errmsg << std::endl;
+        return 1;
+    }
+    Benchmark("meta", *static_cast<BotCtx*>(bot), false);
+    Benchmark("admin", *static_cast<BotCtx*>(bot), true);
+    LGTBot_Release(bot);
+    return 0;
+}
@@ -0,0 +1,100 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+// Compare the throughput of `RecordMatch` and `GetUserProfile` between opening a connection for each transaction (the
+// former implementation of `SQLiteDBManager`) and the connection pool with cached prepared statements, and the
+// throughput of `RecordMatch` when the matches are written behind.
+//
+// Usage: ./bench_db --db_path=/tmp/lgtbot_bench_db.db --record_num=1000 --query_num=10000 --threads=1,4
+
+#include <gflags/gflags.h>
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "bot_core/db_manager.h"
+
+DEFINE_string(db_path, "/tmp/lgtbot_bench_db.db", "The path of the database file, which is removed before each round");
+DEFINE_uint32(user_num, 100, "The number of users who play matches");
+DEFINE_uint32(user_num_each_match, 5, "The number of users in each match");
+DEFINE_uint32(record_num, 1000, "The number of recorded matches");
+DEFINE_uint32(query_num, 10000, "The number of queried user profiles of each thread");
+DEFINE_string(threads, "1,4", "The numbers of threads which query user profiles concurrently, separated by comma");
+DEFINE_uint32(flush_interval_ms, 100, "The interval to write matches when the matches are written behind");
+
+template <typename Fn>
+static double MeasureSec(Fn&& fn)
+{
+    const auto begin = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+static void Benchmark(const char* const name, const uint32_t reader_num, const uint32_t flush_interval_ms,
+        const std::vector<uint32_t>& thread_nums)
+{
+    for (const char* const suffix : {"", "-wal", "-shm", ".records"}) {
+        std::filesystem::remove(FLAGS_db_path + suffix);
+    }
+    const auto db_manager = SQLiteDBManager::UseDB(FLAGS_db_path.c_str(), reader_num, flush_interval_ms);
+    if (!db_manager) {
+        std::cerr << "open database failed" << std::endl;
+        return;
+    }
+
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<uint32_t> user_dist(0, FLAGS_user_num - 1);
+    const double record_sec = MeasureSec([&]
+            {
+                for (uint32_t i = 0; i < FLAGS_record_num; ++i) {
+                    std::vector<std::pair<UserID, int64_t>> game_score_infos;
+                    for (uint32_t j = 0; j < FLAGS_user_num_each_match; ++j) {
+                        game_score_infos.emplace_back(std::to_string((i + j) % FLAGS_user_num), user_dist(rng));
+                    }
+                    db_manager->RecordMatch("bench_game", std::nullopt, "0", 1, game_score_infos, {});
+                }
+            });
+    std::cout << name << ": RecordMatch sec=" << record_sec << " records/sec=" << FLAGS_record_num / record_sec
+              << std::endl;
+
+    for (const uint32_t thread_num : thread_nums) {
+        const double query_sec = MeasureSec([&]
+                {
+                    std::vector<std::thread> threads;
+                    for (uint32_t i = 0; i < thread_num; ++i) {
+                        threads.emplace_back([&, seed = i]
+                                {
+                                    std::mt19937 rng(seed);
+                                    for (uint32_t i = 0; i < FLAGS_query_num; ++i) {
+                                        db_manager->GetUserProfile(std::to_string(user_dist(rng)), "", "");
+                                    }
+                                });
+                    }
+                    for (auto& thread : threads) {
+                        thread.join();
+                    }
+                });
+        std::cout << name << ": GetUserProfile threads=" << thread_num << " sec=" << query_sec
+                  << " queries/sec=" << FLAGS_query_num * thread_num / query_sec << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    gflags::ParseCommandLineFlags(&argc, &argv, true);
+    std::vector<uint32_t> thread_nums;
+    std::istringstream threads_ss(FLAGS_threads);
+    for (std::string thread_num; std::getline(threads_ss, thread_num, ','); ) {
+        thread_nums.emplace_back(std::stoul(thread_num));
+    }
+    Benchmark("open_per_call", 0, 0, thread_nums);
+    Benchmark("pooled", SQLiteDBManager::k_default_reader_num, 0, thread_nums);
+    Benchmark("write_behind", SQLiteDBManager::k_default_reader_num, FLAGS_flush_interval_ms, thread_nums);
+    return 0;
+}
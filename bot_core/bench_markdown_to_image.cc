@@ -0,0 +1,79 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+// Measure the throughput and the latency of rendering images by forking a markdown2image process for each image, when
+// images are requested by several threads at the same time. The number of running renderers is limited by
+// --max_running_num, so the requests beyond it wait (or are rejected beyond --max_waiting_num) instead of starting
+// more browser engines.
+//
+// Usage: ./bench_markdown_to_image --renderer=./markdown2image --count=100 --concurrency=8 --max_running_num=4
+
+#include <gflags/gflags.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "bot_core/markdown_renderer.h"
+
+DEFINE_string(renderer, k_markdown2image_path, "The path of markdown2image");
+DEFINE_string(image_dir, "/tmp/lgtbot_bench_markdown_to_image", "The directory to save images");
+DEFINE_uint32(count, 100, "The number of rendered images");
+DEFINE_uint32(concurrency, 8, "The number of threads which render images concurrently");
+DEFINE_uint32(max_running_num, 4, "The max number of renderers running at the same time");
+DEFINE_uint32(max_waiting_num, 64, "The max number of requests waiting for a renderer");
+DEFINE_uint32(timeout_ms, 30000, "The timeout of each request in milliseconds");
+
+static const std::string k_markdown =
+    "<style>html,body{color:#fdf3dd; background:#783623;}</style>\n"
+    "| 名次 | 玩家 | 分数 |\n| --- | --- | --- |\n| 1 | A | 100 |\n| 2 | B | 50 |\n";
+
+int main(int argc, char** argv)
+{
+    gflags::ParseCommandLineFlags(&argc, &argv, true);
+    std::filesystem::create_directories(FLAGS_image_dir);
+    MarkdownRenderer renderer(MarkdownRenderer::Options{
+            .command_ = FLAGS_renderer,
+            .max_running_num_ = FLAGS_max_running_num,
+            .max_waiting_num_ = FLAGS_max_waiting_num,
+            .timeout_ = std::chrono::milliseconds(FLAGS_timeout_ms),
+        });
+    std::atomic<uint32_t> next{0};
+    std::atomic<uint32_t> failed{0};
+    std::mutex mutex;
+    std::vector<double> latencies_ms;
+    const auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < FLAGS_concurrency; ++i) {
+        threads.emplace_back([&]
+                {
+                    for (uint32_t no = next++; no < FLAGS_count; no = next++) {
+                        const auto path = std::filesystem::path(FLAGS_image_dir) / (std::to_string(no) + ".png");
+                        const auto render_begin = std::chrono::steady_clock::now();
+                        if (renderer.Render(k_markdown, path.string(), 500) != 0) {
+                            ++failed;
+                        }
+                        const double latency_ms = std::chrono::duration<double, std::milli>(
+                                std::chrono::steady_clock::now() - render_begin).count();
+                        std::lock_guard<std::mutex> l(mutex);
+                        latencies_ms.emplace_back(latency_ms);
+                    }
+                });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::ranges::sort(latencies_ms);
+    const auto percentile = [&](const double p) { return latencies_ms[(latencies_ms.size() - 1) * p]; };
+    std::cout << "images=" << FLAGS_count << " failed=" << failed << " sec=" << sec
+              << " images/sec=" << FLAGS_count / sec << " p50_ms=" << percentile(0.5)
+              << " p99_ms=" << percentile(0.99) << " max_ms=" << latencies_ms.back() << std::endl;
+    return 0;
+}
@@ -0,0 +1,101 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+// Compare the throughput of concurrent match lookups by user ID between a map protected by a global lock (the former
+// implementation of `MatchManager`) and the sharded map.
+//
+// Usage: ./bench_match_index --threads=1,4,16 --user_num=10000 --lookup_num=1000000
+
+#include <gflags/gflags.h>
+
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "bot_core/id.h"
+#include "bot_core/sharded_map.h"
+
+DEFINE_string(threads, "1,4,16", "The numbers of threads which look up matches concurrently, separated by comma");
+DEFINE_uint32(user_num, 10000, "The number of users in matches");
+DEFINE_uint32(user_num_each_match, 5, "The number of users in each match");
+DEFINE_uint64(lookup_num, 1000000, "The number of lookups of each thread");
+
+class Match;
+
+class GlobalLockMap
+{
+  public:
+    std::shared_ptr<Match> Get(const UserID& uid) const
+    {
+        std::lock_guard<std::mutex> l(mutex_);
+        const auto it = map_.find(uid);
+        return it == map_.end() ? nullptr : it->second;
+    }
+
+    bool Insert(const UserID& uid, std::shared_ptr<Match> match)
+    {
+        std::lock_guard<std::mutex> l(mutex_);
+        return map_.emplace(uid, std::move(match)).second;
+    }
+
+  private:
+    mutable std::mutex mutex_;
+    std::map<UserID, std::shared_ptr<Match>> map_;
+};
+
+template <typename Map>
+static void Benchmark(const char* const name, const uint32_t thread_num)
+{
+    Map map;
+    std::vector<UserID> uids;
+    std::shared_ptr<Match> match;
+    for (uint32_t i = 0; i < FLAGS_user_num; ++i) {
+        if (i % FLAGS_user_num_each_match == 0) {
+            // Only the reference count matters, so the match is an empty object sharing the control block.
+            match = std::shared_ptr<Match>(std::make_shared<char>(), nullptr);
+        }
+        uids.emplace_back(std::to_string(100000000 + i * 7919));
+        map.Insert(uids.back(), match);
+    }
+
+    std::vector<std::thread> threads;
+    const auto begin = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < thread_num; ++i) {
+        threads.emplace_back([&, seed = i]
+                {
+                    std::mt19937 rng(seed);
+                    std::uniform_int_distribution<uint32_t> dist(0, uids.size() - 1);
+                    uint64_t found_num = 0;
+                    for (uint64_t i = 0; i < FLAGS_lookup_num; ++i) {
+                        found_num += map.Get(uids[dist(rng)]).use_count() > 0;
+                    }
+                    if (found_num != FLAGS_lookup_num) {
+                        std::cerr << "some matches are not found" << std::endl;
+                    }
+                });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << name << ": threads=" << thread_num << " sec=" << sec
+              << " lookups/sec=" << FLAGS_lookup_num * thread_num / sec << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    gflags::ParseCommandLineFlags(&argc, &argv, true);
+    std::istringstream threads_ss(FLAGS_threads);
+    for (std::string thread_num; std::getline(threads_ss, thread_num, ','); ) {
+        Benchmark<GlobalLockMap>("global_lock", std::stoul(thread_num));
+        Benchmark<ShardedMap<UserID, std::shared_ptr<Match>>>("sharded", std::stoul(thread_num));
+    }
+    return 0;
+}
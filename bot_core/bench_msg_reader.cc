@@ -0,0 +1,80 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+// Compare the time cost to parse a request between splitting it with `std::istringstream` into strings and parsing the
+// numbers with `std::stringstream` (the former implementation of `MsgReader` and `BasicChecker`), and splitting it into
+// string views and parsing the numbers with `std::from_chars`.
+//
+// Each request is a keyword followed by numbers, like the requests of games (e.g. "投注 3 100").
+//
+// Usage: ./bench_msg_reader --number_num=2 --msg_num=1000000
+
+#include <gflags/gflags.h>
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "utility/msg_checker.h"
+
+DEFINE_uint32(number_num, 2, "The number of numbers following the keyword in each request");
+DEFINE_uint32(msg_num, 1000000, "The number of parsed requests");
+
+static uint64_t ParseWithStringStream(const std::string& msg)
+{
+    std::vector<std::string> args;
+    std::istringstream ss(msg);
+    for (std::string arg; ss >> arg;) {
+        args.push_back(arg);
+    }
+    uint64_t sum = args.front().size();
+    for (auto it = std::next(args.begin()); it != args.end(); ++it) {
+        if (uint32_t value; std::stringstream(*it) >> value) {
+            sum += value;
+        }
+    }
+    return sum;
+}
+
+static uint64_t ParseWithMsgReader(const std::string& msg)
+{
+    MsgReader reader(msg);
+    uint64_t sum = reader.NextArg().size();
+    while (reader.HasNext()) {
+        if (const auto value = ParseNumber<uint32_t>(reader.NextArg())) {
+            sum += *value;
+        }
+    }
+    return sum;
+}
+
+static void Benchmark(const char* const name, const std::vector<std::string>& msgs,
+        uint64_t(* const parse)(const std::string&))
+{
+    uint64_t sum = 0;
+    const auto begin = std::chrono::steady_clock::now();
+    for (const auto& msg : msgs) {
+        sum += parse(msg);
+    }
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << name << ": checksum=" << sum << " sec=" << sec << " ns/msg=" << sec * 1e9 / msgs.size() << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    gflags::ParseCommandLineFlags(&argc, &argv, true);
+    std::vector<std::string> msgs;
+    for (uint32_t i = 0; i < FLAGS_msg_num; ++i) {
+        std::string msg = "投注";
+        for (uint32_t j = 0; j < FLAGS_number_num; ++j) {
+            msg += " " + std::to_string(i % 1000 + j);
+        }
+        msgs.emplace_back(std::move(msg));
+    }
+    Benchmark("stringstream", msgs, ParseWithStringStream);
+    Benchmark("msg_reader", msgs, ParseWithMsgReader);
+    return 0;
+}
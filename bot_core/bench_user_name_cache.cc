@@ -0,0 +1,91 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+// Count the `get_user_name_in_group` callbacks invoked for a finished match in a group, without the user name cache
+// (the former implementation) and with it.
+//
+// The names are looked up in the same way as a match does: each round the board shows the names of all players
+// (`Match::PlayerName`), and the scoreboard and the timer alert mention all players (`MsgSender::SaveUser`). When the
+// match is over, the result shows the host (`Match::HostUserName_`) and the names of all players again. Users are
+// picked from a fixed pool so that they play several matches.
+//
+// Usage: ./bench_user_name_cache --player_num=8 --round_num=20 --match_num=100 --callback_latency_us=50
+
+#include <gflags/gflags.h>
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bot_core/user_name_cache.h"
+
+DEFINE_uint32(user_num, 100, "The number of users who play matches");
+DEFINE_uint32(player_num, 8, "The number of players in each match");
+DEFINE_uint32(round_num, 20, "The number of rounds of each match");
+DEFINE_uint32(match_num, 100, "The number of finished matches");
+DEFINE_uint32(callback_latency_us, 50, "The time cost by each callback to imitate the chat adapter");
+
+static uint64_t callback_count = 0;
+
+static void GetUserName(void* const handler, char* const buffer, const size_t size, const char* const user_id)
+{
+    ++callback_count;
+    std::this_thread::sleep_for(std::chrono::microseconds(FLAGS_callback_latency_us));
+    std::snprintf(buffer, size, "user_%s", user_id);
+}
+
+static void GetUserNameInGroup(void* const handler, char* const buffer, const size_t size, const char* const group_id,
+        const char* const user_id)
+{
+    ++callback_count;
+    std::this_thread::sleep_for(std::chrono::microseconds(FLAGS_callback_latency_us));
+    std::snprintf(buffer, size, "user_%s@%s", user_id, group_id);
+}
+
+static void Benchmark(const char* const name, const uint32_t capacity)
+{
+    const LGTBot_Callback callbacks{.get_user_name = GetUserName, .get_user_name_in_group = GetUserNameInGroup};
+    UserNameCache cache(nullptr, callbacks, capacity);
+    callback_count = 0;
+    uint64_t lookup_count = 0;
+    const auto lookup = [&](const std::string& uid)
+        {
+            ++lookup_count;
+            return cache.Get(uid.c_str(), "group");
+        };
+
+    const auto begin = std::chrono::steady_clock::now();
+    for (uint32_t match = 0; match < FLAGS_match_num; ++match) {
+        std::vector<std::string> uids;
+        for (uint32_t i = 0; i < FLAGS_player_num; ++i) {
+            uids.emplace_back(std::to_string((match * FLAGS_player_num + i) % FLAGS_user_num));
+        }
+        for (uint32_t round = 0; round < FLAGS_round_num; ++round) {
+            for (const auto& uid : uids) {
+                lookup(uid); // board
+                lookup(uid); // scoreboard
+                lookup(uid); // timer alert
+            }
+        }
+        lookup(uids[0]); // host
+        for (const auto& uid : uids) {
+            lookup(uid); // result
+        }
+    }
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << name << ": lookups/match=" << lookup_count / FLAGS_match_num
+              << " callbacks/match=" << static_cast<double>(callback_count) / FLAGS_match_num
+              << " sec=" << sec << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    gflags::ParseCommandLineFlags(&argc, &argv, true);
+    Benchmark("no_cache", 0);
+    Benchmark("cached", UserNameCache::k_default_capacity);
+    return 0;
+}
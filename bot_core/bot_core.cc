@@ -4,8 +4,12 @@
 
 #include "bot_core.h"
 
+#include <algorithm>
+#include <array>
 #include <fstream>
 #include <filesystem>
+#include <iterator>
+#include <thread>
 
 #if WITH_GLOG
 #include <glog/logging.h>
@@ -17,21 +21,23 @@
 #include "bot_core/db_manager.h"
 #include "bot_core/match.h"
 #include "bot_core/message_handlers.h"
+#include "bot_core/metrics.h"
 #include "bot_core/msg_sender.h"
+#include "bot_core/tracer.h"
 
 #include "sqlite_modern_cpp.h"
 
 static_assert(sizeof(META_COMMAND_SIGN) == 2, "The META_COMMAND_SIGN string must contain one character");
 static_assert(sizeof(ADMIN_COMMAND_SIGN) == 2, "The ADMIN_COMMAND_SIGN string must contain one character");
 
-static ErrCode HandleRequest(BotCtx& bot, const std::optional<GroupID> gid, const UserID uid, const std::string& msg,
-                             MsgSender& reply)
+static ErrCode HandleRequestInternal(BotCtx& bot, const std::optional<GroupID> gid, const UserID uid,
+                                     const std::string& msg, MsgSender& reply)
 {
-    if (std::string first_arg; !(std::stringstream(msg) >> first_arg) || first_arg.empty()) {
+    if (const auto first_char_pos = msg.find_first_not_of(MsgReader::k_spaces); first_char_pos == std::string::npos) {
         reply() << "[错误] 我不理解，所以你是想表达什么？";
         return EC_REQUEST_EMPTY;
     } else {
-        switch (first_arg[0]) {
+        switch (msg[first_char_pos]) {
         case META_COMMAND_SIGN[0]:
             return HandleMetaRequest(bot, uid, gid, msg, reply);
         case ADMIN_COMMAND_SIGN[0]:
@@ -57,10 +63,78 @@ static ErrCode HandleRequest(BotCtx& bot, const std::optional<GroupID> gid, cons
     }
 }
 
+// All error codes in ascending order.
+static constexpr ErrCode k_errcodes[] = {
+#define ERRCODE_DEF_V(errcode, value) errcode,
+#define ERRCODE_DEF(errcode) errcode,
+#include "bot_core/bot_core.h"
+#undef ERRCODE_DEF_V
+#undef ERRCODE_DEF
+};
+static_assert(std::ranges::is_sorted(k_errcodes));
+
+// The counters of `lgtbot_request_total` are resolved once, so counting a request neither allocates nor locks the metrics
+// registry. The counters are indexed by the type of the request and the index of the error code in `k_errcodes`, and the
+// last counter of each type is for the unknown error codes.
+static MetricCounter& RequestTotalCounter(const bool is_public, const ErrCode rc)
+{
+    using Counters = std::array<MetricCounter*, std::size(k_errcodes) + 1>;
+    static const std::array<Counters, 2> counters = []
+        {
+            std::array<Counters, 2> counters;
+            for (const bool is_public : {false, true}) {
+                const char* const type = is_public ? "public" : "private";
+                for (size_t i = 0; i < std::size(k_errcodes); ++i) {
+                    counters[is_public][i] = &GlobalMetrics().Counter("lgtbot_request_total",
+                            {{"type", type}, {"errcode", errcode2str(k_errcodes[i])}});
+                }
+                const auto undefined_errcode = static_cast<ErrCode>(std::end(k_errcodes)[-1] + 1);
+                counters[is_public].back() = &GlobalMetrics().Counter("lgtbot_request_total",
+                        {{"type", type}, {"errcode", errcode2str(undefined_errcode)}});
+            }
+            return counters;
+        }();
+    const auto it = std::ranges::lower_bound(k_errcodes, rc);
+    return *counters[is_public][it != std::end(k_errcodes) && *it == rc ? it - std::begin(k_errcodes) : std::size(k_errcodes)];
+}
+
+static ErrCode HandleRequest(BotCtx& bot, const std::optional<GroupID> gid, const UserID uid, const std::string& msg,
+                             MsgSender& reply)
+{
+    static MetricHistogram& private_latency =
+        GlobalMetrics().Histogram("lgtbot_request_latency_us", {{"type", "private"}});
+    static MetricHistogram& public_latency =
+        GlobalMetrics().Histogram("lgtbot_request_latency_us", {{"type", "public"}});
+    const char* const type = gid.has_value() ? "public" : "private";
+    ErrCode rc = EC_OK;
+    {
+        ScopedLatency latency(gid.has_value() ? public_latency : private_latency);
+        TraceSpan span(bot.tracer(), "HandleRequest");
+        span.AddArg("type", type);
+        span.AddArg("uid", uid.GetStr());
+        rc = HandleRequestInternal(bot, gid, uid, msg, reply);
+        span.AddArg("errcode", errcode2str(rc));
+    }
+    RequestTotalCounter(gid.has_value(), rc).Add();
+    return rc;
+}
+
 LGTBot_Option LGTBot_InitOptions()
 {
     LGTBot_Option options;
     memset(&options, 0, sizeof(options));
+    options.outbound_thread_num_ = 0;
+    options.outbound_queue_capacity_ = 1024;
+    options.outbound_full_policy_ = LGTBOT_OUTBOUND_BLOCK_WHEN_FULL;
+    options.avatar_cache_ttl_sec_ = 3600;
+    options.avatar_negative_cache_ttl_sec_ = 300;
+    options.user_name_cache_capacity_ = 4096;
+    options.user_name_cache_ttl_sec_ = 600;
+    options.load_module_thread_num_ = std::thread::hardware_concurrency();
+    options.trace_file_max_mb_ = 64;
+    options.deduction_thread_num_ = 1;
+    options.deduction_budget_sec_ = 60;
+    options.db_flush_interval_ms_ = 100;
     return options;
 }
 
@@ -84,6 +158,11 @@ void* LGTBot_Create(const LGTBot_Option* const options, const char** const p)
         set_errmsg("the pointer to the bot options is NULL");
         return nullptr;
     }
+    if (options->log_level_ > LOG_LEVEL_NONE) {
+        set_errmsg("the log level is invalid");
+        return nullptr;
+    }
+    GlobalLogBackend().SetLevel(static_cast<LogLevel>(options->log_level_));
     const auto bot = BotCtx::Create(*options);
     if (const char* const* const errmsg = std::get_if<const char*>(&bot)) {
         set_errmsg(*errmsg);
@@ -97,6 +176,7 @@ void LGTBot_Release(void* const bot_p)
 {
     InfoLog() << "Releasing the bot in Release, addr:" << bot_p;
     delete static_cast<BotCtx*>(bot_p);
+    GlobalLogBackend().Flush();
 }
 
 int LGTBot_ReleaseIfNoProcessingGames(void* const bot_p)
@@ -114,6 +194,7 @@ int LGTBot_ReleaseIfNoProcessingGames(void* const bot_p)
     InfoLog() << "Releasing the bot in ReleaseIfNoProcessingGames, addr:" << bot_p;
     std::ranges::for_each(matches, [](const auto& match) { match->Terminate(true); });
     delete &bot;
+    GlobalLogBackend().Flush();
     return true;
 }
 
@@ -158,6 +239,71 @@ ErrCode LGTBot_HandlePublicRequest(void* const bot_p, const char* const gid, con
     return HandleRequest(bot, gid, uid, msg, sender);
 }
 
+// The request is handled in the mailbox of the user first, which routes it to the mailbox of the match it belongs to.
+// See `MatchExecutor`.
+static void HandleRequestAsync(BotCtx& bot, const std::optional<GroupID> gid, const UserID uid,
+                               std::function<ErrCode()> handle, const LGTBot_RequestDoneCallback done, void* const arg)
+{
+    auto handle_and_done = [handle = std::move(handle), done, arg]
+        {
+            const ErrCode rc = handle();
+            if (done) {
+                done(arg, rc);
+            }
+        };
+    MatchExecutor* const executor = bot.match_executor();
+    if (!executor) {
+        handle_and_done();
+        return;
+    }
+    executor->UserMailbox(uid).Post([&bot, executor, gid, uid, handle_and_done = std::move(handle_and_done)]
+            {
+                std::shared_ptr<Match> match = bot.match_manager().GetMatch(uid);
+                if (!match && gid.has_value()) {
+                    match = bot.match_manager().GetMatch(*gid);
+                }
+                executor->RouteUserTask(uid, match ? match->mailbox() : nullptr, handle_and_done);
+            });
+}
+
+void LGTBot_HandlePrivateRequestAsync(void* const bot_p, const char* const uid, const char* const msg,
+                                      const LGTBot_RequestDoneCallback done, void* const arg)
+{
+    if (!bot_p) {
+        ErrorLog() << "Handle private request async not init failed uid=" << uid << " msg=\"" << msg << "\"";
+        if (done) {
+            done(arg, EC_NOT_INIT);
+        }
+        return;
+    }
+    DebugLog() << "Handle private request async uid=" << uid << " msg=\"" << msg << "\"";
+    BotCtx& bot = *static_cast<BotCtx*>(bot_p);
+    HandleRequestAsync(bot, std::nullopt, uid, [&bot, uid = UserID{uid}, msg = std::string(msg)]
+            {
+                MsgSender sender = bot.MakeMsgSender(uid);
+                return HandleRequest(bot, std::nullopt, uid, msg, sender);
+            }, done, arg);
+}
+
+void LGTBot_HandlePublicRequestAsync(void* const bot_p, const char* const gid, const char* const uid,
+                                     const char* const msg, const LGTBot_RequestDoneCallback done, void* const arg)
+{
+    if (!bot_p) {
+        ErrorLog() << "Handle public request async not init failed uid=" << uid << " gid=" << gid << " msg=" << msg;
+        if (done) {
+            done(arg, EC_NOT_INIT);
+        }
+        return;
+    }
+    DebugLog() << "Handle public request async uid=" << uid << " gid=" << gid << " msg=" << msg;
+    BotCtx& bot = *static_cast<BotCtx*>(bot_p);
+    HandleRequestAsync(bot, GroupID{gid}, uid, [&bot, gid = GroupID{gid}, uid = UserID{uid}, msg = std::string(msg)]
+            {
+                PublicReplyMsgSender sender(bot.MakeMsgSender(gid), uid);
+                return HandleRequest(bot, gid, uid, msg, sender);
+            }, done, arg);
+}
+
 int LGTBot_IsUserInMatch(void* const bot_p, const char* const uid)
 {
     return static_cast<BotCtx*>(bot_p)->match_manager().GetMatch(UserID{uid}) != nullptr;
@@ -167,3 +313,51 @@ int LGTBot_IsGroupInMatch(void* const bot_p, const char* const gid)
 {
     return static_cast<BotCtx*>(bot_p)->match_manager().GetMatch(GroupID{gid}) != nullptr;
 }
+
+void LGTBot_GetOutboundMetrics(void* const bot_p, LGTBot_OutboundMetrics* const metrics)
+{
+    *metrics = static_cast<BotCtx*>(bot_p)->outbound().Metrics();
+}
+
+static std::vector<MetricsRegistry::Gauge> BotGauges(BotCtx& bot)
+{
+    const auto outbound = bot.outbound().Metrics();
+    const auto image_cache = bot.image_cache().GetStats();
+    const auto avatar_cache = bot.avatar_cache().GetStats();
+    const auto name_cache = bot.name_cache().GetStats();
+    return std::vector<MetricsRegistry::Gauge>{
+        {"lgtbot_match_count", static_cast<uint64_t>(bot.match_manager().Matches().size())},
+        {"lgtbot_outbound_queued_count", outbound.queued_count_},
+        {"lgtbot_outbound_sent_count", outbound.sent_count_},
+        {"lgtbot_outbound_dropped_count", outbound.dropped_count_},
+        {"lgtbot_outbound_blocked_count", outbound.blocked_count_},
+        {"lgtbot_outbound_pending_count", outbound.pending_count_},
+        {"lgtbot_outbound_max_pending_count", outbound.max_pending_count_},
+        {"lgtbot_image_cache_hit_count", image_cache.hit_count_},
+        {"lgtbot_image_cache_miss_count", image_cache.miss_count_},
+        {"lgtbot_image_cache_bytes", image_cache.total_bytes_},
+        {"lgtbot_avatar_cache_hit_count", avatar_cache.hit_count_},
+        {"lgtbot_avatar_cache_miss_count", avatar_cache.miss_count_},
+        {"lgtbot_avatar_download_failed_count", avatar_cache.download_failed_count_},
+        {"lgtbot_user_name_cache_hit_count", name_cache.hit_count_},
+        {"lgtbot_user_name_cache_miss_count", name_cache.miss_count_},
+    };
+}
+
+size_t LGTBot_DumpMetrics(void* const bot_p, const LGTBot_MetricsFormat format, char* const buffer, const size_t size)
+{
+    const auto gauges = BotGauges(*static_cast<BotCtx*>(bot_p));
+    const std::string str = format == LGTBOT_METRICS_JSON ? GlobalMetrics().DumpJson(gauges) :
+                                                            GlobalMetrics().DumpPrometheus(gauges);
+    if (size > 0) {
+        const size_t copied_size = std::min(str.size(), size - 1);
+        std::copy_n(str.data(), copied_size, buffer);
+        buffer[copied_size] = '\0';
+    }
+    return str.size();
+}
+
+void LGTBot_InvalidateUserName(void* const bot_p, const char* const gid, const char* const uid)
+{
+    static_cast<BotCtx*>(bot_p)->name_cache().Invalidate(uid, gid);
+}
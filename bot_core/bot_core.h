@@ -46,6 +46,7 @@ ERRCODE_DEF_V(EC_REQUEST_EMPTY, 301)
 ERRCODE_DEF(EC_REQUEST_NOT_ADMIN)
 ERRCODE_DEF(EC_REQUEST_NOT_FOUND)
 ERRCODE_DEF(EC_REQUEST_UNKNOWN_GAME)
+ERRCODE_DEF(EC_REQUEST_NO_TRACE_PATH)
 
 ERRCODE_DEF_V(EC_GAME_ALREADY_RELEASE, 401)
 ERRCODE_DEF(EC_USER_SUICIDE_FAILED)
@@ -156,6 +157,13 @@ typedef struct
     void (*handle_messages)(void* handler, const char* id, const int is_to_user, const LGTBot_Message* messages, const size_t size);
 } LGTBot_Callback;
 
+// What to do when a message is flushed but the outbound queue is full.
+typedef enum
+{
+    LGTBOT_OUTBOUND_BLOCK_WHEN_FULL, // block the producer until the queue has room
+    LGTBOT_OUTBOUND_DROP_WHEN_FULL,  // drop the message
+} LGTBot_OutboundFullPolicy;
+
 typedef struct
 {
     // The path to the game modules, be NULL if we do not want to load any games.
@@ -178,8 +186,104 @@ typedef struct
 
     // The callbacks to help sending messages.
     LGTBot_Callback callbacks_;
+
+    // The number of threads to invoke `handle_messages`. Messages sent to the same user or group are always handled in
+    // order. Be 0 (the default) if we want to invoke `handle_messages` synchronously in the thread which generates the
+    // messages.
+    uint32_t outbound_thread_num_;
+
+    // The maximum number of message batches waiting to be sent, be 0 if there is no limit.
+    uint32_t outbound_queue_capacity_;
+
+    // What to do when the outbound queue is full. A thread which holds the lock of a match is never blocked, it blocks
+    // after releasing the lock if the queue is still full.
+    LGTBot_OutboundFullPolicy outbound_full_policy_;
+
+    // The number of threads to handle matches. If it is not 0, requests passed to the asynchronous interfaces, timeouts
+    // and computer acts of a match are handled one by one in the mailbox of the match, and different matches are handled
+    // in parallel. Be 0 if we want to handle them in the threads which invoke the interfaces or fire the timers.
+    uint32_t match_thread_num_;
+
+    // The seconds for which a downloaded user avatar is reused before downloading it again. Be 0 if we
+    // want to download it each time it is shown.
+    uint32_t avatar_cache_ttl_sec_;
+
+    // The seconds for which the download of a user avatar is not retried after it fails.
+    uint32_t avatar_negative_cache_ttl_sec_;
+
+    // The maximum number of user names returned by `get_user_name` and `get_user_name_in_group` to be cached. Be 0 if
+    // we want to invoke the callbacks each time a name is shown.
+    uint32_t user_name_cache_capacity_;
+
+    // The seconds for which a cached user name is reused. Names can also be invalidated by `LGTBot_InvalidateUserName`.
+    uint32_t user_name_cache_ttl_sec_;
+
+    // The number of threads to load game modules when the bot is created. Be 0 if we want to load them one by one in
+    // the thread which invokes `LGTBot_Create`.
+    uint32_t load_module_thread_num_;
+
+    // The path to the Chrome trace event file which spans of requests and timeouts are written to, be NULL if we do
+    // not want to trace. Tracing is started by the administor with the sampling rate or the traced matches.
+    const char* trace_path_;
+
+    // The maximum megabytes of the trace file. The full file is renamed with the suffix '.1' and a new file is started.
+    uint32_t trace_file_max_mb_;
+
+    // The path to the directory which the journal of each started match is written to, be NULL if we do not want to
+    // record journals. A journal can be replayed by the replay_match tool.
+    const char* journal_path_;
+
+    // The minimal level of logs to be written: 0-DEBUG, 1-INFO, 2-WARN, 3-ERROR, 4-FATAL, 5-NONE. Arguments of logs below
+    // the level are not evaluated. The level is shared by all bots in the process.
+    uint32_t log_level_;
+
+    // The number of threads to fast-forward the matches where all users are eliminated and only computers are left.
+    // The rest of such a match is played out without timers and messages, and the match is unlocked between the rounds
+    // of computer acts. Be 0 if we want to play it out in the thread which eliminates the last user.
+    uint32_t deduction_thread_num_;
+
+    // The seconds for which a match can be fast-forwarded. If the match is not over by then, it is terminated and the
+    // result is not recorded. Be 0 if there is no limit.
+    uint32_t deduction_budget_sec_;
+
+    // The milliseconds for which the results of matches are kept in memory before being written to the database in one
+    // transaction. The results are appended to a journal beside the database first, so they are not lost if the bot
+    // crashes. Be 0 if we want to write each result to the database when the match is over.
+    uint32_t db_flush_interval_ms_;
+
+    // Optional. Handle the messages sent to several users, which is used to boardcast messages in private matches. If it
+    // is NULL, `callbacks_.handle_messages` is invoked for each user instead. It is not a member of `LGTBot_Callback`
+    // to keep the layout of the options used by former adapters.
+    // Inputs:
+    //   - `handler`: The user defined handler.
+    //   - `user_ids`: The IDs of users which receive the messages, never be NULL.
+    //   - `user_num`: The size of `user_ids`.
+    //   - `messages`: The messages sent to each user.
+    //   - `size`: The size of the buffer.
+    void (*handle_messages_multi_)(void* handler, const char* const* user_ids, const size_t user_num,
+                                   const LGTBot_Message* messages, const size_t size);
 } LGTBot_Option;
 
+// Invoked when a request passed to the asynchronous interfaces is handled.
+// Inputs:
+//   - `arg`: The argument passed to the asynchronous interface.
+//   - `errcode`: The errcode. If the message is handled well, the errcode should be EC_OK.
+typedef void (*LGTBot_RequestDoneCallback)(void* arg, enum ErrCode errcode);
+
+typedef struct
+{
+    uint64_t queued_count_;      // The number of message batches which are accepted.
+    uint64_t sent_count_;        // The number of message batches which have been passed to `handle_messages`.
+    uint64_t dropped_count_;     // The number of message batches which are dropped because the queue is full.
+    uint64_t blocked_count_;     // The number of times the producer is blocked because the queue is full.
+    uint64_t pending_count_;     // The number of message batches waiting to be sent now.
+    uint64_t max_pending_count_; // The maximum number of message batches waiting to be sent.
+    uint64_t total_latency_us_;  // The sum of time from queuing to `handle_messages` returning, in microseconds.
+    uint64_t max_latency_us_;    // The maximum time from queuing to `handle_messages` returning, in microseconds.
+} LGTBot_OutboundMetrics;
+
+typedef enum { LGTBOT_METRICS_PROMETHEUS, LGTBOT_METRICS_JSON } LGTBot_MetricsFormat;
+
 // Get the initialized options for the bot.
 // Outputs:
 //   The initialized options for the bot.
@@ -224,6 +328,29 @@ DLLEXPORT(enum ErrCode) LGTBot_HandlePrivateRequest(void* bot, const char* user_
 //   The errcode. If the message is handled well, the returned errcode should be EC_OK.
 DLLEXPORT(enum ErrCode) LGTBot_HandlePublicRequest(void* bot, const char* group_id, const char* user_id, const char* msg);
 
+// The same as `LGTBot_HandlePrivateRequest`, but returns before the message is handled if `match_thread_num_` is not 0.
+// Requests of the same user are handled in order.
+// Inputs:
+//   - `bot`: The pointer to the bot, should not be NULL.
+//   - `user_id`: The user ID, should not be NULL.
+//   - `msg`: The message, should not be NULL. It is copied so it can be released when the function returns.
+//   - `done`: The callback invoked when the message is handled, be NULL if we do not care about the errcode.
+//   - `arg`: The argument passed to `done`.
+DLLEXPORT(void) LGTBot_HandlePrivateRequestAsync(void* bot, const char* user_id, const char* msg,
+                                                 LGTBot_RequestDoneCallback done, void* arg);
+
+// The same as `LGTBot_HandlePublicRequest`, but returns before the message is handled if `match_thread_num_` is not 0.
+// Requests of the same user are handled in order.
+// Inputs:
+//   - `bot`: The pointer to the bot, should not be NULL.
+//   - `group_id`: The group ID, should not be NULL.
+//   - `user_id`: The user ID, should not be NULL.
+//   - `msg`: The message, should not be NULL. It is copied so it can be released when the function returns.
+//   - `done`: The callback invoked when the message is handled, be NULL if we do not care about the errcode.
+//   - `arg`: The argument passed to `done`.
+DLLEXPORT(void) LGTBot_HandlePublicRequestAsync(void* bot, const char* group_id, const char* user_id, const char* msg,
+                                                LGTBot_RequestDoneCallback done, void* arg);
+
 // To check whether a user is in a match.
 // Inputs:
 //   - `bot`: The pointer to the bot, should not be NULL.
@@ -240,6 +367,32 @@ DLLEXPORT(int) LGTBot_IsUserInMatch(void* bot, const char* user_id);
 //  If the group is in a match, return 1. Otherwise, return 0;
 DLLEXPORT(int) LGTBot_IsGroupInMatch(void* bot, const char* group_id);
 
+// Get the metrics of sending messages.
+// Inputs:
+//   - `bot`: The pointer to the bot, should not be NULL.
+//   - `metrics`: The pointer to the metrics to be filled, should not be NULL.
+DLLEXPORT(void) LGTBot_GetOutboundMetrics(void* bot, LGTBot_OutboundMetrics* metrics);
+
+// Dump the metrics, which contain the latency histograms of handling requests, game stages, rendering markdowns,
+// flushing messages and recording matches, the counters of requests and timeouts, and the metrics of the caches and sending messages
+// of the bot. Latencies are in microseconds.
+// Inputs:
+//   - `bot`: The pointer to the bot, should not be NULL.
+//   - `format`: The format of the dumped text.
+//   - `buffer`: The buffer to store the null-terminated text. Can be NULL if `size` is 0.
+//   - `size`: The size of the buffer.
+// Outputs:
+//   The length of the whole text. If it is not less than `size`, the text is truncated, and we can dump again with a
+//   larger buffer.
+DLLEXPORT(size_t) LGTBot_DumpMetrics(void* bot, LGTBot_MetricsFormat format, char* buffer, size_t size);
+
+// Invalidate the cached names of the user, which should be invoked when the name of the user is changed.
+// Inputs:
+//   - `bot`: The pointer to the bot, should not be NULL.
+//   - `group_id`: The group ID. Be NULL if we want to invalidate the names of the user in all groups and out of groups.
+//   - `user_id`: The user ID, should not be NULL.
+DLLEXPORT(void) LGTBot_InvalidateUserName(void* bot, const char* group_id, const char* user_id);
+
 // Get version.
 // Output:
 //   The version of the bot.
@@ -2,8 +2,10 @@
 //
 // This source code is licensed under LGPLv2 (found in the LICENSE file).
 
-#include <regex>
+#include <atomic>
+#include <chrono>
 #include <fstream>
+#include <thread>
 #include <cstring>
 #include <ranges>
 #include <span>
@@ -65,15 +67,28 @@ static auto FillAchievements(const std::span<const lgtbot::game::GameAchievement
     return result;
 }
 
-static void LoadGame(HINSTANCE mod, GameHandleMap& game_handles)
+struct GameModule
 {
+    GameHandle::BasicInfo info_;
+    GameHandle::InternalHandler internal_handler_;
+    lgtbot::game::MutableGenericOptions default_generic_options_;
+};
+
+static std::optional<GameModule> LoadGame(const std::string& path)
+{
+    const auto begin = std::chrono::steady_clock::now();
+#ifdef _WIN32
+    HINSTANCE mod = LoadLibrary(path.c_str());
+#else
+    HINSTANCE mod = dlopen(path.c_str(), RTLD_LAZY);
+#endif
     if (!mod) {
 #ifdef __linux__
         ErrorLog() << "Load mod failed: " << dlerror();
 #else
         ErrorLog() << "Load mod failed";
 #endif
-        return;
+        return std::nullopt;
     }
     const auto load_proc = [&mod](const char* const name)
     {
@@ -88,42 +103,44 @@ static void LoadGame(HINSTANCE mod, GameHandleMap& game_handles)
     };
     try {
         const lgtbot::game::GameInfo game_info = reinterpret_cast<lgtbot::game::GameInfo(*)()>(load_proc("GetGameInfo"))();
-        game_handles.emplace(std::piecewise_construct, std::forward_as_tuple(game_info.game_name_), std::forward_as_tuple(
-                    GameHandle::BasicInfo{
-                        .name_ = game_info.game_name_,
-                        .module_name_ = game_info.module_name_,
-                        .developer_ = game_info.developer_,
-                        .description_ = game_info.description_,
-                        .rule_ = game_info.rule_,
-                        .achievements_ = FillAchievements(std::span(game_info.achievements_.data_, game_info.achievements_.size_)),
-                        .max_player_num_fn_ = reinterpret_cast<GameHandle::max_player_num_handler>(load_proc("MaxPlayerNum")),
-                        .multiple_fn_ = reinterpret_cast<GameHandle::multiple_handler>(load_proc("Multiple")),
-                        .handle_rule_command_fn_ = reinterpret_cast<GameHandle::rule_command_handler>(load_proc("HandleRuleCommand")),
-                        .handle_init_options_command_fn_ = reinterpret_cast<GameHandle::init_options_command_handler>(load_proc("HandleInitOptionsCommand")),
-                    },
-                    GameHandle::InternalHandler{
-                        .game_options_allocator_ = reinterpret_cast<GameHandle::game_options_allocator>(load_proc("NewGameOptions")),
-                        .game_options_deleter_ = reinterpret_cast<GameHandle::game_options_deleter>(load_proc("DeleteGameOptions")),
-                        .main_stage_allocator_ = reinterpret_cast<GameHandle::main_stage_allocator>(load_proc("NewMainStage")),
-                        .main_stage_deleter_ = reinterpret_cast<GameHandle::main_stage_deleter>(load_proc("DeleteMainStage")),
-                        .mod_guard_ = [mod] { FreeLibrary(mod); },
-                    },
-                    game_info.default_generic_options_
-                    ));
+        GameModule game_module{
+            .info_ = GameHandle::BasicInfo{
+                .name_ = game_info.game_name_,
+                .module_name_ = game_info.module_name_,
+                .developer_ = game_info.developer_,
+                .description_ = game_info.description_,
+                .achievements_ = FillAchievements(std::span(game_info.achievements_.data_, game_info.achievements_.size_)),
+                // the modules built before `GetGameRule` is exported give the rule by `GetGameInfo`
+                .rule_fn_ = reinterpret_cast<GameHandle::rule_handler>(GetProcAddress(mod, "GetGameRule")),
+                .rule_ = game_info.rule_ ? game_info.rule_ : "",
+                .max_player_num_fn_ = reinterpret_cast<GameHandle::max_player_num_handler>(load_proc("MaxPlayerNum")),
+                .multiple_fn_ = reinterpret_cast<GameHandle::multiple_handler>(load_proc("Multiple")),
+                .handle_rule_command_fn_ = reinterpret_cast<GameHandle::rule_command_handler>(load_proc("HandleRuleCommand")),
+                .handle_init_options_command_fn_ = reinterpret_cast<GameHandle::init_options_command_handler>(load_proc("HandleInitOptionsCommand")),
+            },
+            .internal_handler_ = GameHandle::InternalHandler{
+                .game_options_allocator_ = reinterpret_cast<GameHandle::game_options_allocator>(load_proc("NewGameOptions")),
+                .game_options_deleter_ = reinterpret_cast<GameHandle::game_options_deleter>(load_proc("DeleteGameOptions")),
+                .main_stage_allocator_ = reinterpret_cast<GameHandle::main_stage_allocator>(load_proc("NewMainStage")),
+                .main_stage_deleter_ = reinterpret_cast<GameHandle::main_stage_deleter>(load_proc("DeleteMainStage")),
+                .mod_guard_ = [mod] { FreeLibrary(mod); },
+            },
+            .default_generic_options_ = game_info.default_generic_options_,
+        };
+        InfoLog() << "Loaded library " << path << " successfully, cost_ms="
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin).count();
+        return game_module;
     } catch (const std::exception& e) {
-        ErrorLog() << "Load mod failed: " << e.what();
-        return;
+        ErrorLog() << "Load mod " << path << " failed: " << e.what();
+        FreeLibrary(mod);
+        return std::nullopt;
     }
-    InfoLog() << "Loaded successfully!";
 }
 
 // TODO: use std::expect
-static std::variant<GameHandleMap, const char*> LoadGameModules(const char* const games_path)
+static std::variant<std::vector<std::string>, const char*> ListGameModules(const char* const games_path)
 {
-    GameHandleMap game_handles;
-    if (games_path == nullptr) {
-        return game_handles;
-    }
+    std::vector<std::string> paths;
 #ifdef _WIN32
     WIN32_FIND_DATA file_data;
     HANDLE file_handle = FindFirstFile((std::string(games_path) + "\\*.dll").c_str(), &file_data);
@@ -131,31 +148,80 @@ static std::variant<GameHandleMap, const char*> LoadGameModules(const char* cons
         return "LoadGameModules: find first file failed";
     }
     do {
-        const auto dll_path = std::string(games_path) + "\\" + file_data.cFileName;
-        LoadGame(LoadLibrary(dll_path.c_str()), game_handles);
+        paths.emplace_back(std::string(games_path) + "\\" + file_data.cFileName);
     } while (FindNextFile(file_handle, &file_data));
     FindClose(file_handle);
-    InfoLog() << "Load module count: " << game_handles.size();
 #elif __linux__
     DIR* d = opendir(games_path);
     if (!d) {
         return "LoadGameModules: open directory failed";
     }
-    const std::regex base_regex(".*so");
-    std::smatch base_match;
-    struct stat st;
     for (dirent* dp = nullptr; (dp = readdir(d)) != NULL;) {
-        std::string name(dp->d_name);
-        if (std::regex_match(name, base_match, base_regex); base_match.empty()) {
+        const std::string_view name(dp->d_name);
+        if (!name.ends_with(".so")) {
             DebugLog() << "Find irrelevant file " << name << ", skip";
             continue;
         }
-        InfoLog() << "Loading library " << name;
-        LoadGame(dlopen((std::string(games_path) + "/" + name).c_str(), RTLD_LAZY), game_handles);
+        paths.emplace_back(std::string(games_path) + "/" + dp->d_name);
     }
-    InfoLog() << "Loading finished.";
     closedir(d);
 #endif
+    std::ranges::sort(paths); // the order of files in the directory is not specified
+    return paths;
+}
+
+// Modules are loaded by |thread_num| threads, or by the current thread if |thread_num| is 0.
+// TODO: use std::expect
+static std::variant<GameHandleMap, const char*> LoadGameModules(const char* const games_path, const uint32_t thread_num)
+{
+    GameHandleMap game_handles;
+    if (games_path == nullptr) {
+        return game_handles;
+    }
+    const auto begin = std::chrono::steady_clock::now();
+    auto paths = ListGameModules(games_path);
+    if (const char* const* const errmsg = std::get_if<const char*>(&paths)) {
+        return *errmsg;
+    }
+    const auto& module_paths = std::get<std::vector<std::string>>(paths);
+    std::vector<std::optional<GameModule>> game_modules(module_paths.size());
+    if (thread_num == 0) {
+        for (size_t i = 0; i < module_paths.size(); ++i) {
+            game_modules[i] = LoadGame(module_paths[i]);
+        }
+    } else {
+        std::atomic<size_t> next_index{0};
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < std::min<size_t>(thread_num, module_paths.size()); ++i) {
+            threads.emplace_back([&]()
+                    {
+                        for (size_t i = 0; (i = next_index++) < module_paths.size(); ) {
+                            game_modules[i] = LoadGame(module_paths[i]);
+                        }
+                    });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    for (auto& game_module : game_modules) {
+        if (!game_module.has_value()) {
+            continue;
+        }
+        // Check before emplacing because the handle is constructed even if the name exists, and its destructor would
+        // free the module.
+        if (game_handles.contains(game_module->info_.name_)) {
+            ErrorLog() << "Load mod failed: duplicate game name " << game_module->info_.name_;
+            game_module->internal_handler_.mod_guard_();
+            continue;
+        }
+        game_handles.emplace(std::piecewise_construct, std::forward_as_tuple(game_module->info_.name_),
+                std::forward_as_tuple(game_module->info_, game_module->internal_handler_,
+                    game_module->default_generic_options_));
+    }
+    InfoLog() << "Loading finished, module_count=" << game_handles.size() << " file_count=" << module_paths.size()
+              << " thread_num=" << thread_num << " cost_ms="
+              << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin).count();
     if (game_handles.empty()) {
         return "LoadGameModules: find no games";
     }
@@ -193,7 +259,8 @@ static std::variant<nlohmann::json, const char*> LoadConfig(const char* const co
         return "LoadConfig: parse configuration file failed";
     }
     for (const auto& [option_name, value] : j["bot"]["options"].items()) {
-        MsgReader msg_reader(value.get<std::string>());
+        const auto option_value = value.get<std::string>();
+        MsgReader msg_reader(option_value);
         if (bot_options.SetOption(option_name, msg_reader)) {
             InfoLog() << "LoadConfig set bot option successfully: " << option_name << " " << value;
         } else {
@@ -230,11 +297,28 @@ BotCtx::BotCtx(std::string game_path,
 #endif
                MutableBotOption mutable_bot_options,
                nlohmann::json config_json,
-               void* const handler)
+               void* const handler,
+               const OutboundPipeline::Options& outbound_options,
+               const uint32_t match_thread_num,
+               const uint32_t avatar_cache_ttl_sec,
+               const uint32_t avatar_negative_cache_ttl_sec,
+               const uint32_t user_name_cache_capacity,
+               const uint32_t user_name_cache_ttl_sec,
+               std::unique_ptr<Tracer> tracer,
+               std::string journal_path,
+               const uint32_t deduction_thread_num,
+               const uint32_t deduction_budget_sec,
+               Clock* const clock)
     : game_path_(std::move(game_path))
     , conf_path_(std::move(conf_path))
     , image_path_(std::move(image_path))
+    , journal_path_(std::move(journal_path))
+    , image_cache_(std::filesystem::path(image_path_) / "gen")
+    , avatar_cache_(std::filesystem::absolute(image_path_) / "avatar", std::chrono::seconds(avatar_cache_ttl_sec),
+            std::chrono::seconds(avatar_negative_cache_ttl_sec))
     , callbacks_(std::move(callbacks))
+    , name_cache_(handler, callbacks_, user_name_cache_capacity, std::chrono::seconds(user_name_cache_ttl_sec))
+    , outbound_(handler, callbacks_, outbound_options)
     , game_handles_(std::move(game_handles))
     , admins_(std::move(admins))
 #ifdef WITH_SQLITE
@@ -244,27 +328,53 @@ BotCtx::BotCtx(std::string game_path,
     , config_json_(std::move(config_json))
     , match_manager_(*this)
     , handler_(handler)
+    , tracer_(std::move(tracer))
+    , timer_scheduler_(clock ? std::make_unique<TimerScheduler>(TimerScheduler::DefaultWorkerNum(), *clock) : nullptr)
+    , match_executor_(match_thread_num > 0 ? std::make_unique<MatchExecutor>(match_thread_num) : nullptr)
+    , deduction_executor_(deduction_thread_num > 0 ? std::make_unique<DeductionExecutor>(deduction_thread_num) : nullptr)
+    , deduction_budget_(deduction_budget_sec)
 {
 }
 
+BotCtx::~BotCtx()
+{
+    // Abandon the unfinished deductions, otherwise stopping may take as long as the deduction budget.
+    if (deduction_executor_) {
+        deduction_executor_->Stop();
+    }
+    // Handle the queued requests before releasing the matches they refer to.
+    if (match_executor_) {
+        match_executor_->Stop();
+    }
+}
+
 std::variant<BotCtx*, const char*> BotCtx::Create(const LGTBot_Option& options)
 {
-    auto game_handles = LoadGameModules(options.game_path_);
+    const auto begin = std::chrono::steady_clock::now();
+    const auto elapsed_ms = [&begin]()
+        {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin).count();
+        };
+    auto game_handles = LoadGameModules(options.game_path_, options.load_module_thread_num_);
     if (const char* const* const errmsg = std::get_if<const char*>(&game_handles)) {
         return *errmsg;
     }
+    const auto load_modules_ms = elapsed_ms();
 #ifdef WITH_SQLITE
     std::unique_ptr<DBManagerBase> db_manager;
-    if (options.db_path_ && !(db_manager = SQLiteDBManager::UseDB(options.db_path_))) {
+    if (options.db_path_ && !(db_manager = SQLiteDBManager::UseDB(options.db_path_,
+                    SQLiteDBManager::k_default_reader_num, options.db_flush_interval_ms_))) {
         return "use database failed";
     }
 #endif
+    const auto use_db_ms = elapsed_ms();
     MutableBotOption bot_options;
     auto config_json = LoadConfig(options.conf_path_, std::get<GameHandleMap>(game_handles),
             bot_options);
     if (const char* const* const errmsg = std::get_if<const char*>(&config_json)) {
         return *errmsg;
     }
+    const auto load_config_ms = elapsed_ms();
     for (const void* const* p = reinterpret_cast<const void* const*>(&options.callbacks_);
             p < reinterpret_cast<const void* const*>(&options.callbacks_ + 1);
             ++p) {
@@ -272,7 +382,7 @@ std::variant<BotCtx*, const char*> BotCtx::Create(const LGTBot_Option& options)
             return "some of the callback is NULL";
         }
     }
-    return new BotCtx(
+    auto* const bot = new BotCtx(
             options.game_path_ ? options.game_path_ : "",
             options.conf_path_ ? options.conf_path_ : "",
             options.image_path_ ? options.image_path_ : (std::filesystem::current_path() / ".lgtbot_image").string(),
@@ -284,8 +394,28 @@ std::variant<BotCtx*, const char*> BotCtx::Create(const LGTBot_Option& options)
 #endif
             std::move(bot_options),
             std::move(std::get<nlohmann::json>(config_json)),
-            options.handler_
+            options.handler_,
+            OutboundPipeline::Options{
+                .thread_num_ = options.outbound_thread_num_,
+                .queue_capacity_ = options.outbound_queue_capacity_,
+                .full_policy_ = options.outbound_full_policy_,
+                .handle_messages_multi_ = options.handle_messages_multi_,
+            },
+            options.match_thread_num_,
+            options.avatar_cache_ttl_sec_,
+            options.avatar_negative_cache_ttl_sec_,
+            options.user_name_cache_capacity_,
+            options.user_name_cache_ttl_sec_,
+            options.trace_path_ ? std::make_unique<Tracer>(options.trace_path_,
+                uint64_t(options.trace_file_max_mb_) << 20) : nullptr,
+            options.journal_path_ ? options.journal_path_ : "",
+            options.deduction_thread_num_,
+            options.deduction_budget_sec_
             );
+    InfoLog() << "BotCtx startup finished, game_count=" << bot->game_handles().size()
+              << " load_modules_ms=" << load_modules_ms << " use_db_ms=" << use_db_ms - load_modules_ms
+              << " load_config_ms=" << load_config_ms - use_db_ms << " total_ms=" << elapsed_ms();
+    return bot;
 }
 
 static bool SaveConfig_(nlohmann::json& json, std::string_view conf_path)
@@ -356,22 +486,19 @@ bool BotCtx::UpdateGameDefaultFormal(const std::string& game_name, const bool is
 
 std::string BotCtx::GetUserAvatar(const char* const user_id, const int32_t size) const
 {
-    const auto path = (std::filesystem::absolute(image_path_) / "avatar" / user_id) += ".png";
-    std::filesystem::create_directories(path.parent_path());
-    const std::string path_str = path.string();
-    if (!callbacks_.download_user_avatar(handler_, user_id, path_str.c_str())) {
-        CharToImage(user_id[0], path_str);
-    }
+    const std::string path_str = avatar_cache_.GetOrDownload(user_id,
+            [this, user_id](const std::string& path) { return callbacks_.download_user_avatar(handler_, user_id, path.c_str()); },
+            [user_id](const std::string& path) { CharToImage(user_id[0], path); });
     return "<img src=\"file:///" + path_str + "\" style=\"width:" + std::to_string(size) + "px; height:" +
         std::to_string(size) + "px; border-radius:50%; vertical-align: middle;\"/>";
 }
 
 MsgSender BotCtx::MakeMsgSender(const UserID& user_id, Match* const match) const
 {
-    return MsgSender(handler_, image_path_, callbacks_, user_id, match);
+    return MsgSender(image_cache_, name_cache_, outbound_, user_id, match);
 }
 
 MsgSender BotCtx::MakeMsgSender(const GroupID& group_id, Match* const match) const
 {
-    return MsgSender(handler_, image_path_, callbacks_, group_id, match);
+    return MsgSender(image_cache_, name_cache_, outbound_, group_id, match);
 }
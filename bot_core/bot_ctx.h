@@ -4,15 +4,25 @@
 
 #pragma once
 
+#include <chrono>
 #include <mutex>
 #include <map>
 #include <set>
 #include <optional>
 
+#include "bot_core/avatar_cache.h"
+#include "bot_core/clock.h"
+#include "bot_core/match_executor.h"
 #include "bot_core/match_manager.h"
 #include "bot_core/id.h"
 #include "bot_core/db_manager.h"
 #include "bot_core/options.h"
+#include "bot_core/timer.h"
+#include "bot_core/image_cache.h"
+#include "bot_core/msg_sender.h"
+#include "bot_core/outbound_pipeline.h"
+#include "bot_core/tracer.h"
+#include "bot_core/user_name_cache.h"
 #include "utility/lock_wrapper.h"
 #include "nlohmann/json.hpp"
 
@@ -26,10 +36,29 @@ class BotCtx
     BotCtx(const BotCtx&) = delete;
     BotCtx(BotCtx&&) = delete;
 
+    ~BotCtx();
+
     static std::variant<BotCtx*, const char*> Create(const LGTBot_Option& options);
 
     MatchManager& match_manager() { return match_manager_; }
 
+    // Be NULL if requests are handled in the threads which invoke them.
+    MatchExecutor* match_executor() { return match_executor_.get(); }
+
+    // Be NULL if the matches are fast-forwarded in the threads which eliminate the last users.
+    DeductionExecutor* deduction_executor() { return deduction_executor_.get(); }
+
+    // Be zero if there is no limit.
+    std::chrono::seconds deduction_budget() const { return deduction_budget_; }
+
+    // The clock of the timers of matches, which is the steady clock unless a simulated clock is passed.
+    Clock& clock() const { return timer_scheduler().clock(); }
+
+    TimerScheduler& timer_scheduler() const
+    {
+        return timer_scheduler_ ? *timer_scheduler_ : TimerScheduler::Instance();
+    }
+
     auto& game_handles() { return game_handles_; }
     const auto& game_handles() const { return game_handles_; }
 
@@ -39,6 +68,17 @@ class BotCtx
 
     const std::string& image_path() const { return image_path_; }
 
+    const std::string& journal_path() const { return journal_path_; }
+
+    const MarkdownImageCache& image_cache() const { return image_cache_; }
+
+    const UserAvatarCache& avatar_cache() const { return avatar_cache_; }
+
+    const OutboundPipeline& outbound() const { return outbound_; }
+
+    // Be NULL if the trace path is not set.
+    Tracer* tracer() const { return tracer_.get(); }
+
 #ifdef WITH_SQLITE
     DBManagerBase* db_manager() const { return db_manager_.get(); }
 #endif
@@ -57,22 +97,23 @@ class BotCtx
     // TODO: I don't know why, if I put the definition into bot_ctx.cc, the compiler will report 'undefined reference' in MSYS2.
     std::string GetUserName(const char* const user_id, const char* const group_id) const
     {
-        constexpr static uint64_t k_buffer_size = 128;
-        char buffer[k_buffer_size];
         assert(user_id);
-        if (group_id) {
-            callbacks_.get_user_name_in_group(handler_, buffer, k_buffer_size, group_id, user_id);
-        } else {
-            callbacks_.get_user_name(handler_, buffer, k_buffer_size, user_id);
-        }
-        return buffer;
+        return name_cache_.Get(user_id, group_id);
     }
 
+    UserNameCache& name_cache() const { return name_cache_; }
+
     std::string GetUserAvatar(const char* const user_id, const int32_t size) const;
 
     MsgSender MakeMsgSender(const UserID& user_id, Match* const match = nullptr) const;
     MsgSender MakeMsgSender(const GroupID& user_id, Match* const match = nullptr) const;
 
+    template <typename Fn>
+    MsgSenderBatch<Fn> MakeMsgSenderBatch(Fn&& fn, Match* const match = nullptr) const
+    {
+        return MsgSenderBatch<Fn>(image_cache_, name_cache_, outbound_, std::forward<Fn>(fn), match);
+    }
+
 #ifndef TEST_BOT
   private:
 #endif
@@ -87,13 +128,29 @@ class BotCtx
 #endif
            MutableBotOption mutable_bot_options,
            nlohmann::json config_json,
-           void* const handler);
+           void* const handler,
+           const OutboundPipeline::Options& outbound_options = {},
+           const uint32_t match_thread_num = 0,
+           const uint32_t avatar_cache_ttl_sec = UserAvatarCache::k_default_ttl_sec,
+           const uint32_t avatar_negative_cache_ttl_sec = UserAvatarCache::k_default_negative_ttl_sec,
+           const uint32_t user_name_cache_capacity = UserNameCache::k_default_capacity,
+           const uint32_t user_name_cache_ttl_sec = UserNameCache::k_default_ttl_sec,
+           std::unique_ptr<Tracer> tracer = nullptr,
+           std::string journal_path = "",
+           const uint32_t deduction_thread_num = 0,
+           const uint32_t deduction_budget_sec = 0,
+           Clock* const clock = nullptr);
 
     // The passed `BotOption` in constructor can be destructed soon, we must store the string.
     std::string game_path_;
     std::string conf_path_;
     std::string image_path_;
+    std::string journal_path_; // be empty if journals are not recorded
+    mutable MarkdownImageCache image_cache_;
+    mutable UserAvatarCache avatar_cache_;
     LGTBot_Callback callbacks_;
+    mutable UserNameCache name_cache_;
+    mutable OutboundPipeline outbound_; // should be released after all matches to deliver their messages
     GameHandleMap game_handles_;
     std::set<UserID> admins_;
 #ifdef WITH_SQLITE
@@ -102,7 +159,14 @@ class BotCtx
     LockWrapper<MutableBotOption> mutable_bot_options_;
     LockWrapper<nlohmann::json> config_json_;
     void* const handler_;
+    std::unique_ptr<Tracer> tracer_; // should be released after all matches which may start traces by timers
+    // Be NULL if the timers are scheduled by the bot-wide scheduler. Should be released after all matches which may
+    // cancel their timers.
+    std::unique_ptr<TimerScheduler> timer_scheduler_;
 
     MatchManager match_manager_;
+    std::unique_ptr<MatchExecutor> match_executor_;
+    std::unique_ptr<DeductionExecutor> deduction_executor_;
+    const std::chrono::seconds deduction_budget_;
     mutable std::mutex mutex_;
 };
@@ -0,0 +1,134 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// The clock of timers and stage timeouts.
+//
+// The bot uses the steady clock. Tests and offline simulations can use a simulated clock instead, so that timeouts are
+// fired without really waiting for them.
+class Clock
+{
+  public:
+    using Duration = std::chrono::steady_clock::duration;
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    virtual ~Clock() {}
+
+    virtual TimePoint Now() const = 0;
+
+    // Block the current thread until |deadline| or until |cv| is notified. The caller should hold |l|, which is the
+    // lock of |cv|, and check the time again after returning because the function may return spuriously.
+    virtual void WaitUntil(std::unique_lock<std::mutex>& l, std::condition_variable& cv, const TimePoint deadline) = 0;
+};
+
+class SteadyClock : public Clock
+{
+  public:
+    static SteadyClock& Instance()
+    {
+        static SteadyClock clock;
+        return clock;
+    }
+
+    virtual TimePoint Now() const override { return std::chrono::steady_clock::now(); }
+
+    virtual void WaitUntil(std::unique_lock<std::mutex>& l, std::condition_variable& cv,
+            const TimePoint deadline) override
+    {
+        cv.wait_until(l, deadline);
+    }
+};
+
+// A clock which starts at zero and only moves forward when it is advanced.
+//
+// If the clock advances automatically, the threads waiting for a deadline make the clock jump to the deadline at once,
+// so timers are fired in the order of their deadlines without any real waiting. Otherwise, the threads are blocked
+// until the clock is advanced by |Advance|.
+class SimulatedClock : public Clock
+{
+  public:
+    explicit SimulatedClock(const bool auto_advance = true) : now_(), auto_advance_(auto_advance) {}
+
+    SimulatedClock(const SimulatedClock&) = delete;
+    SimulatedClock(SimulatedClock&&) = delete;
+
+    virtual TimePoint Now() const override
+    {
+        std::lock_guard<std::mutex> l(mutex_);
+        return now_;
+    }
+
+    virtual void WaitUntil(std::unique_lock<std::mutex>& l, std::condition_variable& cv,
+            const TimePoint deadline) override
+    {
+        const Waiter waiter{l.mutex(), &cv};
+        {
+            // We check the time and register the waiter at once, so |Advance| which happens later must notify us.
+            std::lock_guard<std::mutex> clock_l(mutex_);
+            if (auto_advance_ || now_ >= deadline) {
+                now_ = std::max(now_, deadline);
+                return;
+            }
+            waiters_.emplace_back(waiter);
+        }
+        cv.wait(l);
+        std::lock_guard<std::mutex> clock_l(mutex_);
+        waiters_.erase(std::ranges::find(waiters_, waiter));
+    }
+
+    void Advance(const Duration duration)
+    {
+        {
+            std::lock_guard<std::mutex> l(mutex_);
+            now_ += duration;
+        }
+        NotifyWaiters_();
+    }
+
+    void SetAutoAdvance(const bool auto_advance)
+    {
+        {
+            std::lock_guard<std::mutex> l(mutex_);
+            auto_advance_ = auto_advance;
+        }
+        NotifyWaiters_();
+    }
+
+  private:
+    struct Waiter
+    {
+        std::mutex* mutex_;
+        std::condition_variable* cv_;
+
+        bool operator==(const Waiter&) const = default;
+    };
+
+    void NotifyWaiters_()
+    {
+        std::vector<Waiter> waiters;
+        {
+            std::lock_guard<std::mutex> l(mutex_);
+            waiters = waiters_;
+        }
+        for (const auto& waiter : waiters) {
+            // Hold the lock of the waiter so that the notification is not lost when the waiter has registered but not
+            // started waiting.
+            std::lock_guard<std::mutex> l(*waiter.mutex_);
+            waiter.cv_->notify_all();
+        }
+    }
+
+    mutable std::mutex mutex_;
+    TimePoint now_;
+    bool auto_advance_;
+    std::vector<Waiter> waiters_; // the threads blocked in |WaitUntil|
+};
@@ -8,12 +8,28 @@
 
 #include <sstream>
 #include <type_traits>
+#include <algorithm>
+#include <cerrno>
 #include <cmath>
+#include <ctime>
+#include <filesystem>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 #include "utility/log.h"
-#include "bot_core/match.h"
+#include "bot_core/metrics.h"
 #include "bot_core/score_calculation.h"
+#include "bot_core/tracer.h"
 
+#include "nlohmann/json.hpp"
 #include "sqlite_modern_cpp.h"
 
 static void HandleError(const sqlite::sqlite_exception& e)
@@ -26,17 +42,67 @@ static void HandleError(const std::exception& e)
     ErrorLog() << "DB error " << e.what();
 }
 
+// A connection which caches the prepared statements, so each statement of the fixed query set is parsed only once.
+// `db << sql` returns the cached statement, which is reset when it is bound or executed again. Statements without output
+// should be executed explicitly because the cached statements are not executed when released.
+class SQLiteConnection
+{
+  public:
+    explicit SQLiteConnection(const std::string& db_name) : db_(db_name)
+    {
+        db_ << "PRAGMA busy_timeout = 5000;";
+    }
+
+    explicit SQLiteConnection(std::shared_ptr<sqlite3> handle) : db_(std::move(handle)) {}
+
+    SQLiteConnection(const SQLiteConnection&) = delete;
+    SQLiteConnection(SQLiteConnection&&) = delete;
+
+    ~SQLiteConnection()
+    {
+        for (auto& [_, statement] : statements_) {
+            statement.used(true); // not execute the statement when it is destructed
+        }
+    }
+
+    sqlite::database_binder& operator<<(const std::string_view& sql)
+    {
+        auto it = statements_.find(sql);
+        if (it == statements_.end()) {
+            it = statements_.emplace(sql, db_ << std::string(sql)).first;
+        }
+        return it->second;
+    }
+
+    uint64_t last_insert_rowid() const { return db_.last_insert_rowid(); }
+
+  private:
+    struct StringHash
+    {
+        using is_transparent = void;
+        size_t operator()(const std::string_view& sv) const { return std::hash<std::string_view>{}(sv); }
+    };
+
+    sqlite::database db_;
+    std::unordered_map<std::string, sqlite::database_binder, StringHash, std::equal_to<>> statements_;
+};
+
+// Run |fn| in a transaction on |conn|, which is opened if it is null. The connection is closed if any error occurs, so
+// the uncommitted transaction is rolled back and the statements which may be left in a bad state are released.
 template <typename Fn>
-static bool ExecuteTransaction(const std::string& db_name, const Fn& fn)
+static bool ExecuteTransaction(const std::string& db_name, std::unique_ptr<SQLiteConnection>& conn,
+        const std::string_view& begin_sql, const Fn& fn)
 {
     try {
-        sqlite::database db(db_name);
-        db << "BEGIN;";
-        if (fn(db)) {
-            db << "COMMIT;";
+        if (!conn) {
+            conn = std::make_unique<SQLiteConnection>(db_name);
+        }
+        (*conn << begin_sql).execute();
+        if (fn(*conn)) {
+            (*conn << "COMMIT;").execute();
             return true;
         } else {
-            db << "ROLLBACK";
+            (*conn << "ROLLBACK;").execute();
             return false;
         }
     } catch (const sqlite::sqlite_exception& e) {
@@ -44,56 +110,183 @@ static bool ExecuteTransaction(const std::string& db_name, const Fn& fn)
     } catch (const std::exception& e) {
         HandleError(e);
     }
+    conn.reset();
     return false;
 }
 
-uint64_t InsertMatch(sqlite::database& db, const std::string& game_name, const std::optional<GroupID> gid, const UserID host_uid,
-        const uint64_t user_count, const uint64_t multiple)
+template <typename Fn>
+bool SQLiteDBManager::WriteTransaction_(const Fn& fn)
 {
-    db << "INSERT INTO match (game_name, finish_time, group_id, host_user_id, user_count, multiple) VALUES (?,datetime(CURRENT_TIMESTAMP, \'localtime\'),?,?,?,?);"
-       << game_name
-       << gid
-       << host_uid.GetStr()
-       << user_count
-       << multiple;
+    std::lock_guard<std::mutex> l(writer_mutex_);
+    // Take the write lock at the beginning, so the transaction never fails to upgrade a read lock.
+    const bool ret = ExecuteTransaction(db_name_, writer_, "BEGIN IMMEDIATE;", fn);
+    if (reader_num_ == 0) {
+        writer_.reset();
+    }
+    return ret;
+}
+
+template <typename Fn>
+bool SQLiteDBManager::ReadTransaction_(const Fn& fn)
+{
+    std::unique_ptr<SQLiteConnection> conn;
+    if (reader_num_ > 0) {
+        std::unique_lock<std::mutex> l(reader_mutex_);
+        reader_cv_.wait(l, [this] { return borrowed_reader_num_ < reader_num_; });
+        ++borrowed_reader_num_;
+        if (!idle_readers_.empty()) {
+            conn = std::move(idle_readers_.back());
+            idle_readers_.pop_back();
+        }
+    }
+    const bool ret = ExecuteTransaction(db_name_, conn, "BEGIN;", fn);
+    if (reader_num_ > 0) {
+        std::lock_guard<std::mutex> l(reader_mutex_);
+        --borrowed_reader_num_;
+        if (conn) {
+            idle_readers_.emplace_back(std::move(conn));
+        }
+        reader_cv_.notify_one();
+    }
+    return ret;
+}
+
+// The finish time is the current time if |finish_time| is nullopt.
+uint64_t InsertMatch(SQLiteConnection& db, const std::string& game_name, const std::optional<std::string>& finish_time,
+        const std::optional<GroupID> gid, const UserID host_uid, const uint64_t user_count, const uint64_t multiple)
+{
+    (db << "INSERT INTO match (game_name, finish_time, group_id, host_user_id, user_count, multiple) VALUES (?,COALESCE(?,datetime(CURRENT_TIMESTAMP, \'localtime\')),?,?,?,?);"
+        << game_name
+        << finish_time
+        << gid
+        << host_uid.GetStr()
+        << user_count
+        << multiple).execute();
     return db.last_insert_rowid();
 }
 
-void InsertUserIfNotExist(sqlite::database& db, const UserID& uid)
+void InsertUserIfNotExist(SQLiteConnection& db, const UserID& uid)
 {
-    db << "INSERT INTO user (user_id, birth_time) SELECT ?, datetime(CURRENT_TIMESTAMP, \'localtime\') WHERE NOT EXISTS (SELECT user_id FROM user WHERE user_id = ?);"
-       << uid.GetStr() << uid.GetStr();
+    (db << "INSERT INTO user (user_id, birth_time) SELECT ?, datetime(CURRENT_TIMESTAMP, \'localtime\') WHERE NOT EXISTS (SELECT user_id FROM user WHERE user_id = ?);"
+        << uid.GetStr() << uid.GetStr()).execute();
 }
 
-void InsertUserWithMatch(sqlite::database& db, const uint64_t match_id, const UserID& uid, const uint32_t birth_count,
+void InsertUserWithMatch(SQLiteConnection& db, const uint64_t match_id, const UserID& uid, const uint32_t birth_count,
         const int64_t game_score, const int64_t zero_sum_score, const int64_t top_score, const double level_score, const int64_t rank_score)
 {
-    db << "INSERT INTO user_with_match (match_id, user_id, birth_count, game_score, zero_sum_score, top_score, level_score, rank_score) VALUES (?,?,?,?,?,?,?,?);"
-       << match_id
-       << uid.GetStr()
-       << birth_count
-       << game_score
-       << zero_sum_score
-       << top_score
-       << level_score
-       << rank_score;
+    (db << "INSERT INTO user_with_match (match_id, user_id, birth_count, game_score, zero_sum_score, top_score, level_score, rank_score) VALUES (?,?,?,?,?,?,?,?);"
+        << match_id
+        << uid.GetStr()
+        << birth_count
+        << game_score
+        << zero_sum_score
+        << top_score
+        << level_score
+        << rank_score).execute();
 }
 
-void InsertUserWithAchievement(sqlite::database& db, const uint64_t match_id, const UserID& uid, const uint32_t birth_count,
+void InsertUserWithAchievement(SQLiteConnection& db, const uint64_t match_id, const UserID& uid, const uint32_t birth_count,
         const std::string& achievement_name)
 {
-    db << "INSERT INTO user_with_achievement (user_id, birth_count, match_id, achievement_name) VALUES (?,?,?,?);"
-       << uid.GetStr()
-       << birth_count
+    (db << "INSERT INTO user_with_achievement (user_id, birth_count, match_id, achievement_name) VALUES (?,?,?,?);"
+        << uid.GetStr()
+        << birth_count
+        << match_id
+        << achievement_name).execute();
+}
+
+void UpdateBirthOfUser(SQLiteConnection& db, const UserID& uid)
+{
+    (db << "UPDATE user SET birth_time = datetime(CURRENT_TIMESTAMP, \'localtime\'), birth_count = birth_count + 1 "
+             "WHERE user_id = ?;"
+         << uid.GetStr()).execute();
+}
+
+// The score aggregates of a user in the current life are kept in `user_score_aggregate` for each game and for all games
+// (whose game_name is empty), and for each month, each year and all the time (whose period is empty), so that profiles
+// and ranks are queried without scanning the match history.
+
+auto GetPeriodsOfMatch(SQLiteConnection& db, const uint64_t match_id)
+{
+    struct
+    {
+        std::string year_;
+        std::string month_;
+    } result;
+    db << "SELECT strftime('%Y', finish_time), strftime('%Y-%m', finish_time) FROM match WHERE match_id = ?;"
        << match_id
-       << achievement_name;
+       >> std::tie(result.year_, result.month_);
+    return result;
+}
+
+void AddScoreToAggregates(SQLiteConnection& db, const std::string& game_name, const std::string& year,
+        const std::string& month, const uint32_t birth_count, const ScoreInfo& score_info)
+{
+    for (const std::string& aggregate_game_name : {game_name, std::string()}) {
+        for (const std::string& period : {std::string(), year, month}) {
+            (db << "INSERT INTO user_score_aggregate "
+                        "(user_id, birth_count, game_name, period, match_count, zero_sum_score, top_score, level_score) "
+                    "VALUES (?,?,?,?,1,?,?,?) "
+                    "ON CONFLICT (user_id, birth_count, game_name, period) DO UPDATE SET "
+                        "match_count = match_count + 1, "
+                        "zero_sum_score = zero_sum_score + excluded.zero_sum_score, "
+                        "top_score = top_score + excluded.top_score, "
+                        "level_score = level_score + excluded.level_score;"
+                << score_info.uid_.GetStr()
+                << birth_count
+                << aggregate_game_name
+                << period
+                << score_info.zero_sum_score_
+                << score_info.top_score_
+                << score_info.level_score_).execute();
+        }
+    }
 }
 
-void UpdateBirthOfUser(sqlite::database& db, const UserID& uid)
+void RebuildScoreAggregates(SQLiteConnection& db)
 {
-    db << "UPDATE user SET birth_time = datetime(CURRENT_TIMESTAMP, \'localtime\'), birth_count = birth_count + 1 "
-            "WHERE user_id = ?;"
-        << uid.GetStr();
+    (db << "DELETE FROM user_score_aggregate;").execute();
+    (db << "WITH score AS ( "
+                "SELECT user_with_match.user_id, user_with_match.birth_count, match.game_name, "
+                    "user_with_match.zero_sum_score, user_with_match.top_score, user_with_match.level_score, "
+                    "strftime('%Y', match.finish_time) AS year, strftime('%Y-%m', match.finish_time) AS month "
+                "FROM user_with_match, match "
+                "WHERE user_with_match.match_id = match.match_id "
+            "), score_with_period AS ( "
+                "SELECT user_id, birth_count, game_name, '' AS period, zero_sum_score, top_score, level_score FROM score "
+                "UNION ALL "
+                "SELECT user_id, birth_count, game_name, year, zero_sum_score, top_score, level_score FROM score "
+                "UNION ALL "
+                "SELECT user_id, birth_count, game_name, month, zero_sum_score, top_score, level_score FROM score "
+            ") "
+            "INSERT INTO user_score_aggregate "
+                "(user_id, birth_count, game_name, period, match_count, zero_sum_score, top_score, level_score) "
+            "SELECT user_id, birth_count, game_name, period, COUNT(*), SUM(zero_sum_score), SUM(top_score), "
+                "SUM(level_score) "
+            "FROM score_with_period GROUP BY user_id, birth_count, game_name, period "
+            "UNION ALL "
+            "SELECT user_id, birth_count, '', period, COUNT(*), SUM(zero_sum_score), SUM(top_score), SUM(level_score) "
+            "FROM score_with_period GROUP BY user_id, birth_count, period;").execute();
+}
+
+void RebuildScoreAggregates(sqlite::database& db)
+{
+    SQLiteConnection conn(db.connection());
+    RebuildScoreAggregates(conn);
+}
+
+// Return the SQL expression of the aggregate period which the time range corresponds to, or nullopt if the time range
+// is not one of `TimeRange`, in which case the scores are summed up from the match history.
+static std::optional<std::string_view> AggregatePeriod(const std::string_view& time_range_begin,
+        const std::string_view& time_range_end)
+{
+    for (const auto time_range : TimeRange::Members()) {
+        if (time_range_begin == k_time_range_begin_datetimes[time_range.ToUInt()] &&
+                time_range_end == k_time_range_end_datetimes[time_range.ToUInt()]) {
+            return k_time_range_periods[time_range.ToUInt()];
+        }
+    }
+    return std::nullopt;
 }
 
 static std::string ComparationCondition(const std::string_view& column_name, const std::string_view& op,
@@ -115,16 +308,18 @@ static std::string TimeRangeRightCondition(const std::string_view& column_name,
     return ComparationCondition(column_name, "<", time_range_end);
 }
 
-auto GetTotalScoreOfUser(sqlite::database& db, const UserID& uid, const std::string_view& time_range_begin,
+struct TotalScoreOfUser
+{
+    uint64_t match_count_ = 0;
+    int64_t total_zero_sum_score_ = 0;
+    int64_t total_top_score_ = 0;
+    std::string birth_time_;
+};
+
+auto GetTotalScoreOfUser(SQLiteConnection& db, const UserID& uid, const std::string_view& time_range_begin,
         const std::string_view& time_range_end)
 {
-    struct
-    {
-        uint64_t match_count_ = 0;
-        int64_t total_zero_sum_score_ = 0;
-        int64_t total_top_score_ = 0;
-        std::string birth_time_;
-    } result;
+    TotalScoreOfUser result;
     db << "SELECT COUNT(*), SUM(zero_sum_score), SUM(top_score), birth_time FROM user_with_match, user, match "
             "WHERE user_with_match.user_id = ? AND "
                 "user_with_match.user_id = user.user_id AND "
@@ -137,7 +332,7 @@ auto GetTotalScoreOfUser(sqlite::database& db, const UserID& uid, const std::str
     return result;
 }
 
-uint32_t GetMatchCountOfUser(sqlite::database& db, const UserID& uid)
+uint32_t GetMatchCountOfUser(SQLiteConnection& db, const UserID& uid)
 {
     uint32_t count = 0;
     db << "SELECT COUNT(*) FROM user_with_match "
@@ -147,7 +342,7 @@ uint32_t GetMatchCountOfUser(sqlite::database& db, const UserID& uid)
     return count;
 }
 
-uint32_t GetBirthCountOfUser(sqlite::database& db, const UserID& uid)
+uint32_t GetBirthCountOfUser(SQLiteConnection& db, const UserID& uid)
 {
     InsertUserIfNotExist(db, uid);
     uint32_t birth_count = -1;
@@ -155,19 +350,19 @@ uint32_t GetBirthCountOfUser(sqlite::database& db, const UserID& uid)
     return birth_count;
 }
 
-auto GetGameHistoryOfUser(sqlite::database& db, const UserID& uid, const std::string& game_name)
+auto GetGameHistoryOfUser(SQLiteConnection& db, const UserID& uid, const std::string& game_name)
 {
     struct
     {
         uint64_t match_count_ = 0;
         double total_level_score_ = 0;
     } result;
-    db << "SELECT COUNT(*), SUM(level_score) FROM user_with_match, match, user "
-            "WHERE user_with_match.user_id = ? AND "
-                "user_with_match.user_id = user.user_id AND "
-                "user_with_match.birth_count = user.birth_count AND "
-                "user_with_match.match_id = match.match_id AND "
-                "match.game_name = ? "
+    db << "SELECT SUM(match_count), SUM(level_score) FROM user_score_aggregate, user "
+            "WHERE user_score_aggregate.user_id = ? AND "
+                "user_score_aggregate.user_id = user.user_id AND "
+                "user_score_aggregate.birth_count = user.birth_count AND "
+                "user_score_aggregate.game_name = ? AND "
+                "user_score_aggregate.period = '' "
         << uid.GetStr()
         << game_name
         >> std::tie(result.match_count_, result.total_level_score_);
@@ -175,7 +370,7 @@ auto GetGameHistoryOfUser(sqlite::database& db, const UserID& uid, const std::st
 }
 
 template <typename Fn>
-void ForeachTotalLevelScoreOfUser(sqlite::database& db, const UserID& uid, const std::string_view& time_range_begin,
+void ForeachTotalLevelScoreOfUser(SQLiteConnection& db, const UserID& uid, const std::string_view& time_range_begin,
         const std::string_view& time_range_end, const Fn& fn)
 {
     db << "WITH game_match AS ( "
@@ -207,7 +402,7 @@ void ForeachTotalLevelScoreOfUser(sqlite::database& db, const UserID& uid, const
 }
 
 template <typename Fn>
-void ForeachRecentMatchOfUser(sqlite::database& db, const UserID& uid, const uint32_t limit, const Fn& fn)
+void ForeachRecentMatchOfUser(SQLiteConnection& db, const UserID& uid, const uint32_t limit, const Fn& fn)
 {
     db << "SELECT match.game_name, match.finish_time, match.user_count, match.multiple, user_with_match.game_score, "
                 "user_with_match.zero_sum_score, user_with_match.top_score, user_with_match.level_score, user_with_match.rank_score "
@@ -222,7 +417,7 @@ void ForeachRecentMatchOfUser(sqlite::database& db, const UserID& uid, const uin
 }
 
 template <typename Fn>
-void ForeachUserInRank(sqlite::database& db, const std::string& score_name, const std::string_view& time_range_begin,
+void ForeachUserInRank(SQLiteConnection& db, const std::string& score_name, const std::string_view& time_range_begin,
         const std::string_view& time_range_end, const Fn& fn)
 {
     db << "SELECT user.user_id, SUM(" + score_name + ") AS sum_score "
@@ -232,12 +427,12 @@ void ForeachUserInRank(sqlite::database& db, const std::string& score_name, cons
                 "match.match_id = user_with_match.match_id AND "
                 + TimeRangeLeftCondition("match.finish_time", time_range_begin) + " AND "
                 + TimeRangeRightCondition("match.finish_time", time_range_end) + " "
-            "GROUP BY user.user_id ORDER BY sum_score DESC LIMIT 10;"
+            "GROUP BY user.user_id ORDER BY sum_score DESC, user.user_id LIMIT 10;"
        >> fn;
 }
 
 template <typename Fn>
-void ForeachUserInGameLevelScoreRank(sqlite::database& db, const std::string_view& game_name, const std::string_view& time_range_begin,
+void ForeachUserInGameLevelScoreRank(SQLiteConnection& db, const std::string_view& game_name, const std::string_view& time_range_begin,
         const std::string_view& time_range_end, const Fn& fn)
 {
     db << "SELECT user.user_id AS user_id, "
@@ -248,13 +443,13 @@ void ForeachUserInGameLevelScoreRank(sqlite::database& db, const std::string_vie
                 "user_with_match.birth_count = user.birth_count AND "
                 "match.game_name = ? AND "
                 + TimeRangeRightCondition("match.finish_time", time_range_end) + " "
-            "GROUP BY user.user_id ORDER BY total_level_score DESC LIMIT 10"
+            "GROUP BY user.user_id ORDER BY total_level_score DESC, user_id LIMIT 10"
     << game_name.data()
     >> fn;
 }
 
 template <typename Fn>
-void ForeachUserInGameWeightLevelScoreRank(sqlite::database& db, const std::string_view& game_name,
+void ForeachUserInGameWeightLevelScoreRank(SQLiteConnection& db, const std::string_view& game_name,
         const std::string_view& time_range_begin, const std::string_view& time_range_end, const Fn& fn)
 {
     db << "WITH game_user_match AS ( "
@@ -284,13 +479,13 @@ void ForeachUserInGameWeightLevelScoreRank(sqlite::database& db, const std::stri
                     "GROUP BY game_user_match.user_id "
                 ") AS user_time_range_match_count "
             "WHERE user_history_total_level_score.user_id = user_time_range_match_count.user_id "
-            "ORDER BY weight_level_score DESC LIMIT 10"
+            "ORDER BY weight_level_score DESC, user_id LIMIT 10"
        << game_name.data()
        >> fn;
 }
 
 template <typename Fn>
-void ForeachUserInGameMatchCountRank(sqlite::database& db, const std::string_view& game_name, const std::string_view& time_range_begin,
+void ForeachUserInGameMatchCountRank(SQLiteConnection& db, const std::string_view& game_name, const std::string_view& time_range_begin,
         const std::string_view& time_range_end, const Fn& fn)
 {
     db << "SELECT user.user_id AS user_id, "
@@ -302,32 +497,130 @@ void ForeachUserInGameMatchCountRank(sqlite::database& db, const std::string_vie
                 "match.game_name = ? AND "
                 + TimeRangeLeftCondition("match.finish_time", time_range_begin) + " AND "
                 + TimeRangeRightCondition("match.finish_time", time_range_end) + " "
-            "GROUP BY user.user_id ORDER BY match_count DESC LIMIT 10"
+            "GROUP BY user.user_id ORDER BY match_count DESC, user_id LIMIT 10"
     << game_name.data()
     >> fn;
 }
 
-void AddHonor(sqlite::database& db, const std::string_view& description, const UserID& uid, const uint32_t birth_count)
+auto GetTotalScoreOfUserFromAggregate(SQLiteConnection& db, const UserID& uid, const std::string_view& period)
 {
-    db << "INSERT INTO honor (description, user_id, birth_count, time) VALUES (?, ?, ?, datetime(CURRENT_TIMESTAMP, \'localtime\'))"
-       << description.data() << uid.GetStr() << birth_count;
+    TotalScoreOfUser result;
+    db << "SELECT SUM(match_count), SUM(zero_sum_score), SUM(top_score), birth_time FROM user_score_aggregate, user "
+            "WHERE user_score_aggregate.user_id = ? AND "
+                "user_score_aggregate.user_id = user.user_id AND "
+                "user_score_aggregate.birth_count = user.birth_count AND "
+                "user_score_aggregate.game_name = '' AND "
+                "user_score_aggregate.period = " + std::string(period)
+        << uid.GetStr()
+        >> std::tie(result.match_count_, result.total_zero_sum_score_, result.total_top_score_, result.birth_time_);
+    return result;
 }
 
-void DeleteHonor(sqlite::database& db, const int32_t id)
+template <typename Fn>
+void ForeachTotalLevelScoreOfUserFromAggregate(SQLiteConnection& db, const UserID& uid, const std::string_view& period,
+        const Fn& fn)
 {
-    db << "DELETE FROM honor WHERE id = ?" << id;
+    db << "SELECT period_aggregate.game_name, period_aggregate.match_count, total_aggregate.level_score "
+            "FROM user_score_aggregate AS period_aggregate, user_score_aggregate AS total_aggregate, user "
+            "WHERE period_aggregate.user_id = ? AND "
+                "period_aggregate.user_id = user.user_id AND "
+                "period_aggregate.birth_count = user.birth_count AND "
+                "period_aggregate.game_name != '' AND "
+                "period_aggregate.period = " + std::string(period) + " AND "
+                "total_aggregate.user_id = period_aggregate.user_id AND "
+                "total_aggregate.birth_count = period_aggregate.birth_count AND "
+                "total_aggregate.game_name = period_aggregate.game_name AND "
+                "total_aggregate.period = ''"
+        << uid.GetStr()
+        >> fn;
 }
 
 template <typename Fn>
-void ForeachHonor(sqlite::database& db, const std::string& keyword, const uint32_t limit, const Fn& fn)
+void ForeachUserInRankFromAggregate(SQLiteConnection& db, const std::string& score_name, const std::string_view& period,
+        const Fn& fn)
 {
-    db << "SELECT id, description, user_id, time FROM honor WHERE description like '%" + keyword + "%' ORDER BY id DESC LIMIT ?"
-       << limit
+    db << "SELECT user.user_id, " + score_name + " AS sum_score "
+            "FROM user_score_aggregate, user "
+            "WHERE user_score_aggregate.user_id = user.user_id AND "
+                "user_score_aggregate.birth_count = user.birth_count AND "
+                "user_score_aggregate.game_name = '' AND "
+                "user_score_aggregate.period = " + std::string(period) + " "
+            "ORDER BY sum_score DESC, user.user_id LIMIT 10;"
        >> fn;
 }
 
+// The level score rank sums up the level scores in the whole history, so it does not depend on the period.
 template <typename Fn>
-void ForeachRecentHonorOfUser(sqlite::database& db, const UserID& uid, const uint32_t limit, const Fn& fn)
+void ForeachUserInGameLevelScoreRankFromAggregate(SQLiteConnection& db, const std::string_view& game_name, const Fn& fn)
+{
+    db << "SELECT user.user_id AS user_id, user_score_aggregate.level_score AS total_level_score "
+            "FROM user_score_aggregate, user "
+            "WHERE user_score_aggregate.user_id = user.user_id AND "
+                "user_score_aggregate.birth_count = user.birth_count AND "
+                "user_score_aggregate.game_name = ? AND "
+                "user_score_aggregate.period = '' "
+            "ORDER BY total_level_score DESC, user_id LIMIT 10"
+    << game_name.data()
+    >> fn;
+}
+
+template <typename Fn>
+void ForeachUserInGameWeightLevelScoreRankFromAggregate(SQLiteConnection& db, const std::string_view& game_name,
+        const std::string_view& period, const Fn& fn)
+{
+    db << "SELECT user.user_id AS user_id, "
+                "total_aggregate.level_score * ABS(total_aggregate.level_score) * period_aggregate.match_count "
+                    "AS weight_level_score "
+            "FROM user_score_aggregate AS period_aggregate, user_score_aggregate AS total_aggregate, user "
+            "WHERE period_aggregate.user_id = user.user_id AND "
+                "period_aggregate.birth_count = user.birth_count AND "
+                "period_aggregate.game_name = ? AND "
+                "period_aggregate.period = " + std::string(period) + " AND "
+                "total_aggregate.user_id = period_aggregate.user_id AND "
+                "total_aggregate.birth_count = period_aggregate.birth_count AND "
+                "total_aggregate.game_name = period_aggregate.game_name AND "
+                "total_aggregate.period = '' "
+            "ORDER BY weight_level_score DESC, user_id LIMIT 10"
+       << game_name.data()
+       >> fn;
+}
+
+template <typename Fn>
+void ForeachUserInGameMatchCountRankFromAggregate(SQLiteConnection& db, const std::string_view& game_name,
+        const std::string_view& period, const Fn& fn)
+{
+    db << "SELECT user.user_id AS user_id, user_score_aggregate.match_count AS match_count "
+            "FROM user_score_aggregate, user "
+            "WHERE user_score_aggregate.user_id = user.user_id AND "
+                "user_score_aggregate.birth_count = user.birth_count AND "
+                "user_score_aggregate.game_name = ? AND "
+                "user_score_aggregate.period = " + std::string(period) + " "
+            "ORDER BY match_count DESC, user_id LIMIT 10"
+    << game_name.data()
+    >> fn;
+}
+
+void AddHonor(SQLiteConnection& db, const std::string_view& description, const UserID& uid, const uint32_t birth_count)
+{
+    (db << "INSERT INTO honor (description, user_id, birth_count, time) VALUES (?, ?, ?, datetime(CURRENT_TIMESTAMP, \'localtime\'))"
+        << description.data() << uid.GetStr() << birth_count).execute();
+}
+
+void DeleteHonor(SQLiteConnection& db, const int32_t id)
+{
+    (db << "DELETE FROM honor WHERE id = ?" << id).execute();
+}
+
+template <typename Fn>
+void ForeachHonor(SQLiteConnection& db, const std::string& keyword, const uint32_t limit, const Fn& fn)
+{
+    db << "SELECT id, description, user_id, time FROM honor WHERE description like ? ORDER BY id DESC LIMIT ?"
+       << "%" + keyword + "%" << limit
+       >> fn;
+}
+
+template <typename Fn>
+void ForeachRecentHonorOfUser(SQLiteConnection& db, const UserID& uid, const uint32_t limit, const Fn& fn)
 {
     db << "SELECT honor.id, honor.description, honor.user_id, honor.time FROM honor, user "
           "WHERE honor.user_id = ? AND honor.user_id = user.user_id AND honor.birth_count = user.birth_count "
@@ -337,7 +630,7 @@ void ForeachRecentHonorOfUser(sqlite::database& db, const UserID& uid, const uin
 }
 
 template <typename Fn>
-void ForeachRecentAchievementOfUser(sqlite::database& db, const UserID& uid, const uint32_t limit, const Fn& fn)
+void ForeachRecentAchievementOfUser(SQLiteConnection& db, const UserID& uid, const uint32_t limit, const Fn& fn)
 {
     db << "SELECT user_with_achievement.achievement_name, match.game_name, match.finish_time "
           "FROM user_with_achievement, user, match "
@@ -350,7 +643,7 @@ void ForeachRecentAchievementOfUser(sqlite::database& db, const UserID& uid, con
        >> fn;
 }
 
-auto GetAchievementStatistic(sqlite::database& db, const UserID& uid, const std::string& game_name,
+auto GetAchievementStatistic(SQLiteConnection& db, const UserID& uid, const std::string& game_name,
         const std::string& achievement_name)
 {
     struct
@@ -369,7 +662,7 @@ auto GetAchievementStatistic(sqlite::database& db, const UserID& uid, const std:
     return result;
 }
 
-int64_t GetAchievedUserNumber(sqlite::database& db, const std::string& game_name, const std::string& achievement_name)
+int64_t GetAchievedUserNumber(SQLiteConnection& db, const std::string& game_name, const std::string& achievement_name)
 {
     int64_t count = 0;
     db << "SELECT count(*) FROM "
@@ -385,21 +678,112 @@ int64_t GetAchievedUserNumber(sqlite::database& db, const std::string& game_name
     return count;
 }
 
-SQLiteDBManager::SQLiteDBManager(std::string db_name) : db_name_(std::move(db_name))
+// The record journal is written with file descriptors rather than streams, so that it can be synced to the disk: a match
+// is returned only after it survives a crash of the machine.
+#ifdef _WIN32
+
+static int OpenFile(const std::string& path, const bool truncate)
 {
+    return _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY | (truncate ? _O_TRUNC : 0),
+            _S_IREAD | _S_IWRITE);
 }
 
-SQLiteDBManager::~SQLiteDBManager() {}
+static bool SyncFile(const int fd) { return _commit(fd) == 0; }
 
-void RecordMatch(sqlite::database& db, const std::string& game_name, const std::optional<GroupID> gid,
+static void CloseFile(const int fd)
+{
+    if (fd >= 0) {
+        _close(fd);
+    }
+}
+
+// The directory cannot be synced on Windows, where a renamed file is persisted by NTFS journaling.
+static bool SyncDirectory(const std::filesystem::path&) { return true; }
+
+static bool WriteFile(const int fd, const std::string_view data)
+{
+    return _write(fd, data.data(), data.size()) == static_cast<int>(data.size());
+}
+
+#else
+
+static int OpenFile(const std::string& path, const bool truncate)
+{
+    return open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC | (truncate ? O_TRUNC : 0), 0644);
+}
+
+static bool SyncFile(const int fd) { return fsync(fd) == 0; }
+
+static void CloseFile(const int fd)
+{
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+// A renamed file is persisted only after its directory is synced.
+static bool SyncDirectory(const std::filesystem::path& path)
+{
+    const int fd = open(path.empty() ? "." : path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    const bool ret = fsync(fd) == 0;
+    close(fd);
+    return ret;
+}
+
+static bool WriteFile(const int fd, std::string_view data)
+{
+    while (!data.empty()) {
+        const ssize_t ret = write(fd, data.data(), data.size());
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            return false;
+        }
+        data.remove_prefix(ret);
+    }
+    return true;
+}
+
+#endif
+
+SQLiteDBManager::SQLiteDBManager(std::string db_name, const uint32_t reader_num, const uint32_t flush_interval_ms)
+    : db_name_(std::move(db_name))
+    , reader_num_(reader_num)
+    , flush_interval_(flush_interval_ms)
+    , record_journal_path_(db_name_ + ".records")
+{
+}
+
+SQLiteDBManager::~SQLiteDBManager()
+{
+    if (flusher_.joinable()) {
+        {
+            std::lock_guard<std::mutex> l(record_mutex_);
+            is_stopped_ = true;
+        }
+        record_cv_.notify_all();
+        flusher_.join();
+        Flush_(); // the matches failed to be written are kept in the record journal
+    }
+    CloseFile(record_journal_fd_);
+}
+
+void RecordMatch(SQLiteConnection& db, const std::string& game_name, const std::optional<GroupID> gid,
         const UserID host_uid, const uint64_t multiple, const std::vector<ScoreInfo>& score_infos,
-        const std::vector<std::pair<UserID, std::string>>& achievements)
+        const std::vector<std::pair<UserID, std::string>>& achievements,
+        const std::optional<std::string>& finish_time = std::nullopt)
 {
-    const auto match_id = InsertMatch(db, game_name, gid, host_uid, score_infos.size(), multiple);
+    const auto match_id = InsertMatch(db, game_name, finish_time, gid, host_uid, score_infos.size(), multiple);
+    const auto periods = GetPeriodsOfMatch(db, match_id);
     for (const ScoreInfo& score_info : score_infos) {
         const auto birth_count = GetBirthCountOfUser(db, score_info.uid_);
         InsertUserWithMatch(db, match_id, score_info.uid_, birth_count, score_info.game_score_,
                 score_info.zero_sum_score_, score_info.top_score_, score_info.level_score_, score_info.rank_score_);
+        AddScoreToAggregates(db, game_name, periods.year_, periods.month_, birth_count, score_info);
     }
     for (const auto& [user_id, achievement_name] : achievements) {
         const auto birth_count = GetBirthCountOfUser(db, user_id);
@@ -407,7 +791,15 @@ void RecordMatch(sqlite::database& db, const std::string& game_name, const std::
     }
 }
 
-std::vector<UserInfoForCalScore> GetUserInfoForCalScore(sqlite::database& db, const std::string& game_name,
+void RecordMatch(sqlite::database& db, const std::string& game_name, const std::optional<GroupID> gid,
+        const UserID host_uid, const uint64_t multiple, const std::vector<ScoreInfo>& score_infos,
+        const std::vector<std::pair<UserID, std::string>>& achievements)
+{
+    SQLiteConnection conn(db.connection());
+    RecordMatch(conn, game_name, gid, host_uid, multiple, score_infos, achievements);
+}
+
+std::vector<UserInfoForCalScore> GetUserInfoForCalScore(SQLiteConnection& db, const std::string& game_name,
         const std::vector<std::pair<UserID, int64_t>>& game_score_infos)
 {
     std::vector<UserInfoForCalScore> user_infos;
@@ -422,8 +814,12 @@ std::vector<ScoreInfo> SQLiteDBManager::RecordMatch(const std::string& game_name
         const UserID& host_uid, const uint64_t multiple, const std::vector<std::pair<UserID, int64_t>>& game_score_infos,
         const std::vector<std::pair<UserID, std::string>>& achievements)
 {
+    TraceSpan span("RecordMatch");
+    if (IsWriteBehind_()) {
+        return RecordMatchBehind_(game_name, gid, host_uid, multiple, game_score_infos, achievements);
+    }
     std::vector<ScoreInfo> score_infos; // TODO: get from game_score_infos
-    return ExecuteTransaction(db_name_, [&](sqlite::database& db)
+    return WriteTransaction_([&](SQLiteConnection& db)
         {
             auto user_infos = GetUserInfoForCalScore(db, game_name, game_score_infos);
             score_infos = CalScores(user_infos, multiple);
@@ -432,27 +828,332 @@ std::vector<ScoreInfo> SQLiteDBManager::RecordMatch(const std::string& game_name
         }) ? score_infos : std::vector<ScoreInfo>();
 }
 
+// The local time in the same format as `datetime(CURRENT_TIMESTAMP, 'localtime')` of SQLite.
+static std::string LocalDatetime()
+{
+    const std::time_t now = std::time(nullptr);
+    std::tm tm;
+#ifdef _WIN32
+    localtime_s(&tm, &now);
+#else
+    localtime_r(&now, &tm);
+#endif
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &tm);
+    return buffer;
+}
+
+// Each line of the record journal is a match record in JSON.
+static std::string ToJournalLine(const MatchRecord& record)
+{
+    nlohmann::json score_infos = nlohmann::json::array();
+    for (const auto& info : record.score_infos_) {
+        score_infos.push_back({info.uid_.GetStr(), info.game_score_, info.zero_sum_score_, info.top_score_,
+                info.level_score_, info.rank_score_});
+    }
+    nlohmann::json achievements = nlohmann::json::array();
+    for (const auto& [uid, achievement_name] : record.achievements_) {
+        achievements.push_back({uid.GetStr(), achievement_name});
+    }
+    return nlohmann::json{
+        {"seq", record.seq_},
+        {"finish_time", record.finish_time_},
+        {"game_name", record.game_name_},
+        {"gid", record.gid_.has_value() ? nlohmann::json(record.gid_->GetStr()) : nlohmann::json()},
+        {"host_uid", record.host_uid_.GetStr()},
+        {"multiple", record.multiple_},
+        {"score_infos", std::move(score_infos)},
+        {"achievements", std::move(achievements)},
+    }.dump() + "\n";
+}
+
+// Return nullopt if the line is broken, which may be the last line written when the bot crashes.
+static std::optional<MatchRecord> FromJournalLine(const std::string& line)
+{
+    try {
+        const auto json = nlohmann::json::parse(line);
+        MatchRecord record{
+            .seq_ = json.at("seq").get<uint64_t>(),
+            .finish_time_ = json.at("finish_time").get<std::string>(),
+            .game_name_ = json.at("game_name").get<std::string>(),
+            .host_uid_ = UserID(json.at("host_uid").get<std::string>()),
+            .multiple_ = json.at("multiple").get<uint64_t>(),
+        };
+        if (const auto& gid = json.at("gid"); !gid.is_null()) {
+            record.gid_.emplace(gid.get<std::string>());
+        }
+        for (const auto& info : json.at("score_infos")) {
+            record.score_infos_.emplace_back(ScoreInfo{
+                    .uid_ = UserID(info.at(0).get<std::string>()),
+                    .game_score_ = info.at(1).get<int64_t>(),
+                    .zero_sum_score_ = info.at(2).get<int64_t>(),
+                    .top_score_ = info.at(3).get<int64_t>(),
+                    .level_score_ = info.at(4).get<double>(),
+                    .rank_score_ = info.at(5).get<int64_t>(),
+                });
+        }
+        for (const auto& achievement : json.at("achievements")) {
+            record.achievements_.emplace_back(UserID(achievement.at(0).get<std::string>()),
+                    achievement.at(1).get<std::string>());
+        }
+        return record;
+    } catch (const std::exception& e) {
+        return std::nullopt;
+    }
+}
+
+bool SQLiteDBManager::StartWriteBehind_()
+{
+    uint64_t written_seq = 0;
+    if (!ReadTransaction_([&](SQLiteConnection& db)
+                {
+                    db << "SELECT COALESCE(MAX(seq), 0) FROM record_journal_checkpoint;" >> written_seq;
+                    return true;
+                })) {
+        return false;
+    }
+    last_seq_ = written_seq;
+    {
+        std::ifstream file(record_journal_path_, std::ios::binary);
+        for (std::string line; std::getline(file, line); ) {
+            auto record = FromJournalLine(line);
+            if (!record.has_value()) {
+                WarnLog() << "Ignore the broken line of the record journal: " << line;
+                continue;
+            }
+            if (record->seq_ > written_seq) {
+                last_seq_ = std::max(last_seq_, record->seq_);
+                pending_matches_.emplace_back(std::move(*record));
+            }
+        }
+    }
+    if (!pending_matches_.empty()) {
+        InfoLog() << "Write the matches in the record journal count=" << pending_matches_.size();
+        Flush_();
+        if (!pending_matches_.empty()) {
+            return false;
+        }
+    }
+    CloseFile(record_journal_fd_);
+    record_journal_fd_ = OpenFile(record_journal_path_, true);
+    if (record_journal_fd_ < 0) {
+        ErrorLog() << "Open the record journal failed path=" << record_journal_path_;
+        return false;
+    }
+    flusher_ = std::thread([this] { FlushLoop_(); });
+    return true;
+}
+
+std::vector<ScoreInfo> SQLiteDBManager::RecordMatchBehind_(const std::string& game_name,
+        const std::optional<GroupID> gid, const UserID& host_uid, const uint64_t multiple,
+        const std::vector<std::pair<UserID, int64_t>>& game_score_infos,
+        const std::vector<std::pair<UserID, std::string>>& achievements)
+{
+    std::lock_guard<std::mutex> l(record_mutex_);
+    std::vector<UserInfoForCalScore> user_infos;
+    for (const auto& [uid, game_score] : game_score_infos) {
+        const auto history = GetGameHistory_(uid, game_name);
+        if (!history.has_value()) {
+            return {};
+        }
+        user_infos.emplace_back(uid, game_score, history->match_count_, history->total_level_score_);
+    }
+    MatchRecord record{
+        .seq_ = last_seq_ + 1,
+        .finish_time_ = LocalDatetime(),
+        .game_name_ = game_name,
+        .gid_ = gid,
+        .host_uid_ = host_uid,
+        .multiple_ = multiple,
+        .score_infos_ = CalScores(user_infos, multiple),
+        .achievements_ = achievements,
+    };
+    const std::string line = ToJournalLine(record);
+    if (!WriteFile(record_journal_fd_, line) || !SyncFile(record_journal_fd_)) {
+        ErrorLog() << "Append to the record journal failed path=" << record_journal_path_;
+        return {};
+    }
+    last_seq_ = record.seq_;
+    for (const auto& info : record.score_infos_) {
+        auto& history = history_cache_[{info.uid_, game_name}];
+        ++history.match_count_;
+        history.total_level_score_ += info.level_score_;
+    }
+    auto score_infos = record.score_infos_;
+    pending_matches_.emplace_back(std::move(record));
+    record_cv_.notify_all();
+    return score_infos;
+}
+
+// REQUIRE: should be protected by record_mutex_
+std::optional<SQLiteDBManager::GameHistory> SQLiteDBManager::GetGameHistory_(const UserID& uid,
+        const std::string& game_name)
+{
+    const auto key = std::pair(uid, game_name);
+    if (const auto it = history_cache_.find(key); it != history_cache_.end()) {
+        return it->second;
+    }
+    // The user is not in the pending matches, so the history in the database is the latest.
+    GameHistory history;
+    if (!ReadTransaction_([&](SQLiteConnection& db)
+                {
+                    const auto result = GetGameHistoryOfUser(db, uid, game_name);
+                    history.match_count_ = result.match_count_;
+                    history.total_level_score_ = result.total_level_score_;
+                    return true;
+                })) {
+        return std::nullopt;
+    }
+    return history_cache_.emplace(key, history).first->second;
+}
+
+void SQLiteDBManager::FlushLoop_()
+{
+    std::unique_lock<std::mutex> l(record_mutex_);
+    while (true) {
+        record_cv_.wait(l, [this] { return is_stopped_ || !pending_matches_.empty(); });
+        // Wait for more matches to be written in the same transaction.
+        if (record_cv_.wait_for(l, flush_interval_, [this] { return is_stopped_; })) {
+            return;
+        }
+        l.unlock();
+        Flush_();
+        l.lock();
+    }
+}
+
+void SQLiteDBManager::Flush_()
+{
+    if (!IsWriteBehind_()) {
+        return;
+    }
+    std::lock_guard<std::mutex> flush_l(flush_mutex_);
+    std::unique_lock<std::mutex> record_l(record_mutex_);
+    FlushPendingMatches_(record_l, true);
+}
+
+// Write the pending matches in one transaction. If it fails, the matches are kept to be written next time. If
+// |allow_recording| is true, |record_l| is unlocked during writing, so matches can be recorded meanwhile.
+// REQUIRE: should be protected by flush_mutex_, and |record_l| should hold record_mutex_
+bool SQLiteDBManager::FlushPendingMatches_(std::unique_lock<std::mutex>& record_l, const bool allow_recording)
+{
+    static MetricHistogram& flush_latency = GlobalMetrics().Histogram("lgtbot_db_flush_latency_us");
+    static MetricCounter& flushed_match_total = GlobalMetrics().Counter("lgtbot_db_flushed_match_total");
+    static MetricCounter& flush_total = GlobalMetrics().Counter("lgtbot_db_flush_total");
+    if (pending_matches_.empty()) {
+        return true;
+    }
+    std::vector<MatchRecord> records(std::make_move_iterator(pending_matches_.begin()),
+            std::make_move_iterator(pending_matches_.end()));
+    pending_matches_.clear();
+    if (allow_recording) {
+        record_l.unlock();
+    }
+    const bool ok = [&]
+        {
+            ScopedLatency latency(flush_latency);
+            TraceSpan span("FlushMatches");
+            return WriteTransaction_([&](SQLiteConnection& db)
+                {
+                    for (const auto& record : records) {
+                        ::RecordMatch(db, record.game_name_, record.gid_, record.host_uid_, record.multiple_,
+                                record.score_infos_, record.achievements_, record.finish_time_);
+                    }
+                    (db << "INSERT INTO record_journal_checkpoint (id, seq) VALUES (0, ?) "
+                            "ON CONFLICT (id) DO UPDATE SET seq = excluded.seq;"
+                        << records.back().seq_).execute();
+                    return true;
+                });
+        }();
+    if (allow_recording) {
+        record_l.lock();
+    }
+    if (!ok) {
+        ErrorLog() << "Write the recorded matches failed, retry later count=" << records.size();
+        pending_matches_.insert(pending_matches_.begin(), std::make_move_iterator(records.begin()),
+                std::make_move_iterator(records.end()));
+        return false;
+    }
+    flushed_match_total.Add(records.size());
+    flush_total.Add();
+    // The written users can be read from the database, so only the users in the pending matches are kept.
+    std::erase_if(history_cache_, [this](const auto& item)
+            {
+                return std::ranges::none_of(pending_matches_, [&item](const MatchRecord& record)
+                        {
+                            return record.game_name_ == item.first.second &&
+                                std::ranges::any_of(record.score_infos_,
+                                        [&item](const ScoreInfo& info) { return info.uid_ == item.first.first; });
+                        });
+            });
+    CompactRecordJournal_();
+    return true;
+}
+
+// Rewrite the record journal to hold only the pending matches, i.e., the matches after the checkpoint. The new journal
+// is renamed over the old one, so if it fails, the old journal is kept, which is still valid to be replayed.
+// REQUIRE: should be protected by record_mutex_
+bool SQLiteDBManager::CompactRecordJournal_()
+{
+    const std::string tmp_path = record_journal_path_ + ".tmp";
+    const int tmp_fd = OpenFile(tmp_path, true);
+    bool written = tmp_fd >= 0;
+    for (auto it = pending_matches_.begin(); written && it != pending_matches_.end(); ++it) {
+        written = WriteFile(tmp_fd, ToJournalLine(*it));
+    }
+    // The new journal is synced before the rename, otherwise the rename may be persisted before its content.
+    written = written && SyncFile(tmp_fd);
+    CloseFile(tmp_fd);
+    if (!written) {
+        ErrorLog() << "Compact the record journal failed path=" << tmp_path;
+        return false;
+    }
+    CloseFile(record_journal_fd_);
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, record_journal_path_, ec);
+    if (ec) {
+        ErrorLog() << "Compact the record journal failed path=" << record_journal_path_ << " error=" << ec.message();
+    } else if (!SyncDirectory(std::filesystem::path(record_journal_path_).parent_path())) {
+        // The matches are also written to the database, so the journal is still valid if the rename is lost.
+        WarnLog() << "Sync the directory of the record journal failed path=" << record_journal_path_;
+    }
+    record_journal_fd_ = OpenFile(record_journal_path_, false);
+    if (record_journal_fd_ < 0) {
+        ErrorLog() << "Open the record journal failed path=" << record_journal_path_;
+        return false;
+    }
+    return !ec;
+}
+
 UserProfile SQLiteDBManager::GetUserProfile(const UserID& uid, const std::string_view& time_range_begin,
         const std::string_view& time_range_end)
 {
+    Flush_();
     UserProfile profile;
-    ExecuteTransaction(db_name_, [&](sqlite::database& db)
+    const auto period = AggregatePeriod(time_range_begin, time_range_end);
+    ReadTransaction_([&](SQLiteConnection& db)
         {
             // get user total_score
             {
-                const auto result = GetTotalScoreOfUser(db, uid, time_range_begin, time_range_end);
+                const auto result = period ? GetTotalScoreOfUserFromAggregate(db, uid, *period)
+                                           : GetTotalScoreOfUser(db, uid, time_range_begin, time_range_end);
                 profile.uid_ = uid;
                 profile.match_count_ = result.match_count_;
                 profile.total_zero_sum_score_ = result.total_zero_sum_score_;
                 profile.total_top_score_ = result.total_top_score_;
                 profile.birth_time_ = result.birth_time_;
             }
-            ForeachTotalLevelScoreOfUser(db, uid, time_range_begin, time_range_end,
+            const auto on_game_level_info =
                   [&](const std::string& game_name, const uint64_t count, const double total_level_score)
                       {
                           profile.game_level_infos_.emplace_back(GameLevelInfo{
                                   .game_name_ = game_name, .count_ = count, .total_level_score_ = total_level_score});
-                      });
+                      };
+            if (period) {
+                ForeachTotalLevelScoreOfUserFromAggregate(db, uid, *period, on_game_level_info);
+            } else {
+                ForeachTotalLevelScoreOfUser(db, uid, time_range_begin, time_range_end, on_game_level_info);
+            }
             ForeachRecentMatchOfUser(db, uid, 10,
                   [&](const std::string& game_name, const std::string& finish_time, const uint64_t user_count,
                               const uint32_t multiple, const int64_t game_score, const int64_t zero_sum_score,
@@ -489,7 +1190,16 @@ UserProfile SQLiteDBManager::GetUserProfile(const UserID& uid, const std::string
 
 bool SQLiteDBManager::Suicide(const UserID& uid, const uint32_t required_match_num)
 {
-    return ExecuteTransaction(db_name_, [&](sqlite::database& db)
+    std::unique_lock<std::mutex> flush_l(flush_mutex_, std::defer_lock);
+    std::unique_lock<std::mutex> record_l(record_mutex_, std::defer_lock);
+    if (IsWriteBehind_()) {
+        // Block recording until the cached history of the user is invalidated, because the user may begin a new life.
+        std::lock(flush_l, record_l);
+        if (!FlushPendingMatches_(record_l, false)) {
+            return false;
+        }
+    }
+    const bool ret = WriteTransaction_([&](SQLiteConnection& db)
         {
             uint32_t posi_score_count = 0;
             ForeachRecentMatchOfUser(db, uid, required_match_num,
@@ -505,28 +1215,35 @@ bool SQLiteDBManager::Suicide(const UserID& uid, const uint32_t required_match_n
             }
             return false;
         });
+    if (ret) {
+        std::erase_if(history_cache_, [&uid](const auto& item) { return item.first.first == uid; });
+    }
+    return ret;
 }
 
 RankInfo SQLiteDBManager::GetRank(const std::string_view& time_range_begin, const std::string_view& time_range_end)
 {
+    Flush_();
     RankInfo info;
-    ExecuteTransaction(db_name_, [&](sqlite::database& db)
+    const auto period = AggregatePeriod(time_range_begin, time_range_end);
+    ReadTransaction_([&](SQLiteConnection& db)
         {
-            ForeachUserInRank(db, "user_with_match.zero_sum_score", time_range_begin, time_range_end,
-                    [&](std::string uid, const int64_t score_sum)
-                    {
-                        info.zero_sum_score_rank_.emplace_back(std::move(uid), score_sum);
-                    });
-            ForeachUserInRank(db, "user_with_match.top_score", time_range_begin, time_range_end,
-                    [&](std::string uid, const int64_t score_sum)
-                    {
-                        info.top_score_rank_.emplace_back(std::move(uid), score_sum);
-                    });
-            ForeachUserInRank(db, "1", time_range_begin, time_range_end,
-                    [&](std::string uid, const int64_t score_sum)
-                    {
-                        info.match_count_rank_.emplace_back(std::move(uid), score_sum);
-                    });
+            const auto foreach_user_in_rank = [&](const std::string& aggregate_score_name, const std::string& score_name,
+                    std::vector<std::pair<UserID, int64_t>>& rank)
+                {
+                    const auto on_user = [&](std::string uid, const int64_t score_sum)
+                        {
+                            rank.emplace_back(std::move(uid), score_sum);
+                        };
+                    if (period) {
+                        ForeachUserInRankFromAggregate(db, aggregate_score_name, *period, on_user);
+                    } else {
+                        ForeachUserInRank(db, score_name, time_range_begin, time_range_end, on_user);
+                    }
+                };
+            foreach_user_in_rank("zero_sum_score", "user_with_match.zero_sum_score", info.zero_sum_score_rank_);
+            foreach_user_in_rank("top_score", "user_with_match.top_score", info.top_score_rank_);
+            foreach_user_in_rank("match_count", "1", info.match_count_rank_);
             return true;
         });
     return info;
@@ -535,26 +1252,35 @@ RankInfo SQLiteDBManager::GetRank(const std::string_view& time_range_begin, cons
 GameRankInfo SQLiteDBManager::GetLevelScoreRank(const std::string& game_name, const std::string_view& time_range_begin,
         const std::string_view& time_range_end)
 {
+    Flush_();
     GameRankInfo info;
-    ExecuteTransaction(db_name_, [&](sqlite::database& db)
+    const auto period = AggregatePeriod(time_range_begin, time_range_end);
+    ReadTransaction_([&](SQLiteConnection& db)
         {
-            ForeachUserInGameLevelScoreRank(db, game_name, time_range_begin, time_range_end,
-                    [&](std::string uid, const double total_level_score)
+            const auto on_level_score = [&](std::string uid, const double total_level_score)
                     {
                         info.level_score_rank_.emplace_back(std::move(uid), total_level_score);
-                    });
-            ForeachUserInGameWeightLevelScoreRank(db, game_name, time_range_begin, time_range_end,
-                    [&](std::string uid, double weight_level_score)
+                    };
+            const auto on_weight_level_score = [&](std::string uid, double weight_level_score)
                     {
                         weight_level_score =
                             (1 - 2 * std::signbit(weight_level_score)) * std::sqrt(std::abs(weight_level_score));
                         info.weight_level_score_rank_.emplace_back(std::move(uid), weight_level_score);
-                    });
-            ForeachUserInGameMatchCountRank(db, game_name, time_range_begin, time_range_end,
-                    [&](std::string uid, const int64_t match_count)
+                    };
+            const auto on_match_count = [&](std::string uid, const int64_t match_count)
                     {
                         info.match_count_rank_.emplace_back(std::move(uid), match_count);
-                    });
+                    };
+            if (period) {
+                ForeachUserInGameLevelScoreRankFromAggregate(db, game_name, on_level_score);
+                ForeachUserInGameWeightLevelScoreRankFromAggregate(db, game_name, *period, on_weight_level_score);
+                ForeachUserInGameMatchCountRankFromAggregate(db, game_name, *period, on_match_count);
+            } else {
+                ForeachUserInGameLevelScoreRank(db, game_name, time_range_begin, time_range_end, on_level_score);
+                ForeachUserInGameWeightLevelScoreRank(db, game_name, time_range_begin, time_range_end,
+                        on_weight_level_score);
+                ForeachUserInGameMatchCountRank(db, game_name, time_range_begin, time_range_end, on_match_count);
+            }
             return true;
         });
     return info;
@@ -563,8 +1289,9 @@ GameRankInfo SQLiteDBManager::GetLevelScoreRank(const std::string& game_name, co
 AchievementStatisticInfo SQLiteDBManager::GetAchievementStatistic(const UserID& uid, const std::string& game_name,
             const std::string& achievement_name)
 {
+    Flush_();
     AchievementStatisticInfo info;
-    ExecuteTransaction(db_name_, [&](sqlite::database& db)
+    ReadTransaction_([&](SQLiteConnection& db)
         {
             auto result = ::GetAchievementStatistic(db, uid, game_name, std::string(achievement_name));
             info.first_achieve_time_ = std::move(result.first_achieve_time_);
@@ -577,7 +1304,7 @@ AchievementStatisticInfo SQLiteDBManager::GetAchievementStatistic(const UserID&
 
 bool SQLiteDBManager::AddHonor(const UserID& uid, const std::string_view& description)
 {
-    return ExecuteTransaction(db_name_, [&](sqlite::database& db)
+    return WriteTransaction_([&](SQLiteConnection& db)
         {
             const auto birth_count = GetBirthCountOfUser(db, uid);
             ::AddHonor(db, description, uid, birth_count);
@@ -587,7 +1314,7 @@ bool SQLiteDBManager::AddHonor(const UserID& uid, const std::string_view& descri
 
 bool SQLiteDBManager::DeleteHonor(const int32_t id)
 {
-    return ExecuteTransaction(db_name_, [&](sqlite::database& db)
+    return WriteTransaction_([&](SQLiteConnection& db)
         {
             ::DeleteHonor(db, id);
             return true;
@@ -597,7 +1324,7 @@ bool SQLiteDBManager::DeleteHonor(const int32_t id)
 std::vector<HonorInfo> SQLiteDBManager::GetHonors(const std::string& keyword, const uint32_t limit)
 {
     std::vector<HonorInfo> info;
-    ExecuteTransaction(db_name_, [&](sqlite::database& db)
+    ReadTransaction_([&](SQLiteConnection& db)
         {
             ForeachHonor(db, keyword, limit,
                 [&](const int32_t id, std::string description, std::string uid, std::string time)
@@ -609,49 +1336,134 @@ std::vector<HonorInfo> SQLiteDBManager::GetHonors(const std::string& keyword, co
     return info;
 }
 
-std::unique_ptr<DBManagerBase> SQLiteDBManager::UseDB(const char* const db_name)
+// Version 1: the tables created before the schema is versioned.
+static void CreateTables(sqlite::database& db)
+{
+    db << "CREATE TABLE IF NOT EXISTS match("
+            "match_id INTEGER PRIMARY KEY AUTOINCREMENT, "
+            "game_name VARCHAR(100) NOT NULL, "
+            "finish_time DATETIME, "
+            "group_id VARCHAR(100), "
+            "host_user_id VARCHAR(100) NOT NULL, "
+            "user_count BIGINT UNSIGNED NOT NULL, "
+            "multiple INT UNSIGNED NOT NULL);";
+    db << "CREATE TABLE IF NOT EXISTS user_with_match("
+            "user_id VARCHAR(100) NOT NULL, "
+            "birth_count INT UNSIGNED NOT NULL, "
+            "match_id BIGINT UNSIGNED NOT NULL, "
+            "game_score BIGINT NOT NULL, "
+            "zero_sum_score BIGINT NOT NULL, "
+            "top_score BIGINT NOT NULL, "
+            "level_score DOUBLE NOT NULL, "
+            "rank_score BIGINT NOT NULL, "
+            "PRIMARY KEY (user_id, match_id));";
+    db << "CREATE TABLE IF NOT EXISTS user("
+            "user_id VARCHAR(100) PRIMARY KEY, "
+            "birth_time DATETIME, "
+            "birth_count INT UNSIGNED DEFAULT 0, "
+            "passwd VARCHAR(100));";
+    db << "CREATE TABLE IF NOT EXISTS honor("
+            "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+            "description VARCHAR(200) NOT NULL, "
+            "user_id VARCHAR(100) NOT NULL, "
+            "birth_count INT UNSIGNED NOT NULL, "
+            "time DATETIME);";
+    db << "CREATE TABLE IF NOT EXISTS user_with_achievement("
+            "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+            "user_id VARCHAR(100) NOT NULL, "
+            "birth_count INT UNSIGNED NOT NULL, "
+            "match_id BIGINT UNSIGNED NOT NULL, "
+            "achievement_name VARCHAR(100) NOT NULL);";
+}
+
+// Version 2: the score aggregates, which are backfilled from the matches recorded before.
+static void CreateScoreAggregates(sqlite::database& db)
+{
+    db << "CREATE TABLE IF NOT EXISTS user_score_aggregate("
+            "user_id VARCHAR(100) NOT NULL, "
+            "birth_count INT UNSIGNED NOT NULL, "
+            "game_name VARCHAR(100) NOT NULL, "
+            "period VARCHAR(10) NOT NULL, "
+            "match_count BIGINT UNSIGNED NOT NULL, "
+            "zero_sum_score BIGINT NOT NULL, "
+            "top_score BIGINT NOT NULL, "
+            "level_score DOUBLE NOT NULL, "
+            "PRIMARY KEY (user_id, birth_count, game_name, period));";
+    RebuildScoreAggregates(db);
+}
+
+// Version 3: the indexes for the filters of the queries. The index `user_id_index` was created for both
+// `user_with_match` and `user_with_achievement` before, so only the first one existed, and it is covered by the primary
+// key of `user_with_match`.
+static void CreateIndexes(sqlite::database& db)
+{
+    db << "DROP INDEX IF EXISTS user_id_index;";
+    db << "CREATE INDEX IF NOT EXISTS match_game_name_index ON match(game_name, finish_time);";
+    db << "CREATE INDEX IF NOT EXISTS match_finish_time_index ON match(finish_time);";
+    db << "CREATE INDEX IF NOT EXISTS user_with_match_match_id_index ON user_with_match(match_id);";
+    db << "CREATE INDEX IF NOT EXISTS user_with_match_birth_count_index "
+            "ON user_with_match(user_id, birth_count, match_id);";
+    db << "CREATE INDEX IF NOT EXISTS user_with_achievement_user_id_index "
+            "ON user_with_achievement(user_id, birth_count);";
+    db << "CREATE INDEX IF NOT EXISTS user_with_achievement_achievement_name_index "
+            "ON user_with_achievement(achievement_name, match_id);";
+    db << "CREATE INDEX IF NOT EXISTS honor_user_id_index ON honor(user_id, birth_count);";
+    db << "CREATE INDEX IF NOT EXISTS user_score_aggregate_rank_index ON user_score_aggregate(game_name, period);";
+}
+
+// Version 4: the sequence number of the last match in the record journal which has been written, so the matches are
+// written exactly once when the record journal is replayed.
+static void CreateRecordJournalCheckpoint(sqlite::database& db)
+{
+    db << "CREATE TABLE IF NOT EXISTS record_journal_checkpoint("
+            "id INTEGER PRIMARY KEY CHECK (id = 0), "
+            "seq BIGINT UNSIGNED NOT NULL);";
+}
+
+// The migration to version i + 1 is k_schema_migrations[i]. The version of the schema is stored as the user version of
+// the database, which is 0 for the databases created before the schema is versioned. New migrations should only be
+// appended.
+static void (* const k_schema_migrations[])(sqlite::database&) = {
+    CreateTables,
+    CreateScoreAggregates,
+    CreateIndexes,
+    CreateRecordJournalCheckpoint,
+};
+
+void MigrateSchema(sqlite::database& db)
+{
+    int32_t version = 0;
+    db << "PRAGMA user_version;" >> version;
+    if (version < 0 || static_cast<size_t>(version) > std::size(k_schema_migrations)) {
+        throw std::runtime_error("the schema version " + std::to_string(version) + " is not a version up to the latest version " +
+                std::to_string(std::size(k_schema_migrations)));
+    }
+    for (; static_cast<size_t>(version) < std::size(k_schema_migrations); ++version) {
+        db << "BEGIN;";
+        k_schema_migrations[version](db);
+        db << "PRAGMA user_version = " + std::to_string(version + 1) + ";";
+        db << "COMMIT;";
+        InfoLog() << "Migrate the database schema to version " << version + 1;
+    }
+}
+
+std::unique_ptr<DBManagerBase> SQLiteDBManager::UseDB(const char* const db_name, const uint32_t reader_num,
+        const uint32_t flush_interval_ms)
 {
     std::string db_name_str(db_name);
     try {
         sqlite::database db(db_name);
-        db << "CREATE TABLE IF NOT EXISTS match("
-                "match_id INTEGER PRIMARY KEY AUTOINCREMENT, "
-                "game_name VARCHAR(100) NOT NULL, "
-                "finish_time DATETIME, "
-                "group_id VARCHAR(100), "
-                "host_user_id VARCHAR(100) NOT NULL, "
-                "user_count BIGINT UNSIGNED NOT NULL, "
-                "multiple INT UNSIGNED NOT NULL);";
-        db << "CREATE TABLE IF NOT EXISTS user_with_match("
-                "user_id VARCHAR(100) NOT NULL, "
-                "birth_count INT UNSIGNED NOT NULL, "
-                "match_id BIGINT UNSIGNED NOT NULL, "
-                "game_score BIGINT NOT NULL, "
-                "zero_sum_score BIGINT NOT NULL, "
-                "top_score BIGINT NOT NULL, "
-                "level_score DOUBLE NOT NULL, "
-                "rank_score BIGINT NOT NULL, "
-                "PRIMARY KEY (user_id, match_id));";
-        db << "CREATE INDEX IF NOT EXISTS user_id_index ON user_with_match(user_id);";
-        db << "CREATE TABLE IF NOT EXISTS user("
-                "user_id VARCHAR(100) PRIMARY KEY, "
-                "birth_time DATETIME, "
-                "birth_count INT UNSIGNED DEFAULT 0, "
-                "passwd VARCHAR(100));";
-        db << "CREATE TABLE IF NOT EXISTS honor("
-                "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-                "description VARCHAR(200) NOT NULL, "
-                "user_id VARCHAR(100) NOT NULL, "
-                "birth_count INT UNSIGNED NOT NULL, "
-                "time DATETIME);";
-        db << "CREATE TABLE IF NOT EXISTS user_with_achievement("
-                "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-                "user_id VARCHAR(100) NOT NULL, "
-                "birth_count INT UNSIGNED NOT NULL, "
-                "match_id BIGINT UNSIGNED NOT NULL, "
-                "achievement_name VARCHAR(100) NOT NULL);";
-        db << "CREATE INDEX IF NOT EXISTS user_id_index ON user_with_achievement(user_id);";
-        return std::unique_ptr<DBManagerBase>(new SQLiteDBManager(db_name_str));
+        MigrateSchema(db);
+        if (reader_num > 0) {
+            // In WAL mode, the readers read the last committed snapshot without blocking the writer. The mode is persistent
+            // in the database file.
+            db << "PRAGMA journal_mode = WAL;";
+        }
+        std::unique_ptr<SQLiteDBManager> db_manager(new SQLiteDBManager(db_name_str, reader_num, flush_interval_ms));
+        if (flush_interval_ms > 0 && !db_manager->StartWriteBehind_()) {
+            return nullptr;
+        }
+        return db_manager;
     } catch (const sqlite::sqlite_exception& e) {
         HandleError(e);
     } catch (const std::exception& e) {
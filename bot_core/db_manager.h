@@ -29,6 +29,12 @@ ENUM_END(TimeRange)
 #include <bitset>
 #include <array>
 #include <optional>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <thread>
 
 #include "utility/log.h"
 #include "bot_core/id.h"
@@ -48,6 +54,14 @@ inline const char* const k_time_range_end_datetimes[] = {
     [TimeRange(TimeRange::总).ToUInt()] = "",
 };
 
+// The period of the score aggregates which each time range corresponds to. The periods of a match are the year and the
+// month of its finish time, and the empty period covers all the time.
+inline const char* const k_time_range_periods[] = {
+    [TimeRange(TimeRange::月).ToUInt()] = "strftime('%Y-%m', 'now', 'localtime')",
+    [TimeRange(TimeRange::年).ToUInt()] = "strftime('%Y', 'now', 'localtime')",
+    [TimeRange(TimeRange::总).ToUInt()] = "''",
+};
+
 struct MatchProfile
 {
     std::string game_name_;
@@ -150,10 +164,49 @@ class DBManagerBase
 
 #ifdef WITH_SQLITE
 
+class SQLiteConnection;
+
+namespace sqlite {
+class database;
+}
+
+// The operations on a connection opened outside, which are used by the tools and the tests which modify the database
+// file directly.
+void MigrateSchema(sqlite::database& db);
+void RebuildScoreAggregates(sqlite::database& db);
+void RecordMatch(sqlite::database& db, const std::string& game_name, const std::optional<GroupID> gid,
+        const UserID host_uid, const uint64_t multiple, const std::vector<ScoreInfo>& score_infos,
+        const std::vector<std::pair<UserID, std::string>>& achievements);
+
+// The result of a match whose scores are computed but which may have not been written into the database.
+struct MatchRecord
+{
+    uint64_t seq_ = 0; // the sequence number in the record journal
+    std::string finish_time_;
+    std::string game_name_;
+    std::optional<GroupID> gid_;
+    UserID host_uid_;
+    uint64_t multiple_ = 0;
+    std::vector<ScoreInfo> score_infos_;
+    std::vector<std::pair<UserID, std::string>> achievements_;
+};
+
 class SQLiteDBManager : public DBManagerBase
 {
   public:
-    static std::unique_ptr<DBManagerBase> UseDB(const char* sv);
+    static constexpr const uint32_t k_default_reader_num = 4;
+
+    // The manager keeps one connection for writing and at most |reader_num| connections for reading, each of which
+    // caches its prepared statements. If |reader_num| is 0, a new connection is opened for each transaction.
+    //
+    // If |flush_interval_ms| is not 0, results of matches are written behind: the scores are computed with the cached
+    // history of users and returned at once, and the results are written by a background thread, which gathers the
+    // results in |flush_interval_ms| into one transaction. The results are appended to the record journal, whose path
+    // is the database path with the suffix ".records", and synced to the disk before returning, so the results which
+    // have not been written when the bot exits or the machine crashes are written the next time the database is used. Queries wait for the results recorded before
+    // them to be written.
+    static std::unique_ptr<DBManagerBase> UseDB(const char* sv, const uint32_t reader_num = k_default_reader_num,
+            const uint32_t flush_interval_ms = 0);
     virtual ~SQLiteDBManager();
     virtual std::vector<ScoreInfo> RecordMatch(const std::string& game_name, const std::optional<GroupID> gid,
             const UserID& host_uid, const uint64_t multiple,
@@ -172,9 +225,59 @@ class SQLiteDBManager : public DBManagerBase
     virtual bool DeleteHonor(const int32_t id) override;
 
   private:
-    SQLiteDBManager(std::string db_name);
+    struct GameHistory
+    {
+        uint64_t match_count_ = 0;
+        double total_level_score_ = 0;
+    };
+
+    SQLiteDBManager(std::string db_name, const uint32_t reader_num, const uint32_t flush_interval_ms);
+
+    template <typename Fn>
+    bool WriteTransaction_(const Fn& fn);
+
+    template <typename Fn>
+    bool ReadTransaction_(const Fn& fn);
+
+    bool IsWriteBehind_() const { return flush_interval_.count() > 0; }
+    bool StartWriteBehind_();
+    std::vector<ScoreInfo> RecordMatchBehind_(const std::string& game_name, const std::optional<GroupID> gid,
+            const UserID& host_uid, const uint64_t multiple,
+            const std::vector<std::pair<UserID, int64_t>>& game_score_infos,
+            const std::vector<std::pair<UserID, std::string>>& achievements);
+    std::optional<GameHistory> GetGameHistory_(const UserID& uid, const std::string& game_name);
+    void FlushLoop_();
+    void Flush_();
+    bool FlushPendingMatches_(std::unique_lock<std::mutex>& record_l, const bool allow_recording);
+    bool CompactRecordJournal_();
 
     std::string db_name_;
+    const uint32_t reader_num_;
+    const std::chrono::milliseconds flush_interval_; // be zero if matches are written synchronously
+
+    // Writes are serialized because SQLite allows only one writer at the same time.
+    std::mutex writer_mutex_;
+    std::unique_ptr<SQLiteConnection> writer_;
+
+    std::mutex reader_mutex_;
+    std::condition_variable reader_cv_;
+    uint32_t borrowed_reader_num_ = 0;
+    std::vector<std::unique_ptr<SQLiteConnection>> idle_readers_;
+
+    // Flushes are serialized so that the matches are written in the order of recording.
+    std::mutex flush_mutex_;
+
+    std::mutex record_mutex_;
+    std::condition_variable record_cv_;
+    bool is_stopped_ = false;
+    uint64_t last_seq_ = 0; // the sequence number of the last recorded match
+    std::deque<MatchRecord> pending_matches_; // the recorded matches which have not been written
+    // The history of users in their current lives. Each user in the pending matches is cached, so the history of a
+    // missing user can be read from the database. The users are evicted once their matches are written.
+    std::map<std::pair<UserID, std::string>, GameHistory> history_cache_;
+    const std::string record_journal_path_;
+    int record_journal_fd_ = -1;
+    std::thread flusher_;
 };
 
 #endif // WITH_SQLITE
@@ -10,6 +10,7 @@
 #include <optional>
 #include <string>
 #include <memory>
+#include <mutex>
 #include <filesystem>
 
 #include "image.h"
@@ -35,6 +36,7 @@ class GameHandle
     // TODO: Check the type correctness in compiling time.
     using max_player_num_handler = uint64_t(*)(const lgtbot::game::GameOptionsBase*);
     using multiple_handler = uint32_t(*)(const lgtbot::game::GameOptionsBase*);
+    using rule_handler = const char*(*)();
     using rule_command_handler = const char*(*)(const char* const s);
     using init_options_command_handler = lgtbot::game::InitOptionsResult(*)(const char*, lgtbot::game::GameOptionsBase*, lgtbot::game::MutableGenericOptions*);
     using game_options_allocator = lgtbot::game::GameOptionsBase*(*)();
@@ -55,9 +57,10 @@ class GameHandle
         std::string module_name_;
         std::string developer_;
         std::string description_;
-        std::string rule_;
         std::vector<Achievement> achievements_;
 
+        rule_handler rule_fn_{nullptr}; // NULL for the modules built before `GetGameRule` is exported
+        std::string rule_; // the rule returned by `GetGameInfo`, which is used only if |rule_fn_| is NULL
         max_player_num_handler max_player_num_fn_{nullptr};
         multiple_handler multiple_fn_{nullptr};
 
@@ -74,21 +77,24 @@ class GameHandle
         std::function<void()> mod_guard_;
     };
 
+    // The default options and the rule are generated when they are used for the first time, so games nobody plays cost
+    // nothing but loading the module.
     GameHandle(const BasicInfo& info, const InternalHandler& internal_handler,
             const lgtbot::game::MutableGenericOptions& default_generic_options)
         : info_(info)
         , internal_handler_(internal_handler)
-        , default_options_{Options{
-             game_options_ptr{internal_handler_.game_options_allocator_(), internal_handler_.game_options_deleter_},
-             lgtbot::game::GenericOptions{lgtbot::game::ImmutableGenericOptions{}, default_generic_options}
-          }}
+        , default_generic_options_(default_generic_options)
     {
     }
 
     GameHandle(const GameHandle&) = delete;
     GameHandle(GameHandle&&) = delete;
 
-    ~GameHandle() { internal_handler_.mod_guard_(); }
+    ~GameHandle()
+    {
+        default_options_.reset(); // the deleter is in the module
+        internal_handler_.mod_guard_();
+    }
 
     using game_options_ptr = std::unique_ptr<lgtbot::game::GameOptionsBase, game_options_deleter>;
 
@@ -100,15 +106,21 @@ class GameHandle
 
     Options CopyDefaultGameOptions() const
     {
-        const auto locked_options = default_options_.Lock();
+        const auto locked_options = DefaultGameOptions().Lock();
         return Options{
             .game_options_ = game_options_ptr(locked_options->game_options_->Copy(), internal_handler_.game_options_deleter_),
             .generic_options_ = locked_options->generic_options_,
         };
     }
 
-    LockWrapper<Options>& DefaultGameOptions() { return default_options_; }
-    const LockWrapper<Options>& DefaultGameOptions() const { return default_options_; }
+    LockWrapper<Options>& DefaultGameOptions() { return LazyDefaultOptions_(); }
+    const LockWrapper<Options>& DefaultGameOptions() const { return LazyDefaultOptions_(); }
+
+    const std::string& Rule() const
+    {
+        std::call_once(rule_once_, [this] { rule_ = info_.rule_fn_ ? info_.rule_fn_() : info_.rule_; });
+        return rule_;
+    }
 
     using main_stage_ptr = std::unique_ptr<lgtbot::game::MainStageBase, main_stage_deleter>;
 
@@ -123,12 +135,24 @@ class GameHandle
     const BasicInfo& Info() const { return info_; }
 
   private:
+    LockWrapper<Options>& LazyDefaultOptions_() const
+    {
+        std::call_once(default_options_once_, [this]
+                {
+                    default_options_ = std::make_unique<LockWrapper<Options>>(Options{
+                            game_options_ptr{internal_handler_.game_options_allocator_(), internal_handler_.game_options_deleter_},
+                            default_generic_options_});
+                });
+        return *default_options_;
+    }
+
     BasicInfo info_;
     InternalHandler internal_handler_;
-    LockWrapper<Options> default_options_ = Options{
-        game_options_ptr{internal_handler_.game_options_allocator_(), internal_handler_.game_options_deleter_},
-        lgtbot::game::MutableGenericOptions{}
-    };
+    const lgtbot::game::MutableGenericOptions default_generic_options_;
+    mutable std::once_flag default_options_once_;
+    mutable std::unique_ptr<LockWrapper<Options>> default_options_;
+    mutable std::once_flag rule_once_;
+    mutable std::string rule_;
     std::atomic<uint64_t> activity_{0}; // the sum of the number of times all users participated in this game
 };
 
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <cstdint>
+#include <functional>
 #include <string>
 #include <iostream>
 #include <limits>
@@ -84,3 +85,7 @@ struct idname \
 
 DEFINE_STRING_ID(UserID);
 DEFINE_STRING_ID(GroupID);
+
+template <> struct std::hash<MatchID> { size_t operator()(const MatchID id) const { return std::hash<uint32_t>{}(id.Get()); } };
+template <> struct std::hash<UserID> { size_t operator()(const UserID& id) const { return std::hash<std::string>{}(id.GetStr()); } };
+template <> struct std::hash<GroupID> { size_t operator()(const GroupID& id) const { return std::hash<std::string>{}(id.GetStr()); } };
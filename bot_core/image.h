@@ -12,6 +12,7 @@
 #include <dirent.h>
 
 #include "utility/log.h"
+#include "bot_core/markdown_renderer.h"
 
 #ifdef TEST_BOT
 static bool enable_markdown_to_image = false;
@@ -19,8 +20,6 @@ static bool enable_markdown_to_image = false;
 static bool enable_markdown_to_image = true;
 #endif
 
-inline const std::string k_markdown2image_path = (std::filesystem::current_path() / "markdown2image").string(); // TODO: config
-
 inline int MarkdownToImage(const std::string& markdown, const std::string& path, const uint32_t width)
 {
     assert(!path.empty());
@@ -32,16 +31,7 @@ inline int MarkdownToImage(const std::string& markdown, const std::string& path,
         // return 0;
     }
     std::filesystem::create_directories(std::filesystem::path(path).parent_path());
-    const std::string cmd = k_markdown2image_path + " --output " + path + " --width " + std::to_string(width) + " --nowith_css --noprint_info";
-    FILE* fp = popen(cmd.c_str(), "w");
-    if (fp == nullptr) {
-        ErrorLog() << "Draw image failed cmd=\'" << cmd;
-        return -1;
-    }
-    DebugLog() << "Draw image succeed cmd=\'" << cmd;
-    fputs(markdown.c_str(), fp);
-    pclose(fp);
-    return 0;
+    return MarkdownRenderer::Instance().Render(markdown, path, width);
 }
 
 inline int CharToImage(const char ch, const std::string& path)
@@ -0,0 +1,266 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "utility/log.h"
+
+// A content-addressed store of rendered markdown images.
+//
+// The image of a (markdown, width) pair is saved to '<dir>/<hash>.png', where the hash is the 128-bit MurmurHash3 of the
+// markdown seeded by the width, so the same content is rendered only once and the saved file is never rewritten. Files
+// are indexed by an in-memory LRU list, the least recently used files are removed when the total size exceeds
+// |max_bytes|. Files saved by previous runs are loaded into the index on startup.
+//
+// A returned image is pinned until its |pin_| is released, and a pinned file is never removed by eviction, so the path
+// can be handed to the outbound pipeline and sent after other images are rendered.
+class MarkdownImageCache
+{
+  public:
+    using RenderFn = std::function<int(const std::string& markdown, const std::string& path, uint32_t width)>;
+
+    struct PinnedImage
+    {
+        std::string path_;
+        std::shared_ptr<void> pin_; // the file is not evicted until all copies of the pin are released
+    };
+
+    struct Stats
+    {
+        uint64_t hit_count_ = 0;
+        uint64_t miss_count_ = 0;
+        uint64_t evict_count_ = 0;
+        uint64_t file_count_ = 0;
+        uint64_t total_bytes_ = 0;
+    };
+
+    static constexpr const uint64_t k_default_max_bytes = 256ULL << 20;
+
+    MarkdownImageCache(std::filesystem::path dir, const uint64_t max_bytes = k_default_max_bytes)
+        : dir_(std::move(dir)), max_bytes_(max_bytes)
+    {
+        LoadIndex_();
+    }
+
+    MarkdownImageCache(const MarkdownImageCache&) = delete;
+    MarkdownImageCache(MarkdownImageCache&&) = delete;
+
+    // Return the pinned image. The image is rendered by |render| only when it is not cached. Return nullopt if the
+    // image fails to be rendered.
+    std::optional<PinnedImage> GetOrRender(const std::string_view markdown, const uint32_t width, const RenderFn& render)
+    {
+        const std::string key = Key(markdown, width);
+        const std::string path = Path_(key);
+        {
+            std::lock_guard<std::mutex> l(mutex_);
+            if (const auto it = index_.find(key); it != index_.end()) {
+                if (std::error_code ec; std::filesystem::exists(path, ec)) {
+                    lru_.splice(lru_.begin(), lru_, it->second);
+                    ++stats_.hit_count_;
+                    return PinnedImage{path, Pin_(key)};
+                }
+                Erase_(it); // the file is removed by others
+            }
+            ++stats_.miss_count_;
+        }
+
+        // Render to a temporary file and rename it, so that a cached file is always complete.
+        const std::string tmp_path = path + "." + std::to_string(tmp_no_++) + ".tmp";
+        render(std::string(markdown), tmp_path, width);
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(tmp_path, ec);
+        if (ec) {
+            DebugLog() << "Image is not rendered, skip caching path=" << path;
+            return std::nullopt;
+        }
+        // Pin the image before it is renamed into place, so the file cannot be evicted before it is returned.
+        std::unique_lock<std::mutex> l(mutex_);
+        auto pin = Pin_(key);
+        l.unlock();
+        std::filesystem::rename(tmp_path, path, ec);
+        if (ec) {
+            WarnLog() << "Rename rendered image failed path=" << path << " reason=" << ec.message();
+            std::filesystem::remove(tmp_path, ec);
+            return std::nullopt;
+        }
+
+        l.lock();
+        if (index_.find(key) == index_.end()) { // another thread may render the same image concurrently
+            Insert_(key, size);
+            Evict_();
+        }
+        return PinnedImage{path, std::move(pin)};
+    }
+
+    Stats GetStats() const
+    {
+        std::lock_guard<std::mutex> l(mutex_);
+        return stats_;
+    }
+
+    static std::string Key(const std::string_view markdown, const uint32_t width)
+    {
+        const auto [h1, h2] = Murmur3_128_(markdown, width);
+        char buffer[33];
+        std::snprintf(buffer, sizeof(buffer), "%016llx%016llx", static_cast<unsigned long long>(h1),
+                static_cast<unsigned long long>(h2));
+        return buffer;
+    }
+
+  private:
+    // MurmurHash3_x64_128 of |data|, whose seed is the width.
+    static std::pair<uint64_t, uint64_t> Murmur3_128_(const std::string_view data, const uint32_t seed)
+    {
+        static constexpr uint64_t c1 = 0x87c37b91114253d5ULL;
+        static constexpr uint64_t c2 = 0x4cf5ad432745937fULL;
+        const auto rotl = [](const uint64_t x, const int r) { return (x << r) | (x >> (64 - r)); };
+        const auto fmix = [](uint64_t k)
+            {
+                k ^= k >> 33;
+                k *= 0xff51afd7ed558ccdULL;
+                k ^= k >> 33;
+                k *= 0xc4ceb9fe1a85ec53ULL;
+                k ^= k >> 33;
+                return k;
+            };
+        const auto load = [&data](const size_t begin, const size_t end)
+            {
+                uint64_t k = 0;
+                for (size_t i = end; i > begin; --i) {
+                    k = (k << 8) | static_cast<unsigned char>(data[i - 1]);
+                }
+                return k;
+            };
+        uint64_t h1 = seed;
+        uint64_t h2 = seed;
+        const size_t block_num = data.size() / 16;
+        for (size_t i = 0; i < block_num; ++i) {
+            h1 ^= rotl(load(i * 16, i * 16 + 8) * c1, 31) * c2;
+            h1 = (rotl(h1, 27) + h2) * 5 + 0x52dce729;
+            h2 ^= rotl(load(i * 16 + 8, i * 16 + 16) * c2, 33) * c1;
+            h2 = (rotl(h2, 31) + h1) * 5 + 0x38495ab5;
+        }
+        const size_t tail = block_num * 16;
+        if (data.size() > tail + 8) {
+            h2 ^= rotl(load(tail + 8, data.size()) * c2, 33) * c1;
+        }
+        if (data.size() > tail) {
+            h1 ^= rotl(load(tail, std::min(data.size(), tail + 8)) * c1, 31) * c2;
+        }
+        h1 ^= data.size();
+        h2 ^= data.size();
+        h1 += h2;
+        h2 += h1;
+        h1 = fmix(h1);
+        h2 = fmix(h2);
+        h1 += h2;
+        h2 += h1;
+        return {h1, h2};
+    }
+
+    using LRUList = std::list<std::pair<std::string, uint64_t>>; // (key, file size), most recently used first
+
+    std::string Path_(const std::string& key) const { return (dir_ / (key + ".png")).string(); }
+
+    void LoadIndex_()
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(dir_, ec);
+        std::vector<std::filesystem::directory_entry> entries;
+        for (const auto& entry : std::filesystem::directory_iterator(dir_, ec)) {
+            if (!entry.is_regular_file(ec)) {
+                continue;
+            }
+            if (entry.path().extension() == ".tmp") {
+                std::filesystem::remove(entry.path(), ec); // left by a crashed process
+            } else if (entry.path().extension() == ".png") {
+                entries.emplace_back(entry);
+            } // files of other formats are not managed by the cache
+        }
+        std::ranges::sort(entries, [](const auto& _1, const auto& _2)
+                {
+                    std::error_code ec;
+                    return _1.last_write_time(ec) < _2.last_write_time(ec);
+                });
+        for (const auto& entry : entries) {
+            Insert_(entry.path().stem().string(), entry.file_size(ec));
+        }
+        Evict_();
+        InfoLog() << "Load image cache dir=" << dir_ << " file_count=" << stats_.file_count_
+                  << " total_bytes=" << stats_.total_bytes_;
+    }
+
+    // REQUIRE: should be protected by mutex_
+    std::shared_ptr<void> Pin_(const std::string& key)
+    {
+        ++pin_counts_[key];
+        return std::shared_ptr<void>(nullptr, [this, key](void*)
+                {
+                    std::lock_guard<std::mutex> l(mutex_);
+                    if (const auto it = pin_counts_.find(key); --it->second == 0) {
+                        pin_counts_.erase(it);
+                        Evict_(); // the file may be kept beyond the limit because it was pinned
+                    }
+                });
+    }
+
+    // REQUIRE: should be protected by mutex_
+    void Insert_(const std::string& key, const uint64_t size)
+    {
+        lru_.emplace_front(key, size);
+        index_.emplace(key, lru_.begin());
+        ++stats_.file_count_;
+        stats_.total_bytes_ += size;
+    }
+
+    // REQUIRE: should be protected by mutex_
+    void Erase_(const std::unordered_map<std::string, LRUList::iterator>::iterator it)
+    {
+        --stats_.file_count_;
+        stats_.total_bytes_ -= it->second->second;
+        lru_.erase(it->second);
+        index_.erase(it);
+    }
+
+    // REQUIRE: should be protected by mutex_
+    void Evict_()
+    {
+        // Pinned files may be being sent, so they are skipped even if the total size exceeds the limit.
+        for (auto it = lru_.end(); stats_.total_bytes_ > max_bytes_ && it != lru_.begin(); ) {
+            const std::string key = (--it)->first;
+            if (pin_counts_.contains(key)) {
+                continue;
+            }
+            std::error_code ec;
+            std::filesystem::remove(Path_(key), ec);
+            it = std::next(it);
+            Erase_(index_.find(key));
+            ++stats_.evict_count_;
+        }
+    }
+
+    const std::filesystem::path dir_;
+    const uint64_t max_bytes_;
+    std::atomic<uint64_t> tmp_no_{0};
+    mutable std::mutex mutex_;
+    LRUList lru_;
+    std::unordered_map<std::string, LRUList::iterator> index_;
+    std::unordered_map<std::string, uint32_t> pin_counts_; // the keys of images which are not released by callers
+    Stats stats_;
+};
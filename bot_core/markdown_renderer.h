@@ -0,0 +1,212 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "utility/log.h"
+
+inline const std::string k_markdown2image_path = (std::filesystem::current_path() / "markdown2image").string(); // TODO: config
+
+// Render markdown to images by starting a markdown2image process for each image.
+//
+// At most |max_running_num_| processes run at the same time. When all of them are busy, at most |max_waiting_num_|
+// callers can wait, other callers fail immediately, so a burst of images cannot start unbounded browser engines. Each
+// request must be finished in |timeout_| (including the waiting time), otherwise the process group of the renderer is
+// killed and the request fails. On Windows, markdown2image is started by popen and there is no per-image timeout, only
+// the time waiting for other renderers is bounded.
+//
+// A failed request removes the output file, so a partially written image is never sent.
+class MarkdownRenderer
+{
+  public:
+    struct Options
+    {
+        std::string command_;
+        uint32_t max_running_num_ = 4;
+        uint32_t max_waiting_num_ = 64;
+        std::chrono::milliseconds timeout_{30000};
+    };
+
+    static MarkdownRenderer& Instance()
+    {
+        static MarkdownRenderer renderer(Options{.command_ = k_markdown2image_path});
+        return renderer;
+    }
+
+    explicit MarkdownRenderer(Options options) : options_(std::move(options)) {}
+
+    MarkdownRenderer(const MarkdownRenderer&) = delete;
+    MarkdownRenderer(MarkdownRenderer&&) = delete;
+
+    int Render(const std::string& markdown, const std::string& path, const uint32_t width)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + options_.timeout_;
+        {
+            std::unique_lock<std::mutex> l(mutex_);
+            if (running_num_ >= options_.max_running_num_ && waiting_num_ >= options_.max_waiting_num_) {
+                WarnLog() << "Draw image rejected because too many requests are waiting, path=" << path;
+                return -1;
+            }
+            ++waiting_num_;
+            const bool can_run =
+                cv_.wait_until(l, deadline, [this] { return running_num_ < options_.max_running_num_; });
+            --waiting_num_;
+            if (!can_run) {
+                WarnLog() << "Draw image timeout when waiting for other renderers, path=" << path;
+                return -1;
+            }
+            ++running_num_;
+        }
+        const int ret = Fork_(markdown, path, width, deadline);
+        {
+            std::lock_guard<std::mutex> l(mutex_);
+            --running_num_;
+        }
+        cv_.notify_one();
+        if (ret != 0) {
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+        }
+        return ret;
+    }
+
+  private:
+#ifdef _WIN32
+
+    // There is no per-image timeout here: the deadline only bounds the time waiting for other renderers.
+    int Fork_(const std::string& markdown, const std::string& path, const uint32_t width,
+            const std::chrono::steady_clock::time_point /*deadline*/)
+    {
+        const std::string cmd = options_.command_ + " --output " + path + " --width " + std::to_string(width) +
+            " --nowith_css --noprint_info";
+        FILE* fp = popen(cmd.c_str(), "w");
+        if (fp == nullptr) {
+            ErrorLog() << "Draw image failed cmd=\'" << cmd;
+            return -1;
+        }
+        fputs(markdown.c_str(), fp);
+        if (const int status = pclose(fp); status != 0) {
+            ErrorLog() << "Draw image failed status=" << status << " cmd=\'" << cmd;
+            return -1;
+        }
+        DebugLog() << "Draw image succeed cmd=\'" << cmd;
+        return 0;
+    }
+
+#else
+
+    int Fork_(const std::string& markdown, const std::string& path, const uint32_t width,
+            const std::chrono::steady_clock::time_point deadline)
+    {
+        // The markdown is written through a socket rather than a pipe, so MSG_NOSIGNAL prevents the bot being killed by
+        // SIGPIPE when the renderer exits early.
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0) {
+            ErrorLog() << "Create socket for renderer failed errno=" << errno;
+            return -1;
+        }
+        const std::string width_str = std::to_string(width);
+        const pid_t pid = fork();
+        if (pid < 0) {
+            ErrorLog() << "Fork renderer failed errno=" << errno;
+            close(fds[0]);
+            close(fds[1]);
+            return -1;
+        }
+        if (pid == 0) {
+            // Only async-signal-safe functions can be invoked here. The renderer leads a new process group, so the
+            // processes it starts are killed together when it times out.
+            setpgid(0, 0);
+            dup2(fds[1], STDIN_FILENO);
+            execl(options_.command_.c_str(), options_.command_.c_str(), "--output", path.c_str(), "--width",
+                    width_str.c_str(), "--nowith_css", "--noprint_info", nullptr);
+            _exit(127);
+        }
+        setpgid(pid, pid); // also set in the parent, so the group exists before it may be killed
+        close(fds[1]);
+        const bool sent = SendAll_(fds[0], markdown, deadline);
+        close(fds[0]);
+        int status = 0;
+        if (!sent || !Wait_(pid, status, deadline)) {
+            ErrorLog() << "Draw image timeout, kill the renderer pid=" << pid << " path=" << path;
+            kill(-pid, SIGKILL);
+            kill(pid, SIGKILL);
+            waitpid(pid, nullptr, 0);
+            return -1;
+        }
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            ErrorLog() << "Draw image failed status=" << status << " path=" << path;
+            return -1;
+        }
+        DebugLog() << "Draw image succeed path=" << path;
+        return 0;
+    }
+
+    static bool SendAll_(const int fd, const std::string& data, const std::chrono::steady_clock::time_point deadline)
+    {
+        for (size_t sent = 0; sent < data.size(); ) {
+            const auto remaining_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now()).count();
+            if (remaining_ms <= 0) {
+                return false;
+            }
+            pollfd pfd{.fd = fd, .events = POLLOUT, .revents = 0};
+            if (const int ret = poll(&pfd, 1, remaining_ms); ret < 0 && errno == EINTR) {
+                continue;
+            } else if (ret <= 0) {
+                return false;
+            }
+            const ssize_t ret = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (ret < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) {
+                continue;
+            }
+            if (ret < 0) {
+                // The renderer has exited without reading all the markdown, its exit status tells the reason.
+                return true;
+            }
+            sent += ret;
+        }
+        return true;
+    }
+
+    static bool Wait_(const pid_t pid, int& status, const std::chrono::steady_clock::time_point deadline)
+    {
+        // The renderer takes hundreds of milliseconds, so polling the exit status costs little.
+        for (auto now = std::chrono::steady_clock::now(); now < deadline; now = std::chrono::steady_clock::now()) {
+            if (const pid_t ret = waitpid(pid, &status, WNOHANG); ret == pid) {
+                return true;
+            } else if (ret < 0 && errno != EINTR) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+                        deadline - now, std::chrono::milliseconds(5)));
+        }
+        return false;
+    }
+
+#endif
+
+    const Options options_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    uint32_t running_num_ = 0;
+    uint32_t waiting_num_ = 0;
+};
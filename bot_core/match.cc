@@ -8,6 +8,7 @@
 
 #include <filesystem>
 #include <numeric>
+#include <random>
 #include <algorithm>
 #include <utility> // g++12 has a bug which will cause 'exchange' is not a member of 'std'
 #include <ranges>
@@ -22,6 +23,24 @@
 #include "bot_core/options.h"
 #include "nlohmann/json.hpp"
 
+static uint64_t MakeRandomSeed()
+{
+    std::random_device rd;
+    return (static_cast<uint64_t>(rd()) << 32) | rd();
+}
+
+LogLine& operator<<(LogLine& line, const MatchLogHeader& header)
+{
+    const Match& match = header.match_;
+    line << "[mid=" << match.MatchId() << "] ";
+    if (match.gid_.has_value()) {
+        line << "[gid=" << match.gid_->GetStr() << "] ";
+    } else {
+        line << "[no gid] ";
+    }
+    return line << "[game=" << match.GameName() << "] [host_uid=" << match.host_uid_.GetStr() << "] ";
+}
+
 Match::Match(BotCtx& bot, const MatchID mid, GameHandle& game_handle, GameHandle::Options options,
         const UserID host_uid, const std::optional<GroupID> gid)
         : bot_(bot)
@@ -30,6 +49,13 @@ Match::Match(BotCtx& bot, const MatchID mid, GameHandle& game_handle, GameHandle
         , host_uid_(host_uid)
         , gid_(gid)
         , state_(State::NOT_STARTED)
+        , random_seed_(MakeRandomSeed())
+        , request_latency_(GlobalMetrics().Histogram("lgtbot_match_request_latency_us",
+                    {{"game", game_handle.Info().module_name_}}))
+        , stage_request_latency_(GlobalMetrics().Histogram("lgtbot_stage_request_latency_us",
+                    {{"game", game_handle.Info().module_name_}}))
+        , record_match_latency_(GlobalMetrics().Histogram("lgtbot_db_record_match_latency_us",
+                    {{"game", game_handle.Info().name_}}))
         , options_{
             .game_options_ = std::move(options.game_options_),
             .generic_options_{
@@ -39,14 +65,16 @@ Match::Match(BotCtx& bot, const MatchID mid, GameHandle& game_handle, GameHandle
           }
         , main_stage_(nullptr, [](const lgtbot::game::MainStageBase*) {}) // make when game starts
         , users_()
-        , boardcast_private_sender_(MsgSenderBatchHandler(*this, false))
-        , boardcast_ai_info_private_sender_(MsgSenderBatchHandler(*this, true))
+        , boardcast_private_sender_(bot.MakeMsgSenderBatch(MsgSenderBatchHandler(*this, false), this))
+        , boardcast_ai_info_private_sender_(bot.MakeMsgSenderBatch(MsgSenderBatchHandler(*this, true), this))
         , group_sender_(gid.has_value() ? std::optional<MsgSender>(bot.MakeMsgSender(*gid_, this)) : std::nullopt)
+        , mailbox_(bot.match_executor() ? bot.match_executor()->MakeMailbox() : nullptr)
         , help_cmd_(Command<void(MsgSenderBase&)>("查看游戏帮助", std::bind_front(&Match::Help_, this), VoidChecker("帮助"), OptionalDefaultChecker<BoolChecker>(false, "文字", "图片")))
 #ifdef TEST_BOT
         , before_handle_timeout_(false)
 #endif
         , is_in_deduction_(false)
+        , is_deducing_(false)
 {
     EmplaceUser_(host_uid);
 }
@@ -82,9 +110,50 @@ Match::VariantID Match::ConvertPid(const PlayerID pid) const
     return players_[pid].id_;
 }
 
+std::optional<MatchJournalHeader> Match::JournalHeader_() const
+{
+    if (bot_.journal_path().empty()) {
+        return std::nullopt;
+    }
+    MatchJournalHeader header{
+        .module_name_ = game_handle_.Info().module_name_,
+        .random_seed_ = random_seed_,
+        .user_num_ = options_.generic_options_.user_num_,
+        .player_num_each_user_ = options_.generic_options_.player_num_each_user_,
+        .bench_computers_to_player_num_ = options_.generic_options_.bench_computers_to_player_num_,
+        .public_timer_alert_ = options_.generic_options_.public_timer_alert_,
+    };
+    for (const char* const* option = options_.game_options_->ShortInfo(); *option; ++option) {
+        header.game_options_.emplace_back(*option);
+    }
+    return header;
+}
+
+void Match::OpenJournal_(const MatchJournalHeader& header)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(bot_.journal_path(), ec);
+    const auto path = (std::filesystem::path(bot_.journal_path()) /
+        (std::to_string(std::chrono::system_clock::now().time_since_epoch().count()) + "_" +
+         std::to_string(mid_.Get()) + "_" + game_handle_.Info().module_name_ + ".journal")).string();
+    if (!(journal_ = MatchJournalWriter::Open(path, header, bot_.clock()))) {
+        ErrorLog() << LogHeader_() << "Open journal failed path=" << path;
+        return;
+    }
+    InfoLog() << LogHeader_() << "Open journal path=" << path << " random_seed=" << random_seed_;
+}
+
+// REQUIRE: should be protected by mutex_
+void Match::Journal_(MatchJournalRecord record)
+{
+    if (journal_) {
+        journal_->Write(std::move(record));
+    }
+}
+
 ErrCode Match::SetBenchTo(const UserID uid, MsgSenderBase& reply, const uint64_t bench_computers_to_player_num)
 {
-    std::lock_guard<std::mutex> l(mutex_);
+    const MatchLock l(mutex_);
     if (uid != host_uid_) {
         reply() << "[错误] 您并非房主，没有变更游戏设置的权限，房主是" << HostUserName_();
         return EC_MATCH_NOT_HOST;
@@ -106,7 +175,7 @@ ErrCode Match::SetBenchTo(const UserID uid, MsgSenderBase& reply, const uint64_t
 
 ErrCode Match::SetFormal(const UserID uid, MsgSenderBase& reply, const bool is_formal)
 {
-    std::lock_guard<std::mutex> l(mutex_);
+    const MatchLock l(mutex_);
     if (uid != host_uid_) {
         reply() << "[错误] 您并非房主，没有变更游戏设置的权限，房主是" << HostUserName_();
         return EC_MATCH_NOT_HOST;
@@ -141,14 +210,19 @@ static ErrCode ConverErrCode(const StageErrCode& stage_errcode)
 ErrCode Match::Request(const UserID uid, const std::optional<GroupID> gid, const std::string& msg,
                        MsgSender& reply)
 {
-    std::lock_guard<std::mutex> l(mutex_);
+    ScopedLatency latency(request_latency_);
+    TraceSpan span("Match::Request");
+    span.AddArg("mid", mid_.Get());
+    span.AddArg("game", game_handle_.Info().module_name_);
+    TraceSpan::SampleIfMatchTraced(mid_);
+    const MatchLock l(mutex_);
     const auto it = users_.find(uid);
     if (it == users_.end() || it->second.state_ == ParticipantUser::State::LEFT) {
         reply() << "[错误] 您未处于游戏中或已经离开";
         return EC_MATCH_USER_NOT_IN_MATCH;
     }
     if (state_ == State::IS_OVER) {
-        MatchLog(WarnLog()) << "Match is over but receive request uid=" << uid << " msg=" << msg;
+        WarnLog() << LogHeader_() << "Match is over but receive request uid=" << uid << " msg=" << msg;
         reply() << "[错误] 游戏已经结束";
         return EC_MATCH_ALREADY_OVER;
     }
@@ -164,7 +238,14 @@ ErrCode Match::Request(const UserID uid, const std::optional<GroupID> gid, const
             reply() << "[错误] 您已经被淘汰，无法执行游戏请求";
             return EC_MATCH_ELIMINATED;
         }
-        const auto stage_rc = main_stage_->HandleRequest(msg.c_str(), pid, gid.has_value(), reply);
+        Journal_(MatchJournalRecord{
+                .type_ = MatchJournalRecord::Type::REQUEST, .pid_ = pid, .is_public_ = gid.has_value(), .msg_ = msg});
+        const auto stage_rc = [&]
+            {
+                ScopedLatency stage_latency(stage_request_latency_);
+                TraceSpan stage_span("MainStage::HandleRequest");
+                return main_stage_->HandleRequest(msg.c_str(), pid, gid.has_value(), reply);
+            }();
         if (stage_rc == StageErrCode::NOT_FOUND) {
             reply() << "[错误] 未预料的游戏指令，您可以通过「帮助」（不带" META_COMMAND_SIGN "号）查看所有支持的游戏指令\n"
                         "若您想执行元指令，请尝试在请求前加「" META_COMMAND_SIGN "」，或通过「" META_COMMAND_SIGN "帮助」查看所有支持的元指令";
@@ -188,7 +269,7 @@ ErrCode Match::Request(const UserID uid, const std::optional<GroupID> gid, const
 
 ErrCode Match::GameStart(const UserID uid, MsgSenderBase& reply)
 {
-    std::lock_guard<std::mutex> l(mutex_);
+    const MatchLock l(mutex_);
     if (state_ != State::NOT_STARTED) {
         reply() << "[错误] 开始失败：游戏已经开始";
         return EC_MATCH_ALREADY_BEGIN;
@@ -225,10 +306,14 @@ ErrCode Match::GameStart(const UserID uid, MsgSenderBase& reply)
     options_.generic_options_.public_timer_alert_ = GET_OPTION_VALUE(*bot_.option().Lock(), 计时公开提示);
     options_.generic_options_.user_num_ = static_cast<uint32_t>(users_.size());
     assert(main_stage_ == nullptr);
+    const auto journal_header = JournalHeader_(); // the options should be recorded before being adapted by the game
     if (!(main_stage_ = game_handle_.MakeMainStage(reply, *options_.game_options_, options_.generic_options_, *this))) {
         reply() << "[错误] 开始失败：不符合游戏参数的预期";
         return EC_MATCH_UNEXPECTED_CONFIG;
     }
+    if (journal_header.has_value()) {
+        OpenJournal_(*journal_header);
+    }
     state_ = State::IS_STARTED;
     BoardcastAtAll() << "游戏开始，您可以使用「帮助」命令（不带" META_COMMAND_SIGN "号），查看可执行命令";
     BoardcastAiInfo() << nlohmann::json{
@@ -243,7 +328,7 @@ ErrCode Match::GameStart(const UserID uid, MsgSenderBase& reply)
 
 ErrCode Match::Join(const UserID uid, MsgSenderBase& reply)
 {
-    std::lock_guard<std::mutex> l(mutex_);
+    const MatchLock l(mutex_);
     if (state_ != State::NOT_STARTED) {
         reply() << "[错误] 加入失败：游戏已经开始";
         return EC_MATCH_ALREADY_BEGIN;
@@ -274,7 +359,7 @@ bool Match::AllControlledPlayerState_(const ParticipantUser& user, Fn&& fn) cons
 ErrCode Match::Leave(const UserID uid, MsgSenderBase& reply, const bool force)
 {
     ErrCode rc = EC_OK;
-    std::lock_guard<std::mutex> l(mutex_);
+    const MatchLock l(mutex_);
     const auto it = users_.find(uid);
     if (it == users_.end() || it->second.state_ == ParticipantUser::State::LEFT) {
         reply() << "[错误] 退出失败：您未处于游戏中或已经离开";
@@ -304,10 +389,13 @@ ErrCode Match::Leave(const UserID uid, MsgSenderBase& reply, const bool force)
         it->second.state_ = ParticipantUser::State::LEFT;
         if (std::ranges::all_of(users_, [](const auto& user) { return user.second.state_ == ParticipantUser::State::LEFT; })) {
             Boardcast() << "所有玩家都强制退出了游戏，那还玩啥玩，游戏解散，结果不会被记录";
-            MatchLog(InfoLog()) << "All users left the game";
+            InfoLog() << LogHeader_() << "All users left the game";
             Terminate_();
         } else {
+            // the left users may be the last ones who are not eliminated, then the computers play the rest
+            is_in_deduction_ = IsOnlyComputersActive_();
             for (const auto pid : it->second.pids_) {
+                Journal_(MatchJournalRecord{.type_ = MatchJournalRecord::Type::LEAVE, .pid_ = pid});
                 main_stage_->HandleLeave(pid);
                 Routine_();
             }
@@ -399,13 +487,13 @@ MsgSenderBase::MsgSenderGuard Match::BoardcastAtAll()
 bool Match::SwitchHost()
 {
     if (users_.empty()) {
-        MatchLog(InfoLog()) << "SwitchHost but no users left";
+        InfoLog() << LogHeader_() << "SwitchHost but no users left";
         return false;
     }
     if (state_ == NOT_STARTED) {
         host_uid_ = users_.begin()->first;
         Boardcast() << At(host_uid_) << "被选为新房主";
-        MatchLog(InfoLog()) << "SwitchHost succeed";
+        InfoLog() << LogHeader_() << "SwitchHost succeed";
     }
     return true;
 }
@@ -414,8 +502,8 @@ bool Match::SwitchHost()
 void Match::StartTimer(const uint64_t sec, void* p, void(*cb)(void*, uint64_t))
 {
     static const uint64_t kMinAlertSec = 10;
-    if (sec == 0) {
-        return;
+    if (sec == 0 || is_deducing_) {
+        return; // the deduction never waits for timeouts
     }
     StopTimer();
     timer_is_over_ = std::make_shared<bool>(false);
@@ -425,36 +513,49 @@ void Match::StartTimer(const uint64_t sec, void* p, void(*cb)(void*, uint64_t))
             // Handle a reference because match may be removed from match_manager if timeout cause game over.
             auto match = match_wk.lock();
             if (!match) {
-                MatchLog(WarnLog()) << "Timer timeout but match has been already released";
+                WarnLog() << "Timer timeout but match has been already released";
                 return; // match is released
             }
+            match->Execute([this, match, timer_is_over]
+                {
 #ifdef TEST_BOT
-            {
-                std::lock_guard<std::mutex> l(before_handle_timeout_mutex_);
-                before_handle_timeout_ = true;
-            }
-            before_handle_timeout_cv_.notify_all();
+                    {
+                        std::lock_guard<std::mutex> l(before_handle_timeout_mutex_);
+                        before_handle_timeout_ = true;
+                    }
+                    before_handle_timeout_cv_.notify_all();
 
 #endif
-            // Timeout event should not be triggered during request handling, so we need lock here.
-            // timer_is_over also should protected in lock. Otherwise, a rquest may be handled after checking timer_is_over and before timeout_timer lock match.
-            std::lock_guard<std::mutex> l(match->mutex_);
+                    TraceSpan span(match->bot_.tracer(), "Match::HandleTimeout");
+                    span.AddArg("mid", match->mid_.Get());
+                    span.AddArg("game", match->game_handle_.Info().module_name_);
+                    TraceSpan::SampleIfMatchTraced(match->mid_);
+                    // Timeout event should not be triggered during request handling, so we need lock here.
+                    // timer_is_over also should protected in lock. Otherwise, a rquest may be handled after checking timer_is_over and before timeout_timer lock match.
+                    const MatchLock l(match->mutex_);
 
 #ifdef TEST_BOT
-            {
-                std::lock_guard<std::mutex> l(before_handle_timeout_mutex_);
-                before_handle_timeout_ = false;
-            }
+                    {
+                        std::lock_guard<std::mutex> l(before_handle_timeout_mutex_);
+                        before_handle_timeout_ = false;
+                    }
 #endif
-            // If stage has been finished by other request, timeout event should not be triggered again, so we check stage_is_over_ here.
-            // Should NOT use this->timer_is_over_ here which may be belong to a new timer.
-            if (!*timer_is_over) {
-                MatchLog(DebugLog()) << "Timer timeout";
-                match->main_stage_->HandleTimeout();
-                match->Routine_();
-            } else {
-                MatchLog(WarnLog()) << "Timer timeout but timer has been already over";
-            }
+                    // If stage has been finished by other request, timeout event should not be triggered again, so we check stage_is_over_ here.
+                    // Should NOT use this->timer_is_over_ here which may be belong to a new timer.
+                    if (!*timer_is_over) {
+                        static MetricCounter& timeout_total = GlobalMetrics().Counter("lgtbot_match_timeout_total");
+                        timeout_total.Add();
+                        DebugLog() << LogHeader_() << "Timer timeout";
+                        {
+                            TraceSpan stage_span("MainStage::HandleTimeout");
+                            match->Journal_(MatchJournalRecord{.type_ = MatchJournalRecord::Type::TIMEOUT});
+                            match->main_stage_->HandleTimeout();
+                        }
+                        match->Routine_();
+                    } else {
+                        WarnLog() << LogHeader_() << "Timer timeout but timer has been already over";
+                    }
+                });
         };
     Timer::TaskSet tasks;
     if (kMinAlertSec > sec / 2) {
@@ -467,21 +568,24 @@ void Match::StartTimer(const uint64_t sec, void* p, void(*cb)(void*, uint64_t))
                     {
                         auto match = match_wk.lock();
                         if (!match) {
-                            match->MatchLog(WarnLog()) << "Timer alert but match is released sec=" << alert_sec;
+                            WarnLog() << "Timer alert but match is released sec=" << alert_sec;
                             return; // match is released
                         }
-                        std::lock_guard<std::mutex> l(match->mutex_);
-                        if (!*timer_is_over) {
-                            match->MatchLog(DebugLog()) << "Timer alert sec=" << alert_sec;
-                            cb(p, alert_sec);
-                        } else {
-                            match->MatchLog(WarnLog()) << "Timer alert but timer has been already over sec=" << alert_sec;
-                        }
+                        match->Execute([cb, p, alert_sec, timer_is_over, match]
+                            {
+                                const MatchLock l(match->mutex_);
+                                if (!*timer_is_over) {
+                                    DebugLog() << match->LogHeader_() << "Timer alert sec=" << alert_sec;
+                                    cb(p, alert_sec);
+                                } else {
+                                    WarnLog() << match->LogHeader_() << "Timer alert but timer has been already over sec=" << alert_sec;
+                                }
+                            });
                     });
         }
         tasks.emplace_front(sec - sum_alert_sec, [] {});
     }
-    timer_ = std::make_unique<Timer>(std::move(tasks)); // start timer
+    timer_ = std::make_unique<Timer>(bot_.timer_scheduler(), std::move(tasks)); // start timer
 }
 
 // This function can be invoked event if timer is not started.
@@ -489,10 +593,10 @@ void Match::StartTimer(const uint64_t sec, void* p, void(*cb)(void*, uint64_t))
 void Match::StopTimer()
 {
     if (timer_is_over_ != nullptr) {
-        MatchLog(DebugLog()) << "Timer stop";
+        DebugLog() << LogHeader_() << "Timer stop";
         *timer_is_over_ = true;
     } else {
-        MatchLog(WarnLog()) << "Timer stop but timer has been already over";
+        WarnLog() << LogHeader_() << "Timer stop but timer has been already over";
     }
     timer_ = nullptr; // stop timer
 }
@@ -502,9 +606,8 @@ void Match::Eliminate(const PlayerID pid)
     if (std::exchange(players_[pid].state_, Player::State::ELIMINATED) != Player::State::ELIMINATED) {
         // TODO: check all players of the user
         Tell(pid) << "很遗憾，您被淘汰了，可以通过「" META_COMMAND_SIGN "退出」以退出游戏";
-        is_in_deduction_ = std::ranges::all_of(players_,
-                [](const auto& p) { return std::get_if<ComputerID>(&p.id_) || p.state_ == Player::State::ELIMINATED; });
-        MatchLog(InfoLog()) << "Eliminate player pid=" << pid << " is_in_deduction=" << Bool2Str(is_in_deduction_);
+        is_in_deduction_ = IsOnlyComputersActive_();
+        InfoLog() << LogHeader_() << "Eliminate player pid=" << pid << " is_in_deduction=" << Bool2Str(is_in_deduction_);
     }
 }
 
@@ -531,7 +634,7 @@ void Match::Activate(const PlayerID pid)
 void Match::ShowInfo(MsgSenderBase& reply) const
 {
     reply.SetMatch(this);
-    std::lock_guard<std::mutex> l(mutex_);
+    const MatchLock l(mutex_);
     auto sender = reply();
     sender << "游戏名称：" << game_handle().Info().name_ << "\n";
     sender << "配置信息：" << OptionInfo_() << "\n";
@@ -568,7 +671,7 @@ void Match::ShowInfo(MsgSenderBase& reply) const
 
 std::string Match::BriefInfo() const
 {
-    std::lock_guard l(mutex_);
+    const MatchLock l(mutex_);
     return BriefInfo_();
 }
 
@@ -598,7 +701,7 @@ std::string Match::OptionInfo_() const
 void Match::OnGameOver_()
 {
     if (state_ == State::IS_OVER) {
-        MatchLog(WarnLog()) << "OnGameOver_ but has already been over";
+        WarnLog() << LogHeader_() << "OnGameOver_ but has already been over";
         return;
     }
     std::vector<std::pair<UserID, int64_t>> user_game_scores;
@@ -615,7 +718,7 @@ void Match::OnGameOver_()
                 const char* const* const achievements = main_stage_->VerdictateAchievements(pid);
                 for (const char* const* achievement_name_p = achievements; *achievement_name_p; ++achievement_name_p) {
                     user_achievements.emplace_back(*pval, *achievement_name_p);
-                    MatchLog(InfoLog()) << "User get achievement uid=" << *pval << " achievement=" << *achievement_name_p;
+                    InfoLog() << LogHeader_() << "User get achievement uid=" << *pval << " achievement=" << *achievement_name_p;
                 }
             }
         }
@@ -640,12 +743,15 @@ void Match::OnGameOver_()
             sender << "\n\n游戏结果不记录：因为未连接数据库";
         } else if (const auto multiple = Multiple_(); !options_.generic_options_.is_formal_ || multiple == 0) {
             sender << "\n\n游戏结果不记录：因为该游戏为非正式游戏";
-        } else if (const auto score_info =
-                    bot_.db_manager()->RecordMatch(game_handle_.Info().name_, gid_, host_uid_,
-                        multiple, user_game_scores, user_achievements);
+        } else if (const auto score_info = [&]
+                    {
+                        ScopedLatency latency(record_match_latency_);
+                        return bot_.db_manager()->RecordMatch(game_handle_.Info().name_, gid_, host_uid_,
+                                multiple, user_game_scores, user_achievements);
+                    }();
                 score_info.empty()) {
             sender << "\n\n[错误] 游戏结果写入数据库失败，请联系管理员";
-            MatchLog(ErrorLog()) << "Save database failed";
+            ErrorLog() << LogHeader_() << "Save database failed";
         } else {
             assert(score_info.size() == users_.size());
             sender << "\n\n游戏结果写入数据库成功：";
@@ -666,7 +772,7 @@ void Match::OnGameOver_()
     }
     state_ = State::IS_OVER; // is necessary because other thread may own a match reference
     game_handle_.IncreaseActivity(users_.size());
-    MatchLog(InfoLog()) << "Match is over normally";
+    InfoLog() << LogHeader_() << "Match is over normally";
     Terminate_();
 }
 
@@ -696,16 +802,25 @@ void Match::Help_(MsgSenderBase& reply, const bool text_mode)
 
 void Match::Routine_()
 {
+    TraceSpan span("Match::Routine");
     if (main_stage_->IsOver()) {
         OnGameOver_();
         return;
     }
     const uint64_t user_controlled_num = users_.size() * options_.generic_options_.player_num_each_user_;
     const uint64_t computer_num = players_.size() - user_controlled_num;
+    if (is_in_deduction_ && computer_num > 0) {
+        Deduce_();
+        return;
+    }
     uint64_t ok_count = 0;
-    for (uint64_t i = 0; !main_stage_->IsOver() && ok_count < computer_num; i = (i + 1) % computer_num) {
+    for (uint64_t i = 0; !main_stage_->IsOver() && !is_in_deduction_ && ok_count < computer_num; i = (i + 1) % computer_num) {
         const auto pid = user_controlled_num + i;
-        if (players_[pid].state_ == Player::State::ELIMINATED || StageErrCode::OK == main_stage_->HandleComputerAct(pid, false)) {
+        const bool is_eliminated = players_[pid].state_ == Player::State::ELIMINATED;
+        if (!is_eliminated) {
+            Journal_(MatchJournalRecord{.type_ = MatchJournalRecord::Type::COMPUTER_ACT, .pid_ = PlayerID(pid)});
+        }
+        if (is_eliminated || StageErrCode::OK == main_stage_->HandleComputerAct(pid, false)) {
             ++ok_count;
         } else {
             ok_count = 0;
@@ -713,12 +828,98 @@ void Match::Routine_()
     }
     if (main_stage_->IsOver()) {
         OnGameOver_();
+    } else if (is_in_deduction_ && computer_num > 0) {
+        Deduce_(); // the last user is eliminated by computers
+    }
+}
+
+// Return true if each player is a computer, is eliminated, or is controlled by a user who has left.
+// REQUIRE: should be protected by mutex_
+bool Match::IsOnlyComputersActive_() const
+{
+    return std::ranges::all_of(players_, [this](const Player& player)
+            {
+                const auto* const uid = std::get_if<UserID>(&player.id_);
+                return !uid || player.state_ == Player::State::ELIMINATED ||
+                    users_.at(*uid).state_ == ParticipantUser::State::LEFT;
+            });
+}
+
+// REQUIRE: should be protected by mutex_
+void Match::Deduce_()
+{
+    if (std::exchange(is_deducing_, true)) {
+        return; // the deduction has already begun
+    }
+    if (timer_) {
+        StopTimer();
+    }
+    if (const auto budget = bot_.deduction_budget(); budget.count() > 0) {
+        deduction_deadline_ = std::chrono::steady_clock::now() + budget;
+    }
+    InfoLog() << LogHeader_() << "Deduction begins budget_sec=" << bot_.deduction_budget().count()
+              << " in_background=" << Bool2Str(bot_.deduction_executor() != nullptr);
+    Boardcast() << "所有玩家都已被淘汰或退出，游戏将由电脑推演至终局";
+    if (const auto executor = bot_.deduction_executor()) {
+        executor->Submit([match_wk = weak_from_this()]()
+                {
+                    const auto match = match_wk.lock();
+                    if (!match) {
+                        WarnLog() << "Deduction step but match has been already released";
+                        return false;
+                    }
+                    const MatchLock l(match->mutex_);
+                    return match->DeduceStep_();
+                });
+    } else {
+        while (DeduceStep_())
+            ;
     }
 }
 
+// Let each computer act once. If all computers have nothing to do, time out the stage instead of waiting for the timer.
+// Return true if the deduction should continue.
+// REQUIRE: should be protected by mutex_
+bool Match::DeduceStep_()
+{
+    static MetricCounter& deduction_over_total = GlobalMetrics().Counter("lgtbot_deduction_total", {{"result", "over"}});
+    static MetricCounter& deduction_timeout_total = GlobalMetrics().Counter("lgtbot_deduction_total", {{"result", "timeout"}});
+    if (state_ != State::IS_STARTED) {
+        return false; // the match has been terminated
+    }
+    if (deduction_deadline_.has_value() && std::chrono::steady_clock::now() > *deduction_deadline_) {
+        WarnLog() << LogHeader_() << "Deduction exceeds the budget budget_sec=" << bot_.deduction_budget().count();
+        deduction_timeout_total.Add();
+        Boardcast() << "推演超时，游戏已中止，结果不会被记录";
+        Terminate_();
+        return false;
+    }
+    TraceSpan span("Match::DeduceStep");
+    const uint64_t user_controlled_num = users_.size() * options_.generic_options_.player_num_each_user_;
+    bool is_waiting_timeout = true; // all computers return OK, like the loop in `Routine_`
+    for (uint64_t pid = user_controlled_num; pid < players_.size() && !main_stage_->IsOver(); ++pid) {
+        if (players_[pid].state_ != Player::State::ELIMINATED) {
+            Journal_(MatchJournalRecord{.type_ = MatchJournalRecord::Type::COMPUTER_ACT, .pid_ = PlayerID(pid)});
+            if (StageErrCode::OK != main_stage_->HandleComputerAct(pid, false)) {
+                is_waiting_timeout = false;
+            }
+        }
+    }
+    if (is_waiting_timeout && !main_stage_->IsOver()) {
+        Journal_(MatchJournalRecord{.type_ = MatchJournalRecord::Type::TIMEOUT});
+        main_stage_->HandleTimeout();
+    }
+    if (main_stage_->IsOver()) {
+        deduction_over_total.Add();
+        OnGameOver_();
+        return false;
+    }
+    return true;
+}
+
 ErrCode Match::UserInterrupt(const UserID uid, MsgSenderBase& reply, const bool cancel)
 {
-    const std::lock_guard<std::mutex> l(mutex_);
+    const MatchLock l(mutex_);
     const auto it = users_.find(uid);
     if (it == users_.end() && it->second.state_ == ParticipantUser::State::LEFT) {
         reply() << "[错误] 中断失败：您未处于游戏中或已经离开";
@@ -736,7 +937,7 @@ ErrCode Match::UserInterrupt(const UserID uid, MsgSenderBase& reply, const bool
     reply() << "中断成功";
     if (remain == 0) {
         BoardcastAtAll() << "全员支持中断游戏，游戏已中断，谢谢大家参与";
-        MatchLog(InfoLog()) << "Match is interrupted by users";
+        InfoLog() << LogHeader_() << "Match is interrupted by users";
         Terminate_();
     } else {
         Boardcast() << "有玩家" << (cancel ? "取消" : "确定") << "中断游戏，目前 " << remain << " 人尚未确定中止，所有玩家可通过「" META_COMMAND_SIGN "中断」命令确定中断游戏，或「" META_COMMAND_SIGN "中断 取消」命令取消中断游戏";
@@ -747,10 +948,10 @@ ErrCode Match::UserInterrupt(const UserID uid, MsgSenderBase& reply, const bool
 
 ErrCode Match::Terminate(const bool is_force)
 {
-    const std::lock_guard<std::mutex> l(mutex_);
+    const MatchLock l(mutex_);
     if (is_force || state_ == State::NOT_STARTED) {
         BoardcastAtAll() << "游戏已解散，谢谢大家参与";
-        MatchLog(InfoLog()) << "Match is terminated outside";
+        InfoLog() << LogHeader_() << "Match is terminated outside";
         Terminate_();
         return EC_OK;
     } else {
@@ -14,6 +14,9 @@
 #include "utility/msg_checker.h"
 
 #include "bot_core/match_base.h"
+#include "bot_core/match_executor.h"
+#include "bot_core/match_journal.h"
+#include "bot_core/metrics.h"
 #include "bot_core/msg_sender.h"
 #include "bot_core/timer.h"
 #include "bot_core/game_handle.h"
@@ -33,6 +36,15 @@ class GroupMatch;
 class DiscussMatch;
 class MatchManager;
 
+// The header of the logs of a match. Its fields are streamed as separate arguments, so they are formatted by the
+// writer thread instead of the thread which may hold the match lock.
+struct MatchLogHeader
+{
+    const Match& match_;
+};
+
+LogLine& operator<<(LogLine& line, const MatchLogHeader& header);
+
 template <typename ...Ts>
 class Overload : public Ts...
 {
@@ -43,6 +55,8 @@ class Overload : public Ts...
 
 class Match : public MatchBase, public std::enable_shared_from_this<Match>
 {
+    friend LogLine& operator<<(LogLine& line, const MatchLogHeader& header);
+
   public:
     using VariantID = std::variant<UserID, ComputerID>;
     enum State { NOT_STARTED = 'N', IS_STARTED = 'S', IS_OVER = 'O' };
@@ -62,6 +76,10 @@ class Match : public MatchBase, public std::enable_shared_from_this<Match>
 
     virtual void StartTimer(const uint64_t sec, void* p, void(*cb)(void*, uint64_t)) override;
     virtual void StopTimer() override;
+    virtual int64_t NowNs() const override
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(bot_.clock().Now().time_since_epoch()).count();
+    }
 
     virtual void Eliminate(const PlayerID pid) override;
     virtual void Hook(const PlayerID pid) override;
@@ -70,6 +88,7 @@ class Match : public MatchBase, public std::enable_shared_from_this<Match>
     virtual bool IsInDeduction() const override { return is_in_deduction_; }
     virtual uint64_t MatchId() const override { return mid_; }
     virtual const char* GameName() const override { return game_handle_.Info().name_.c_str(); }
+    virtual uint64_t RandomSeed() const override { return random_seed_; }
 
     ErrCode SetBenchTo(const UserID uid, MsgSenderBase& reply, const uint64_t bench_computers_to_player_num);
     ErrCode SetFormal(const UserID uid, MsgSenderBase& reply, const bool is_formal);
@@ -97,6 +116,18 @@ class Match : public MatchBase, public std::enable_shared_from_this<Match>
 
     ErrCode Terminate(const bool is_force);
 
+    // Run |task| in the mailbox of the match if the bot has a match executor. Otherwise, run it in the current thread.
+    void Execute(std::function<void()> task)
+    {
+        if (mailbox_) {
+            mailbox_->Post(std::move(task));
+        } else {
+            task();
+        }
+    }
+
+    const std::shared_ptr<Mailbox>& mailbox() const { return mailbox_; }
+
     const GameHandle& game_handle() const { return game_handle_; }
     std::optional<GroupID> gid() const { return gid_; }
     UserID HostUserId() const { return std::lock_guard(mutex_), host_uid_; }
@@ -126,27 +157,29 @@ class Match : public MatchBase, public std::enable_shared_from_this<Match>
         bool want_interrupt_;
     };
 
+    // Hold the lock of the match. Flushing messages never blocks for a full outbound queue while the lock is held, the
+    // thread waits for the queue after the lock is released.
+    struct MatchLock
+    {
+        explicit MatchLock(std::mutex& mutex) : l_(mutex) {}
+
+        OutboundPipeline::NonBlockingScope non_blocking_; // should be released after the lock
+        std::lock_guard<std::mutex> l_;
+    };
+
     uint32_t MaxPlayerNum_() const { return game_handle_.Info().max_player_num_fn_(options_.game_options_.get()); }
     uint32_t Multiple_() const { return game_handle_.Info().multiple_fn_(options_.game_options_.get()); }
 
-    template <typename Logger>
-    Logger& MatchLog(Logger&& logger) const
-    {
-        logger << "[mid=" << MatchId() << "] ";
-        if (gid_.has_value()) {
-            logger << "[gid=" << *gid_ << "] ";
-        } else {
-            logger << "[no gid] ";
-        }
-        logger << "[game=" << GameName() << "] [host_uid=" << host_uid_ << "] ";
-        return logger;
-    }
+    MatchLogHeader LogHeader_() const { return MatchLogHeader{*this}; }
 
     const uint32_t user_controlled_player_num() const { return users_.size() * options_.generic_options_.player_num_each_user_; }
     std::string BriefInfo_() const;
     void OnGameOver_();
     void Help_(MsgSenderBase& reply, const bool text_mode);
     void Routine_();
+    bool IsOnlyComputersActive_() const;
+    void Deduce_();
+    bool DeduceStep_();
     std::string OptionInfo_() const;
     void KickForConfigChange_();
     void Unbind_();
@@ -157,6 +190,9 @@ class Match : public MatchBase, public std::enable_shared_from_this<Match>
     std::string HostUserName_() const;
     uint32_t ComputerNum_() const;
     void EmplaceUser_(const UserID uid);
+    std::optional<MatchJournalHeader> JournalHeader_() const;
+    void OpenJournal_(const MatchJournalHeader& header);
+    void Journal_(MatchJournalRecord record);
 
     mutable std::mutex mutex_;
 
@@ -169,6 +205,12 @@ class Match : public MatchBase, public std::enable_shared_from_this<Match>
     UserID host_uid_;
     const std::optional<GroupID> gid_;
     std::atomic<State> state_;
+    const uint64_t random_seed_;
+
+    // metrics
+    MetricHistogram& request_latency_;
+    MetricHistogram& stage_request_latency_;
+    MetricHistogram& record_match_latency_;
 
     // time info
     std::shared_ptr<bool> timer_is_over_; // must before match because atom stage will call StopTimer
@@ -191,6 +233,7 @@ class Match : public MatchBase, public std::enable_shared_from_this<Match>
 
     // game
     GameHandle::main_stage_ptr main_stage_;
+    std::unique_ptr<MatchJournalWriter> journal_; // be NULL if journals are not recorded
 
     // user info
     std::map<UserID, ParticipantUser> users_;
@@ -202,11 +245,11 @@ class Match : public MatchBase, public std::enable_shared_from_this<Match>
         MsgSenderBatchHandler(Match& match, const bool ai_only) : match_(match), ai_only_(ai_only) {};
 
         template <typename Fn>
-        void operator()(Fn&& fn)
+        void operator()(Fn&& fn) const
         {
-            for (auto& [_, user_info] : match_.users_) {
+            for (const auto& [uid, user_info] : match_.users_) {
                 if (user_info.state_ != ParticipantUser::State::LEFT && (!ai_only_ || user_info.is_ai_)) {
-                    fn(user_info.sender_);
+                    fn(uid);
                 }
             }
         }
@@ -219,6 +262,8 @@ class Match : public MatchBase, public std::enable_shared_from_this<Match>
     MsgSenderBatch<MsgSenderBatchHandler> boardcast_ai_info_private_sender_;
     std::optional<MsgSender> group_sender_;
 
+    const std::shared_ptr<Mailbox> mailbox_; // be NULL if the bot has no match executor
+
     // player info (fill when game ready to start)
     struct Player
     {
@@ -239,4 +284,8 @@ class Match : public MatchBase, public std::enable_shared_from_this<Match>
 #endif
 
     bool is_in_deduction_;
+
+    // fast-forward info (fill when deduction begins)
+    bool is_deducing_;
+    std::optional<std::chrono::steady_clock::time_point> deduction_deadline_; // be nullopt if there is no limit
 };
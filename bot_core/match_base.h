@@ -9,6 +9,10 @@
 class MsgSenderBase;
 
 // Cross-module class interface for game level.
+//
+// Game modules are built separately from the bot, so the interfaces shared with them (this class, MsgSenderBase and
+// GameInfo) only grow at the end: a new virtual function or field is declared after all the existing ones, and the
+// modules built before keep working without being rebuilt.
 class MatchBase
 {
   public:
@@ -38,4 +42,6 @@ class MatchBase
     virtual bool IsInDeduction() const = 0;
     virtual uint64_t MatchId() const = 0;
     virtual const char* GameName() const = 0;
+    virtual uint64_t RandomSeed() const = 0; // the seed of random numbers used by the game, so the match can be replayed
+    virtual int64_t NowNs() const = 0; // the time in nanoseconds of the clock of timers, which may be simulated
 };
@@ -0,0 +1,251 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+#include "bot_core/match_executor.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "utility/defer.h"
+#include "utility/log.h"
+
+// The pool which the current thread belongs to, and the index of its queue.
+static thread_local const WorkStealingPool* current_pool = nullptr;
+static thread_local uint32_t current_queue_index = 0;
+
+std::shared_ptr<WorkStealingPool> WorkStealingPool::Make(const uint32_t thread_num)
+{
+    return std::shared_ptr<WorkStealingPool>(new WorkStealingPool(thread_num), [](WorkStealingPool* const pool)
+            {
+                if (current_pool == pool) {
+                    // The pool thread goes on running after the task returns, so it is joined by another thread.
+                    std::thread([pool] { delete pool; }).detach();
+                } else {
+                    delete pool;
+                }
+            });
+}
+
+// At least one thread is started, otherwise the submitted tasks are never run.
+WorkStealingPool::WorkStealingPool(const uint32_t thread_num)
+    : queues_(new Queue[std::max<uint32_t>(thread_num, 1)]), queue_num_(std::max<uint32_t>(thread_num, 1))
+{
+    for (uint32_t i = 0; i < queue_num_; ++i) {
+        threads_.emplace_back([this, i] { WorkerLoop_(i); });
+    }
+}
+
+void WorkStealingPool::Submit(Task task)
+{
+    if (current_pool == this) {
+        // Tasks submitted by the pool threads are still queued after stopping, they are run before the thread exits.
+        Push_(current_queue_index, std::move(task));
+        return;
+    }
+    ++submitting_num_;
+    if (stop_) {
+        --submitting_num_;
+        task();
+        return;
+    }
+    Push_(next_queue_++ % queue_num_, std::move(task));
+    --submitting_num_;
+}
+
+void WorkStealingPool::Push_(const uint32_t index, Task task)
+{
+    {
+        std::lock_guard<std::mutex> l(queues_[index].mutex_);
+        queues_[index].tasks_.emplace_back(std::move(task));
+        ++queues_[index].size_;
+    }
+    // An idle thread counts itself before checking the queues, so either it sees the task or we see it.
+    if (idle_num_ > 0) {
+        std::lock_guard<std::mutex> l(idle_mutex_);
+        idle_cv_.notify_one();
+    }
+}
+
+void WorkStealingPool::Stop()
+{
+    assert(current_pool != this); // the pool cannot join its own threads
+    if (stop_.exchange(true)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> l(idle_mutex_);
+        idle_cv_.notify_all();
+    }
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+    // Run the tasks pushed by the submitters which did not see the pool stopping.
+    while (submitting_num_ > 0) {
+        std::this_thread::yield();
+    }
+    for (Task task; TrySteal_(queue_num_ - 1, task) || TryPop_(queue_num_ - 1, task); ) {
+        task();
+    }
+}
+
+void WorkStealingPool::WorkerLoop_(const uint32_t index)
+{
+    current_pool = this;
+    current_queue_index = index;
+    while (true) {
+        if (Task task; TryPop_(index, task) || TrySteal_(index, task)) {
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> l(idle_mutex_);
+        ++idle_num_;
+        idle_cv_.wait(l, [this] { return stop_ || HasPending_(); });
+        --idle_num_;
+        if (stop_ && !HasPending_()) {
+            return; // we stop only when all tasks are run
+        }
+    }
+}
+
+bool WorkStealingPool::HasPending_() const
+{
+    for (uint32_t i = 0; i < queue_num_; ++i) {
+        if (queues_[i].size_ > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool WorkStealingPool::TryPop_(const uint32_t index, Task& task)
+{
+    auto& queue = queues_[index];
+    if (queue.size_ == 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> l(queue.mutex_);
+    if (queue.tasks_.empty()) {
+        return false;
+    }
+    task = std::move(queue.tasks_.front());
+    queue.tasks_.pop_front();
+    --queue.size_;
+    return true;
+}
+
+bool WorkStealingPool::TrySteal_(const uint32_t index, Task& task)
+{
+    for (uint32_t i = 1; i < queue_num_; ++i) {
+        auto& queue = queues_[(index + i) % queue_num_];
+        if (queue.size_ == 0) {
+            continue;
+        }
+        std::lock_guard<std::mutex> l(queue.mutex_);
+        if (!queue.tasks_.empty()) {
+            // Steal from the back, which is the task least likely to be cache-hot for the owner.
+            task = std::move(queue.tasks_.back());
+            queue.tasks_.pop_back();
+            --queue.size_;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Mailbox::Post(WorkStealingPool::Task task)
+{
+    {
+        std::lock_guard<std::mutex> l(mutex_);
+        tasks_.emplace_back(std::move(task));
+        if (is_scheduled_) {
+            return;
+        }
+        is_scheduled_ = true;
+    }
+    pool_->Submit([self = shared_from_this()] { self->Drain_(); });
+}
+
+void Mailbox::Drain_()
+{
+    for (uint32_t i = 0; i < k_batch_size; ++i) {
+        WorkStealingPool::Task task;
+        {
+            std::lock_guard<std::mutex> l(mutex_);
+            if (tasks_.empty()) {
+                is_scheduled_ = false;
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+    // Submit again instead of looping so that a busy mailbox does not starve others.
+    pool_->Submit([self = shared_from_this()] { self->Drain_(); });
+}
+
+MatchExecutor::MatchExecutor(const uint32_t thread_num) : pool_(WorkStealingPool::Make(thread_num))
+{
+    for (auto& mailbox : user_mailboxes_) {
+        mailbox = MakeMailbox();
+    }
+    InfoLog() << "Match executor started thread_num=" << thread_num;
+}
+
+void MatchExecutor::RouteUserTask(const UserID& uid, std::shared_ptr<Mailbox> match_mailbox,
+        WorkStealingPool::Task task)
+{
+    auto& user_routes = user_routes_[UserMailboxIndex_(uid)];
+    {
+        std::lock_guard<std::mutex> l(user_routes.mutex_);
+        if (const auto it = user_routes.routes_.find(uid); it != user_routes.routes_.end()) {
+            match_mailbox = it->second.mailbox_; // follow the former tasks
+            ++it->second.pending_num_;
+        } else if (match_mailbox) {
+            user_routes.routes_.emplace(uid, Route{.mailbox_ = match_mailbox, .pending_num_ = 1});
+        }
+    }
+    if (!match_mailbox) {
+        task();
+        return;
+    }
+    match_mailbox->Post([&user_routes, uid, task = std::move(task)]
+            {
+                // The route is released even if the task throws, otherwise later tasks of the user follow it forever.
+                const Defer defer([&]
+                        {
+                            std::lock_guard<std::mutex> l(user_routes.mutex_);
+                            if (const auto it = user_routes.routes_.find(uid); --it->second.pending_num_ == 0) {
+                                user_routes.routes_.erase(it);
+                            }
+                        });
+                task();
+            });
+}
+
+DeductionExecutor::DeductionExecutor(const uint32_t thread_num) : pool_(WorkStealingPool::Make(thread_num))
+{
+    InfoLog() << "Deduction executor started thread_num=" << thread_num;
+}
+
+void DeductionExecutor::Submit(Step step)
+{
+    pool_->Submit([this, step = std::move(step)]() mutable { RunStep_(std::move(step)); });
+}
+
+void DeductionExecutor::Stop()
+{
+    is_stopped_ = true;
+    pool_->Stop();
+}
+
+void DeductionExecutor::RunStep_(Step step)
+{
+    if (is_stopped_) {
+        return;
+    }
+    if (step()) {
+        Submit(std::move(step)); // to the back of the queue of the current thread
+    }
+}
@@ -0,0 +1,176 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "bot_core/id.h"
+
+// A thread pool where each thread has its own task queue. Tasks submitted by a pool thread are pushed to its own queue,
+// and an idle thread steals tasks from the queues of others. Each queue is guarded by its own lock, the shared lock is
+// only taken by the threads which have nothing to do and by the submitters which wake them up.
+//
+// The pool is shared by the tasks (e.g. by mailboxes), so the last reference may be released by one of its tasks. The
+// pool created by `Make` is released in a new thread in that case, because a pool cannot join its own threads.
+class WorkStealingPool
+{
+  public:
+    using Task = std::function<void()>;
+
+    static std::shared_ptr<WorkStealingPool> Make(const uint32_t thread_num);
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool(WorkStealingPool&&) = delete;
+
+    ~WorkStealingPool() { Stop(); }
+
+    void Submit(Task task);
+
+    // Run all submitted tasks and join the threads. Tasks submitted by other threads after stopping are run in the
+    // submitting thread. It should not be invoked by the tasks of the pool.
+    void Stop();
+
+  private:
+    struct alignas(64) Queue
+    {
+        std::mutex mutex_;
+        std::deque<Task> tasks_;
+        std::atomic<size_t> size_{0}; // the size of |tasks_|, which is read without locking |mutex_|
+    };
+
+    explicit WorkStealingPool(const uint32_t thread_num);
+
+    void WorkerLoop_(const uint32_t index);
+
+    void Push_(const uint32_t index, Task task);
+
+    bool TryPop_(const uint32_t index, Task& task);
+
+    bool TrySteal_(const uint32_t index, Task& task);
+
+    bool HasPending_() const;
+
+    std::unique_ptr<Queue[]> queues_;
+    const uint32_t queue_num_;
+    std::atomic<uint32_t> next_queue_{0};
+    std::atomic<bool> stop_{false};
+    std::atomic<uint32_t> submitting_num_{0}; // the number of threads which are not pool threads pushing tasks
+
+    // The idle threads wait for tasks here.
+    std::mutex idle_mutex_;
+    std::condition_variable idle_cv_;
+    std::atomic<uint32_t> idle_num_{0};
+
+    std::vector<std::thread> threads_;
+};
+
+// A mailbox runs its tasks one by one in the order they are posted, on the threads of a `WorkStealingPool`. Different
+// mailboxes run in parallel.
+class Mailbox : public std::enable_shared_from_this<Mailbox>
+{
+  public:
+    static std::shared_ptr<Mailbox> Make(std::shared_ptr<WorkStealingPool> pool)
+    {
+        return std::shared_ptr<Mailbox>(new Mailbox(std::move(pool)));
+    }
+
+    void Post(WorkStealingPool::Task task);
+
+  private:
+    // The number of tasks run before yielding the thread to other mailboxes.
+    static constexpr const uint32_t k_batch_size = 16;
+
+    Mailbox(std::shared_ptr<WorkStealingPool> pool) : pool_(std::move(pool)) {}
+
+    void Drain_();
+
+    const std::shared_ptr<WorkStealingPool> pool_;
+    std::mutex mutex_;
+    std::deque<WorkStealingPool::Task> tasks_;
+    bool is_scheduled_ = false; // a drain task is submitted or running
+};
+
+// The executor which runs the requests, timeouts and computer acts of each match in the mailbox of the match, so that
+// a match is never handled by two threads at the same time.
+//
+// A request is first posted to the mailbox of its user, which routes the request to the mailbox of the match by
+// `RouteUserTask`, or handles it directly if the user is not in any match. So the requests of the same user keep their
+// order even if the user joins or leaves a match.
+class MatchExecutor
+{
+  public:
+    explicit MatchExecutor(const uint32_t thread_num);
+
+    std::shared_ptr<Mailbox> MakeMailbox() { return Mailbox::Make(pool_); }
+
+    Mailbox& UserMailbox(const UserID& uid) { return *user_mailboxes_[UserMailboxIndex_(uid)]; }
+
+    // Run |task| of the user in |match_mailbox|, or in the current thread if |match_mailbox| is NULL. If former tasks of
+    // the user are still waiting in the mailbox of a match, |task| is posted to that mailbox after them instead, so a
+    // task never overtakes the former tasks of the same user. It should be invoked in the mailbox of the user.
+    void RouteUserTask(const UserID& uid, std::shared_ptr<Mailbox> match_mailbox, WorkStealingPool::Task task);
+
+    void Stop() { pool_->Stop(); }
+
+  private:
+    static constexpr const uint32_t k_user_mailbox_num = 64;
+
+    // The mailbox of the match which the unfinished tasks of a user are posted to.
+    struct Route
+    {
+        std::shared_ptr<Mailbox> mailbox_;
+        uint32_t pending_num_;
+    };
+
+    struct UserRoutes
+    {
+        std::mutex mutex_;
+        std::unordered_map<UserID, Route> routes_;
+    };
+
+    static uint32_t UserMailboxIndex_(const UserID& uid) { return std::hash<UserID>{}(uid) % k_user_mailbox_num; }
+
+    const std::shared_ptr<WorkStealingPool> pool_;
+    std::array<std::shared_ptr<Mailbox>, k_user_mailbox_num> user_mailboxes_;
+    std::array<UserRoutes, k_user_mailbox_num> user_routes_; // the users of each mailbox
+};
+
+// The executor which fast-forwards the matches where only computers are left. The deduction of a match is divided into
+// steps. The next step is submitted after the previous one returns, so that the match is not locked between steps and
+// the steps of different matches run in turn.
+class DeductionExecutor
+{
+  public:
+    // Return true if there are more steps to run.
+    using Step = std::function<bool()>;
+
+    explicit DeductionExecutor(const uint32_t thread_num);
+
+    DeductionExecutor(const DeductionExecutor&) = delete;
+    DeductionExecutor(DeductionExecutor&&) = delete;
+
+    ~DeductionExecutor() { Stop(); }
+
+    // Run |step| repeatedly until it returns false.
+    void Submit(Step step);
+
+    // Join the threads. The steps of unfinished deductions are not run any more.
+    void Stop();
+
+  private:
+    void RunStep_(Step step);
+
+    const std::shared_ptr<WorkStealingPool> pool_;
+    std::atomic<bool> is_stopped_{false};
+};
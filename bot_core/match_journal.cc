@@ -0,0 +1,214 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+#include "bot_core/match_journal.h"
+
+#include <sstream>
+
+static constexpr const std::string_view k_magic = "LGTJ";
+static constexpr const uint64_t k_version = 1;
+
+static void AppendVarint(std::string& buffer, uint64_t value)
+{
+    while (value >= 0x80) {
+        buffer += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    buffer += static_cast<char>(value);
+}
+
+static void AppendString(std::string& buffer, const std::string_view str)
+{
+    AppendVarint(buffer, str.size());
+    buffer.append(str);
+}
+
+static std::optional<uint64_t> ReadVarint(std::string_view& remain)
+{
+    uint64_t value = 0;
+    for (uint32_t shift = 0; shift < 64 && !remain.empty(); shift += 7) {
+        const auto byte = static_cast<uint8_t>(remain.front());
+        remain.remove_prefix(1);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return value;
+        }
+    }
+    return std::nullopt;
+}
+
+static std::optional<std::string> ReadString(std::string_view& remain)
+{
+    const auto size = ReadVarint(remain);
+    if (!size.has_value() || *size > remain.size()) {
+        return std::nullopt;
+    }
+    std::string str(remain.substr(0, *size));
+    remain.remove_prefix(*size);
+    return str;
+}
+
+const char* MatchJournalRecordTypeName(const MatchJournalRecord::Type type)
+{
+    switch (type) {
+    case MatchJournalRecord::Type::REQUEST: return "request";
+    case MatchJournalRecord::Type::LEAVE: return "leave";
+    case MatchJournalRecord::Type::TIMEOUT: return "timeout";
+    case MatchJournalRecord::Type::COMPUTER_ACT: return "computer_act";
+    default: return "unknown";
+    }
+}
+
+MatchJournalWriter::MatchJournalWriter(std::string path, std::ofstream file, const Clock& clock)
+    : path_(std::move(path))
+    , file_(std::move(file))
+    , clock_(clock)
+    , begin_(clock.Now())
+{
+}
+
+std::unique_ptr<MatchJournalWriter> MatchJournalWriter::Open(const std::string& path, const MatchJournalHeader& header,
+        const Clock& clock)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return nullptr;
+    }
+    std::string buffer(k_magic);
+    AppendVarint(buffer, k_version);
+    AppendString(buffer, header.module_name_);
+    AppendVarint(buffer, header.random_seed_);
+    AppendVarint(buffer, header.game_options_.size());
+    for (const auto& option : header.game_options_) {
+        AppendString(buffer, option);
+    }
+    AppendVarint(buffer, header.user_num_);
+    AppendVarint(buffer, header.player_num_each_user_);
+    AppendVarint(buffer, header.bench_computers_to_player_num_);
+    AppendVarint(buffer, header.public_timer_alert_);
+    file.write(buffer.data(), buffer.size());
+    file.flush();
+    if (!file) {
+        return nullptr;
+    }
+    return std::unique_ptr<MatchJournalWriter>(new MatchJournalWriter(path, std::move(file), clock));
+}
+
+void MatchJournalWriter::Write(MatchJournalRecord record)
+{
+    record.time_us_ = std::chrono::duration_cast<std::chrono::microseconds>(
+            clock_.Now() - begin_).count();
+    buffer_.clear();
+    AppendVarint(buffer_, static_cast<uint8_t>(record.type_));
+    AppendVarint(buffer_, record.time_us_);
+    switch (record.type_) {
+    case MatchJournalRecord::Type::REQUEST:
+        AppendVarint(buffer_, record.pid_);
+        AppendVarint(buffer_, record.is_public_);
+        AppendString(buffer_, record.msg_);
+        break;
+    case MatchJournalRecord::Type::LEAVE:
+    case MatchJournalRecord::Type::COMPUTER_ACT:
+        AppendVarint(buffer_, record.pid_);
+        break;
+    case MatchJournalRecord::Type::TIMEOUT:
+        break;
+    }
+    file_.write(buffer_.data(), buffer_.size());
+    file_.flush();
+}
+
+std::unique_ptr<MatchJournalReader> MatchJournalReader::Open(const std::string& path, std::string& errmsg)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        errmsg = "open file failed";
+        return nullptr;
+    }
+    std::stringstream ss;
+    ss << file.rdbuf();
+    std::unique_ptr<MatchJournalReader> reader(new MatchJournalReader(std::move(ss).str()));
+    auto& remain = reader->remain_;
+    auto& header = reader->header_;
+    remain = reader->content_;
+    if (!remain.starts_with(k_magic)) {
+        errmsg = "not a match journal";
+        return nullptr;
+    }
+    remain.remove_prefix(k_magic.size());
+    if (const auto version = ReadVarint(remain); version != k_version) {
+        errmsg = "unsupported version";
+        return nullptr;
+    }
+    const auto module_name = ReadString(remain);
+    const auto random_seed = ReadVarint(remain);
+    const auto game_option_num = ReadVarint(remain);
+    if (!module_name || !random_seed || !game_option_num) {
+        errmsg = "invalid header";
+        return nullptr;
+    }
+    header.module_name_ = *module_name;
+    header.random_seed_ = *random_seed;
+    for (uint64_t i = 0; i < *game_option_num; ++i) {
+        auto option = ReadString(remain);
+        if (!option) {
+            errmsg = "invalid header";
+            return nullptr;
+        }
+        header.game_options_.emplace_back(std::move(*option));
+    }
+    const auto user_num = ReadVarint(remain);
+    const auto player_num_each_user = ReadVarint(remain);
+    const auto bench_computers_to_player_num = ReadVarint(remain);
+    const auto public_timer_alert = ReadVarint(remain);
+    if (!user_num || !player_num_each_user || !bench_computers_to_player_num || !public_timer_alert) {
+        errmsg = "invalid header";
+        return nullptr;
+    }
+    header.user_num_ = *user_num;
+    header.player_num_each_user_ = *player_num_each_user;
+    header.bench_computers_to_player_num_ = *bench_computers_to_player_num;
+    header.public_timer_alert_ = *public_timer_alert;
+    return reader;
+}
+
+std::optional<MatchJournalRecord> MatchJournalReader::Next()
+{
+    std::string_view remain = remain_;
+    const auto type = ReadVarint(remain);
+    const auto time_us = ReadVarint(remain);
+    if (!type || !time_us) {
+        return std::nullopt;
+    }
+    MatchJournalRecord record{.type_ = static_cast<MatchJournalRecord::Type>(*type), .time_us_ = *time_us};
+    switch (record.type_) {
+    case MatchJournalRecord::Type::REQUEST: {
+        const auto pid = ReadVarint(remain);
+        const auto is_public = ReadVarint(remain);
+        auto msg = ReadString(remain);
+        if (!pid || !is_public || !msg) {
+            return std::nullopt;
+        }
+        record.pid_ = *pid;
+        record.is_public_ = *is_public;
+        record.msg_ = std::move(*msg);
+        break;
+    }
+    case MatchJournalRecord::Type::LEAVE:
+    case MatchJournalRecord::Type::COMPUTER_ACT: {
+        const auto pid = ReadVarint(remain);
+        if (!pid) {
+            return std::nullopt;
+        }
+        record.pid_ = *pid;
+        break;
+    }
+    case MatchJournalRecord::Type::TIMEOUT:
+        break;
+    default:
+        return std::nullopt;
+    }
+    remain_ = remain;
+    return record;
+}
@@ -0,0 +1,95 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "bot_core/clock.h"
+#include "bot_core/id.h"
+
+// The journal of a match records everything needed to re-execute the match against its game module: the options, the
+// random seed and each input of the main stage in order.
+//
+// The file is a sequence of varints and length-prefixed strings. It starts with the magic "LGTJ", the version and the
+// header, and is followed by records. Each record is flushed once written, so a journal is still readable if the bot
+// crashes, except that the last record may be truncated, which is ignored by the reader.
+
+struct MatchJournalHeader
+{
+    std::string module_name_;
+    uint64_t random_seed_ = 0;
+    std::vector<std::string> game_options_; // each can be set by `GameOptionsBase::SetOption`
+    uint32_t user_num_ = 0;
+    uint32_t player_num_each_user_ = 1;
+    uint32_t bench_computers_to_player_num_ = 0;
+    bool public_timer_alert_ = false;
+};
+
+struct MatchJournalRecord
+{
+    enum class Type : uint8_t { REQUEST = 1, LEAVE = 2, TIMEOUT = 3, COMPUTER_ACT = 4 };
+
+    Type type_;
+    uint64_t time_us_ = 0; // the time since the journal is started
+    PlayerID pid_{0};      // not used by TIMEOUT
+    bool is_public_ = false; // used by REQUEST only
+    std::string msg_;        // used by REQUEST only
+};
+
+const char* MatchJournalRecordTypeName(const MatchJournalRecord::Type type);
+
+class MatchJournalWriter
+{
+  public:
+    // Return NULL if the file cannot be created. The time of records is measured by |clock|.
+    static std::unique_ptr<MatchJournalWriter> Open(const std::string& path, const MatchJournalHeader& header,
+            const Clock& clock = SteadyClock::Instance());
+
+    MatchJournalWriter(const MatchJournalWriter&) = delete;
+    MatchJournalWriter(MatchJournalWriter&&) = delete;
+
+    // The time of |record| is filled by the writer.
+    void Write(MatchJournalRecord record);
+
+    const std::string& path() const { return path_; }
+
+  private:
+    MatchJournalWriter(std::string path, std::ofstream file, const Clock& clock);
+
+    const std::string path_;
+    std::ofstream file_;
+    const Clock& clock_;
+    const Clock::TimePoint begin_;
+    std::string buffer_;
+};
+
+class MatchJournalReader
+{
+  public:
+    // Return NULL and set |errmsg| if the file cannot be opened or the header is invalid.
+    static std::unique_ptr<MatchJournalReader> Open(const std::string& path, std::string& errmsg);
+
+    MatchJournalReader(const MatchJournalReader&) = delete;
+    MatchJournalReader(MatchJournalReader&&) = delete;
+
+    const MatchJournalHeader& header() const { return header_; }
+
+    // Return std::nullopt if there are no more complete records.
+    std::optional<MatchJournalRecord> Next();
+
+  private:
+    MatchJournalReader(std::string content) : content_(std::move(content)) {}
+
+    const std::string content_;
+    std::string_view remain_;
+    MatchJournalHeader header_;
+};
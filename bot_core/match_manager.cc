@@ -4,6 +4,7 @@
 
 #include "bot_core/match_manager.h"
 
+#include <algorithm>
 #include <cassert>
 
 #include "bot_core/msg_sender.h"
@@ -12,18 +13,24 @@
 ErrCode MatchManager::NewMatch(GameHandle& game_handle, const std::string_view init_options_args, const UserID& uid,
         const std::optional<GroupID> gid, MsgSenderBase& reply)
 {
-    std::lock_guard<std::mutex> l(mutex_);
-    if (GetMatch_(uid)) {
-        reply() << "[错误] 建立失败：您已加入游戏";
-        return EC_MATCH_USER_ALREADY_IN_MATCH;
+    const auto reply_user_already_in_match = [&]
+        {
+            reply() << "[错误] 建立失败：您已加入游戏";
+            return EC_MATCH_USER_ALREADY_IN_MATCH;
+        };
+    const auto reply_group_already_in_match = [&]
+        {
+            // We has tried terminating the game outside this funciton.
+            // This case may happen when another user creates a new match after terminating.
+            reply() << "[错误] 建立失败：该房间已经开始游戏";
+            return EC_MATCH_ALREADY_BEGIN;
+        };
+    if (GetMatch(uid)) {
+        return reply_user_already_in_match();
     }
-    if (gid.has_value() && GetMatch_(*gid)) {
-        // We has tried terminating the game outside this funciton.
-        // This case may happen when another user creates a new match after terminating.
-        reply() << "[错误] 建立失败：该房间已经开始游戏";
-        return EC_MATCH_ALREADY_BEGIN;
+    if (gid.has_value() && GetMatch(*gid)) {
+        return reply_group_already_in_match();
     }
-    const MatchID mid = NewMatchID_();
     auto options = game_handle.CopyDefaultGameOptions();
     const lgtbot::game::InitOptionsResult start_mode =
         init_options_args.empty() ? lgtbot::game::InitOptionsResult::NEW_MULTIPLE_USERS_MODE_GAME
@@ -35,12 +42,18 @@ ErrCode MatchManager::NewMatch(GameHandle& game_handle, const std::string_view i
                 << game_handle.Info().name_ << "」查看所有的预设指令";
         return EC_INVALID_ARGUMENT;
     }
+    const MatchID mid = NewMatchID_();
     const auto new_match = std::make_shared<Match>(bot_, mid, game_handle, std::move(options), uid, gid);
-    BindMatch_(mid, new_match);
-    BindMatch_(uid, new_match);
-    if (gid.has_value()) {
-        BindMatch_(*gid, new_match);
+    // There is no global lock, so the user or the group may be bound to another match after the checks above. Binding
+    // fails in such case.
+    if (!BindMatch(uid, new_match)) {
+        return reply_user_already_in_match();
     }
+    if (gid.has_value() && !BindMatch(*gid, new_match)) {
+        UnbindMatch(uid);
+        return reply_group_already_in_match();
+    }
+    BindMatch(mid, new_match);
     if (start_mode == lgtbot::game::InitOptionsResult::NEW_SINGLE_USER_MODE_GAME) {
         // Start game directly for single-player mode.
         const auto ret = new_match->GameStart(uid, reply);
@@ -63,23 +76,22 @@ ErrCode MatchManager::NewMatch(GameHandle& game_handle, const std::string_view i
 
 std::vector<std::shared_ptr<Match>> MatchManager::Matches() const
 {
-    std::lock_guard<std::mutex> l(mutex_);
     std::vector<std::shared_ptr<Match>> matches;
-    for (const auto& [_, match] : id2match<MatchID>()) {
-        matches.emplace_back(match);
-    }
+    id2match<MatchID>().ForEach([&](const MatchID, const std::shared_ptr<Match>& match) { matches.emplace_back(match); });
+    std::ranges::sort(matches, [](const auto& _1, const auto& _2) { return _1->MatchId() < _2->MatchId(); });
     return matches;
 }
 
 MatchID MatchManager::NewMatchID_()
 {
-    const auto& mid2match = id2match<MatchID>();
-    while (mid2match.find(++next_mid_) != mid2match.end())
+    // The counter may wrap around and reach the ID of an old match which is still running.
+    MatchID mid;
+    while (id2match<MatchID>().Contains(mid = ++next_mid_))
         ;
-    return next_mid_;
+    return mid;
 }
 
 bool MatchManager::HasMatch() const
 {
-    return std::apply([&](const auto& ...id2match) { return (!id2match.empty() || ...); }, id2match_);
+    return std::apply([&](const auto& ...id2match) { return (!id2match.Empty() || ...); }, id2match_);
 }
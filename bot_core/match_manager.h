@@ -15,12 +15,15 @@
 
 #include "bot_core/bot_core.h"
 #include "bot_core/id.h"
+#include "bot_core/sharded_map.h"
 
 class Match;
 class BotCtx;
 class MsgSenderBase;
 class GameHandle;
 
+// Index the matches by user ID, match ID and group ID. Lookups are done for each inbound message, so the indexes are
+// sharded hash maps instead of maps protected by a global lock.
 class MatchManager
 {
    public:
@@ -30,10 +33,9 @@ class MatchManager
             const std::optional<GroupID> gid, MsgSenderBase& reply);
 
     template <typename IdType>
-    std::shared_ptr<Match> GetMatch(const IdType id)
+    std::shared_ptr<Match> GetMatch(const IdType id) const
     {
-        std::lock_guard<std::mutex> l(mutex_);
-        return GetMatch_(id);
+        return id2match<IdType>().Get(id);
     }
 
     std::vector<std::shared_ptr<Match>> Matches() const;
@@ -41,48 +43,24 @@ class MatchManager
     template <typename IdType>
     bool BindMatch(const IdType id, std::shared_ptr<Match> match)
     {
-        std::lock_guard<std::mutex> l(mutex_);
-        return BindMatch_(id, std::move(match));
+        return id2match<IdType>().Insert(id, std::move(match));
     }
 
     template <typename IdType>
     void UnbindMatch(const IdType id)
     {
-        std::lock_guard<std::mutex> l(mutex_);
-        UnbindMatch_(id);
+        id2match<IdType>().Erase(id);
     }
 
     bool HasMatch() const;
 
    private:
-    void DeleteMatch_(const MatchID id);
-
-    template <typename IdType>
-    std::shared_ptr<Match> GetMatch_(const IdType id)
-    {
-        const auto it = id2match<IdType>().find(id);
-        return (it == id2match<IdType>().end()) ? nullptr : it->second;
-    }
-
-    template <typename IdType>
-    bool BindMatch_(const IdType id, std::shared_ptr<Match> match)
-    {
-        return id2match<IdType>().emplace(id, match).second;
-    }
-
-    template <typename IdType>
-    void UnbindMatch_(const IdType id)
-    {
-        id2match<IdType>().erase(id);
-    }
-
     MatchID NewMatchID_();
 
     BotCtx& bot_;
-    mutable std::mutex mutex_;
-    template <typename IdType> using Id2Map = std::map<IdType, std::shared_ptr<Match>>;
+    template <typename IdType> using Id2Map = ShardedMap<IdType, std::shared_ptr<Match>>;
     std::tuple<Id2Map<UserID>, Id2Map<MatchID>, Id2Map<GroupID>> id2match_;
     template <typename IdType> Id2Map<IdType>& id2match() { return std::get<Id2Map<IdType>>(id2match_); }
     template <typename IdType> const Id2Map<IdType>& id2match() const { return std::get<Id2Map<IdType>>(id2match_); }
-    MatchID next_mid_;
+    std::atomic<uint32_t> next_mid_;
 };
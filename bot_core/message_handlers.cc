@@ -3,8 +3,10 @@
 // This source code is licensed under LGPLv2 (found in the LICENSE file).
 
 #include <algorithm>
+#include <chrono>
 #include <ranges>
 #include <cmath>
+#include <unordered_map>
 
 #include "bot_core/message_handlers.h"
 
@@ -14,6 +16,7 @@
 #include "bot_core/bot_core.h"
 #include "bot_core/db_manager.h"
 #include "bot_core/match.h"
+#include "bot_core/metrics.h"
 #include "bot_core/image.h"
 #include "bot_core/options.h"
 
@@ -92,26 +95,80 @@ static ErrCode help(BotCtx& bot, const UserID uid, const std::optional<GroupID>
             IS_ADMIN ? "管理" : "元");
 }
 
-ErrCode HandleRequest(BotCtx& bot, const UserID uid, const std::optional<GroupID>& gid, MsgReader& reader,
-                      MsgSenderBase& reply, const std::vector<MetaCommandGroup>& cmd_groups)
+// Index the commands of all groups, in the order they are shown in the help.
+static IndexedMetaCommands IndexMetaCommands(const std::vector<MetaCommandGroup>& cmd_groups)
 {
-    reader.Reset();
+    std::vector<MetaCommand> cmds;
     for (const MetaCommandGroup& cmd_group : cmd_groups) {
         for (const MetaCommand& cmd : cmd_group.desc_) {
-            const std::optional<ErrCode> errcode = cmd.CallIfValid(reader, bot, uid, gid, reply);
-            if (errcode.has_value()) {
-                return *errcode;
-            }
+            cmds.emplace_back(cmd);
         }
     }
-    return EC_REQUEST_NOT_FOUND;
+    return IndexedMetaCommands(std::move(cmds));
 }
 
+const IndexedMetaCommands& GetIndexedMetaCommands(const bool is_admin)
+{
+    static const IndexedMetaCommands indexed_meta_cmds = IndexMetaCommands(meta_cmds);
+    static const IndexedMetaCommands indexed_admin_cmds = IndexMetaCommands(admin_cmds);
+    return is_admin ? indexed_admin_cmds : indexed_meta_cmds;
+}
+
+ErrCode HandleRequest(BotCtx& bot, const UserID uid, const std::optional<GroupID>& gid, MsgReader& reader,
+                      MsgSenderBase& reply, const IndexedMetaCommands& cmds)
+{
+    return cmds.CallIfValid(reader, bot, uid, gid, reply).value_or(EC_REQUEST_NOT_FOUND);
+}
+
+// The latency histograms of commands labeled by their leading keywords. The histograms are resolved when the commands
+// are indexed, so recording the latency of a request neither allocates nor locks the metrics registry. Only the
+// keywords of existing commands are used as labels, so that the number of metrics is bounded.
+class CommandLatencies
+{
+  public:
+    CommandLatencies(const char* const type, const IndexedMetaCommands& cmds)
+        : unknown_(GlobalMetrics().Histogram("lgtbot_command_latency_us", {{"type", type}, {"command", "unknown"}}))
+    {
+        for (const MetaCommand& cmd : cmds) {
+            if (const auto keywords = cmd.LeadingKeywords()) {
+                for (const auto& keyword : *keywords) {
+                    histograms_.try_emplace(keyword,
+                            &GlobalMetrics().Histogram("lgtbot_command_latency_us", {{"type", type}, {"command", keyword}}));
+                }
+            }
+        }
+    }
+
+    MetricHistogram& Get(MsgReader& reader, const ErrCode ret) const
+    {
+        reader.Reset();
+        if (ret == EC_REQUEST_NOT_FOUND || !reader.HasNext()) {
+            return unknown_;
+        }
+        const auto it = histograms_.find(reader.NextArg());
+        return it == histograms_.end() ? unknown_ : *it->second;
+    }
+
+  private:
+    struct StringHash
+    {
+        using is_transparent = void;
+        size_t operator()(const std::string_view& sv) const { return std::hash<std::string_view>{}(sv); }
+    };
+
+    MetricHistogram& unknown_;
+    std::unordered_map<std::string, MetricHistogram*, StringHash, std::equal_to<>> histograms_;
+};
+
 ErrCode HandleMetaRequest(BotCtx& bot, const UserID uid, const std::optional<GroupID>& gid, const std::string& msg,
                           MsgSenderBase& reply)
 {
+    static const CommandLatencies meta_cmd_latencies("meta", GetIndexedMetaCommands(false));
+    const auto begin = std::chrono::steady_clock::now();
     MsgReader reader(msg);
-    const auto ret = HandleRequest(bot, uid, gid, reader, reply, meta_cmds);
+    const auto ret = HandleRequest(bot, uid, gid, reader, reply, GetIndexedMetaCommands(false));
+    meta_cmd_latencies.Get(reader, ret).Record(
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count());
     if (ret == EC_REQUEST_NOT_FOUND) {
         reply() << "[错误] 未预料的元指令，您可以通过「" META_COMMAND_SIGN "帮助」查看所有支持的元指令";
     }
@@ -121,8 +178,12 @@ ErrCode HandleMetaRequest(BotCtx& bot, const UserID uid, const std::optional<Gro
 ErrCode HandleAdminRequest(BotCtx& bot, const UserID uid, const std::optional<GroupID>& gid, const std::string& msg,
                            MsgSenderBase& reply)
 {
+    static const CommandLatencies admin_cmd_latencies("admin", GetIndexedMetaCommands(true));
+    const auto begin = std::chrono::steady_clock::now();
     MsgReader reader(msg);
-    const auto ret = HandleRequest(bot, uid, gid, reader, reply, admin_cmds);
+    const auto ret = HandleRequest(bot, uid, gid, reader, reply, GetIndexedMetaCommands(true));
+    admin_cmd_latencies.Get(reader, ret).Record(
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count());
     if (ret == EC_REQUEST_NOT_FOUND) {
         reply() << "[错误] 未预料的管理指令，您可以通过「" ADMIN_COMMAND_SIGN "帮助」查看所有支持的管理指令";
     }
@@ -357,7 +418,7 @@ static ErrCode show_rule(BotCtx& bot, const UserID uid, const std::optional<Grou
         return EC_REQUEST_UNKNOWN_GAME;
     };
     if (!show_text) {
-        reply() << Markdown(it->second.Info().rule_);
+        reply() << Markdown(it->second.Rule());
         return EC_OK;
     }
     auto sender = reply();
@@ -369,7 +430,7 @@ static ErrCode show_rule(BotCtx& bot, const UserID uid, const std::optional<Grou
     }
     sender << "人\n";
     sender << "详细规则：\n";
-    sender << it->second.Info().rule_;
+    sender << it->second.Rule();
     return EC_OK;
 }
 
@@ -998,6 +1059,85 @@ static ErrCode show_bot_options(BotCtx& bot, const UserID uid, const std::option
     return EC_OK;
 }
 
+static ErrCode show_image_cache(BotCtx& bot, const UserID uid, const std::optional<GroupID> gid,
+        MsgSenderBase& reply)
+{
+    const auto stats = bot.image_cache().GetStats();
+    const auto total = stats.hit_count_ + stats.miss_count_;
+    const auto avatar_stats = bot.avatar_cache().GetStats();
+    reply() << "图片缓存统计："
+            << "\n命中次数：" << stats.hit_count_
+            << "\n未命中次数：" << stats.miss_count_
+            << "\n命中率：" << (total == 0 ? 0 : stats.hit_count_ * 100 / total) << "%"
+            << "\n淘汰次数：" << stats.evict_count_
+            << "\n文件数量：" << stats.file_count_
+            << "\n占用空间：" << (stats.total_bytes_ >> 10) << " KB"
+            << "\n\n头像缓存统计："
+            << "\n命中次数：" << avatar_stats.hit_count_
+            << "\n下载失败后命中次数：" << avatar_stats.negative_hit_count_
+            << "\n未命中次数：" << avatar_stats.miss_count_
+            << "\n等待其他下载次数：" << avatar_stats.wait_count_
+            << "\n下载失败次数：" << avatar_stats.download_failed_count_
+            << "\n平均下载耗时：" << (avatar_stats.miss_count_ == 0 ? 0 :
+                    avatar_stats.total_download_latency_us_ / avatar_stats.miss_count_ / 1000) << " ms"
+            << "\n最大下载耗时：" << avatar_stats.max_download_latency_us_ / 1000 << " ms";
+    return EC_OK;
+}
+
+static ErrCode show_trace(BotCtx& bot, const UserID uid, const std::optional<GroupID> gid, MsgSenderBase& reply)
+{
+    Tracer* const tracer = bot.tracer();
+    if (!tracer) {
+        reply() << "[错误] 查看失败：未设置追踪文件路径";
+        return EC_REQUEST_NO_TRACE_PATH;
+    }
+    const auto stats = tracer->GetStats();
+    auto sender = reply();
+    sender << "追踪文件：" << tracer->path()
+           << "\n采样比例：" << tracer->sample_percent() << "%"
+           << "\n追踪的比赛：";
+    const auto mids = tracer->TracedMatches();
+    if (mids.empty()) {
+        sender << "无";
+    }
+    for (const auto mid : mids) {
+        sender << mid << " ";
+    }
+    sender << "\n已写入事件数：" << stats.event_count_
+           << "\n文件轮转次数：" << stats.rotate_count_;
+    return EC_OK;
+}
+
+static ErrCode set_trace_sample_percent(BotCtx& bot, const UserID uid, const std::optional<GroupID> gid,
+        MsgSenderBase& reply, const uint32_t percent)
+{
+    Tracer* const tracer = bot.tracer();
+    if (!tracer) {
+        reply() << "[错误] 设置失败：未设置追踪文件路径";
+        return EC_REQUEST_NO_TRACE_PATH;
+    }
+    tracer->SetSamplePercent(percent);
+    reply() << "设置成功，" << (percent == 0 ? "已关闭请求采样" : "请求的采样比例为 " + std::to_string(percent) + "%");
+    return EC_OK;
+}
+
+static ErrCode set_match_traced(BotCtx& bot, const UserID uid, const std::optional<GroupID> gid,
+        MsgSenderBase& reply, const MatchID mid, const bool traced)
+{
+    Tracer* const tracer = bot.tracer();
+    if (!tracer) {
+        reply() << "[错误] 设置失败：未设置追踪文件路径";
+        return EC_REQUEST_NO_TRACE_PATH;
+    }
+    if (traced && !bot.match_manager().GetMatch(mid)) {
+        reply() << "[错误] 设置失败：游戏ID不存在";
+        return EC_MATCH_NOT_EXIST;
+    }
+    tracer->SetMatchTraced(mid, traced);
+    reply() << "设置成功，" << (traced ? "开始" : "停止") << "追踪比赛 " << mid << " 的所有请求和超时";
+    return EC_OK;
+}
+
 static ErrCode add_honor(BotCtx& bot, const UserID uid, const std::optional<GroupID> gid, MsgSenderBase& reply,
         const std::string& honor_uid, const std::string honor_desc)
 {
@@ -1035,6 +1175,8 @@ const std::vector<MetaCommandGroup> admin_cmds = {
                         OptionalDefaultChecker<BoolChecker>(false, "文字", "图片")),
             make_command("查看他人战绩", show_others_profile, VoidChecker(ADMIN_COMMAND_SIGN "战绩"), AnyArg("用户 ID", "123456789"),
                         OptionalDefaultChecker<EnumChecker<TimeRange>>(TimeRange::总)),
+            make_command("查看图片和头像缓存统计", show_image_cache, VoidChecker(ADMIN_COMMAND_SIGN "图片缓存")),
+            make_command("查看请求追踪状态", show_trace, VoidChecker(ADMIN_COMMAND_SIGN "追踪")),
         }
     },
     {
@@ -1043,6 +1185,10 @@ const std::vector<MetaCommandGroup> admin_cmds = {
                         OptionalChecker<BasicChecker<MatchID>>("私密比赛编号")),
             make_command("清除他人战绩，并通知其具体理由", clear_others_profile, VoidChecker(ADMIN_COMMAND_SIGN "清除战绩"),
                         AnyArg("用户 ID", "123456789"), AnyArg("理由", "恶意刷分")),
+            make_command("设置请求追踪的采样比例，为 0 时关闭采样", set_trace_sample_percent,
+                        VoidChecker(ADMIN_COMMAND_SIGN "追踪"), VoidChecker("采样"), ArithChecker<uint32_t>(0, 100, "百分比")),
+            make_command("开启/关闭追踪比赛的所有请求和超时", set_match_traced, VoidChecker(ADMIN_COMMAND_SIGN "追踪"),
+                        VoidChecker("比赛"), BasicChecker<MatchID>("比赛编号"), BoolChecker("开启", "关闭")),
         }
     },
     {
@@ -15,6 +15,10 @@ class BotCtx;
 
 using MetaUserFuncType = ErrCode(BotCtx&, const UserID, const std::optional<GroupID>&, MsgSenderBase& reply);
 using MetaCommand = Command<MetaUserFuncType>;
+using IndexedMetaCommands = IndexedCommands<MetaUserFuncType>;
+
+// The indexed meta commands, or the indexed admin commands if |is_admin| is true. It is exposed for benchmarks.
+const IndexedMetaCommands& GetIndexedMetaCommands(const bool is_admin);
 
 ErrCode HandleMetaRequest(BotCtx& bot, const UserID uid, const std::optional<GroupID>& gid, const std::string& msg,
                           MsgSenderBase& reply);
@@ -0,0 +1,130 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+#include "bot_core/metrics.h"
+
+#include "nlohmann/json.hpp"
+
+static constexpr const std::array<std::pair<const char*, double>, 4> k_quantiles{{
+    {"0.5", 0.5}, {"0.9", 0.9}, {"0.99", 0.99}, {"0.999", 0.999}
+}};
+
+static void AppendLabels(std::string& str, const MetricsRegistry::Labels& labels, const char* const quantile = nullptr)
+{
+    if (labels.empty() && !quantile) {
+        return;
+    }
+    str += '{';
+    const auto append_label = [&str](const std::string_view name, const std::string_view value)
+        {
+            if (str.back() != '{') {
+                str += ',';
+            }
+            str.append(name).append("=\"");
+            for (const char c : value) {
+                switch (c) {
+                case '\\': str += "\\\\"; break;
+                case '"': str += "\\\""; break;
+                case '\n': str += "\\n"; break;
+                default: str += c;
+                }
+            }
+            str += '"';
+        };
+    for (const auto& [name, value] : labels) {
+        append_label(name, value);
+    }
+    if (quantile) {
+        append_label("quantile", quantile);
+    }
+    str += '}';
+}
+
+static void AppendType(std::string& str, std::string& last_name, const std::string& name, const char* const type)
+{
+    if (name != last_name) {
+        str.append("# TYPE ").append(name).append(" ").append(type).append("\n");
+        last_name = name;
+    }
+}
+
+std::string MetricsRegistry::DumpPrometheus(const std::vector<Gauge>& gauges) const
+{
+    std::string str;
+    std::shared_lock<std::shared_mutex> l(mutex_);
+    std::string last_name;
+    // Series of the same name are adjacent because the map is ordered by the name followed by '{'.
+    for (const auto& [_, series] : counters_) {
+        AppendType(str, last_name, series.name_, "counter");
+        str += series.name_;
+        AppendLabels(str, series.labels_);
+        str.append(" ").append(std::to_string(series.metric_->Value())).append("\n");
+    }
+    for (const auto& [_, series] : histograms_) {
+        AppendType(str, last_name, series.name_, "summary");
+        const auto snapshot = series.metric_->GetSnapshot();
+        for (const auto& [quantile_str, quantile] : k_quantiles) {
+            str += series.name_;
+            AppendLabels(str, series.labels_, quantile_str);
+            str.append(" ").append(std::to_string(snapshot.Quantile(quantile))).append("\n");
+        }
+        str.append(series.name_).append("_sum");
+        AppendLabels(str, series.labels_);
+        str.append(" ").append(std::to_string(snapshot.sum_)).append("\n");
+        str.append(series.name_).append("_count");
+        AppendLabels(str, series.labels_);
+        str.append(" ").append(std::to_string(snapshot.count_)).append("\n");
+    }
+    for (const auto& gauge : gauges) {
+        AppendType(str, last_name, gauge.name_, "gauge");
+        str.append(gauge.name_).append(" ").append(std::to_string(gauge.value_)).append("\n");
+    }
+    return str;
+}
+
+static nlohmann::json LabelsToJson(const MetricsRegistry::Labels& labels)
+{
+    nlohmann::json json = nlohmann::json::object();
+    for (const auto& [name, value] : labels) {
+        json[name] = value;
+    }
+    return json;
+}
+
+std::string MetricsRegistry::DumpJson(const std::vector<Gauge>& gauges) const
+{
+    nlohmann::json json{
+        {"counters", nlohmann::json::array()},
+        {"histograms", nlohmann::json::array()},
+        {"gauges", nlohmann::json::array()},
+    };
+    {
+        std::shared_lock<std::shared_mutex> l(mutex_);
+        for (const auto& [_, series] : counters_) {
+            json["counters"].push_back({
+                    {"name", series.name_},
+                    {"labels", LabelsToJson(series.labels_)},
+                    {"value", series.metric_->Value()},
+                });
+        }
+        for (const auto& [_, series] : histograms_) {
+            const auto snapshot = series.metric_->GetSnapshot();
+            nlohmann::json histogram{
+                {"name", series.name_},
+                {"labels", LabelsToJson(series.labels_)},
+                {"count", snapshot.count_},
+                {"sum", snapshot.sum_},
+                {"max", snapshot.max_},
+            };
+            for (const auto& [quantile_str, quantile] : k_quantiles) {
+                histogram["quantiles"][quantile_str] = snapshot.Quantile(quantile);
+            }
+            json["histograms"].push_back(std::move(histogram));
+        }
+    }
+    for (const auto& gauge : gauges) {
+        json["gauges"].push_back({{"name", gauge.name_}, {"value", gauge.value_}});
+    }
+    return json.dump();
+}
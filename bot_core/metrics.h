@@ -0,0 +1,274 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// A counter which can be increased by many threads at the same time.
+//
+// The value is split into stripes on different cache lines, and each thread increases the stripe it is assigned to, so
+// threads do not contend on the same cache line.
+class MetricCounter
+{
+  public:
+    static constexpr const uint32_t k_stripe_num = 16;
+
+    MetricCounter() = default;
+    MetricCounter(const MetricCounter&) = delete;
+    MetricCounter(MetricCounter&&) = delete;
+
+    void Add(const uint64_t n = 1) { stripes_[ThreadStripe_()].value_.fetch_add(n, std::memory_order_relaxed); }
+
+    uint64_t Value() const
+    {
+        uint64_t value = 0;
+        for (const auto& stripe : stripes_) {
+            value += stripe.value_.load(std::memory_order_relaxed);
+        }
+        return value;
+    }
+
+  private:
+    struct alignas(64) Stripe
+    {
+        std::atomic<uint64_t> value_{0};
+    };
+
+    static uint32_t ThreadStripe_()
+    {
+        static std::atomic<uint32_t> next_stripe{0};
+        thread_local const uint32_t stripe = next_stripe.fetch_add(1, std::memory_order_relaxed) % k_stripe_num;
+        return stripe;
+    }
+
+    std::array<Stripe, k_stripe_num> stripes_;
+};
+
+// A histogram of non-negative values (e.g. latencies in microseconds) with bounded relative error, like HdrHistogram.
+//
+// Values less than `k_linear_bucket_num` are counted exactly. Each range [2^n, 2^(n+1)) of larger values is split into
+// `k_sub_bucket_num` buckets of the same width, so a value is reported with a relative error less than
+// 1 / `k_sub_bucket_num`. Recording a value is a few relaxed atomic additions without locks.
+class MetricHistogram
+{
+  public:
+    static constexpr const uint32_t k_sub_bucket_bits = 3;
+    static constexpr const uint32_t k_sub_bucket_num = 1 << k_sub_bucket_bits;
+    static constexpr const uint32_t k_linear_bucket_num = k_sub_bucket_num * 2;
+    static constexpr const uint32_t k_bucket_num =
+        k_linear_bucket_num + (64 - k_sub_bucket_bits - 1) * k_sub_bucket_num;
+
+    struct Snapshot
+    {
+        uint64_t count_ = 0;
+        uint64_t sum_ = 0;
+        uint64_t max_ = 0;
+        std::array<uint64_t, k_bucket_num> buckets_{};
+
+        // Return the upper bound of the bucket which contains the value at |quantile| (in [0, 1]).
+        uint64_t Quantile(const double quantile) const
+        {
+            if (count_ == 0) {
+                return 0;
+            }
+            const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(quantile * count_ + 0.5));
+            uint64_t seen = 0;
+            for (uint32_t i = 0; i < k_bucket_num; ++i) {
+                seen += buckets_[i];
+                if (seen >= rank) {
+                    return std::min(BucketUpperBound(i), max_);
+                }
+            }
+            return max_;
+        }
+    };
+
+    MetricHistogram() = default;
+    MetricHistogram(const MetricHistogram&) = delete;
+    MetricHistogram(MetricHistogram&&) = delete;
+
+    void Record(const uint64_t value)
+    {
+        buckets_[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(value, std::memory_order_relaxed);
+        for (uint64_t max = max_.load(std::memory_order_relaxed);
+                max < value && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed); ) {
+        }
+    }
+
+    // The snapshot is not atomic as a whole, so the count may differ slightly from the sum of buckets when values are
+    // being recorded.
+    Snapshot GetSnapshot() const
+    {
+        Snapshot snapshot;
+        snapshot.count_ = count_.load(std::memory_order_relaxed);
+        snapshot.sum_ = sum_.load(std::memory_order_relaxed);
+        snapshot.max_ = max_.load(std::memory_order_relaxed);
+        for (uint32_t i = 0; i < k_bucket_num; ++i) {
+            snapshot.buckets_[i] = buckets_[i].load(std::memory_order_relaxed);
+        }
+        return snapshot;
+    }
+
+    static uint32_t BucketIndex(const uint64_t value)
+    {
+        if (value < k_linear_bucket_num) {
+            return value;
+        }
+        const uint32_t exponent = std::bit_width(value) - 1;
+        const uint32_t sub_bucket = (value >> (exponent - k_sub_bucket_bits)) - k_sub_bucket_num;
+        return k_linear_bucket_num + (exponent - k_sub_bucket_bits - 1) * k_sub_bucket_num + sub_bucket;
+    }
+
+    static uint64_t BucketUpperBound(const uint32_t index)
+    {
+        if (index < k_linear_bucket_num) {
+            return index;
+        }
+        const uint32_t exponent = (index - k_linear_bucket_num) / k_sub_bucket_num + k_sub_bucket_bits + 1;
+        const uint64_t sub_bucket = (index - k_linear_bucket_num) % k_sub_bucket_num;
+        const uint64_t width = uint64_t(1) << (exponent - k_sub_bucket_bits);
+        return (k_sub_bucket_num + sub_bucket) * width + (width - 1);
+    }
+
+  private:
+    std::array<std::atomic<uint64_t>, k_bucket_num> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+// Record the microseconds from construction to destruction into the histogram.
+class ScopedLatency
+{
+  public:
+    explicit ScopedLatency(MetricHistogram& histogram)
+        : histogram_(histogram), begin_(std::chrono::steady_clock::now()) {}
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency(ScopedLatency&&) = delete;
+
+    ~ScopedLatency()
+    {
+        histogram_.Record(std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - begin_).count());
+    }
+
+  private:
+    MetricHistogram& histogram_;
+    const std::chrono::steady_clock::time_point begin_;
+};
+
+// The registry of counters and histograms, which are identified by their names and labels.
+//
+// Metrics are never removed, so the returned references stay valid for the lifetime of the registry. Callers on hot
+// paths should keep the reference when the labels do not change rather than looking it up each time. To bound the
+// memory, at most `k_max_series_num` metrics are registered, and the exceeding ones share a metric labeled with
+// `overflow="true"`.
+class MetricsRegistry
+{
+  public:
+    using Labels = std::vector<std::pair<std::string, std::string>>;
+
+    // The value of a metric computed when dumping, like the size of a cache.
+    struct Gauge
+    {
+        std::string name_;
+        uint64_t value_;
+    };
+
+    static constexpr const uint32_t k_max_series_num = 4096;
+
+    MetricsRegistry() = default;
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry(MetricsRegistry&&) = delete;
+
+    MetricCounter& Counter(const std::string_view name, const Labels& labels = {})
+    {
+        return GetOrCreate_(counters_, name, labels);
+    }
+
+    MetricHistogram& Histogram(const std::string_view name, const Labels& labels = {})
+    {
+        return GetOrCreate_(histograms_, name, labels);
+    }
+
+    // Dump the metrics in the Prometheus text format. Histograms are dumped as summaries with quantiles.
+    std::string DumpPrometheus(const std::vector<Gauge>& gauges = {}) const;
+
+    // Dump the metrics as a JSON object with the fields "counters", "histograms" and "gauges".
+    std::string DumpJson(const std::vector<Gauge>& gauges = {}) const;
+
+  private:
+    template <typename Metric>
+    struct Series
+    {
+        std::string name_;
+        Labels labels_;
+        std::unique_ptr<Metric> metric_;
+    };
+
+    template <typename Metric>
+    using SeriesMap = std::map<std::string, Series<Metric>>;
+
+    static std::string Key_(const std::string_view name, const Labels& labels)
+    {
+        std::string key(name);
+        key += '{';
+        for (const auto& [label_name, label_value] : labels) {
+            key.append(label_name).append("=\"").append(label_value).append("\",");
+        }
+        key += '}';
+        return key;
+    }
+
+    template <typename Metric>
+    Metric& GetOrCreate_(SeriesMap<Metric>& series_map, const std::string_view name, const Labels& labels)
+    {
+        const std::string key = Key_(name, labels);
+        {
+            std::shared_lock<std::shared_mutex> l(mutex_);
+            if (const auto it = series_map.find(key); it != series_map.end()) {
+                return *it->second.metric_;
+            }
+        }
+        std::lock_guard<std::shared_mutex> l(mutex_);
+        if (const auto it = series_map.find(key); it != series_map.end()) {
+            return *it->second.metric_;
+        }
+        if (counters_.size() + histograms_.size() >= k_max_series_num) {
+            const Labels overflow_labels{{"overflow", "true"}};
+            return *series_map.try_emplace(Key_(name, overflow_labels), std::string(name), overflow_labels,
+                    std::make_unique<Metric>()).first->second.metric_;
+        }
+        return *series_map.try_emplace(key, std::string(name), labels,
+                std::make_unique<Metric>()).first->second.metric_;
+    }
+
+    mutable std::shared_mutex mutex_;
+    SeriesMap<MetricCounter> counters_;     // REQUIRE: should be protected by mutex_
+    SeriesMap<MetricHistogram> histograms_; // REQUIRE: should be protected by mutex_
+};
+
+// The registry shared by all bots in the process, which is dumped by `LGTBot_DumpMetrics`.
+inline MetricsRegistry& GlobalMetrics()
+{
+    static MetricsRegistry registry;
+    return registry;
+}
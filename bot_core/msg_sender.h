@@ -11,9 +11,15 @@
 #include <filesystem>
 #include <thread>
 #include <cstring>
+#include <concepts>
 
 #include "bot_core/id.h"
 #include "bot_core/image.h"
+#include "bot_core/image_cache.h"
+#include "bot_core/metrics.h"
+#include "bot_core/tracer.h"
+#include "bot_core/outbound_pipeline.h"
+#include "bot_core/user_name_cache.h"
 #include "bot_core/bot_core.h"
 
 class PlayerID;
@@ -26,6 +32,9 @@ template <typename IdType> struct Name { IdType id_; };
 struct Image { std::string path_; };
 struct Markdown { std::string_view data_; uint32_t width_ = 600; };
 
+// The markdown is produced by |fn_| only if the message has any receiver, e.g. `LazyMarkdown{[&] { return ToHtml_(); }}`.
+template <typename Fn> struct LazyMarkdown { Fn fn_; uint32_t width_ = 600; };
+
 template <typename T> concept CanToString = requires(T&& t) { std::to_string(std::forward<T>(t)); };
 
 class MsgSenderBase
@@ -45,6 +54,9 @@ class MsgSenderBase
 
         void Release() { sender_ = nullptr; }
 
+        // Return false if the messages will be discarded, so the caller can skip building them.
+        bool HasReceiver() const { return sender_ && sender_->HasReceiver(); }
+
         inline MsgSenderGuard& operator<<(const std::string_view& sv);
 
         template <CanToString Arg>
@@ -55,6 +67,26 @@ class MsgSenderBase
 
         inline MsgSenderGuard& operator<<(const char c) { return (*this) << std::string(1, c); }
 
+        // The deferred producer is invoked only if there is any receiver, and its result is sent as if it were streamed
+        // directly.
+        template <std::invocable Fn>
+        MsgSenderGuard& operator<<(Fn&& fn)
+        {
+            if (HasReceiver()) {
+                (*this) << std::invoke(std::forward<Fn>(fn));
+            }
+            return *this;
+        }
+
+        template <typename Fn>
+        MsgSenderGuard& operator<<(const LazyMarkdown<Fn>& markdown_msg)
+        {
+            if (HasReceiver()) {
+                const std::string markdown = std::invoke(markdown_msg.fn_);
+                sender_->SaveMarkdown(markdown.c_str(), markdown_msg.width_);
+            }
+            return *this;
+        }
 
         // It is safe to use STL because MsgSenderGuard will not be passed between libraries
         inline MsgSenderGuard& operator<<(const At<UserID>&);
@@ -68,8 +100,6 @@ class MsgSenderBase
         MsgSenderBase* sender_;
     };
 
-    template<typename> friend class MsgSenderBatch;
-
   public:
     virtual ~MsgSenderBase() {}
     virtual MsgSenderGuard operator()() { return MsgSenderGuard(*this); }
@@ -84,6 +114,10 @@ class MsgSenderBase
     virtual void SaveImage(const char* const path) = 0;
     virtual void SaveMarkdown(const char* const markdown, const uint32_t width) = 0;
     virtual void Flush() = 0;
+
+  public:
+    // Return false if the messages are discarded without being delivered to anyone.
+    virtual bool HasReceiver() const { return true; }
 };
 
 class EmptyMsgSender : public MsgSenderBase
@@ -95,6 +129,8 @@ class EmptyMsgSender : public MsgSenderBase
         return sender;
     }
 
+    virtual bool HasReceiver() const override { return false; }
+
   protected:
     virtual void SaveText(const char* const data, const uint64_t len) override {}
     virtual void SaveUser(const UserID& uid, const bool is_at) override {}
@@ -112,11 +148,15 @@ class EmptyMsgSender : public MsgSenderBase
 class MsgSender : public MsgSenderBase
 {
   public:
-    MsgSender(void* handler, const std::string& image_path, const LGTBot_Callback& callbacks, const UserID& uid, Match* const match = nullptr)
-        : handler_(handler), image_path_(&image_path), callbacks_(&callbacks), id_(uid.GetStr()), is_to_user_(true), match_(match) {}
+    MsgSender(MarkdownImageCache& image_cache, UserNameCache& name_cache, OutboundPipeline& outbound, const UserID& uid,
+              Match* const match = nullptr)
+        : image_cache_(&image_cache), name_cache_(&name_cache), outbound_(&outbound), id_(uid.GetStr())
+        , is_to_user_(true), match_(match) {}
 
-    MsgSender(void* handler, const std::string& image_path, const LGTBot_Callback& callbacks, const GroupID& gid, Match* const match = nullptr)
-        : handler_(handler), image_path_(&image_path), callbacks_(&callbacks), id_(gid.GetStr()), is_to_user_(false), match_(match) {}
+    MsgSender(MarkdownImageCache& image_cache, UserNameCache& name_cache, OutboundPipeline& outbound, const GroupID& gid,
+              Match* const match = nullptr)
+        : image_cache_(&image_cache), name_cache_(&name_cache), outbound_(&outbound), id_(gid.GetStr())
+        , is_to_user_(false), match_(match) {}
 
     MsgSender(const MsgSender&) = delete;
     MsgSender(MsgSender&& o) = default;
@@ -132,6 +172,10 @@ class MsgSender : public MsgSenderBase
     virtual MsgSenderGuard operator()() override { return MsgSenderGuard(*this); }
 
   protected:
+    // The receivers are decided by the derived class when flushing. See `MsgSenderBatch`.
+    MsgSender(MarkdownImageCache& image_cache, UserNameCache& name_cache, OutboundPipeline& outbound, Match* const match)
+        : image_cache_(&image_cache), name_cache_(&name_cache), outbound_(&outbound), is_to_user_(true), match_(match) {}
+
     virtual void SaveText(const char* const data, const uint64_t len) override
     {
         // TODO: len is useless
@@ -148,13 +192,7 @@ class MsgSender : public MsgSenderBase
             messages_.emplace_back(uid.GetStr(), LGTBot_MessageType::LGTBOT_MSG_USER_MENTION);
             return;
         }
-        char buffer[128];
-        if (is_to_user_) {
-            callbacks_->get_user_name(handler_, buffer, sizeof(buffer), uid.GetCStr());
-        } else {
-            callbacks_->get_user_name_in_group(handler_, buffer, sizeof(buffer), id_.c_str(), uid.GetCStr());
-        }
-        SaveText(buffer, std::strlen(buffer));
+        SaveText_(name_cache_->Get(uid.GetCStr(), is_to_user_ ? nullptr : id_.c_str()));
     }
 
     virtual void SavePlayer(const PlayerID& pid, const bool is_at) override;
@@ -166,25 +204,35 @@ class MsgSender : public MsgSenderBase
 
     virtual void SaveMarkdown(const char* const markdown, const uint32_t width)
     {
-        if (!image_path_) {
+        if (!image_cache_) {
             return;
         }
-        std::stringstream ss;
-        ss << std::this_thread::get_id();
-        const std::string path =
-            (std::filesystem::path(*image_path_) / "gen" / ss.str() += ".png").string();
-        MarkdownToImage(markdown, path, width);
-        SaveImage(path.c_str());
+        // The cached image is immutable and pinned until the message is delivered, so it is safe to be sent after other
+        // messages are rendered.
+        auto image = image_cache_->GetOrRender(markdown, width,
+                [](const std::string& markdown, const std::string& path, const uint32_t width)
+                {
+                    static MetricHistogram& render_latency =
+                        GlobalMetrics().Histogram("lgtbot_markdown_to_image_latency_us");
+                    ScopedLatency latency(render_latency);
+                    TraceSpan span("MarkdownToImage");
+                    span.AddArg("bytes", markdown.size());
+                    return MarkdownToImage(markdown, path, width);
+                });
+        if (!image.has_value()) {
+            return; // the renderer has logged the failure
+        }
+        messages_.emplace_back(std::move(image->path_), LGTBot_MessageType::LGTBOT_MSG_IMAGE, std::move(image->pin_));
     }
 
     virtual void Flush() override
     {
-        std::vector<LGTBot_Message> raw_messages;
-        raw_messages.reserve(messages_.size());
-        for (const auto& message : messages_) {
-            raw_messages.emplace_back(message.str_.c_str(), message.type_);
-        }
-        callbacks_->handle_messages(handler_, id_.c_str(), is_to_user_, raw_messages.data(), raw_messages.size());
+        static MetricHistogram& flush_latency =
+            GlobalMetrics().Histogram("lgtbot_msg_flush_latency_us", {{"receiver", "single"}});
+        ScopedLatency latency(flush_latency);
+        TraceSpan span("MsgSender::Flush");
+        span.AddArg("message_num", messages_.size());
+        outbound_->Send(id_, is_to_user_, std::move(messages_));
         messages_.clear();
     }
 
@@ -193,19 +241,13 @@ class MsgSender : public MsgSenderBase
         SaveText(sv.data(), sv.size());
     }
 
-  private:
-    struct Message
-    {
-        std::string str_;
-        LGTBot_MessageType type_;
-    };
-    void* handler_;
-    const std::string* image_path_;
-    const LGTBot_Callback* callbacks_;
+    MarkdownImageCache* image_cache_ = nullptr;
+    UserNameCache* name_cache_ = nullptr;
+    OutboundPipeline* outbound_ = nullptr;
     std::string id_;
     bool is_to_user_;
     const Match* match_;
-    std::vector<Message> messages_;
+    std::vector<OutboundMessage> messages_;
 };
 
 MsgSenderBase::MsgSenderGuard::~MsgSenderGuard()
@@ -257,50 +299,39 @@ MsgSenderBase::MsgSenderGuard& MsgSenderBase::MsgSenderGuard::operator<<(const s
     return *this;
 }
 
-// `MsgSenderBatch` is a wrapper which support sending the same message to several `MsgSender`s. User-defined class `Fn`
-// should override the operator() which handles a function `sender_fn`. When we send something by `MsgSenderBatch`, it
-// will invoke the `fn_` and pass a function as `sender_fn`. The user-defined `Fn` would pass each `MsgSender` to the
-// `sender_fn` so that the message can be sent by each `MsgSender`.
+// `MsgSenderBatch` sends the same messages to several users. User-defined class `Fn` should override the operator()
+// which handles a function `receiver_fn`. When the messages are flushed, `MsgSenderBatch` will invoke the `fn_` and pass
+// a function as `receiver_fn`, and the user-defined `Fn` would pass the ID of each receiver to the `receiver_fn`.
+//
+// The messages are built only once regardless of the number of receivers, so a markdown is rendered once, and the
+// messages are delivered to all receivers by one `handle_messages_multi_` callback if it is set.
 template <typename Fn>
-class MsgSenderBatch : public MsgSenderBase
+class MsgSenderBatch : public MsgSender
 {
   public:
-    MsgSenderBatch(Fn&& fn) : fn_(std::forward<Fn>(fn)) {}
+    MsgSenderBatch(MarkdownImageCache& image_cache, UserNameCache& name_cache, OutboundPipeline& outbound, Fn&& fn,
+                   Match* const match = nullptr)
+        : MsgSender(image_cache, name_cache, outbound, match), fn_(std::forward<Fn>(fn)) {}
 
-  protected:
-    virtual void SaveText(const char* const data, const uint64_t len) override
-    {
-        fn_([&](MsgSenderBase& sender) { sender.SaveText(data, len); });
-    }
-
-    virtual void SaveUser(const UserID& uid, const bool is_at) override
-    {
-        fn_([&](MsgSenderBase& sender) { sender.SaveUser(uid.GetCStr(), is_at); });
-    }
-
-    virtual void SavePlayer(const PlayerID& pid, const bool is_at) override
-    {
-        fn_([&](MsgSenderBase& sender) { sender.SavePlayer(pid, is_at); });
-    }
-
-    virtual void SaveImage(const char* const path) override
+    virtual bool HasReceiver() const override
     {
-        fn_([&](MsgSenderBase& sender) { sender.SaveImage(path); });
+        bool has_receiver = false;
+        fn_([&](const UserID&) { has_receiver = true; });
+        return has_receiver;
     }
 
+  protected:
     virtual void Flush() override
     {
-        fn_([&](MsgSenderBase& sender) { sender.Flush(); });
-    }
-
-    virtual void SaveMarkdown(const char* const markdown, const uint32_t width) override
-    {
-        fn_([&](MsgSenderBase& sender) { sender.SaveMarkdown(markdown, width); });
-    };
-
-    virtual void SetMatch(const Match* const match) override
-    {
-        fn_([&](MsgSenderBase& sender) { sender.SetMatch(match); });
+        static MetricHistogram& flush_latency =
+            GlobalMetrics().Histogram("lgtbot_msg_flush_latency_us", {{"receiver", "batch"}});
+        ScopedLatency latency(flush_latency);
+        TraceSpan span("MsgSenderBatch::Flush");
+        span.AddArg("message_num", messages_.size());
+        std::vector<std::string> user_ids;
+        fn_([&](const UserID& uid) { user_ids.emplace_back(uid.GetStr()); });
+        outbound_->SendToUsers(std::move(user_ids), std::move(messages_));
+        messages_.clear();
     }
 
   private:
@@ -0,0 +1,249 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+#include "bot_core/outbound_pipeline.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "utility/log.h"
+
+static void UpdateMax(std::atomic<uint64_t>& max, const uint64_t value)
+{
+    for (uint64_t old = max.load(); old < value && !max.compare_exchange_weak(old, value); );
+}
+
+thread_local uint32_t OutboundPipeline::NonBlockingScope::depth_ = 0;
+thread_local std::vector<OutboundPipeline*> OutboundPipeline::NonBlockingScope::overflowed_pipelines_;
+
+OutboundPipeline::NonBlockingScope::~NonBlockingScope()
+{
+    if (--depth_ > 0) {
+        return;
+    }
+    for (OutboundPipeline* const pipeline : std::exchange(overflowed_pipelines_, {})) {
+        pipeline->WaitForOverflowedRoom_();
+    }
+}
+
+OutboundPipeline::OutboundPipeline(void* const handler, const LGTBot_Callback& callbacks, const Options& options)
+    : handler_(handler), callbacks_(callbacks), options_(options)
+{
+    for (uint32_t i = 0; i < options_.thread_num_; ++i) {
+        threads_.emplace_back([this] { WorkerLoop_(); });
+    }
+    InfoLog() << "Outbound pipeline started thread_num=" << options_.thread_num_
+              << " queue_capacity=" << options_.queue_capacity_ << " full_policy=" << options_.full_policy_;
+}
+
+OutboundPipeline::~OutboundPipeline()
+{
+    {
+        std::lock_guard<std::mutex> l(mutex_);
+        stop_ = true;
+    }
+    ready_cv_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void OutboundPipeline::Send(std::string id, const bool is_to_user, std::vector<OutboundMessage> messages)
+{
+    Batch batch{.messages_ = std::move(messages), .enqueue_time_ = Clock::now()};
+    if (threads_.empty()) {
+        ++queued_count_;
+        Deliver_(id, is_to_user, batch);
+        return;
+    }
+    std::unique_lock<std::mutex> l(mutex_);
+    if (!WaitForRoom_(l)) {
+        WarnLog() << "Outbound queue is full, drop messages id=" << id << " is_to_user=" << is_to_user;
+        return;
+    }
+    const auto [it, is_new] = destinations_.try_emplace(std::pair{std::move(id), is_to_user});
+    it->second.batches_.emplace_back(std::move(batch));
+    UpdateMax(max_pending_count_, ++pending_count_);
+    ++queued_count_;
+    if (is_new) {
+        ready_destinations_.emplace_back(it);
+        l.unlock();
+        ready_cv_.notify_one();
+    }
+}
+
+void OutboundPipeline::SendToUsers(std::vector<std::string> user_ids, std::vector<OutboundMessage> messages)
+{
+    // A user appearing twice would wait for the batch in its queue forever.
+    std::ranges::sort(user_ids);
+    user_ids.erase(std::unique(user_ids.begin(), user_ids.end()), user_ids.end());
+    if (!options_.handle_messages_multi_ || user_ids.size() <= 1) {
+        for (auto& id : user_ids) {
+            Send(std::move(id), true, messages);
+        }
+        return;
+    }
+    const uint32_t user_num = user_ids.size();
+    auto batch = std::make_shared<MultiBatch>(MultiBatch{
+            .user_ids_ = std::move(user_ids),
+            .messages_ = std::move(messages),
+            .enqueue_time_ = Clock::now(),
+            .waiting_num_ = user_num,
+        });
+    if (threads_.empty()) {
+        ++queued_count_;
+        DeliverMulti_(*batch);
+        return;
+    }
+    std::unique_lock<std::mutex> l(mutex_);
+    if (!WaitForRoom_(l)) {
+        WarnLog() << "Outbound queue is full, drop messages user_num=" << user_num;
+        return;
+    }
+    for (const auto& id : batch->user_ids_) {
+        const auto [it, is_new] = destinations_.try_emplace(std::pair{id, true});
+        it->second.batches_.emplace_back(Batch{.enqueue_time_ = batch->enqueue_time_, .multi_ = batch});
+        if (is_new) {
+            ready_destinations_.emplace_back(it);
+        }
+    }
+    UpdateMax(max_pending_count_, ++pending_count_);
+    ++queued_count_;
+    l.unlock();
+    ready_cv_.notify_all();
+}
+
+bool OutboundPipeline::WaitForRoom_(std::unique_lock<std::mutex>& l)
+{
+    if (options_.queue_capacity_ == 0 || pending_count_ < options_.queue_capacity_) {
+        return true;
+    }
+    if (options_.full_policy_ == LGTBOT_OUTBOUND_DROP_WHEN_FULL) {
+        ++dropped_count_;
+        return false;
+    }
+    if (NonBlockingScope::depth_ > 0) {
+        // The batch is queued at once to keep its order with batches sent by other threads later.
+        if (auto& pipelines = NonBlockingScope::overflowed_pipelines_;
+                std::ranges::find(pipelines, this) == pipelines.end()) {
+            pipelines.emplace_back(this);
+        }
+        return true;
+    }
+    ++blocked_count_;
+    room_cv_.wait(l, [this] { return pending_count_ < options_.queue_capacity_; });
+    return true;
+}
+
+void OutboundPipeline::WaitForOverflowedRoom_()
+{
+    std::unique_lock<std::mutex> l(mutex_);
+    if (pending_count_ >= options_.queue_capacity_) {
+        ++blocked_count_;
+        room_cv_.wait(l, [this] { return pending_count_ < options_.queue_capacity_; });
+    }
+}
+
+void OutboundPipeline::WorkerLoop_()
+{
+    std::unique_lock<std::mutex> l(mutex_);
+    while (true) {
+        ready_cv_.wait(l, [this] { return stop_ || !ready_destinations_.empty(); });
+        if (ready_destinations_.empty()) {
+            return; // we stop only when all messages are delivered
+        }
+        const auto it = ready_destinations_.front();
+        ready_destinations_.pop_front();
+        const Batch batch = std::move(it->second.batches_.front());
+        it->second.batches_.pop_front();
+        if (batch.multi_ && --batch.multi_->waiting_num_ > 0) {
+            // Some receivers have earlier messages to be delivered, the last receiver reaching the batch delivers it.
+            // Because a multi-receiver batch is put into all queues at once, receivers cannot wait for each other.
+            batch.multi_->parked_destinations_.emplace_back(it);
+            continue;
+        }
+        --pending_count_;
+        room_cv_.notify_one();
+
+        l.unlock();
+        if (batch.multi_) {
+            DeliverMulti_(*batch.multi_);
+        } else {
+            Deliver_(it->first.first, it->first.second, batch);
+        }
+        l.lock();
+
+        if (batch.multi_) {
+            for (const auto parked_it : batch.multi_->parked_destinations_) {
+                Release_(parked_it);
+            }
+        }
+        Release_(it);
+    }
+}
+
+void OutboundPipeline::Release_(const DestinationMap::iterator it)
+{
+    if (it->second.batches_.empty()) {
+        destinations_.erase(it);
+    } else {
+        // Put it back to the tail so that a busy destination does not starve others.
+        ready_destinations_.emplace_back(it);
+        ready_cv_.notify_one();
+    }
+}
+
+static std::vector<LGTBot_Message> ToRawMessages(const std::vector<OutboundMessage>& messages)
+{
+    std::vector<LGTBot_Message> raw_messages;
+    raw_messages.reserve(messages.size());
+    for (const auto& message : messages) {
+        raw_messages.emplace_back(message.str_.c_str(), message.type_);
+    }
+    return raw_messages;
+}
+
+void OutboundPipeline::Deliver_(const std::string& id, const bool is_to_user, const Batch& batch)
+{
+    const auto raw_messages = ToRawMessages(batch.messages_);
+    callbacks_.handle_messages(handler_, id.c_str(), is_to_user, raw_messages.data(), raw_messages.size());
+    OnDelivered_(batch.enqueue_time_);
+}
+
+void OutboundPipeline::DeliverMulti_(const MultiBatch& batch)
+{
+    const auto raw_messages = ToRawMessages(batch.messages_);
+    std::vector<const char*> raw_user_ids;
+    raw_user_ids.reserve(batch.user_ids_.size());
+    for (const auto& id : batch.user_ids_) {
+        raw_user_ids.emplace_back(id.c_str());
+    }
+    options_.handle_messages_multi_(handler_, raw_user_ids.data(), raw_user_ids.size(), raw_messages.data(),
+            raw_messages.size());
+    OnDelivered_(batch.enqueue_time_);
+}
+
+void OutboundPipeline::OnDelivered_(const Clock::time_point enqueue_time)
+{
+    const uint64_t latency_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - enqueue_time).count();
+    ++sent_count_;
+    total_latency_us_ += latency_us;
+    UpdateMax(max_latency_us_, latency_us);
+}
+
+LGTBot_OutboundMetrics OutboundPipeline::Metrics() const
+{
+    std::lock_guard<std::mutex> l(mutex_);
+    return LGTBot_OutboundMetrics{
+        .queued_count_ = queued_count_,
+        .sent_count_ = sent_count_,
+        .dropped_count_ = dropped_count_,
+        .blocked_count_ = blocked_count_,
+        .pending_count_ = pending_count_,
+        .max_pending_count_ = max_pending_count_,
+        .total_latency_us_ = total_latency_us_,
+        .max_latency_us_ = max_latency_us_,
+    };
+}
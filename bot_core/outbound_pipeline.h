@@ -0,0 +1,153 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "bot_core/bot_core.h"
+
+struct OutboundMessage
+{
+    std::string str_;
+    LGTBot_MessageType type_;
+    std::shared_ptr<void> pin_ = nullptr; // keep the cached image file until the message is delivered
+};
+
+// Deliver the flushed messages to the `handle_messages` callback.
+//
+// Each destination (a user or a group) has its own ordered queue, and at most one sender thread delivers messages of a
+// destination at any time, so messages of the same destination keep their order while different destinations are
+// delivered in parallel. If |thread_num_| is 0, messages are delivered in the thread which flushes them.
+//
+// Messages sent to several users are delivered once by the `handle_messages_multi_` callback. Such a batch is put into
+// the queue of each receiver, and it is delivered only when it reaches the front of all these queues, so it keeps its
+// order with other messages of each receiver.
+class OutboundPipeline
+{
+  public:
+    struct Options
+    {
+        uint32_t thread_num_ = 0;
+        uint32_t queue_capacity_ = 0; // 0 means no limit
+        LGTBot_OutboundFullPolicy full_policy_ = LGTBOT_OUTBOUND_BLOCK_WHEN_FULL;
+        // Optional, see `LGTBot_Option::handle_messages_multi_`.
+        void (*handle_messages_multi_)(void* handler, const char* const* user_ids, const size_t user_num,
+                const LGTBot_Message* messages, const size_t size) = nullptr;
+    };
+
+    // While a scope is alive in the current thread, sending messages never blocks for a full queue under the blocking
+    // policy. The messages are queued beyond the capacity instead, and the thread blocks until the queue has room when
+    // the outermost scope is released. It is used when the sender holds a lock, e.g. the lock of a match, so that a slow
+    // adapter cannot block other threads waiting for the lock.
+    class NonBlockingScope
+    {
+      public:
+        NonBlockingScope() { ++depth_; }
+        NonBlockingScope(const NonBlockingScope&) = delete;
+        NonBlockingScope(NonBlockingScope&&) = delete;
+        ~NonBlockingScope();
+
+      private:
+        friend class OutboundPipeline;
+
+        static thread_local uint32_t depth_;
+        static thread_local std::vector<OutboundPipeline*> overflowed_pipelines_;
+    };
+
+    OutboundPipeline(void* const handler, const LGTBot_Callback& callbacks, const Options& options);
+
+    OutboundPipeline(const OutboundPipeline&) = delete;
+    OutboundPipeline(OutboundPipeline&&) = delete;
+
+    // All queued messages are delivered before the pipeline is released.
+    ~OutboundPipeline();
+
+    void Send(std::string id, const bool is_to_user, std::vector<OutboundMessage> messages);
+
+    // Send the same messages to several users. If `handle_messages_multi_` is not set, the messages are sent to each user
+    // by `Send`.
+    void SendToUsers(std::vector<std::string> user_ids, std::vector<OutboundMessage> messages);
+
+    LGTBot_OutboundMetrics Metrics() const;
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Destination;
+
+    using DestinationMap = std::map<std::pair<std::string, bool>, Destination>; // key is (id, is_to_user)
+
+    struct MultiBatch
+    {
+        std::vector<std::string> user_ids_;
+        std::vector<OutboundMessage> messages_;
+        Clock::time_point enqueue_time_;
+        uint32_t waiting_num_; // the number of receivers whose queue front has not reached this batch
+        std::vector<DestinationMap::iterator> parked_destinations_; // receivers waiting for this batch to be delivered
+    };
+
+    struct Batch
+    {
+        std::vector<OutboundMessage> messages_;
+        Clock::time_point enqueue_time_;
+        std::shared_ptr<MultiBatch> multi_; // not null if the batch is sent to several users
+    };
+
+    struct Destination
+    {
+        std::deque<Batch> batches_;
+    };
+
+    // Return false if the batch should be dropped because the queue is full.
+    bool WaitForRoom_(std::unique_lock<std::mutex>& l);
+
+    // Block until the queue has room, which is invoked when the outermost `NonBlockingScope` is released.
+    void WaitForOverflowedRoom_();
+
+    void WorkerLoop_();
+
+    // REQUIRE: should be protected by mutex_
+    void Release_(const DestinationMap::iterator it);
+
+    void Deliver_(const std::string& id, const bool is_to_user, const Batch& batch);
+
+    void DeliverMulti_(const MultiBatch& batch);
+
+    void OnDelivered_(const Clock::time_point enqueue_time);
+
+    void* const handler_;
+    const LGTBot_Callback& callbacks_;
+    const Options options_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable ready_cv_; // notified when a destination is ready or the pipeline is stopping
+    std::condition_variable room_cv_; // notified when a batch leaves the queue
+    // A destination is in |destinations_| iff it has batches, is being delivered by a sender thread, or is waiting for a
+    // multi-receiver batch. It is in |ready_destinations_| iff it has batches and is neither being delivered nor waiting.
+    // A multi-receiver batch is counted once in |pending_count_|.
+    DestinationMap destinations_;
+    std::deque<DestinationMap::iterator> ready_destinations_;
+    uint64_t pending_count_ = 0;
+    bool stop_ = false;
+    std::vector<std::thread> threads_;
+
+    std::atomic<uint64_t> queued_count_{0};
+    std::atomic<uint64_t> sent_count_{0};
+    std::atomic<uint64_t> dropped_count_{0};
+    std::atomic<uint64_t> blocked_count_{0};
+    std::atomic<uint64_t> max_pending_count_{0};
+    std::atomic<uint64_t> total_latency_us_{0};
+    std::atomic<uint64_t> max_latency_us_{0};
+};
@@ -0,0 +1,94 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+#pragma once
+
+#include <array>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+// A hash map split into shards, each of which is protected by its own read-write lock, so lookups of different keys
+// from many threads do not contend on a single lock.
+template <typename Key, typename Value, size_t k_shard_num = 16, typename Hash = std::hash<Key>>
+class ShardedMap
+{
+    static_assert((k_shard_num & (k_shard_num - 1)) == 0, "the number of shards should be a power of 2");
+
+  public:
+    // Return a default constructed value if |key| does not exist.
+    Value Get(const Key& key) const
+    {
+        const auto& shard = GetShard_(key);
+        std::shared_lock<std::shared_mutex> l(shard.mutex_);
+        const auto it = shard.map_.find(key);
+        return it == shard.map_.end() ? Value{} : it->second;
+    }
+
+    // Return false if |key| already exists.
+    bool Insert(const Key& key, Value value)
+    {
+        auto& shard = GetShard_(key);
+        std::lock_guard<std::shared_mutex> l(shard.mutex_);
+        return shard.map_.emplace(key, std::move(value)).second;
+    }
+
+    bool Erase(const Key& key)
+    {
+        auto& shard = GetShard_(key);
+        std::lock_guard<std::shared_mutex> l(shard.mutex_);
+        return shard.map_.erase(key) > 0;
+    }
+
+    bool Contains(const Key& key) const
+    {
+        const auto& shard = GetShard_(key);
+        std::shared_lock<std::shared_mutex> l(shard.mutex_);
+        return shard.map_.contains(key);
+    }
+
+    // Each shard is locked when its elements are visited, so the elements are not a consistent snapshot of the map.
+    template <typename Fn>
+    void ForEach(Fn&& fn) const
+    {
+        for (const auto& shard : shards_) {
+            std::shared_lock<std::shared_mutex> l(shard.mutex_);
+            for (const auto& [key, value] : shard.map_) {
+                fn(key, value);
+            }
+        }
+    }
+
+    bool Empty() const
+    {
+        for (const auto& shard : shards_) {
+            std::shared_lock<std::shared_mutex> l(shard.mutex_);
+            if (!shard.map_.empty()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+  private:
+    // Align shards to cache lines so that locking a shard does not invalidate the lock of its neighbor.
+    struct alignas(64) Shard
+    {
+        mutable std::shared_mutex mutex_;
+        std::unordered_map<Key, Value, Hash> map_;
+    };
+
+    Shard& GetShard_(const Key& key) { return shards_[Index_(key)]; }
+    const Shard& GetShard_(const Key& key) const { return shards_[Index_(key)]; }
+
+    static size_t Index_(const Key& key)
+    {
+        // Mix the high half in because some hashes have poor low bits.
+        const size_t hash = Hash{}(key);
+        return (hash ^ (hash >> (sizeof(size_t) * 4))) & (k_shard_num - 1);
+    }
+
+    std::array<Shard, k_shard_num> shards_;
+};
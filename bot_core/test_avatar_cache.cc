@@ -0,0 +1,154 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "bot_core/avatar_cache.h"
+
+#ifdef _WIN32
+static const std::filesystem::path k_cache_dir = "TEMP_test_avatar_cache";
+#else
+static const std::filesystem::path k_cache_dir = "/tmp/lgtbot_test_avatar_cache";
+#endif
+
+class TestAvatarCache : public testing::Test
+{
+  public:
+    virtual void SetUp() override
+    {
+        std::filesystem::remove_all(k_cache_dir);
+        download_count_ = 0;
+        fallback_count_ = 0;
+    }
+
+  protected:
+    // Write |content| to the file if |succeed| is true.
+    UserAvatarCache::DownloadFn FakeDownload(const bool succeed, const std::string content = "avatar",
+            const std::chrono::milliseconds delay = std::chrono::milliseconds(0))
+    {
+        return [=, this](const std::string& path)
+            {
+                ++download_count_;
+                std::this_thread::sleep_for(delay);
+                if (succeed) {
+                    std::ofstream(path) << content;
+                }
+                return succeed;
+            };
+    }
+
+    UserAvatarCache::FallbackFn FakeFallback()
+    {
+        return [this](const std::string& path)
+            {
+                ++fallback_count_;
+                std::ofstream(path) << "fallback";
+            };
+    }
+
+    static std::string ReadFile(const std::string& path)
+    {
+        std::string content;
+        std::ifstream(path) >> content;
+        return content;
+    }
+
+    std::atomic<uint32_t> download_count_ = 0;
+    std::atomic<uint32_t> fallback_count_ = 0;
+};
+
+TEST_F(TestAvatarCache, download_once_before_expired)
+{
+    UserAvatarCache cache(k_cache_dir);
+    const auto path_1 = cache.GetOrDownload("123", FakeDownload(true), FakeFallback());
+    const auto path_2 = cache.GetOrDownload("123", FakeDownload(true), FakeFallback());
+    ASSERT_EQ(path_1, path_2);
+    ASSERT_EQ(1, download_count_);
+    ASSERT_EQ(0, fallback_count_);
+    ASSERT_EQ("avatar", ReadFile(path_1));
+    const auto stats = cache.GetStats();
+    ASSERT_EQ(1, stats.hit_count_);
+    ASSERT_EQ(1, stats.miss_count_);
+    ASSERT_EQ(0, stats.download_failed_count_);
+}
+
+TEST_F(TestAvatarCache, different_users_have_different_paths)
+{
+    UserAvatarCache cache(k_cache_dir);
+    const auto path_1 = cache.GetOrDownload("123", FakeDownload(true, "avatar1"), FakeFallback());
+    const auto path_2 = cache.GetOrDownload("456", FakeDownload(true, "avatar2"), FakeFallback());
+    ASSERT_NE(path_1, path_2);
+    ASSERT_EQ(2, download_count_);
+    ASSERT_EQ("avatar1", ReadFile(path_1));
+    ASSERT_EQ("avatar2", ReadFile(path_2));
+}
+
+TEST_F(TestAvatarCache, download_again_after_expired)
+{
+    UserAvatarCache cache(k_cache_dir, std::chrono::milliseconds(50));
+    cache.GetOrDownload("123", FakeDownload(true, "avatar1"), FakeFallback());
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    const auto path = cache.GetOrDownload("123", FakeDownload(true, "avatar2"), FakeFallback());
+    ASSERT_EQ(2, download_count_);
+    ASSERT_EQ("avatar2", ReadFile(path));
+    ASSERT_EQ(2, cache.GetStats().miss_count_);
+}
+
+TEST_F(TestAvatarCache, failed_download_is_not_retried_before_negative_ttl)
+{
+    UserAvatarCache cache(k_cache_dir, std::chrono::hours(1), std::chrono::milliseconds(50));
+    const auto path = cache.GetOrDownload("123", FakeDownload(false), FakeFallback());
+    cache.GetOrDownload("123", FakeDownload(false), FakeFallback());
+    ASSERT_EQ(1, download_count_);
+    ASSERT_EQ(1, fallback_count_);
+    ASSERT_EQ("fallback", ReadFile(path));
+    auto stats = cache.GetStats();
+    ASSERT_EQ(1, stats.negative_hit_count_);
+    ASSERT_EQ(1, stats.download_failed_count_);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    cache.GetOrDownload("123", FakeDownload(true), FakeFallback());
+    ASSERT_EQ(2, download_count_);
+    ASSERT_EQ("avatar", ReadFile(path));
+}
+
+TEST_F(TestAvatarCache, keep_outdated_avatar_if_download_failed)
+{
+    UserAvatarCache cache(k_cache_dir, std::chrono::milliseconds(0));
+    const auto path = cache.GetOrDownload("123", FakeDownload(true), FakeFallback());
+    cache.GetOrDownload("123", FakeDownload(false), FakeFallback());
+    ASSERT_EQ(2, download_count_);
+    ASSERT_EQ(0, fallback_count_);
+    ASSERT_EQ("avatar", ReadFile(path));
+}
+
+TEST_F(TestAvatarCache, concurrent_requests_download_once)
+{
+    constexpr static uint32_t k_thread_num = 8;
+    UserAvatarCache cache(k_cache_dir);
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < k_thread_num; ++i) {
+        threads.emplace_back([&] { cache.GetOrDownload("123", FakeDownload(true, "avatar", std::chrono::milliseconds(100)), FakeFallback()); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    ASSERT_EQ(1, download_count_);
+    const auto stats = cache.GetStats();
+    ASSERT_EQ(1, stats.miss_count_);
+    ASSERT_EQ(k_thread_num - 1, stats.hit_count_ + stats.wait_count_);
+    ASSERT_GE(stats.max_download_latency_us_, 100000);
+}
+
+int main(int argc, char** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
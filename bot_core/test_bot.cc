@@ -14,6 +14,8 @@ EXTEND_OPTION("时间限制", 时限, (ArithChecker<int>(0, 10)), 1)
 
 #include <future>
 #include <filesystem>
+#include <fstream>
+#include <sstream>
 
 #include <gtest/gtest.h>
 #include <gflags/gflags.h>
@@ -32,7 +34,6 @@ EXTEND_OPTION("时间限制", 时限, (ArithChecker<int>(0, 10)), 1)
 static_assert(TEST_BOT);
 
 std::condition_variable Timer::cv_;
-bool Timer::skip_timer_ = false;
 std::condition_variable Timer::remaining_thread_cv_;
 uint64_t Timer::remaining_thread_count_ = 0;
 std::mutex Timer::mutex_;
@@ -134,6 +135,19 @@ void HandleMessages(void* handler, const char* const id, const int is_uid, const
     std::cout << s << std::endl;
 }
 
+static std::atomic<uint32_t> multi_messages_count{0};
+static std::atomic<size_t> last_multi_messages_user_num{0};
+
+void HandleMessagesMulti(void* handler, const char* const* const user_ids, const size_t user_num,
+        const LGTBot_Message* const messages, const size_t size)
+{
+    ++multi_messages_count;
+    last_multi_messages_user_num = user_num;
+    for (size_t i = 0; i < user_num; ++i) {
+        HandleMessages(handler, user_ids[i], true, messages, size);
+    }
+}
+
 void GetUserName(void* handler, char* buffer, size_t size, const char* const user_id)
 {
     strncpy(buffer, user_id, size);
@@ -339,7 +353,7 @@ class SubStage : public SubGameStage<>
     uint32_t to_reset_ready_{0};
     std::set<PlayerID> to_reset_others_ready_players_;
     std::map<PlayerID, uint32_t> to_computer_failed_;
-    bool is_over_;
+    bool is_over_{false};
 };
 
 class MainStage : public MainGameStage<SubStage>
@@ -434,6 +448,78 @@ class AtomMainStage : public MainGameStage<>
     bool is_over_;
 };
 
+class MarkdownMainStage : public MainGameStage<>
+{
+  public:
+    MarkdownMainStage(StageUtility&& utility)
+        : StageFsm(std::move(utility),
+                MakeStageCommand(*this, "展示棋盘", &MarkdownMainStage::ShowBoard_, VoidChecker("展示棋盘")),
+                MakeStageCommand(*this, "延迟展示棋盘", &MarkdownMainStage::ShowBoardLazily_, VoidChecker("延迟展示棋盘")))
+    {}
+
+    virtual int64_t PlayerScore(const PlayerID pid) const override { return 0; };
+
+    static inline uint32_t boardcast_produced_count_ = 0;
+    static inline uint32_t tell_produced_count_ = 0;
+    static inline uint32_t ai_info_produced_count_ = 0;
+
+  private:
+    AtomReqErrCode ShowBoard_(const PlayerID pid, const bool is_public, MsgSenderBase& reply)
+    {
+        Global().Boardcast() << Markdown{"## 棋盘"};
+        return StageErrCode::OK;
+    }
+
+    AtomReqErrCode ShowBoardLazily_(const PlayerID pid, const bool is_public, MsgSenderBase& reply)
+    {
+        Global().Boardcast() << LazyMarkdown{[] { ++boardcast_produced_count_; return std::string("## 棋盘"); }};
+        for (PlayerID pid = 0; pid < Global().PlayerNum(); ++pid) {
+            Global().Tell(pid) << [] { ++tell_produced_count_; return "您的棋盘"; };
+        }
+        Global().BoardcastAiInfo([] { ++ai_info_produced_count_; return nlohmann::json{}; });
+        return StageErrCode::OK;
+    }
+};
+
+class EndlessMainStage;
+
+class EndlessSubStage : public StageFsm<EndlessMainStage>
+{
+  public:
+    EndlessSubStage(EndlessMainStage& main_stage)
+        : StageFsm(main_stage, "无尽子阶段",
+                MakeStageCommand(*this, "淘汰", &EndlessSubStage::Eliminate_, VoidChecker("淘汰")))
+    {}
+
+    virtual AtomReqErrCode OnComputerAct(const PlayerID pid, MsgSenderBase& reply) override
+    {
+        return StageErrCode::READY;
+    }
+
+  private:
+    AtomReqErrCode Eliminate_(const PlayerID pid, const bool is_public, MsgSenderBase& reply)
+    {
+        Global().Eliminate(pid);
+        return StageErrCode::OK;
+    }
+};
+
+// The game never ends because each round is followed by another one.
+class EndlessMainStage : public MainGameStage<EndlessSubStage>
+{
+  public:
+    EndlessMainStage(StageUtility&& utility) : StageFsm(std::move(utility)) {}
+
+    virtual void FirstStageFsm(SubStageFsmSetter setter) override { setter.Emplace<EndlessSubStage>(*this); }
+
+    virtual void NextStageFsm(EndlessSubStage& sub_stage, const CheckoutReason reason, SubStageFsmSetter setter) override
+    {
+        setter.Emplace<EndlessSubStage>(*this);
+    }
+
+    virtual int64_t PlayerScore(const PlayerID pid) const override { return 0; };
+};
+
 } // namespace GAME_MODULE_NAME
 
 } // namespace game
@@ -445,7 +531,16 @@ class TestBot : public testing::Test
   public:
     virtual void SetUp() override
     {
-        Timer::skip_timer_ = false;
+        clock_.SetAutoAdvance(false);
+        ResetBot(0);
+    }
+
+    MockDBManager& db_manager() { return *static_cast<MockDBManager*>(bot_->db_manager()); }
+
+  protected:
+    void ResetBot(const uint32_t match_thread_num, const uint32_t deduction_thread_num = 0,
+            const uint32_t deduction_budget_sec = 0)
+    {
         bot_.reset(new BotCtx(
                     "./", // game_path
                     "", // conf_path
@@ -463,12 +558,33 @@ class TestBot : public testing::Test
 #endif
                     MutableBotOption{},
                     nlohmann::json{},
-                    nullptr));
+                    nullptr,
+                    OutboundPipeline::Options{.handle_messages_multi_ = HandleMessagesMulti},
+                    match_thread_num,
+                    UserAvatarCache::k_default_ttl_sec,
+                    UserAvatarCache::k_default_negative_ttl_sec,
+                    UserNameCache::k_default_capacity,
+                    UserNameCache::k_default_ttl_sec,
+                    nullptr, // tracer
+                    "", // journal_path
+                    deduction_thread_num,
+                    deduction_budget_sec,
+                    &clock_));
     }
 
-    MockDBManager& db_manager() { return *static_cast<MockDBManager*>(bot_->db_manager()); }
+    // Wait until the match of |uid| is over, which may be fast-forwarded in background.
+    bool WaitMatchOver(const UserID& uid, const std::chrono::seconds timeout)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (bot_->match_manager().GetMatch(uid)) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return true;
+    }
 
-  protected:
     template <uint64_t k_max_player, class MyMainStage = lgtbot::game::GAME_MODULE_NAME::MainStage>
     void AddGame(const char* const name)
     {
@@ -479,8 +595,8 @@ class TestBot : public testing::Test
                         .module_name_ = name,
                         .developer_ = "测试开发者",
                         .description_ = "用来测试的游戏",
-                        .rule_ = "没有规则",
                         .achievements_{},
+                        .rule_fn_ = []() -> const char* { return "没有规则"; },
                         .max_player_num_fn_ = [](const lgtbot::game::GameOptionsBase*) -> uint64_t { return k_max_player; },
                         .multiple_fn_ = [](const lgtbot::game::GameOptionsBase*) -> uint32_t { return 1; },
                         .handle_rule_command_fn_ = [](const char*) -> const char* { return nullptr; },
@@ -516,11 +632,10 @@ class TestBot : public testing::Test
                     ));
     }
 
+    // Fire all the timers at once, including the ones started later, until |BlockTimer| is called.
     static void SkipTimer()
     {
-        std::unique_lock<std::mutex> l(Timer::mutex_);
-        Timer::skip_timer_ = true;
-        Timer::cv_.notify_all();
+        clock_.SetAutoAdvance(true);
     }
 
     static void WaitTimerThreadFinish()
@@ -538,7 +653,7 @@ class TestBot : public testing::Test
 
     static void BlockTimer()
     {
-        Timer::skip_timer_ = false;
+        clock_.SetAutoAdvance(false);
     }
 
     void NotifySubStage()
@@ -552,6 +667,9 @@ class TestBot : public testing::Test
         while (!substage_blocked_.load());
     }
 
+    // Timers are never fired unless |SkipTimer| is called, so tests are not affected by the real time.
+    static inline SimulatedClock clock_{false};
+
     std::unique_ptr<BotCtx, void(*)(void*)> bot_{nullptr, &LGTBot_Release};
 
 };
@@ -1338,6 +1456,20 @@ TEST_F(TestBot, substage_reset_timer)
   ASSERT_PRI_MSG(EC_OK, "1", "#新游戏 测试游戏");
 }
 
+TEST_F(TestBot, timeout_when_simulated_clock_reaches_deadline)
+{
+  AddGame<2, lgtbot::game::GAME_MODULE_NAME::AtomMainStage>("测试游戏");
+  ASSERT_PRI_MSG(EC_OK, "1", "#新游戏 测试游戏");
+  ASSERT_PRI_MSG(EC_OK, "2", "#加入 1");
+  ASSERT_PRI_MSG(EC_OK, "1", "#开始");
+  clock_.Advance(std::chrono::milliseconds(999));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  ASSERT_NE(nullptr, bot_->match_manager().GetMatch(UserID("1")));
+  clock_.Advance(std::chrono::milliseconds(1));
+  ASSERT_TRUE(WaitMatchOver(UserID("1"), std::chrono::seconds(5)));
+  WaitTimerThreadFinish();
+}
+
 TEST_F(TestBot, timeout_during_handle_request_checkout)
 {
   AddGame<2>("测试游戏");
@@ -1732,6 +1864,237 @@ TEST_F(TestBot, get_achievement)
   ASSERT_EQ("普通成就", db_manager().user_achievements_[UserID("2")][1]);
 }
 
+TEST_F(TestBot, deduce_in_background_when_all_users_eliminated)
+{
+  ResetBot(0, 1);
+  AddGame<3>("测试游戏");
+  ASSERT_PRI_MSG(EC_OK, "1", "#新游戏 测试游戏");
+  ASSERT_PRI_MSG(EC_OK, "1", "#替补至 3");
+  ASSERT_PRI_MSG(EC_OK, "2", ("#加入 1"));
+  ASSERT_PRI_MSG(EC_OK, "1", "#开始");
+  ASSERT_PRI_MSG(EC_GAME_REQUEST_OK, "1", "准备切换 5");
+  ASSERT_PRI_MSG(EC_GAME_REQUEST_OK, "1", "淘汰");
+  ASSERT_PRI_MSG(EC_GAME_REQUEST_CHECKOUT, "2", "淘汰");
+  ASSERT_TRUE(WaitMatchOver(UserID("1"), std::chrono::seconds(5)));
+  ASSERT_PRI_MSG(EC_OK, "1", "#新游戏 测试游戏");
+}
+
+TEST_F(TestBot, deduce_in_background_when_other_users_left_after_eliminated)
+{
+  ResetBot(0, 1);
+  AddGame<3>("测试游戏");
+  ASSERT_PRI_MSG(EC_OK, "1", "#新游戏 测试游戏");
+  ASSERT_PRI_MSG(EC_OK, "1", "#替补至 3");
+  ASSERT_PRI_MSG(EC_OK, "2", ("#加入 1"));
+  ASSERT_PRI_MSG(EC_OK, "1", "#开始");
+  ASSERT_PRI_MSG(EC_GAME_REQUEST_OK, "1", "准备切换 5");
+  ASSERT_PRI_MSG(EC_GAME_REQUEST_OK, "1", "淘汰");
+  auto& deduction_over_total = GlobalMetrics().Counter("lgtbot_deduction_total", {{"result", "over"}});
+  const auto deduction_over_num = deduction_over_total.Value();
+  ASSERT_PRI_MSG(EC_OK, "2", "#退出 强制");
+  ASSERT_TRUE(WaitMatchOver(UserID("1"), std::chrono::seconds(5)));
+  ASSERT_EQ(deduction_over_num + 1, deduction_over_total.Value());
+  ASSERT_PRI_MSG(EC_OK, "1", "#新游戏 测试游戏");
+}
+
+TEST_F(TestBot, deduction_exceeding_budget_is_terminated)
+{
+  ResetBot(0, 1, 1);
+  AddGame<2, lgtbot::game::GAME_MODULE_NAME::EndlessMainStage>("测试游戏");
+  ASSERT_PRI_MSG(EC_OK, "1", "#新游戏 测试游戏");
+  ASSERT_PRI_MSG(EC_OK, "1", "#替补至 2");
+  ASSERT_PRI_MSG(EC_OK, "1", "#开始");
+  const auto begin = std::chrono::steady_clock::now();
+  ASSERT_PRI_MSG(EC_GAME_REQUEST_CHECKOUT, "1", "淘汰");
+  ASSERT_TRUE(WaitMatchOver(UserID("1"), std::chrono::seconds(5)));
+  ASSERT_LE(std::chrono::seconds(1), std::chrono::steady_clock::now() - begin);
+#ifdef WITH_SQLITE
+  ASSERT_TRUE(db_manager().match_profiles_.empty());
+#endif
+}
+
+// Private Boardcast
+
+TEST_F(TestBot, pri_boardcast_markdown_render_once)
+{
+  AddGame<0, lgtbot::game::GAME_MODULE_NAME::MarkdownMainStage>("测试游戏");
+  uint32_t mid = 0;
+  for (const uint32_t user_num : {2, 5}) {
+    const auto uid = [user_num](const uint32_t i) { return std::to_string(user_num * 10 + i); };
+    const std::string join_cmd = "#加入 " + std::to_string(++mid);
+    ASSERT_PRI_MSG(EC_OK, uid(0).c_str(), "#新游戏 测试游戏");
+    for (uint32_t i = 1; i < user_num; ++i) {
+      ASSERT_PRI_MSG(EC_OK, uid(i).c_str(), join_cmd.c_str());
+    }
+    ASSERT_PRI_MSG(EC_OK, uid(0).c_str(), "#开始");
+
+    const auto stats_before = bot_->image_cache().GetStats();
+    const uint32_t multi_messages_count_before = multi_messages_count;
+    ASSERT_PRI_MSG(EC_GAME_REQUEST_OK, uid(0).c_str(), "展示棋盘");
+    const auto stats_after = bot_->image_cache().GetStats();
+    ASSERT_EQ(1, stats_after.hit_count_ + stats_after.miss_count_ - stats_before.hit_count_ - stats_before.miss_count_);
+    ASSERT_EQ(1, multi_messages_count - multi_messages_count_before);
+    ASSERT_EQ(user_num, last_multi_messages_user_num);
+  }
+}
+
+TEST_F(TestBot, pri_boardcast_lazy_messages_only_for_receivers)
+{
+  using lgtbot::game::GAME_MODULE_NAME::MarkdownMainStage;
+  AddGame<0, MarkdownMainStage>("测试游戏");
+  ASSERT_PRI_MSG(EC_OK, "1", "#新游戏 测试游戏");
+  ASSERT_PRI_MSG(EC_OK, "1", "#替补至 5");
+  ASSERT_PRI_MSG(EC_OK, "2", "#加入 1");
+  ASSERT_PRI_MSG(EC_OK, "1", "#开始");
+  MarkdownMainStage::boardcast_produced_count_ = 0;
+  MarkdownMainStage::tell_produced_count_ = 0;
+  MarkdownMainStage::ai_info_produced_count_ = 0;
+  ASSERT_PRI_MSG(EC_GAME_REQUEST_OK, "1", "延迟展示棋盘");
+  ASSERT_EQ(1, MarkdownMainStage::boardcast_produced_count_);
+  ASSERT_EQ(2, MarkdownMainStage::tell_produced_count_); // computers receive nothing
+  ASSERT_EQ(0, MarkdownMainStage::ai_info_produced_count_); // no AI users
+}
+
+// Match Executor
+
+static void SetRequestDone(void* const arg, const ErrCode rc)
+{
+  static_cast<std::promise<ErrCode>*>(arg)->set_value(rc);
+}
+
+#define ASSERT_PUB_MSG_ASYNC(ret_list, gid, uid, ...)\
+do\
+{\
+  const std::vector<const char*> msgs{__VA_ARGS__};\
+  std::vector<std::promise<ErrCode>> promises(msgs.size());\
+  for (size_t i = 0; i < msgs.size(); ++i) {\
+    std::cout << "[USER_" << uid <<  " -> GROUP_" << gid << " ASYNC]" << std::endl << msgs[i] << std::endl;\
+    LGTBot_HandlePublicRequestAsync(bot_.get(), (gid), (uid), msgs[i], SetRequestDone, &promises[i]);\
+  }\
+  std::vector<ErrCode> rets;\
+  for (auto& promise : promises) {\
+    rets.emplace_back(promise.get_future().get());\
+  }\
+  ASSERT_EQ(std::vector<ErrCode>(ret_list), rets);\
+} while (0)
+
+TEST_F(TestBot, async_requests_of_same_user_in_order)
+{
+  ResetBot(4);
+  AddGame<0>("测试游戏");
+  ASSERT_PUB_MSG_ASYNC((std::initializer_list<ErrCode>{EC_OK, EC_OK, EC_OK}), "1", "1",
+          "#新游戏 测试游戏", "#退出", "#新游戏 测试游戏");
+  ASSERT_PUB_MSG_ASYNC((std::initializer_list<ErrCode>{EC_OK, EC_MATCH_USER_ALREADY_IN_MATCH}), "1", "2",
+          "#加入", "#加入");
+  ASSERT_PUB_MSG_ASYNC((std::initializer_list<ErrCode>{EC_OK}), "1", "1", "#开始");
+}
+
+TEST_F(TestBot, async_requests_without_match_executor_are_handled_before_return)
+{
+  AddGame<2>("测试游戏");
+  std::promise<ErrCode> promise;
+  LGTBot_HandlePrivateRequestAsync(bot_.get(), "1", "#新游戏 测试游戏", SetRequestDone, &promise);
+  auto future = promise.get_future();
+  ASSERT_EQ(std::future_status::ready, future.wait_for(std::chrono::seconds(0)));
+  ASSERT_EQ(EC_OK, future.get());
+}
+
+TEST_F(TestBot, dump_metrics_of_handled_requests)
+{
+  AddGame<2>("测试游戏");
+  ASSERT_PUB_MSG(EC_OK, "1", "1", "#新游戏 测试游戏");
+  ASSERT_PUB_MSG(EC_REQUEST_NOT_FOUND, "1", "1", "#不存在的指令");
+  const size_t size = LGTBot_DumpMetrics(bot_.get(), LGTBOT_METRICS_PROMETHEUS, nullptr, 0);
+  std::string str(size, '\0');
+  ASSERT_EQ(size, LGTBot_DumpMetrics(bot_.get(), LGTBOT_METRICS_PROMETHEUS, str.data(), size + 1));
+  ASSERT_NE(std::string::npos, str.find("lgtbot_request_latency_us_count{type=\"public\"}"));
+  ASSERT_NE(std::string::npos, str.find("lgtbot_request_total{type=\"public\",errcode=\"EC_OK\"}"));
+  ASSERT_NE(std::string::npos, str.find("lgtbot_command_latency_us_count{type=\"meta\",command=\"#新游戏\"}"));
+  ASSERT_NE(std::string::npos, str.find("lgtbot_command_latency_us_count{type=\"meta\",command=\"unknown\"}"));
+  ASSERT_EQ(std::string::npos, str.find("#不存在的指令"));
+  ASSERT_NE(std::string::npos, str.find("lgtbot_match_count 1\n"));
+
+  char buffer[8];
+  ASSERT_EQ(LGTBot_DumpMetrics(bot_.get(), LGTBOT_METRICS_JSON, nullptr, 0),
+            LGTBot_DumpMetrics(bot_.get(), LGTBOT_METRICS_JSON, buffer, sizeof(buffer)));
+  ASSERT_STREQ("{\"count", buffer);
+}
+
+TEST_F(TestBot, record_journal_of_started_match)
+{
+  const std::string journal_path = "/tmp/lgtbot_test_bot/journal";
+  std::filesystem::remove_all(journal_path);
+  bot_->journal_path_ = journal_path;
+  AddGame<2>("测试游戏");
+  ASSERT_PUB_MSG(EC_OK, "1", "1", "#新游戏 测试游戏");
+  ASSERT_PUB_MSG(EC_OK, "1", "1", "#替补至 2");
+  ASSERT_PUB_MSG(EC_OK, "1", "1", "#开始");
+  const auto random_seed = bot_->match_manager().GetMatch(GroupID{"1"})->RandomSeed();
+  ASSERT_PUB_MSG(EC_GAME_REQUEST_OK, "1", "1", "准备切换 5");
+  ASSERT_PUB_MSG(EC_OK, "1", "1", "#退出 强制");
+
+  std::vector<std::filesystem::path> journal_files;
+  for (const auto& entry : std::filesystem::directory_iterator(journal_path)) {
+    journal_files.emplace_back(entry.path());
+  }
+  ASSERT_EQ(1, journal_files.size());
+  std::string errmsg;
+  const auto reader = MatchJournalReader::Open(journal_files[0].string(), errmsg);
+  ASSERT_NE(nullptr, reader) << errmsg;
+  ASSERT_EQ("测试游戏", reader->header().module_name_);
+  ASSERT_EQ(random_seed, reader->header().random_seed_);
+  ASSERT_EQ(1, reader->header().user_num_);
+  ASSERT_EQ(2, reader->header().bench_computers_to_player_num_);
+  bool has_request = false;
+  bool has_computer_act = false;
+  for (auto record = reader->Next(); record.has_value(); record = reader->Next()) {
+    if (record->type_ == MatchJournalRecord::Type::REQUEST) {
+      ASSERT_FALSE(has_request);
+      ASSERT_EQ(0, record->pid_);
+      ASSERT_TRUE(record->is_public_);
+      ASSERT_EQ("准备切换 5", record->msg_);
+      has_request = true;
+    } else {
+      ASSERT_EQ(MatchJournalRecord::Type::COMPUTER_ACT, record->type_);
+      ASSERT_EQ(1, record->pid_);
+      has_computer_act = true;
+    }
+  }
+  ASSERT_TRUE(has_request);
+  ASSERT_TRUE(has_computer_act);
+}
+
+TEST_F(TestBot, trace_requests_of_traced_match)
+{
+  ASSERT_PRI_MSG(EC_REQUEST_NO_TRACE_PATH, k_admin_qq, "%追踪");
+  const std::string trace_path = "/tmp/lgtbot_test_bot/trace.json";
+  bot_->tracer_ = std::make_unique<Tracer>(trace_path);
+  AddGame<2>("测试游戏");
+  ASSERT_PUB_MSG(EC_OK, "1", "1", "#新游戏 测试游戏");
+  ASSERT_PUB_MSG(EC_OK, "1", "2", "#加入");
+  ASSERT_PUB_MSG(EC_OK, "1", "1", "#开始");
+  ASSERT_PUB_MSG(EC_GAME_REQUEST_OK, "1", "2", "准备");
+  ASSERT_EQ(0, bot_->tracer()->GetStats().event_count_);
+
+  const auto mid = bot_->match_manager().GetMatch(GroupID{"1"})->MatchId();
+  ASSERT_PRI_MSG(EC_MATCH_NOT_EXIST, k_admin_qq, ("%追踪 比赛 " + std::to_string(mid + 1) + " 开启").c_str());
+  ASSERT_PRI_MSG(EC_OK, k_admin_qq, ("%追踪 比赛 " + std::to_string(mid) + " 开启").c_str());
+  ASSERT_PUB_MSG(EC_OK, "1", "3", "#游戏列表"); // not a request of the match
+  ASSERT_EQ(0, bot_->tracer()->GetStats().event_count_);
+  ASSERT_PUB_MSG(EC_GAME_REQUEST_OK, "1", "2", "准备");
+  bot_->tracer_.reset(); // close the file
+
+  std::ifstream file(trace_path);
+  std::stringstream ss;
+  ss << file.rdbuf();
+  std::set<std::string> names;
+  for (const auto& event : nlohmann::json::parse(ss.str())) {
+    names.emplace(event["name"]);
+  }
+  ASSERT_EQ((std::set<std::string>{"HandleRequest", "Match::Request", "MainStage::HandleRequest", "Match::Routine"}),
+            names);
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -3,15 +3,23 @@
 // This source code is licensed under LGPLv2 (found in the LICENSE file).
 
 #include <array>
+#include <atomic>
 #include <string_view>
 #include <map>
+#include <mutex>
+#include <regex>
+#include <set>
+#include <sstream>
 #include <filesystem>
+#include <fstream>
+#include <thread>
 
 #include <gtest/gtest.h>
 #include <gflags/gflags.h>
 
 #include "bot_core/db_manager.h"
 #include "sqlite_modern_cpp.h"
+#include "sqlite3.h"
 
 #ifdef _WIN32
 static const char* const k_db_path = "TEMP_test_db.db";
@@ -26,13 +34,16 @@ class TestDB : public testing::Test
 
     virtual void SetUp() override
     {
-        std::filesystem::remove(std::filesystem::path(k_db_path));
+        for (const char* const suffix : {"", "-wal", "-shm", ".records"}) {
+            std::filesystem::remove(std::filesystem::path(std::string(k_db_path) + suffix));
+        }
     }
 
   protected:
-    bool UseDB_()
+    bool UseDB_(const uint32_t flush_interval_ms = 0)
     {
-        return (db_manager_ = SQLiteDBManager::UseDB(k_db_path)) != nullptr;
+        return (db_manager_ = SQLiteDBManager::UseDB(k_db_path, SQLiteDBManager::k_default_reader_num,
+                        flush_interval_ms)) != nullptr;
     }
 
     std::unique_ptr<DBManagerBase> db_manager_;
@@ -59,10 +70,6 @@ class TestDB : public testing::Test
     ASSERT_EQ((top), profile.top_score_); \
 }()
 
-void RecordMatch(sqlite::database& db, const std::string& game_name, const std::optional<GroupID> gid,
-        const UserID host_uid, const uint64_t multiple, const std::vector<ScoreInfo>& score_infos,
-        const std::vector<std::pair<UserID, std::string>>& achievements);
-
 void RecordMatch(const std::string& game_name, const std::optional<GroupID> gid,
         const UserID host_uid, const uint64_t multiple, const std::vector<ScoreInfo>& score_infos,
         const std::vector<std::pair<UserID, std::string>>& achievements = std::vector<std::pair<UserID, std::string>>{})
@@ -194,6 +201,408 @@ TEST_F(TestDB, get_achievement_statisic)
     ASSERT_EQ(0, result.achieved_user_num_);
 }
 
+// A time range which is not one of `TimeRange`, so the scores are summed up from the match history.
+static const char* const k_history_time_range_begin = "datetime('now','-100 years')";
+
+static void RecordMatchesOfGames(DBManagerBase& db_manager)
+{
+    for (int i = 0; i < 5; ++i) {
+        db_manager.RecordMatch("g1", std::nullopt, "1", 1, {{"1", 10 * i}, {"2", 20}, {"3", 5}}, {});
+        db_manager.RecordMatch("g2", std::nullopt, "1", 2, {{"1", 3}, {"3", i}}, {});
+    }
+}
+
+#define ASSERT_AGGREGATES_EQ_HISTORY() \
+[&]() { \
+    for (const char* const uid : {"1", "2", "3"}) { \
+        const auto aggregate = db_manager_->GetUserProfile(UserID(uid), "", ""); \
+        const auto history = db_manager_->GetUserProfile(UserID(uid), k_history_time_range_begin, ""); \
+        ASSERT_EQ(history.match_count_, aggregate.match_count_); \
+        ASSERT_EQ(history.total_zero_sum_score_, aggregate.total_zero_sum_score_); \
+        ASSERT_EQ(history.total_top_score_, aggregate.total_top_score_); \
+        ASSERT_EQ(history.game_level_infos_.size(), aggregate.game_level_infos_.size()); \
+        for (size_t i = 0; i < history.game_level_infos_.size(); ++i) { \
+            ASSERT_EQ(history.game_level_infos_[i].game_name_, aggregate.game_level_infos_[i].game_name_); \
+            ASSERT_EQ(history.game_level_infos_[i].count_, aggregate.game_level_infos_[i].count_); \
+            ASSERT_DOUBLE_EQ(history.game_level_infos_[i].total_level_score_, \
+                    aggregate.game_level_infos_[i].total_level_score_); \
+        } \
+    } \
+    const auto aggregate_rank = db_manager_->GetRank("", ""); \
+    const auto history_rank = db_manager_->GetRank(k_history_time_range_begin, ""); \
+    ASSERT_EQ(history_rank.zero_sum_score_rank_.size(), aggregate_rank.zero_sum_score_rank_.size()); \
+    ASSERT_EQ(history_rank.top_score_rank_.size(), aggregate_rank.top_score_rank_.size()); \
+    ASSERT_EQ(history_rank.match_count_rank_, aggregate_rank.match_count_rank_); \
+    for (const char* const game_name : {"g1", "g2"}) { \
+        const auto aggregate_game_rank = db_manager_->GetLevelScoreRank(game_name, "", ""); \
+        const auto history_game_rank = db_manager_->GetLevelScoreRank(game_name, k_history_time_range_begin, ""); \
+        ASSERT_EQ(history_game_rank.level_score_rank_.size(), aggregate_game_rank.level_score_rank_.size()); \
+        ASSERT_EQ(history_game_rank.weight_level_score_rank_.size(), aggregate_game_rank.weight_level_score_rank_.size()); \
+        ASSERT_EQ(history_game_rank.match_count_rank_, aggregate_game_rank.match_count_rank_); \
+    } \
+}()
+
+TEST_F(TestDB, score_aggregates_equal_to_history)
+{
+    ASSERT_TRUE(UseDB_());
+    RecordMatchesOfGames(*db_manager_);
+    ASSERT_AGGREGATES_EQ_HISTORY();
+    // all matches are finished in this month and this year
+    for (const TimeRange time_range : {TimeRange(TimeRange::月), TimeRange(TimeRange::年)}) {
+        const auto profile = db_manager_->GetUserProfile(UserID("1"), k_time_range_begin_datetimes[time_range.ToUInt()],
+                k_time_range_end_datetimes[time_range.ToUInt()]);
+        ASSERT_EQ(10, profile.match_count_);
+        ASSERT_EQ(2, profile.game_level_infos_.size());
+    }
+}
+
+TEST_F(TestDB, score_aggregates_of_new_life_are_empty)
+{
+    ASSERT_TRUE(UseDB_());
+    RecordMatch("g1", std::nullopt, "1", 1, std::vector<ScoreInfo>{ScoreInfo(UserID("1"), 10, 10, 10)});
+    ASSERT_TRUE(db_manager_->Suicide(UserID("1"), 1));
+    ASSERT_TRUE(db_manager_->GetRank("", "").match_count_rank_.empty());
+    ASSERT_TRUE(db_manager_->GetLevelScoreRank("g1", "", "").level_score_rank_.empty());
+}
+
+TEST_F(TestDB, backfill_score_aggregates_when_open_db_without_them)
+{
+    ASSERT_TRUE(UseDB_());
+    RecordMatchesOfGames(*db_manager_);
+    db_manager_.reset();
+    {
+        // the database is recorded by the version before the score aggregates exist
+        sqlite::database db(k_db_path);
+        db << "DROP TABLE user_score_aggregate;";
+        db << "PRAGMA user_version = 1;";
+    }
+    ASSERT_TRUE(UseDB_());
+    ASSERT_AGGREGATES_EQ_HISTORY();
+}
+
+TEST_F(TestDB, concurrent_record_match_and_get_user_profile)
+{
+    static constexpr const uint32_t k_match_num = 50;
+    ASSERT_TRUE(UseDB_());
+    std::atomic<bool> is_finished = false;
+    std::vector<std::thread> readers;
+    for (uint32_t i = 0; i < SQLiteDBManager::k_default_reader_num * 2; ++i) {
+        readers.emplace_back([&]
+                {
+                    int64_t last_match_count = 0;
+                    while (!is_finished) {
+                        // each reader sees a committed snapshot, so the match count never decreases
+                        const auto match_count = db_manager_->GetUserProfile(UserID("1"), "", "").match_count_;
+                        EXPECT_LE(last_match_count, match_count);
+                        last_match_count = match_count;
+                    }
+                });
+    }
+    for (uint32_t i = 0; i < k_match_num; ++i) {
+        ASSERT_EQ(2, db_manager_->RecordMatch("g1", std::nullopt, "1", 1, {{"1", 10}, {"2", -10}}, {}).size());
+    }
+    is_finished = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    const auto profile = db_manager_->GetUserProfile(UserID("1"), "", "");
+    ASSERT_EQ(k_match_num, profile.match_count_);
+    ASSERT_EQ(10, profile.recent_matches_.size());
+}
+
+static std::vector<std::vector<ScoreInfo>> RecordMatchesOfUsers(DBManagerBase& db_manager)
+{
+    std::vector<std::vector<ScoreInfo>> score_infos;
+    for (int64_t i = 0; i < 20; ++i) {
+        score_infos.emplace_back(db_manager.RecordMatch(i % 3 ? "g1" : "g2", std::nullopt, "1", 1,
+                    {{"1", i * 10}, {"2", 50}, {std::to_string(i % 4 + 3), 100 - i * 10}}, {{"1", "a1"}}));
+    }
+    return score_infos;
+}
+
+#define ASSERT_SCORE_INFOS_EQ(expected, actual) \
+[&]() { \
+    ASSERT_EQ((expected).size(), (actual).size()); \
+    for (size_t i = 0; i < (expected).size(); ++i) { \
+        ASSERT_EQ((expected)[i].size(), (actual)[i].size()); \
+        for (size_t j = 0; j < (expected)[i].size(); ++j) { \
+            ASSERT_EQ((expected)[i][j].uid_, (actual)[i][j].uid_); \
+            ASSERT_EQ((expected)[i][j].zero_sum_score_, (actual)[i][j].zero_sum_score_); \
+            ASSERT_EQ((expected)[i][j].top_score_, (actual)[i][j].top_score_); \
+            ASSERT_EQ((expected)[i][j].level_score_, (actual)[i][j].level_score_); \
+            ASSERT_EQ((expected)[i][j].rank_score_, (actual)[i][j].rank_score_); \
+        } \
+    } \
+}()
+
+TEST_F(TestDB, write_behind_scores_equal_to_write_through)
+{
+    ASSERT_TRUE(UseDB_());
+    const auto expected_score_infos = RecordMatchesOfUsers(*db_manager_);
+    const auto expected_profile = db_manager_->GetUserProfile(UserID("1"), "", "");
+    const auto expected_achievement_count = db_manager_->GetAchievementStatistic(UserID("1"), "g1", "a1").count_;
+    db_manager_.reset();
+    SetUp();
+    ASSERT_TRUE(UseDB_(1000 * 3600));
+    const auto actual_score_infos = RecordMatchesOfUsers(*db_manager_);
+    ASSERT_SCORE_INFOS_EQ(expected_score_infos, actual_score_infos);
+    // queries wait for the recorded matches to be written
+    ASSERT_USER_PROFILE(UserID("1"), expected_profile.total_zero_sum_score_, expected_profile.total_top_score_, 20, 10,
+            expected_profile.recent_achievements_.size());
+    ASSERT_EQ(expected_achievement_count, db_manager_->GetAchievementStatistic(UserID("1"), "g1", "a1").count_);
+    ASSERT_EQ(6, db_manager_->GetRank("", "").match_count_rank_.size());
+}
+
+TEST_F(TestDB, write_behind_flush_in_background)
+{
+    ASSERT_TRUE(UseDB_(1));
+    ASSERT_EQ(1, db_manager_->RecordMatch("g1", std::nullopt, "1", 1, {{"1", 10}}, {}).size());
+    for (uint32_t match_count = 0; match_count == 0; ) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        sqlite::database db(k_db_path);
+        db << "SELECT COUNT(*) FROM match;" >> match_count;
+    }
+}
+
+TEST_F(TestDB, write_behind_replay_record_journal_once)
+{
+    const std::string record_journal_path = std::string(k_db_path) + ".records";
+    const std::string backup_path = record_journal_path + ".bak";
+    ASSERT_TRUE(UseDB_(1000 * 3600));
+    const auto expected_score_infos = RecordMatchesOfUsers(*db_manager_);
+    // the bot crashes before the matches are written
+    std::filesystem::copy_file(record_journal_path, backup_path, std::filesystem::copy_options::overwrite_existing);
+    db_manager_.reset();
+    SetUp();
+    std::filesystem::rename(backup_path, record_journal_path);
+    {
+        std::ofstream file(record_journal_path, std::ios::app);
+        file << "{\"seq\": 21, \"fini"; // the line being written when the bot crashes
+    }
+    ASSERT_TRUE(UseDB_(1000 * 3600));
+    ASSERT_EQ(20, db_manager_->GetUserProfile(UserID("1"), "", "").match_count_);
+    ASSERT_EQ(0, std::filesystem::file_size(record_journal_path));
+
+    // the matches which have been written are not replayed again
+    std::filesystem::copy_file(record_journal_path, backup_path, std::filesystem::copy_options::overwrite_existing);
+    db_manager_.reset();
+    {
+        std::ofstream file(record_journal_path, std::ios::trunc);
+        std::ifstream backup(backup_path);
+        file << backup.rdbuf();
+    }
+    ASSERT_TRUE(UseDB_(1000 * 3600));
+    ASSERT_EQ(20, db_manager_->GetUserProfile(UserID("1"), "", "").match_count_);
+    std::filesystem::remove(backup_path);
+}
+
+TEST_F(TestDB, write_behind_compact_record_journal_to_checkpoint)
+{
+    static constexpr const uint32_t k_match_num = 200;
+    const std::string record_journal_path = std::string(k_db_path) + ".records";
+    static const std::regex k_seq_regex("\"seq\":(\\d+)");
+    ASSERT_TRUE(UseDB_(1000 * 3600));
+    std::thread recorder([&]
+            {
+                for (uint32_t i = 0; i < k_match_num; ++i) {
+                    ASSERT_EQ(2, db_manager_->RecordMatch("g1", std::nullopt, "1", 1, {{"1", 10}, {"2", -10}}, {}).size());
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+            });
+    // matches are recorded while flushing, so the record journal is not empty after each flush
+    for (int64_t match_count = 0; match_count < k_match_num; ) {
+        match_count = db_manager_->GetUserProfile(UserID("1"), "", "").match_count_;
+        uint64_t written_seq = 0;
+        sqlite::database db(k_db_path);
+        db << "SELECT COALESCE(MAX(seq), 0) FROM record_journal_checkpoint;" >> written_seq;
+        EXPECT_EQ(match_count, written_seq);
+        std::ifstream file(record_journal_path);
+        for (std::string line; std::getline(file, line); ) {
+            std::smatch match;
+            if (std::regex_search(line, match, k_seq_regex)) {
+                // only the matches after the checkpoint are kept in the record journal
+                EXPECT_LT(written_seq, std::stoull(match[1].str())) << line;
+            }
+        }
+    }
+    recorder.join();
+    ASSERT_EQ(0, std::filesystem::file_size(record_journal_path));
+}
+
+TEST_F(TestDB, write_behind_evict_cached_history_after_flushing)
+{
+    ASSERT_TRUE(UseDB_(1000 * 3600));
+    const auto first_score_infos = db_manager_->RecordMatch("g1", std::nullopt, "1", 1, {{"1", 10}, {"2", 0}}, {});
+    for (uint32_t i = 0; i < 5; ++i) {
+        db_manager_->RecordMatch("g1", std::nullopt, "1", 1, {{"1", 10}, {"2", 0}}, {});
+    }
+    ASSERT_EQ(6, db_manager_->GetUserProfile(UserID("1"), "", "").match_count_);
+    {
+        sqlite::database db(k_db_path);
+        db << "DELETE FROM user_score_aggregate;";
+    }
+    // the history is read from the database instead of the cache after the matches are written
+    const auto score_infos = db_manager_->RecordMatch("g1", std::nullopt, "1", 1, {{"1", 10}, {"2", 0}}, {});
+    ASSERT_EQ(first_score_infos.size(), score_infos.size());
+    ASSERT_EQ(first_score_infos[0].level_score_, score_infos[0].level_score_);
+    ASSERT_EQ(first_score_infos[0].rank_score_, score_infos[0].rank_score_);
+}
+
+TEST_F(TestDB, write_behind_suicide_clear_cached_history)
+{
+    ASSERT_TRUE(UseDB_(1000 * 3600));
+    const auto first_life_score_infos = db_manager_->RecordMatch("g1", std::nullopt, "1", 1, {{"1", 10}, {"2", 0}}, {});
+    for (uint32_t i = 0; i < 5; ++i) {
+        db_manager_->RecordMatch("g1", std::nullopt, "1", 1, {{"1", 10}, {"2", 0}}, {});
+    }
+    ASSERT_TRUE(db_manager_->Suicide(UserID("1"), 1));
+    // the user begins a new life, so the score is calculated as the first match of the user
+    const auto second_life_score_infos = db_manager_->RecordMatch("g1", std::nullopt, "1", 1, {{"1", 10}, {"3", 0}}, {});
+    ASSERT_EQ(2, second_life_score_infos.size());
+    ASSERT_EQ(first_life_score_infos[0].level_score_, second_life_score_infos[0].level_score_);
+    ASSERT_EQ(first_life_score_infos[0].rank_score_, second_life_score_infos[0].rank_score_);
+    ASSERT_EQ(1, db_manager_->GetUserProfile(UserID("1"), "", "").match_count_);
+}
+
+DEFINE_uint32(query_plan_match_num, 2000, "The number of matches seeded for the query plan test, each of which has "
+        "5 users. The test `test_db_query_plan` seeds 200000 matches, i.e., 1 million rows in user_with_match");
+
+// Collects the SQL of the statements run by the connections opened after it is registered.
+class StatementCollector
+{
+  public:
+    StatementCollector() { sqlite3_auto_extension(reinterpret_cast<void(*)(void)>(&Register)); }
+
+    ~StatementCollector() { sqlite3_cancel_auto_extension(reinterpret_cast<void(*)(void)>(&Register)); }
+
+    std::set<std::string> Statements()
+    {
+        std::lock_guard<std::mutex> l(mutex_);
+        return statements_;
+    }
+
+  private:
+    static int Register(sqlite3* const db, char** const, const sqlite3_api_routines* const)
+    {
+        sqlite3_trace_v2(db, SQLITE_TRACE_STMT, &Trace, nullptr);
+        return SQLITE_OK;
+    }
+
+    static int Trace(const unsigned, void* const, void* const stmt, void* const)
+    {
+        std::lock_guard<std::mutex> l(mutex_);
+        statements_.emplace(sqlite3_sql(static_cast<sqlite3_stmt*>(stmt)));
+        return 0;
+    }
+
+    static inline std::mutex mutex_;
+    static inline std::set<std::string> statements_;
+};
+
+// The names of the results of CTEs and subqueries in |sql|, which are scanned after being materialized.
+static std::set<std::string> IntermediateResults(const std::string& sql)
+{
+    static const std::regex k_cte_regex("(\\w+) AS \\(");
+    static const std::regex k_subquery_regex("\\) AS (\\w+)");
+    std::set<std::string> names;
+    for (const std::regex* const regex : {&k_cte_regex, &k_subquery_regex}) {
+        for (auto it = std::sregex_iterator(sql.begin(), sql.end(), *regex); it != std::sregex_iterator(); ++it) {
+            names.emplace((*it)[1]);
+        }
+    }
+    return names;
+}
+
+// Fill the tables in a way similar to a long-running bot: 10000 users, 20 games, matches in the recent 1000 days.
+static void SeedDB(sqlite::database& db, const uint32_t match_num)
+{
+    db << "BEGIN;";
+    db << "WITH RECURSIVE seq(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM seq WHERE i < ?) "
+          "INSERT INTO match (match_id, game_name, finish_time, host_user_id, user_count, multiple) "
+          "SELECT i, 'g' || (i % 20), datetime('now', 'localtime', '-' || (i % 1000) || ' days'), 'u' || (i % 10000), 5, 1 "
+          "FROM seq;"
+       << match_num;
+    db << "INSERT INTO user_with_match "
+              "(user_id, birth_count, match_id, game_score, zero_sum_score, top_score, level_score, rank_score) "
+          "SELECT 'u' || ((match_id * 7 + k) % 10000), 0, match_id, k, k - 2, k, k * 0.5 - 1, k "
+          "FROM match, (SELECT 0 AS k UNION ALL SELECT 1 UNION ALL SELECT 2 UNION ALL SELECT 3 UNION ALL SELECT 4);";
+    db << "WITH RECURSIVE seq(i) AS (SELECT 0 UNION ALL SELECT i + 1 FROM seq WHERE i < 9999) "
+          "INSERT INTO user (user_id, birth_time, birth_count) SELECT 'u' || i, datetime('now', 'localtime'), 0 FROM seq;";
+    db << "INSERT INTO user_with_achievement (user_id, birth_count, match_id, achievement_name) "
+          "SELECT user_id, birth_count, match_id, 'a' || (match_id % 10) FROM user_with_match WHERE match_id % 10 = 0;";
+    db << "INSERT INTO honor (description, user_id, birth_count, time) "
+          "SELECT 'honor' || match_id, host_user_id, 0, finish_time FROM match WHERE match_id % 100 = 0;";
+    // let the next `UseDB` backfill the score aggregates
+    db << "PRAGMA user_version = 1;";
+    db << "COMMIT;";
+}
+
+TEST_F(TestDB, queries_not_scan_full_table)
+{
+    ASSERT_TRUE(UseDB_());
+    db_manager_.reset();
+    {
+        sqlite::database db(k_db_path);
+        SeedDB(db, FLAGS_query_plan_match_num);
+    }
+    ASSERT_TRUE(UseDB_()); // backfill the score aggregates, which is a full scan as expected
+    db_manager_.reset();
+    std::set<std::string> statements;
+    {
+        StatementCollector collector;
+        ASSERT_TRUE(UseDB_());
+        const char* const time_range_begins[] = {k_time_range_begin_datetimes[0], k_time_range_begin_datetimes[1],
+            k_time_range_begin_datetimes[2], "datetime('now', '-7 days')"};
+        const char* const time_range_ends[] = {k_time_range_end_datetimes[0], k_time_range_end_datetimes[1],
+            k_time_range_end_datetimes[2], "datetime('now')"};
+        for (uint32_t i = 0; i < std::size(time_range_begins); ++i) {
+            db_manager_->GetUserProfile(UserID("u1"), time_range_begins[i], time_range_ends[i]);
+            db_manager_->GetRank(time_range_begins[i], time_range_ends[i]);
+            db_manager_->GetLevelScoreRank("g1", time_range_begins[i], time_range_ends[i]);
+        }
+        db_manager_->RecordMatch("g1", GroupID("1"), "u1", 1, {{"u1", 10}, {"u2", -10}}, {{"u1", "a1"}});
+        db_manager_->GetAchievementStatistic(UserID("u1"), "g1", "a1");
+        db_manager_->AddHonor(UserID("u1"), "honor");
+        db_manager_->GetHonors("honor", 10);
+        db_manager_->DeleteHonor(1);
+        db_manager_->Suicide(UserID("u1"), 10);
+        db_manager_.reset();
+        statements = collector.Statements();
+    }
+
+    sqlite::database db(k_db_path);
+    uint32_t query_num = 0;
+    for (const auto& sql : statements) {
+        if (!sql.starts_with("SELECT") && !sql.starts_with("WITH") && !sql.starts_with("INSERT") &&
+                !sql.starts_with("UPDATE") && !sql.starts_with("DELETE")) {
+            continue;
+        }
+        if (sql.find("FROM honor WHERE description like") != std::string::npos) {
+            continue; // searching honors by keywords cannot use any index
+        }
+        ++query_num;
+        const auto intermediate_results = IntermediateResults(sql);
+        db << "EXPLAIN QUERY PLAN " + sql >> [&](const int32_t id, const int32_t parent, const int32_t, std::string detail)
+            {
+                std::istringstream detail_ss(detail);
+                std::string op, name;
+                detail_ss >> op >> name;
+                if (name == "TABLE") {
+                    detail_ss >> name; // the format of SQLite before 3.36
+                }
+                // Any scan without an index is a full scan, including scans of a table by its alias. Only the
+                // intermediate results, whose rows are searched by their own plans, are allowed to be scanned.
+                static const std::regex k_using_index_regex(" USING .*INDEX ");
+                const bool is_intermediate_result = name == "CONSTANT" || name.starts_with("(subquery-") ||
+                    intermediate_results.contains(name);
+                const bool is_full_scan = op == "SCAN" && !std::regex_search(detail, k_using_index_regex) &&
+                    !is_intermediate_result;
+                EXPECT_FALSE(is_full_scan) << "Full table scan: " << detail << "\nSQL: " << sql;
+            };
+    }
+    ASSERT_LT(20, query_num);
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,154 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+#include <filesystem>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+#include "bot_core/image_cache.h"
+
+#ifdef _WIN32
+static const std::filesystem::path k_cache_dir = "TEMP_test_image_cache";
+#else
+static const std::filesystem::path k_cache_dir = "/tmp/lgtbot_test_image_cache";
+#endif
+
+class TestImageCache : public testing::Test
+{
+  public:
+    virtual void SetUp() override
+    {
+        std::filesystem::remove_all(k_cache_dir);
+        render_count_ = 0;
+    }
+
+  protected:
+    // Write a file of |markdown.size()| bytes.
+    MarkdownImageCache::RenderFn FakeRender()
+    {
+        return [this](const std::string& markdown, const std::string& path, const uint32_t width)
+            {
+                ++render_count_;
+                std::ofstream(path) << markdown;
+                return 0;
+            };
+    }
+
+    uint32_t render_count_ = 0;
+};
+
+TEST_F(TestImageCache, render_once_for_same_content)
+{
+    MarkdownImageCache cache(k_cache_dir);
+    const auto path_1 = cache.GetOrRender("hello", 100, FakeRender())->path_;
+    const auto path_2 = cache.GetOrRender("hello", 100, FakeRender())->path_;
+    ASSERT_EQ(path_1, path_2);
+    ASSERT_EQ(1, render_count_);
+    ASSERT_TRUE(std::filesystem::exists(path_1));
+    const auto stats = cache.GetStats();
+    ASSERT_EQ(1, stats.hit_count_);
+    ASSERT_EQ(1, stats.miss_count_);
+    ASSERT_EQ(1, stats.file_count_);
+    ASSERT_EQ(5, stats.total_bytes_);
+}
+
+TEST_F(TestImageCache, different_width_or_markdown_has_different_path)
+{
+    MarkdownImageCache cache(k_cache_dir);
+    const auto path_1 = cache.GetOrRender("hello", 100, FakeRender())->path_;
+    const auto path_2 = cache.GetOrRender("hello", 200, FakeRender())->path_;
+    const auto path_3 = cache.GetOrRender("world", 100, FakeRender())->path_;
+    ASSERT_NE(path_1, path_2);
+    ASSERT_NE(path_1, path_3);
+    ASSERT_NE(path_2, path_3);
+    ASSERT_EQ(3, render_count_);
+}
+
+TEST_F(TestImageCache, key_is_murmur3_128_seeded_by_width)
+{
+    ASSERT_EQ("cbd8a7b341bd9b025b1e906a48ae1d19", MarkdownImageCache::Key("hello", 0));
+    ASSERT_EQ("977daa0afaf143765a0772ba8eb4761d", MarkdownImageCache::Key(std::string(37, 'a'), 100));
+    ASSERT_EQ("fc6c862ba3533d89b0c5bb83ee9f01ec", MarkdownImageCache::Key("渲染后的图片渲染后的图片渲染后的图片", 800));
+}
+
+TEST_F(TestImageCache, evict_least_recently_used)
+{
+    MarkdownImageCache cache(k_cache_dir, 10);
+    const auto path_1 = cache.GetOrRender("aaaa", 100, FakeRender())->path_;
+    const auto path_2 = cache.GetOrRender("bbbb", 100, FakeRender())->path_;
+    cache.GetOrRender("aaaa", 100, FakeRender()); // now "bbbb" is the least recently used
+    const auto path_3 = cache.GetOrRender("cccc", 100, FakeRender())->path_;
+    ASSERT_TRUE(std::filesystem::exists(path_1));
+    ASSERT_FALSE(std::filesystem::exists(path_2));
+    ASSERT_TRUE(std::filesystem::exists(path_3));
+    const auto stats = cache.GetStats();
+    ASSERT_EQ(1, stats.evict_count_);
+    ASSERT_EQ(2, stats.file_count_);
+    ASSERT_EQ(8, stats.total_bytes_);
+}
+
+TEST_F(TestImageCache, keep_pinned_file_even_if_too_large)
+{
+    MarkdownImageCache cache(k_cache_dir, 1);
+    auto image = cache.GetOrRender("hello", 100, FakeRender());
+    ASSERT_TRUE(image.has_value());
+    ASSERT_TRUE(std::filesystem::exists(image->path_));
+    const auto path = image->path_;
+    image.reset(); // the image is sent
+    ASSERT_FALSE(std::filesystem::exists(path));
+    ASSERT_EQ(1, cache.GetStats().evict_count_);
+}
+
+TEST_F(TestImageCache, not_evict_pinned_file)
+{
+    MarkdownImageCache cache(k_cache_dir, 10);
+    const auto image_1 = cache.GetOrRender("aaaa", 100, FakeRender()); // the image is being sent
+    const auto path_2 = cache.GetOrRender("bbbb", 100, FakeRender())->path_;
+    const auto path_3 = cache.GetOrRender("cccc", 100, FakeRender())->path_;
+    ASSERT_TRUE(std::filesystem::exists(image_1->path_));
+    ASSERT_FALSE(std::filesystem::exists(path_2));
+    ASSERT_TRUE(std::filesystem::exists(path_3));
+    ASSERT_EQ(1, cache.GetStats().evict_count_);
+}
+
+TEST_F(TestImageCache, load_files_saved_by_previous_run)
+{
+    std::string path;
+    {
+        MarkdownImageCache cache(k_cache_dir);
+        path = cache.GetOrRender("hello", 100, FakeRender())->path_;
+    }
+    std::ofstream(k_cache_dir / "broken.png.0.tmp") << "broken";
+    MarkdownImageCache cache(k_cache_dir);
+    ASSERT_EQ(path, cache.GetOrRender("hello", 100, FakeRender())->path_);
+    ASSERT_EQ(1, render_count_);
+    ASSERT_FALSE(std::filesystem::exists(k_cache_dir / "broken.png.0.tmp"));
+}
+
+TEST_F(TestImageCache, rerender_when_file_is_removed)
+{
+    MarkdownImageCache cache(k_cache_dir);
+    const auto path = cache.GetOrRender("hello", 100, FakeRender())->path_;
+    std::filesystem::remove(path);
+    ASSERT_EQ(path, cache.GetOrRender("hello", 100, FakeRender())->path_);
+    ASSERT_EQ(2, render_count_);
+    ASSERT_TRUE(std::filesystem::exists(path));
+}
+
+TEST_F(TestImageCache, not_cache_when_render_failed)
+{
+    MarkdownImageCache cache(k_cache_dir);
+    const auto render_nothing = [this](const std::string&, const std::string&, const uint32_t) { ++render_count_; return -1; };
+    ASSERT_FALSE(cache.GetOrRender("hello", 100, render_nothing).has_value());
+    ASSERT_FALSE(cache.GetOrRender("hello", 100, render_nothing).has_value());
+    ASSERT_EQ(2, render_count_);
+    ASSERT_EQ(0, cache.GetStats().file_count_);
+}
+
+int main(int argc, char** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,169 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "bot_core/markdown_renderer.h"
+
+#ifdef __linux__
+
+// When the test binary is started with '--output', it acts as a fake markdown2image which writes the width and the
+// markdown to the output file. The markdown "fail" makes it exit with an error and "hang" makes it sleep after writing
+// part of the image.
+static int FakeRendererMain(const char* const path, const char* const width)
+{
+    const std::string markdown{std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>()};
+    if (markdown == "fail") {
+        return 1;
+    }
+    std::ofstream ofs(path);
+    if (markdown == "hang") {
+        ofs << "partial" << std::flush;
+        std::this_thread::sleep_for(std::chrono::seconds(10));
+    }
+    ofs << width << " " << markdown;
+    return 0;
+}
+
+static const std::filesystem::path k_image_dir = "/tmp/lgtbot_test_markdown_renderer";
+
+class TestMarkdownRenderer : public testing::Test
+{
+  public:
+    virtual void SetUp() override
+    {
+        std::filesystem::remove_all(k_image_dir);
+        std::filesystem::create_directories(k_image_dir);
+    }
+
+  protected:
+    static MarkdownRenderer::Options FakeOptions()
+    {
+        return MarkdownRenderer::Options{
+            .command_ = std::filesystem::canonical("/proc/self/exe").string(),
+            .max_running_num_ = 2,
+            .max_waiting_num_ = 4,
+            .timeout_ = std::chrono::milliseconds(2000),
+        };
+    }
+
+    static std::string ImagePath(const std::string& name) { return (k_image_dir / name).string(); }
+
+    static std::string ReadImage(const std::string& name)
+    {
+        std::stringstream ss;
+        ss << std::ifstream(ImagePath(name)).rdbuf();
+        return ss.str();
+    }
+};
+
+TEST_F(TestMarkdownRenderer, render)
+{
+    MarkdownRenderer renderer(FakeOptions());
+    ASSERT_EQ(0, renderer.Render("hello", ImagePath("1.png"), 100));
+    ASSERT_EQ(0, renderer.Render("world", ImagePath("2.png"), 200));
+    ASSERT_EQ("100 hello", ReadImage("1.png"));
+    ASSERT_EQ("200 world", ReadImage("2.png"));
+}
+
+TEST_F(TestMarkdownRenderer, render_large_markdown)
+{
+    MarkdownRenderer renderer(FakeOptions());
+    const std::string markdown(4 << 20, 'a'); // larger than the buffer of the socket
+    ASSERT_EQ(0, renderer.Render(markdown, ImagePath("1.png"), 100));
+    ASSERT_EQ("100 " + markdown, ReadImage("1.png"));
+}
+
+TEST_F(TestMarkdownRenderer, render_concurrently)
+{
+    MarkdownRenderer renderer(FakeOptions());
+    std::vector<std::future<int>> futures;
+    for (int i = 0; i < 6; ++i) {
+        futures.emplace_back(std::async(std::launch::async,
+                    [&renderer, i] { return renderer.Render(std::to_string(i), ImagePath(std::to_string(i) + ".png"), i); }));
+    }
+    for (int i = 0; i < 6; ++i) {
+        ASSERT_EQ(0, futures[i].get());
+        ASSERT_EQ(std::to_string(i) + " " + std::to_string(i), ReadImage(std::to_string(i) + ".png"));
+    }
+}
+
+TEST_F(TestMarkdownRenderer, fail_when_renderer_fails)
+{
+    MarkdownRenderer renderer(FakeOptions());
+    ASSERT_NE(0, renderer.Render("fail", ImagePath("1.png"), 100));
+    ASSERT_FALSE(std::filesystem::exists(ImagePath("1.png")));
+}
+
+TEST_F(TestMarkdownRenderer, fail_when_renderer_not_exist)
+{
+    auto options = FakeOptions();
+    options.command_ = ImagePath("not_exist");
+    MarkdownRenderer renderer(std::move(options));
+    ASSERT_NE(0, renderer.Render("hello", ImagePath("1.png"), 100));
+}
+
+TEST_F(TestMarkdownRenderer, kill_renderer_when_timeout)
+{
+    auto options = FakeOptions();
+    options.timeout_ = std::chrono::milliseconds(500);
+    MarkdownRenderer renderer(std::move(options));
+    const auto begin = std::chrono::steady_clock::now();
+    ASSERT_NE(0, renderer.Render("hang", ImagePath("1.png"), 100));
+    ASSERT_LT(std::chrono::steady_clock::now() - begin, std::chrono::seconds(5));
+    ASSERT_FALSE(std::filesystem::exists(ImagePath("1.png"))); // the partial image is removed
+    ASSERT_EQ(0, renderer.Render("hello", ImagePath("2.png"), 100));
+    ASSERT_EQ("100 hello", ReadImage("2.png"));
+}
+
+TEST_F(TestMarkdownRenderer, reject_when_too_many_waiting_requests)
+{
+    auto options = FakeOptions();
+    options.max_running_num_ = 1;
+    options.max_waiting_num_ = 0;
+    MarkdownRenderer renderer(std::move(options));
+    auto fut = std::async(std::launch::async, [&renderer] { return renderer.Render("hang", ImagePath("1.png"), 100); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(200)); // wait the renderer busy
+    const auto begin = std::chrono::steady_clock::now();
+    ASSERT_NE(0, renderer.Render("hello", ImagePath("2.png"), 100));
+    ASSERT_LT(std::chrono::steady_clock::now() - begin, std::chrono::milliseconds(200)); // rejected at once
+    fut.wait();
+}
+
+TEST_F(TestMarkdownRenderer, wait_for_the_running_renderer)
+{
+    auto options = FakeOptions();
+    options.max_running_num_ = 1;
+    options.max_waiting_num_ = 1;
+    options.timeout_ = std::chrono::milliseconds(500);
+    MarkdownRenderer renderer(std::move(options));
+    auto fut = std::async(std::launch::async, [&renderer] { return renderer.Render("hang", ImagePath("1.png"), 100); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(200)); // wait the renderer busy
+    // the request waits until the hanging renderer is killed, which happens before its own deadline
+    ASSERT_EQ(0, renderer.Render("hello", ImagePath("2.png"), 100));
+    ASSERT_EQ("100 hello", ReadImage("2.png"));
+    ASSERT_NE(0, fut.get());
+}
+
+#endif
+
+int main(int argc, char** argv)
+{
+#ifdef __linux__
+    if (argc > 4 && std::strcmp(argv[1], "--output") == 0) {
+        return FakeRendererMain(argv[2], argv[4]);
+    }
+#endif
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
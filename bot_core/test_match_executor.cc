@@ -0,0 +1,218 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "bot_core/match_executor.h"
+
+TEST(TestMatchExecutor, mailbox_runs_tasks_one_by_one_in_order)
+{
+    static constexpr const uint32_t k_task_num = 10000;
+    auto pool = WorkStealingPool::Make(4);
+    const auto mailbox = Mailbox::Make(pool);
+    std::vector<uint32_t> results;
+    std::atomic<uint32_t> running_num{0};
+    std::atomic<bool> has_concurrent_tasks{false};
+    for (uint32_t i = 0; i < k_task_num; ++i) {
+        mailbox->Post([&, i]
+                {
+                    if (++running_num > 1) {
+                        has_concurrent_tasks = true;
+                    }
+                    results.emplace_back(i);
+                    --running_num;
+                });
+    }
+    pool->Stop();
+    ASSERT_FALSE(has_concurrent_tasks);
+    ASSERT_EQ(k_task_num, results.size());
+    for (uint32_t i = 0; i < k_task_num; ++i) {
+        ASSERT_EQ(i, results[i]);
+    }
+}
+
+TEST(TestMatchExecutor, mailboxes_run_in_parallel)
+{
+    auto pool = WorkStealingPool::Make(2);
+    const auto mailbox_1 = Mailbox::Make(pool);
+    const auto mailbox_2 = Mailbox::Make(pool);
+    std::promise<void> promise;
+    auto future = promise.get_future();
+    std::atomic<bool> is_done{false};
+    mailbox_1->Post([&] { is_done = future.wait_for(std::chrono::seconds(10)) == std::future_status::ready; });
+    mailbox_2->Post([&] { promise.set_value(); }); // the first mailbox is blocked until this task is run
+    pool->Stop();
+    ASSERT_TRUE(is_done);
+}
+
+TEST(TestMatchExecutor, busy_mailbox_not_starve_others)
+{
+    auto pool = WorkStealingPool::Make(1);
+    const auto gate_mailbox = Mailbox::Make(pool);
+    const auto busy_mailbox = Mailbox::Make(pool);
+    const auto other_mailbox = Mailbox::Make(pool);
+    std::promise<void> gate;
+    gate_mailbox->Post([future = gate.get_future().share()] { future.wait(); }); // block the only thread
+    std::atomic<bool> other_is_run{false};
+    std::atomic<uint32_t> busy_run_num_before_other{0};
+    std::function<void()> busy_task = [&]
+        {
+            if (!other_is_run) {
+                ++busy_run_num_before_other;
+                busy_mailbox->Post(busy_task); // always has a task
+            }
+        };
+    busy_mailbox->Post(busy_task);
+    other_mailbox->Post([&] { other_is_run = true; });
+    gate.set_value();
+    pool->Stop();
+    ASSERT_TRUE(other_is_run);
+    ASSERT_LT(busy_run_num_before_other, 100);
+}
+
+TEST(TestMatchExecutor, run_in_current_thread_after_stop)
+{
+    auto pool = WorkStealingPool::Make(2);
+    const auto mailbox = Mailbox::Make(pool);
+    pool->Stop();
+    std::thread::id thread_id;
+    mailbox->Post([&] { thread_id = std::this_thread::get_id(); });
+    ASSERT_EQ(std::this_thread::get_id(), thread_id);
+}
+
+TEST(TestMatchExecutor, start_one_thread_if_thread_num_is_zero)
+{
+    auto pool = WorkStealingPool::Make(0);
+    std::promise<std::thread::id> thread_id;
+    pool->Submit([&] { thread_id.set_value(std::this_thread::get_id()); });
+    ASSERT_NE(std::this_thread::get_id(), thread_id.get_future().get());
+}
+
+TEST(TestMatchExecutor, release_pool_in_its_own_task)
+{
+    auto pool = WorkStealingPool::Make(2);
+    std::promise<void> released;
+    pool->Submit([&pool, &released]
+            {
+                pool = nullptr; // the last reference
+                released.set_value();
+            });
+    released.get_future().wait();
+    ASSERT_EQ(nullptr, pool);
+}
+
+TEST(TestMatchExecutor, user_task_not_overtake_former_tasks_in_match_mailbox)
+{
+    MatchExecutor executor(2);
+    const auto match_mailbox = executor.MakeMailbox();
+    std::promise<void> blocker;
+    std::promise<void> done;
+    std::mutex mutex;
+    std::vector<int> order;
+    match_mailbox->Post([future = blocker.get_future().share()] { future.wait(); });
+    executor.UserMailbox(UserID("1")).Post([&]
+            {
+                executor.RouteUserTask(UserID("1"), match_mailbox, [&] { std::lock_guard l(mutex); order.emplace_back(1); });
+            });
+    executor.UserMailbox(UserID("1")).Post([&]
+            {
+                // the user has left the match, but the former task is not finished
+                executor.RouteUserTask(UserID("1"), nullptr, [&]
+                        {
+                            {
+                                std::lock_guard l(mutex);
+                                order.emplace_back(2);
+                            }
+                            done.set_value();
+                        });
+            });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    blocker.set_value();
+    done.get_future().wait();
+    ASSERT_EQ((std::vector<int>{1, 2}), order);
+    executor.Stop();
+}
+
+TEST(TestMatchExecutor, user_task_run_directly_without_former_tasks)
+{
+    MatchExecutor executor(2);
+    std::promise<std::thread::id> thread_id;
+    executor.UserMailbox(UserID("1")).Post([&]
+            {
+                executor.RouteUserTask(UserID("1"), nullptr, [&] { thread_id.set_value(std::this_thread::get_id()); });
+            });
+    ASSERT_NE(std::this_thread::get_id(), thread_id.get_future().get());
+    executor.Stop();
+}
+
+TEST(TestMatchExecutor, same_user_same_mailbox)
+{
+    MatchExecutor executor(2);
+    ASSERT_EQ(&executor.UserMailbox(UserID("1")), &executor.UserMailbox(UserID("1")));
+    executor.Stop();
+}
+
+TEST(TestMatchExecutor, deduction_steps_run_in_turn_until_over)
+{
+    DeductionExecutor executor(1);
+    std::mutex mutex;
+    std::vector<uint32_t> deduction_ids;
+    std::promise<void> all_submitted;
+    const auto all_submitted_future = all_submitted.get_future().share();
+    std::promise<void> done;
+    std::atomic<uint32_t> remaining_deduction_num{2};
+    for (const uint32_t deduction_id : {0, 1}) {
+        executor.Submit([&, deduction_id, step_num = 0]() mutable
+                {
+                    all_submitted_future.wait();
+                    {
+                        std::lock_guard<std::mutex> l(mutex);
+                        deduction_ids.emplace_back(deduction_id);
+                    }
+                    if (++step_num < 3) {
+                        return true;
+                    }
+                    if (--remaining_deduction_num == 0) {
+                        done.set_value();
+                    }
+                    return false;
+                });
+    }
+    all_submitted.set_value();
+    done.get_future().wait();
+    executor.Stop();
+    ASSERT_EQ((std::vector<uint32_t>{0, 1, 0, 1, 0, 1}), deduction_ids);
+}
+
+TEST(TestMatchExecutor, deduction_steps_not_run_after_stop)
+{
+    DeductionExecutor executor(1);
+    std::atomic<uint32_t> step_num{0};
+    std::promise<void> first_step_done;
+    executor.Submit([&]
+            {
+                if (++step_num == 1) {
+                    first_step_done.set_value();
+                }
+                return true; // never over
+            });
+    first_step_done.get_future().wait();
+    executor.Stop();
+    const uint32_t step_num_after_stop = step_num;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ASSERT_EQ(step_num_after_stop, step_num);
+}
+
+int main(int argc, char** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,118 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "bot_core/match_journal.h"
+
+class TestMatchJournal : public testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        path_ = (std::filesystem::temp_directory_path() /
+            ("lgtbot_test_match_journal_" + std::to_string(testing::UnitTest::GetInstance()->random_seed()) + "_" +
+             testing::UnitTest::GetInstance()->current_test_info()->name())).string();
+    }
+
+    void TearDown() override { std::filesystem::remove(path_); }
+
+    static MatchJournalHeader Header()
+    {
+        return MatchJournalHeader{
+            .module_name_ = "othello",
+            .random_seed_ = UINT64_MAX - 1,
+            .game_options_ = {"局时 60", "种子 "},
+            .user_num_ = 2,
+            .player_num_each_user_ = 1,
+            .bench_computers_to_player_num_ = 3,
+            .public_timer_alert_ = true,
+        };
+    }
+
+    std::string path_;
+};
+
+TEST_F(TestMatchJournal, read_written_journal)
+{
+    {
+        const auto writer = MatchJournalWriter::Open(path_, Header());
+        ASSERT_NE(nullptr, writer);
+        writer->Write(MatchJournalRecord{
+                .type_ = MatchJournalRecord::Type::REQUEST, .pid_ = 1, .is_public_ = true, .msg_ = "A1 中文"});
+        writer->Write(MatchJournalRecord{.type_ = MatchJournalRecord::Type::COMPUTER_ACT, .pid_ = 2});
+        writer->Write(MatchJournalRecord{.type_ = MatchJournalRecord::Type::TIMEOUT});
+        writer->Write(MatchJournalRecord{.type_ = MatchJournalRecord::Type::LEAVE, .pid_ = 300});
+    }
+    std::string errmsg;
+    const auto reader = MatchJournalReader::Open(path_, errmsg);
+    ASSERT_NE(nullptr, reader) << errmsg;
+    const auto& header = reader->header();
+    ASSERT_EQ("othello", header.module_name_);
+    ASSERT_EQ(UINT64_MAX - 1, header.random_seed_);
+    ASSERT_EQ(Header().game_options_, header.game_options_);
+    ASSERT_EQ(2, header.user_num_);
+    ASSERT_EQ(3, header.bench_computers_to_player_num_);
+    ASSERT_TRUE(header.public_timer_alert_);
+
+    auto record = reader->Next();
+    ASSERT_TRUE(record.has_value());
+    ASSERT_EQ(MatchJournalRecord::Type::REQUEST, record->type_);
+    ASSERT_EQ(1, record->pid_);
+    ASSERT_TRUE(record->is_public_);
+    ASSERT_EQ("A1 中文", record->msg_);
+    const auto last_time_us = record->time_us_;
+
+    record = reader->Next();
+    ASSERT_TRUE(record.has_value());
+    ASSERT_EQ(MatchJournalRecord::Type::COMPUTER_ACT, record->type_);
+    ASSERT_EQ(2, record->pid_);
+    ASSERT_LE(last_time_us, record->time_us_);
+
+    record = reader->Next();
+    ASSERT_TRUE(record.has_value());
+    ASSERT_EQ(MatchJournalRecord::Type::TIMEOUT, record->type_);
+
+    record = reader->Next();
+    ASSERT_TRUE(record.has_value());
+    ASSERT_EQ(MatchJournalRecord::Type::LEAVE, record->type_);
+    ASSERT_EQ(300, record->pid_);
+
+    ASSERT_FALSE(reader->Next().has_value());
+}
+
+TEST_F(TestMatchJournal, ignore_truncated_last_record)
+{
+    {
+        const auto writer = MatchJournalWriter::Open(path_, Header());
+        ASSERT_NE(nullptr, writer);
+        writer->Write(MatchJournalRecord{.type_ = MatchJournalRecord::Type::TIMEOUT});
+        writer->Write(MatchJournalRecord{
+                .type_ = MatchJournalRecord::Type::REQUEST, .pid_ = 0, .is_public_ = false, .msg_ = "a long request"});
+    }
+    std::filesystem::resize_file(path_, std::filesystem::file_size(path_) - 3);
+    std::string errmsg;
+    const auto reader = MatchJournalReader::Open(path_, errmsg);
+    ASSERT_NE(nullptr, reader) << errmsg;
+    ASSERT_TRUE(reader->Next().has_value());
+    ASSERT_FALSE(reader->Next().has_value());
+}
+
+TEST_F(TestMatchJournal, reject_invalid_file)
+{
+    std::ofstream(path_) << "not a journal";
+    std::string errmsg;
+    ASSERT_EQ(nullptr, MatchJournalReader::Open(path_, errmsg));
+    ASSERT_FALSE(errmsg.empty());
+}
+
+int main(int argc, char** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
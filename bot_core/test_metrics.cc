@@ -0,0 +1,124 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "bot_core/metrics.h"
+#include "nlohmann/json.hpp"
+
+TEST(TestMetrics, counter_is_added_by_many_threads)
+{
+    MetricCounter counter;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([&counter] { for (int j = 0; j < 10000; ++j) { counter.Add(); } });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    ASSERT_EQ(80000, counter.Value());
+}
+
+TEST(TestMetrics, small_values_are_recorded_exactly)
+{
+    for (uint64_t value = 0; value < MetricHistogram::k_linear_bucket_num; ++value) {
+        ASSERT_EQ(value, MetricHistogram::BucketUpperBound(MetricHistogram::BucketIndex(value)));
+    }
+}
+
+TEST(TestMetrics, bucket_bounds_the_relative_error)
+{
+    for (uint64_t value = 1; value < (uint64_t(1) << 62); value = value * 3 + 1) {
+        const auto index = MetricHistogram::BucketIndex(value);
+        ASSERT_LT(index, MetricHistogram::k_bucket_num);
+        const auto upper_bound = MetricHistogram::BucketUpperBound(index);
+        ASSERT_GE(upper_bound, value);
+        ASSERT_LE(upper_bound - value, value / MetricHistogram::k_sub_bucket_num);
+    }
+    ASSERT_EQ(MetricHistogram::k_bucket_num - 1, MetricHistogram::BucketIndex(UINT64_MAX));
+    ASSERT_EQ(UINT64_MAX, MetricHistogram::BucketUpperBound(MetricHistogram::k_bucket_num - 1));
+}
+
+TEST(TestMetrics, histogram_quantiles)
+{
+    MetricHistogram histogram;
+    for (uint64_t value = 1; value <= 1000; ++value) {
+        histogram.Record(value);
+    }
+    const auto snapshot = histogram.GetSnapshot();
+    ASSERT_EQ(1000, snapshot.count_);
+    ASSERT_EQ(500500, snapshot.sum_);
+    ASSERT_EQ(1000, snapshot.max_);
+    ASSERT_NEAR(500, snapshot.Quantile(0.5), 500 / MetricHistogram::k_sub_bucket_num);
+    ASSERT_NEAR(990, snapshot.Quantile(0.99), 990 / MetricHistogram::k_sub_bucket_num);
+    ASSERT_EQ(1000, snapshot.Quantile(1));
+    ASSERT_EQ(0, MetricHistogram().GetSnapshot().Quantile(0.5));
+}
+
+TEST(TestMetrics, same_name_and_labels_refer_to_same_metric)
+{
+    MetricsRegistry registry;
+    auto& counter = registry.Counter("requests", {{"type", "public"}});
+    ASSERT_EQ(&counter, &registry.Counter("requests", {{"type", "public"}}));
+    ASSERT_NE(&counter, &registry.Counter("requests", {{"type", "private"}}));
+    ASSERT_NE(&counter, &registry.Counter("requests"));
+}
+
+TEST(TestMetrics, exceeding_series_share_overflow_metric)
+{
+    MetricsRegistry registry;
+    for (uint32_t i = 0; i < MetricsRegistry::k_max_series_num; ++i) {
+        registry.Counter("requests", {{"id", std::to_string(i)}}).Add();
+    }
+    auto& overflow_counter = registry.Counter("requests", {{"id", "a"}});
+    ASSERT_EQ(&overflow_counter, &registry.Counter("requests", {{"id", "b"}}));
+    ASSERT_EQ(&overflow_counter, &registry.Counter("requests", {{"overflow", "true"}}));
+}
+
+TEST(TestMetrics, dump_prometheus)
+{
+    MetricsRegistry registry;
+    registry.Counter("requests", {{"type", "public"}}).Add(2);
+    registry.Counter("requests", {{"type", "private\"\\"}}).Add();
+    registry.Histogram("latency_us", {{"game", "lie"}}).Record(10);
+    const std::string str = registry.DumpPrometheus({{"match_count", 3}});
+    ASSERT_EQ(
+            "# TYPE requests counter\n"
+            "requests{type=\"private\\\"\\\\\"} 1\n"
+            "requests{type=\"public\"} 2\n"
+            "# TYPE latency_us summary\n"
+            "latency_us{game=\"lie\",quantile=\"0.5\"} 10\n"
+            "latency_us{game=\"lie\",quantile=\"0.9\"} 10\n"
+            "latency_us{game=\"lie\",quantile=\"0.99\"} 10\n"
+            "latency_us{game=\"lie\",quantile=\"0.999\"} 10\n"
+            "latency_us_sum{game=\"lie\"} 10\n"
+            "latency_us_count{game=\"lie\"} 1\n"
+            "# TYPE match_count gauge\n"
+            "match_count 3\n", str);
+}
+
+TEST(TestMetrics, dump_json)
+{
+    MetricsRegistry registry;
+    registry.Counter("requests", {{"type", "public"}}).Add(2);
+    registry.Histogram("latency_us").Record(10);
+    const auto json = nlohmann::json::parse(registry.DumpJson({{"match_count", 3}}));
+    ASSERT_EQ("requests", json["counters"][0]["name"]);
+    ASSERT_EQ("public", json["counters"][0]["labels"]["type"]);
+    ASSERT_EQ(2, json["counters"][0]["value"]);
+    ASSERT_EQ("latency_us", json["histograms"][0]["name"]);
+    ASSERT_EQ(1, json["histograms"][0]["count"]);
+    ASSERT_EQ(10, json["histograms"][0]["quantiles"]["0.99"]);
+    ASSERT_EQ(3, json["gauges"][0]["value"]);
+}
+
+int main(int argc, char** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
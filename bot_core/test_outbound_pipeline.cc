@@ -0,0 +1,296 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "bot_core/outbound_pipeline.h"
+
+// Records the received messages for each destination. Messages sent to "block" are blocked until Unblock is called.
+class FakeReceiver
+{
+  public:
+    static void HandleMessages(void* handler, const char* const id, const int is_to_user,
+            const LGTBot_Message* const messages, const size_t size)
+    {
+        auto& receiver = *static_cast<FakeReceiver*>(handler);
+        std::unique_lock<std::mutex> l(receiver.mutex_);
+        if (std::string_view(id) == "block") {
+            ++receiver.blocked_num_;
+            receiver.cv_.notify_all();
+            receiver.cv_.wait(l, [&] { return !receiver.is_blocked_; });
+        }
+        auto& received = receiver.received_[std::string(is_to_user ? "u" : "g") + id];
+        for (size_t i = 0; i < size; ++i) {
+            received.emplace_back(messages[i].str_);
+        }
+    }
+
+    static void HandleMessagesMulti(void* handler, const char* const* const user_ids, const size_t user_num,
+            const LGTBot_Message* const messages, const size_t size)
+    {
+        auto& receiver = *static_cast<FakeReceiver*>(handler);
+        std::lock_guard<std::mutex> l(receiver.mutex_);
+        ++receiver.multi_num_;
+        for (size_t i = 0; i < user_num; ++i) {
+            auto& received = receiver.received_[std::string("u") + user_ids[i]];
+            for (size_t j = 0; j < size; ++j) {
+                received.emplace_back(messages[j].str_);
+            }
+        }
+    }
+
+    LGTBot_Callback Callbacks() const
+    {
+        return LGTBot_Callback{.handle_messages = HandleMessages};
+    }
+
+    void WaitBlocked(const uint32_t num)
+    {
+        std::unique_lock<std::mutex> l(mutex_);
+        cv_.wait(l, [&] { return blocked_num_ >= num; });
+    }
+
+    void Unblock()
+    {
+        std::lock_guard<std::mutex> l(mutex_);
+        is_blocked_ = false;
+        cv_.notify_all();
+    }
+
+    std::vector<std::string> Received(const std::string& key)
+    {
+        std::lock_guard<std::mutex> l(mutex_);
+        return received_[key];
+    }
+
+    uint32_t MultiNum()
+    {
+        std::lock_guard<std::mutex> l(mutex_);
+        return multi_num_;
+    }
+
+  private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool is_blocked_ = true;
+    uint32_t blocked_num_ = 0;
+    uint32_t multi_num_ = 0;
+    std::map<std::string, std::vector<std::string>> received_;
+};
+
+static std::vector<OutboundMessage> Text(std::string str)
+{
+    return {OutboundMessage{std::move(str), LGTBOT_MSG_TEXT}};
+}
+
+class TestOutboundPipeline : public testing::Test
+{
+  protected:
+    FakeReceiver receiver_;
+    LGTBot_Callback callbacks_ = receiver_.Callbacks();
+};
+
+TEST_F(TestOutboundPipeline, send_synchronously)
+{
+    OutboundPipeline pipeline(&receiver_, callbacks_, OutboundPipeline::Options{});
+    pipeline.Send("1", true, Text("a"));
+    pipeline.Send("1", false, Text("b"));
+    ASSERT_EQ(std::vector<std::string>{"a"}, receiver_.Received("u1"));
+    ASSERT_EQ(std::vector<std::string>{"b"}, receiver_.Received("g1"));
+    const auto metrics = pipeline.Metrics();
+    ASSERT_EQ(2, metrics.queued_count_);
+    ASSERT_EQ(2, metrics.sent_count_);
+}
+
+TEST_F(TestOutboundPipeline, keep_order_of_each_destination)
+{
+    static constexpr const uint32_t k_destination_num = 8;
+    static constexpr const uint32_t k_message_num = 1000;
+    std::vector<std::string> expected;
+    {
+        OutboundPipeline pipeline(&receiver_, callbacks_, OutboundPipeline::Options{.thread_num_ = 4});
+        for (uint32_t i = 0; i < k_message_num; ++i) {
+            expected.emplace_back(std::to_string(i));
+            for (uint32_t id = 0; id < k_destination_num; ++id) {
+                pipeline.Send(std::to_string(id), true, Text(std::to_string(i)));
+            }
+        }
+    } // all messages are delivered when the pipeline is released
+    for (uint32_t id = 0; id < k_destination_num; ++id) {
+        ASSERT_EQ(expected, receiver_.Received("u" + std::to_string(id)));
+    }
+}
+
+TEST_F(TestOutboundPipeline, slow_destination_not_block_others)
+{
+    OutboundPipeline pipeline(&receiver_, callbacks_, OutboundPipeline::Options{.thread_num_ = 2});
+    pipeline.Send("block", true, Text("a"));
+    receiver_.WaitBlocked(1);
+    pipeline.Send("block", true, Text("b"));
+    pipeline.Send("1", true, Text("c"));
+    while (receiver_.Received("u1").empty()) {
+        std::this_thread::yield();
+    }
+    ASSERT_TRUE(receiver_.Received("ublock").empty());
+    receiver_.Unblock();
+}
+
+TEST_F(TestOutboundPipeline, release_pin_after_delivered)
+{
+    OutboundPipeline pipeline(&receiver_, callbacks_, OutboundPipeline::Options{.thread_num_ = 1});
+    pipeline.Send("block", true, Text("a"));
+    receiver_.WaitBlocked(1);
+    auto pin = std::make_shared<int>(0);
+    const std::weak_ptr<int> weak_pin = pin;
+    std::vector<OutboundMessage> messages;
+    messages.emplace_back("image.png", LGTBOT_MSG_IMAGE, std::move(pin));
+    pipeline.Send("block", true, std::move(messages));
+    ASSERT_FALSE(weak_pin.expired()); // the image is queued
+    receiver_.Unblock();
+    while (receiver_.Received("ublock").size() < 2) {
+        std::this_thread::yield();
+    }
+    while (!weak_pin.expired()) {
+        std::this_thread::yield();
+    }
+}
+
+TEST_F(TestOutboundPipeline, drop_when_full)
+{
+    {
+        OutboundPipeline pipeline(&receiver_, callbacks_, OutboundPipeline::Options{
+                .thread_num_ = 1,
+                .queue_capacity_ = 1,
+                .full_policy_ = LGTBOT_OUTBOUND_DROP_WHEN_FULL,
+            });
+        pipeline.Send("block", true, Text("a"));
+        receiver_.WaitBlocked(1); // "a" has left the queue
+        pipeline.Send("block", true, Text("b"));
+        pipeline.Send("block", true, Text("c")); // dropped
+        const auto metrics = pipeline.Metrics();
+        ASSERT_EQ(1, metrics.dropped_count_);
+        ASSERT_EQ(1, metrics.pending_count_);
+        receiver_.Unblock();
+    }
+    ASSERT_EQ((std::vector<std::string>{"a", "b"}), receiver_.Received("ublock"));
+}
+
+TEST_F(TestOutboundPipeline, block_when_full)
+{
+    {
+        OutboundPipeline pipeline(&receiver_, callbacks_, OutboundPipeline::Options{
+                .thread_num_ = 1,
+                .queue_capacity_ = 1,
+                .full_policy_ = LGTBOT_OUTBOUND_BLOCK_WHEN_FULL,
+            });
+        pipeline.Send("block", true, Text("a"));
+        receiver_.WaitBlocked(1);
+        pipeline.Send("block", true, Text("b"));
+        std::thread unblock_thread([&]
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                    receiver_.Unblock();
+                });
+        pipeline.Send("block", true, Text("c")); // blocked until "b" leaves the queue
+        ASSERT_EQ(1, pipeline.Metrics().blocked_count_);
+        unblock_thread.join();
+    }
+    ASSERT_EQ((std::vector<std::string>{"a", "b", "c"}), receiver_.Received("ublock"));
+}
+
+TEST_F(TestOutboundPipeline, block_after_non_blocking_scope_when_full)
+{
+    {
+        OutboundPipeline pipeline(&receiver_, callbacks_, OutboundPipeline::Options{
+                .thread_num_ = 1,
+                .queue_capacity_ = 1,
+                .full_policy_ = LGTBOT_OUTBOUND_BLOCK_WHEN_FULL,
+            });
+        pipeline.Send("block", true, Text("a"));
+        receiver_.WaitBlocked(1);
+        std::thread unblock_thread;
+        {
+            OutboundPipeline::NonBlockingScope non_blocking; // e.g. the lock of a match is held
+            pipeline.Send("block", true, Text("b"));
+            pipeline.Send("block", true, Text("c")); // queued beyond the capacity
+            ASSERT_EQ(2, pipeline.Metrics().pending_count_);
+            ASSERT_EQ(0, pipeline.Metrics().blocked_count_);
+            unblock_thread = std::thread([&]
+                    {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                        receiver_.Unblock();
+                    });
+        } // blocked until the queue has room
+        ASSERT_EQ(1, pipeline.Metrics().blocked_count_);
+        ASSERT_EQ(0, pipeline.Metrics().pending_count_);
+        unblock_thread.join();
+    }
+    ASSERT_EQ((std::vector<std::string>{"a", "b", "c"}), receiver_.Received("ublock"));
+}
+
+TEST_F(TestOutboundPipeline, send_to_users_once)
+{
+    OutboundPipeline pipeline(&receiver_, callbacks_,
+            OutboundPipeline::Options{.handle_messages_multi_ = FakeReceiver::HandleMessagesMulti});
+    pipeline.SendToUsers({"1", "2", "3", "2"}, Text("a"));
+    ASSERT_EQ(1, receiver_.MultiNum());
+    for (const auto& key : {"u1", "u2", "u3"}) {
+        ASSERT_EQ(std::vector<std::string>{"a"}, receiver_.Received(key));
+    }
+    ASSERT_EQ(1, pipeline.Metrics().sent_count_);
+}
+
+TEST_F(TestOutboundPipeline, send_to_users_one_by_one_if_no_multi_callback)
+{
+    OutboundPipeline pipeline(&receiver_, callbacks_, OutboundPipeline::Options{});
+    pipeline.SendToUsers({"1", "2", "3"}, Text("a"));
+    ASSERT_EQ(0, receiver_.MultiNum());
+    for (const auto& key : {"u1", "u2", "u3"}) {
+        ASSERT_EQ(std::vector<std::string>{"a"}, receiver_.Received(key));
+    }
+    ASSERT_EQ(3, pipeline.Metrics().sent_count_);
+}
+
+TEST_F(TestOutboundPipeline, send_to_users_keep_order_of_each_destination)
+{
+    static constexpr const uint32_t k_destination_num = 8;
+    static constexpr const uint32_t k_message_num = 1000;
+    std::vector<std::string> ids;
+    for (uint32_t id = 0; id < k_destination_num; ++id) {
+        ids.emplace_back(std::to_string(id));
+    }
+    std::vector<std::string> expected;
+    {
+        OutboundPipeline pipeline(&receiver_, callbacks_, OutboundPipeline::Options{
+                .thread_num_ = 4,
+                .handle_messages_multi_ = FakeReceiver::HandleMessagesMulti,
+            });
+        for (uint32_t i = 0; i < k_message_num; ++i) {
+            expected.emplace_back(std::to_string(i));
+            if (i % 3 == 0) {
+                pipeline.SendToUsers(ids, Text(std::to_string(i)));
+                continue;
+            }
+            for (const auto& id : ids) {
+                pipeline.Send(id, true, Text(std::to_string(i)));
+            }
+        }
+    } // all messages are delivered when the pipeline is released
+    ASSERT_EQ((k_message_num + 2) / 3, receiver_.MultiNum());
+    for (const auto& id : ids) {
+        ASSERT_EQ(expected, receiver_.Received("u" + id));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,156 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+#include <atomic>
+#include <filesystem>
+#include <future>
+#include <optional>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "bot_core/timer.h"
+
+static std::optional<size_t> CurrentThreadNum()
+{
+#ifdef __linux__
+    const std::filesystem::directory_iterator it("/proc/self/task");
+    return std::distance(std::filesystem::begin(it), std::filesystem::end(it));
+#else
+    return std::nullopt;
+#endif
+}
+
+template <typename Pred>
+static bool WaitUntil(Pred&& pred, const std::chrono::seconds timeout)
+{
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+class TestTimer : public testing::Test
+{
+  protected:
+    static constexpr const uint32_t k_worker_num = 4;
+
+    TimerScheduler scheduler_{k_worker_num};
+};
+
+TEST_F(TestTimer, fire_tasks_in_order)
+{
+    std::mutex mutex;
+    std::vector<int> fired;
+    std::promise<void> finished;
+    TimerScheduler::TaskSet tasks;
+    tasks.emplace_back(0, [&] { std::lock_guard<std::mutex> l(mutex); fired.emplace_back(1); });
+    tasks.emplace_back(0, [&] { std::lock_guard<std::mutex> l(mutex); fired.emplace_back(2); });
+    tasks.emplace_back(1, [&] { std::lock_guard<std::mutex> l(mutex); fired.emplace_back(3); finished.set_value(); });
+    auto handle = scheduler_.Schedule(std::move(tasks));
+    ASSERT_EQ(std::future_status::ready, finished.get_future().wait_for(std::chrono::seconds(5)));
+    std::lock_guard<std::mutex> l(mutex);
+    ASSERT_EQ((std::vector<int>{1, 2, 3}), fired);
+}
+
+TEST_F(TestTimer, cancel_before_fire)
+{
+    std::atomic<int> fired_num{0};
+    TimerScheduler::TaskSet tasks;
+    tasks.emplace_back(0, [&] { ++fired_num; });
+    tasks.emplace_back(1, [&] { ++fired_num; });
+    auto handle = scheduler_.Schedule(std::move(tasks));
+    ASSERT_TRUE(WaitUntil([&] { return fired_num == 1; }, std::chrono::seconds(5)));
+    handle.Cancel();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+    ASSERT_EQ(1, fired_num);
+}
+
+TEST_F(TestTimer, cancel_twice)
+{
+    TimerScheduler::TaskSet tasks;
+    tasks.emplace_back(3600, [] {});
+    auto handle = scheduler_.Schedule(std::move(tasks));
+    handle.Cancel();
+    handle.Cancel();
+}
+
+TEST_F(TestTimer, ten_thousand_timers_run_on_constant_threads)
+{
+    static constexpr const uint32_t k_timer_num = 10000;
+    const auto thread_num = CurrentThreadNum();
+    if (!thread_num.has_value()) {
+        GTEST_SKIP() << "counting threads is not supported on this platform";
+    }
+
+    // Long timers which are cancelled before firing, like the matches whose stages are over in time.
+    std::vector<TimerScheduler::Handle> long_handles;
+    for (uint32_t i = 0; i < k_timer_num; ++i) {
+        TimerScheduler::TaskSet tasks;
+        tasks.emplace_back(3600, [] {});
+        long_handles.emplace_back(scheduler_.Schedule(std::move(tasks)));
+    }
+    ASSERT_EQ(thread_num, CurrentThreadNum());
+    for (auto& handle : long_handles) {
+        handle.Cancel();
+    }
+
+    // Short timers with an alert and a timeout, like the matches whose players do not act.
+    std::atomic<uint32_t> alert_num{0};
+    std::atomic<uint32_t> timeout_num{0};
+    std::vector<TimerScheduler::Handle> short_handles;
+    for (uint32_t i = 0; i < k_timer_num; ++i) {
+        TimerScheduler::TaskSet tasks;
+        tasks.emplace_back(0, [&] { ++alert_num; });
+        tasks.emplace_back(1, [&] { ++timeout_num; });
+        short_handles.emplace_back(scheduler_.Schedule(std::move(tasks)));
+    }
+    size_t max_thread_num = 0;
+    ASSERT_TRUE(WaitUntil([&]
+                {
+                    max_thread_num = std::max(max_thread_num, *CurrentThreadNum());
+                    return timeout_num == k_timer_num;
+                }, std::chrono::seconds(30)));
+    ASSERT_EQ(k_timer_num, alert_num);
+    ASSERT_EQ(*thread_num, max_thread_num);
+}
+
+TEST(TestSimulatedTimer, fire_at_once_when_clock_advances_automatically)
+{
+    SimulatedClock clock;
+    TimerScheduler scheduler(1, clock);
+    std::promise<void> finished;
+    TimerScheduler::TaskSet tasks;
+    tasks.emplace_back(3600, [] {});
+    tasks.emplace_back(3600, [&] { finished.set_value(); });
+    auto handle = scheduler.Schedule(std::move(tasks));
+    ASSERT_EQ(std::future_status::ready, finished.get_future().wait_for(std::chrono::seconds(5)));
+    ASSERT_EQ(Clock::TimePoint(std::chrono::seconds(7200)), clock.Now());
+}
+
+TEST(TestSimulatedTimer, fire_only_when_clock_is_advanced_to_deadline)
+{
+    SimulatedClock clock(false);
+    TimerScheduler scheduler(1, clock);
+    std::atomic<int> fired_num{0};
+    TimerScheduler::TaskSet tasks;
+    tasks.emplace_back(10, [&] { ++fired_num; });
+    auto handle = scheduler.Schedule(std::move(tasks));
+    clock.Advance(std::chrono::seconds(9));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_EQ(0, fired_num);
+    clock.Advance(std::chrono::seconds(1));
+    ASSERT_TRUE(WaitUntil([&] { return fired_num == 1; }, std::chrono::seconds(5)));
+    ASSERT_EQ(Clock::TimePoint(std::chrono::seconds(10)), clock.Now());
+}
+
+int main(int argc, char** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,138 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "bot_core/tracer.h"
+#include "nlohmann/json.hpp"
+
+class TestTracer : public testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        dir_ = std::filesystem::temp_directory_path() /
+            ("lgtbot_test_tracer_" + std::to_string(testing::UnitTest::GetInstance()->random_seed()) + "_" +
+             testing::UnitTest::GetInstance()->current_test_info()->name());
+        std::filesystem::remove_all(dir_);
+        std::filesystem::create_directories(dir_);
+        path_ = (dir_ / "trace.json").string();
+    }
+
+    void TearDown() override { std::filesystem::remove_all(dir_); }
+
+    static nlohmann::json ReadEvents(const std::string& path)
+    {
+        std::ifstream file(path);
+        std::stringstream ss;
+        ss << file.rdbuf();
+        return nlohmann::json::parse(ss.str());
+    }
+
+    static void Request(Tracer& tracer, const MatchID mid)
+    {
+        TraceSpan root(&tracer, "HandleRequest");
+        TraceSpan span("Match::Request");
+        span.AddArg("mid", mid.Get());
+        TraceSpan::SampleIfMatchTraced(mid);
+        TraceSpan child("MainStage::HandleRequest");
+    }
+
+    std::filesystem::path dir_;
+    std::string path_;
+};
+
+TEST_F(TestTracer, no_spans_are_written_if_disabled)
+{
+    {
+        Tracer tracer(path_);
+        Request(tracer, MatchID{1});
+        ASSERT_EQ(0, tracer.GetStats().event_count_);
+    }
+    ASSERT_TRUE(ReadEvents(path_).empty());
+}
+
+TEST_F(TestTracer, child_spans_out_of_trace_do_nothing)
+{
+    Tracer tracer(path_);
+    tracer.SetSamplePercent(100);
+    {
+        TraceSpan span("MsgSender::Flush");
+    }
+    ASSERT_EQ(0, tracer.GetStats().event_count_);
+}
+
+TEST_F(TestTracer, write_sampled_spans)
+{
+    {
+        Tracer tracer(path_);
+        tracer.SetSamplePercent(100);
+        Request(tracer, MatchID{1});
+        ASSERT_EQ(3, tracer.GetStats().event_count_);
+    }
+    const auto events = ReadEvents(path_);
+    ASSERT_EQ(3, events.size());
+    // children are finished and written first
+    ASSERT_EQ("MainStage::HandleRequest", events[0]["name"]);
+    ASSERT_EQ("Match::Request", events[1]["name"]);
+    ASSERT_EQ(1, events[1]["args"]["mid"]);
+    ASSERT_EQ("HandleRequest", events[2]["name"]);
+    ASSERT_EQ("X", events[2]["ph"]);
+    ASSERT_EQ(events[0]["tid"], events[2]["tid"]);
+    ASSERT_LE(events[2]["ts"].get<uint64_t>(), events[1]["ts"].get<uint64_t>());
+}
+
+TEST_F(TestTracer, write_all_spans_of_traced_match)
+{
+    {
+        Tracer tracer(path_);
+        tracer.SetMatchTraced(MatchID{2}, true);
+        Request(tracer, MatchID{1});
+        ASSERT_EQ(0, tracer.GetStats().event_count_);
+        Request(tracer, MatchID{2});
+        ASSERT_EQ(3, tracer.GetStats().event_count_);
+        tracer.SetMatchTraced(MatchID{2}, false);
+        ASSERT_FALSE(tracer.IsEnabled());
+        Request(tracer, MatchID{2});
+        ASSERT_EQ(3, tracer.GetStats().event_count_);
+    }
+    ASSERT_EQ(3, ReadEvents(path_).size());
+}
+
+TEST_F(TestTracer, escape_args)
+{
+    {
+        Tracer tracer(path_);
+        tracer.SetSamplePercent(100);
+        TraceSpan span(&tracer, "HandleRequest");
+        span.AddArg("uid", "\"a\\b\"\n");
+    }
+    ASSERT_EQ("\"a\\b\"\n", ReadEvents(path_)[0]["args"]["uid"]);
+}
+
+TEST_F(TestTracer, rotate_full_file)
+{
+    {
+        Tracer tracer(path_, 1024);
+        tracer.SetSamplePercent(100);
+        for (int i = 0; i < 100; ++i) {
+            Request(tracer, MatchID{1});
+        }
+        ASSERT_LT(0, tracer.GetStats().rotate_count_);
+    }
+    ASSERT_LE(std::filesystem::file_size(path_), 1024 + 8);
+    ASSERT_FALSE(ReadEvents(path_).empty());
+    ASSERT_FALSE(ReadEvents(path_ + ".1").empty());
+}
+
+int main(int argc, char** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
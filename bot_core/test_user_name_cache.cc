@@ -0,0 +1,142 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+#include <cstdio>
+#include <map>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "bot_core/user_name_cache.h"
+
+// The name of a user is "<user_id>:<version>" out of groups and "<user_id>@<group_id>:<version>" in groups. The
+// version is increased when the user renames.
+struct FakeAdapter
+{
+    static void GetUserName(void* const handler, char* const buffer, const size_t size, const char* const user_id)
+    {
+        auto& adapter = *static_cast<FakeAdapter*>(handler);
+        ++adapter.callback_count_;
+        std::snprintf(buffer, size, "%s:%u", user_id, adapter.versions_[user_id]);
+    }
+
+    static void GetUserNameInGroup(void* const handler, char* const buffer, const size_t size,
+            const char* const group_id, const char* const user_id)
+    {
+        auto& adapter = *static_cast<FakeAdapter*>(handler);
+        ++adapter.callback_count_;
+        std::snprintf(buffer, size, "%s@%s:%u", user_id, group_id, adapter.versions_[user_id]);
+    }
+
+    uint32_t callback_count_ = 0;
+    std::map<std::string, uint32_t> versions_;
+    const LGTBot_Callback callbacks_{
+        .get_user_name = GetUserName,
+        .get_user_name_in_group = GetUserNameInGroup,
+    };
+};
+
+class TestUserNameCache : public testing::Test
+{
+  protected:
+    FakeAdapter adapter_;
+};
+
+TEST_F(TestUserNameCache, invoke_callback_once_for_same_name)
+{
+    UserNameCache cache(&adapter_, adapter_.callbacks_);
+    ASSERT_EQ("123:0", cache.Get("123", nullptr));
+    ASSERT_EQ("123:0", cache.Get("123", nullptr));
+    ASSERT_EQ(1, adapter_.callback_count_);
+    const auto stats = cache.GetStats();
+    ASSERT_EQ(1, stats.hit_count_);
+    ASSERT_EQ(1, stats.miss_count_);
+    ASSERT_EQ(1, stats.name_count_);
+}
+
+TEST_F(TestUserNameCache, names_in_different_groups_are_cached_separately)
+{
+    UserNameCache cache(&adapter_, adapter_.callbacks_);
+    ASSERT_EQ("123:0", cache.Get("123", nullptr));
+    ASSERT_EQ("123@1:0", cache.Get("123", "1"));
+    ASSERT_EQ("123@2:0", cache.Get("123", "2"));
+    ASSERT_EQ("123@1:0", cache.Get("123", "1"));
+    ASSERT_EQ(3, adapter_.callback_count_);
+}
+
+TEST_F(TestUserNameCache, invoke_callback_each_time_if_disabled)
+{
+    UserNameCache cache_1(&adapter_, adapter_.callbacks_, 0);
+    cache_1.Get("123", nullptr);
+    cache_1.Get("123", nullptr);
+    ASSERT_EQ(2, adapter_.callback_count_);
+    UserNameCache cache_2(&adapter_, adapter_.callbacks_, UserNameCache::k_default_capacity, std::chrono::seconds(0));
+    cache_2.Get("123", nullptr);
+    cache_2.Get("123", nullptr);
+    ASSERT_EQ(4, adapter_.callback_count_);
+}
+
+TEST_F(TestUserNameCache, invoke_callback_again_after_expired)
+{
+    UserNameCache cache(&adapter_, adapter_.callbacks_, UserNameCache::k_default_capacity, std::chrono::milliseconds(50));
+    cache.Get("123", nullptr);
+    ++adapter_.versions_["123"];
+    ASSERT_EQ("123:0", cache.Get("123", nullptr));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_EQ("123:1", cache.Get("123", nullptr));
+    ASSERT_EQ(2, adapter_.callback_count_);
+}
+
+TEST_F(TestUserNameCache, evict_least_recently_used_name)
+{
+    UserNameCache cache(&adapter_, adapter_.callbacks_, 2);
+    cache.Get("1", nullptr);
+    cache.Get("2", nullptr);
+    cache.Get("1", nullptr);
+    cache.Get("3", nullptr); // evict "2"
+    ASSERT_EQ(3, adapter_.callback_count_);
+    cache.Get("1", nullptr);
+    cache.Get("3", nullptr);
+    ASSERT_EQ(3, adapter_.callback_count_);
+    cache.Get("2", nullptr);
+    ASSERT_EQ(4, adapter_.callback_count_);
+    const auto stats = cache.GetStats();
+    ASSERT_EQ(2, stats.evict_count_);
+    ASSERT_EQ(2, stats.name_count_);
+}
+
+TEST_F(TestUserNameCache, invalidate_name_in_group)
+{
+    UserNameCache cache(&adapter_, adapter_.callbacks_);
+    cache.Get("123", nullptr);
+    cache.Get("123", "1");
+    cache.Get("123", "2");
+    ++adapter_.versions_["123"];
+    cache.Invalidate("123", "1");
+    ASSERT_EQ("123:0", cache.Get("123", nullptr));
+    ASSERT_EQ("123@1:1", cache.Get("123", "1"));
+    ASSERT_EQ("123@2:0", cache.Get("123", "2"));
+}
+
+TEST_F(TestUserNameCache, invalidate_all_names_of_user)
+{
+    UserNameCache cache(&adapter_, adapter_.callbacks_);
+    cache.Get("123", nullptr);
+    cache.Get("123", "1");
+    cache.Get("456", "1");
+    ++adapter_.versions_["123"];
+    ++adapter_.versions_["456"];
+    cache.Invalidate("123", nullptr);
+    ASSERT_EQ("123:1", cache.Get("123", nullptr));
+    ASSERT_EQ("123@1:1", cache.Get("123", "1"));
+    ASSERT_EQ("456@1:0", cache.Get("456", "1"));
+    ASSERT_EQ(1, cache.GetStats().invalidate_count_);
+}
+
+int main(int argc, char** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
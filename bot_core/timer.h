@@ -3,92 +3,307 @@
 // This source code is licensed under LGPLv2 (found in the LICENSE file).
 
 #pragma once
-#include <atomic>
+#include <algorithm>
 #include <chrono>
 #include <condition_variable>
+#include <deque>
 #include <functional>
+#include <iterator>
 #include <list>
+#include <memory>
+#include <mutex>
 #include <thread>
-#include <iostream> //
+#include <vector>
 
-class Timer
+#include "bot_core/clock.h"
+
+// A bot-wide min-heap scheduler which owns the tasks of all timers.
+//
+// One dispatcher thread waits for the nearest deadline and hands expired tasks to a bounded worker pool, so the
+// number of threads does not grow with the number of matches. Cancelling a timer only marks its chain as done, the
+// stale heap entry is dropped lazily when it is popped (or when the heap is compacted). Deadlines are measured by the
+// clock of the scheduler, which may be simulated.
+class TimerScheduler
 {
-   public:
-    using TaskSet = std::list<std::pair<uint64_t, std::function<void()>>>;
-    Timer(TaskSet&& tasks) : is_over_(false)
+  public:
+    using Task = std::function<void()>;
+    using TaskSet = std::list<std::pair<uint64_t, Task>>;
+
+  private:
+    // The tasks of one timer. Each task is fired |sec| seconds after the previous one.
+    struct Chain
     {
-#ifdef TEST_BOT
+        std::vector<std::pair<uint64_t, Task>> tasks_;
+        size_t next_ = 0;
+        bool done_ = false; // protected by the mutex of the scheduler
+    };
+
+  public:
+    class Handle
+    {
+      public:
+        Handle() = default;
+        Handle(TimerScheduler& scheduler, std::shared_ptr<Chain> chain)
+            : scheduler_(&scheduler), chain_(std::move(chain)) {}
+
+        // Tasks which have not been fired will never be fired. Tasks which have been dispatched to workers are not
+        // affected.
+        void Cancel()
         {
-            std::lock_guard<std::mutex> l(Timer::mutex_);
-            ++remaining_thread_count_;
+            if (scheduler_ && chain_) {
+                scheduler_->Cancel_(*chain_);
+                chain_ = nullptr;
+            }
         }
-#endif
-        thread_ = std::thread([this, t = std::move(tasks)]()
-            {
-                std::unique_lock<std::mutex> lock(mutex_);
-                for (const auto& [sec, handle] : t) {
-                    cv_.wait_for(lock, std::chrono::seconds(sec), [this]()
-                            {
-#ifdef TEST_BOT
-                                return is_over_.load() || skip_timer_;
-#else
-                                return is_over_.load();
-#endif
-                            });
-                    if (!is_over_) {
-                        // We need call handle async, because handle may release timer which will cause deadlock
-#ifdef TEST_BOT
-                        ++remaining_thread_count_;
-#endif
-                        // TODO: we should wait all detached threads to finish before exiting
-                        std::thread([handle]
-                                {
-                                    handle();
-#ifdef TEST_BOT
-                                    std::lock_guard<std::mutex> l(Timer::mutex_);
-                                    if (0 == --remaining_thread_count_) {
-                                        remaining_thread_cv_.notify_all();
-                                    }
-#endif
-                                }).detach();
-                    } else {
-                        break;
-                    }
-                }
-#ifdef TEST_BOT
-                if (0 == --remaining_thread_count_) {
-                    remaining_thread_cv_.notify_all();
-                }
-#endif
-            }); /* make sure thread_ is inited last */
+
+      private:
+        TimerScheduler* scheduler_ = nullptr;
+        std::shared_ptr<Chain> chain_;
+    };
+
+    static TimerScheduler& Instance()
+    {
+        static TimerScheduler scheduler(DefaultWorkerNum());
+        return scheduler;
     }
-    Timer(const Timer&) = delete;
-    Timer(Timer&&) = delete;
-    ~Timer()
+
+    static uint32_t DefaultWorkerNum() { return std::max(8U, 2 * std::thread::hardware_concurrency()); }
+
+    explicit TimerScheduler(const uint32_t worker_num, Clock& clock = SteadyClock::Instance())
+        : clock_(clock), stop_(false), cancelled_num_(0), seq_(0)
+    {
+        for (uint32_t i = 0; i < worker_num; ++i) {
+            workers_.emplace_back([this] { WorkerLoop_(); });
+        }
+        dispatcher_ = std::thread([this] { DispatcherLoop_(); });
+    }
+
+    TimerScheduler(const TimerScheduler&) = delete;
+    TimerScheduler(TimerScheduler&&) = delete;
+
+    ~TimerScheduler()
+    {
+        {
+            std::lock_guard<std::mutex> l(Mutex_());
+            stop_ = true;
+        }
+        Cv_().notify_all();
+        dispatcher_.join();
+        {
+            std::lock_guard<std::mutex> l(pool_mutex_);
+            pool_stop_ = true;
+        }
+        pool_cv_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    Handle Schedule(TaskSet&& tasks)
+    {
+        auto chain = std::make_shared<Chain>();
+        chain->tasks_.reserve(tasks.size());
+        std::move(tasks.begin(), tasks.end(), std::back_inserter(chain->tasks_));
+        {
+            std::lock_guard<std::mutex> l(Mutex_());
+            OnChainBegin_();
+            if (chain->tasks_.empty()) {
+                chain->done_ = true;
+                OnChainEnd_();
+                return Handle(*this, std::move(chain));
+            }
+            Push_(clock_.Now() + std::chrono::seconds(chain->tasks_.front().first), chain);
+        }
+        Cv_().notify_one();
+        return Handle(*this, std::move(chain));
+    }
+
+    size_t ThreadNum() const { return workers_.size() + 1; }
+
+    Clock& clock() const { return clock_; }
+
+  private:
+    struct Entry
+    {
+        Clock::TimePoint deadline_;
+        uint64_t seq_; // keep tasks with the same deadline in FIFO order
+        std::shared_ptr<Chain> chain_;
+
+        bool operator>(const Entry& e) const
+        {
+            return deadline_ != e.deadline_ ? deadline_ > e.deadline_ : seq_ > e.seq_;
+        }
+    };
+
+    // REQUIRE: should be protected by Mutex_()
+    void Push_(const Clock::TimePoint deadline, std::shared_ptr<Chain> chain)
+    {
+        heap_.emplace_back(Entry{deadline, seq_++, std::move(chain)});
+        std::push_heap(heap_.begin(), heap_.end(), std::greater<Entry>());
+    }
+
+    void Cancel_(Chain& chain)
     {
-        if (thread_.joinable()) {
+        std::lock_guard<std::mutex> l(Mutex_());
+        if (chain.done_) {
+            return;
+        }
+        chain.done_ = true;
+        OnChainEnd_();
+        // Each unfinished chain has exactly one entry in the heap.
+        if (++cancelled_num_ > 64 && cancelled_num_ * 2 > heap_.size()) {
+            Compact_();
+        }
+    }
+
+    // REQUIRE: should be protected by Mutex_()
+    void Compact_()
+    {
+        heap_.erase(std::remove_if(heap_.begin(), heap_.end(), [](const Entry& e) { return e.chain_->done_; }),
+                heap_.end());
+        std::make_heap(heap_.begin(), heap_.end(), std::greater<Entry>());
+        cancelled_num_ = 0;
+    }
+
+    void DispatcherLoop_()
+    {
+        std::unique_lock<std::mutex> l(Mutex_());
+        while (!stop_) {
+            if (heap_.empty()) {
+                Cv_().wait(l, [this] { return stop_ || !heap_.empty(); });
+                continue;
+            }
+            if (const auto deadline = heap_.front().deadline_; clock_.Now() < deadline) {
+                // Copy the deadline because the heap may be changed during waiting.
+                clock_.WaitUntil(l, Cv_(), deadline);
+                continue;
+            }
+            std::pop_heap(heap_.begin(), heap_.end(), std::greater<Entry>());
+            Entry entry = std::move(heap_.back());
+            heap_.pop_back();
+            Chain& chain = *entry.chain_;
+            if (chain.done_) {
+                --cancelled_num_;
+                continue;
+            }
+            Task task = std::move(chain.tasks_[chain.next_].second);
+            if (++chain.next_ < chain.tasks_.size()) {
+                Push_(entry.deadline_ + std::chrono::seconds(chain.tasks_[chain.next_].first), entry.chain_);
+            } else {
+                chain.done_ = true;
+            }
+            // We need call task async, because task may release timer or start a new one.
+            Dispatch_(std::move(task));
+            if (chain.done_) {
+                OnChainEnd_();
+            }
+        }
+    }
+
+    // REQUIRE: should be protected by Mutex_()
+    void Dispatch_(Task&& task)
+    {
+        OnTaskBegin_();
+        {
+            std::lock_guard<std::mutex> l(pool_mutex_);
+            jobs_.emplace_back(std::move(task));
+        }
+        pool_cv_.notify_one();
+    }
+
+    void WorkerLoop_()
+    {
+        while (true) {
+            Task task;
             {
-                std::unique_lock<std::mutex> lock(mutex_);
-                is_over_.store(true);
+                std::unique_lock<std::mutex> l(pool_mutex_);
+                pool_cv_.wait(l, [this] { return pool_stop_ || !jobs_.empty(); });
+                if (pool_stop_) {
+                    return;
+                }
+                task = std::move(jobs_.front());
+                jobs_.pop_front();
             }
-            cv_.notify_all();
-            thread_.join();
+            task();
+            OnTaskEnd_();
         }
     }
 
+    // The hooks below keep the counters used by test_bot to wait for all timers.
+    std::mutex& Mutex_();
+    std::condition_variable& Cv_();
+    void OnChainBegin_();
+    void OnChainEnd_();
+    void OnTaskBegin_();
+    void OnTaskEnd_();
+
+    Clock& clock_;
+#ifndef TEST_BOT
+    std::mutex mutex_;
+    std::condition_variable cv_;
+#endif
+    bool stop_;
+    size_t cancelled_num_;
+    uint64_t seq_;
+    std::vector<Entry> heap_;
+    std::thread dispatcher_;
+
+    std::mutex pool_mutex_;
+    std::condition_variable pool_cv_;
+    bool pool_stop_ = false;
+    std::deque<Task> jobs_;
+    std::vector<std::thread> workers_;
+};
+
+// A RAII wrapper of the tasks scheduled by the TimerScheduler. Tasks which have not been fired are cancelled when the
+// timer is released.
+class Timer
+{
+   public:
+    using TaskSet = TimerScheduler::TaskSet;
+    Timer(TimerScheduler& scheduler, TaskSet&& tasks) : handle_(scheduler.Schedule(std::move(tasks))) {}
+    Timer(const Timer&) = delete;
+    Timer(Timer&&) = delete;
+    ~Timer() { handle_.Cancel(); }
+
 #ifdef TEST_BOT
     static std::condition_variable cv_;
-    static bool skip_timer_;
     static std::condition_variable remaining_thread_cv_;
-    static uint64_t remaining_thread_count_;
+    static uint64_t remaining_thread_count_; // the number of unfinished timers and running tasks
     static std::mutex mutex_;
+#endif
 
   private:
+    TimerScheduler::Handle handle_;
+};
+
+#ifdef TEST_BOT
+
+inline std::mutex& TimerScheduler::Mutex_() { return Timer::mutex_; }
+inline std::condition_variable& TimerScheduler::Cv_() { return Timer::cv_; }
+inline void TimerScheduler::OnChainBegin_() { ++Timer::remaining_thread_count_; }
+inline void TimerScheduler::OnTaskBegin_() { ++Timer::remaining_thread_count_; }
+
+inline void TimerScheduler::OnChainEnd_()
+{
+    if (0 == --Timer::remaining_thread_count_) {
+        Timer::remaining_thread_cv_.notify_all();
+    }
+}
+
+inline void TimerScheduler::OnTaskEnd_()
+{
+    std::lock_guard<std::mutex> l(Timer::mutex_);
+    OnChainEnd_();
+}
+
 #else
-  private:
-    std::condition_variable cv_;
-    std::mutex mutex_;
+
+inline std::mutex& TimerScheduler::Mutex_() { return mutex_; }
+inline std::condition_variable& TimerScheduler::Cv_() { return cv_; }
+inline void TimerScheduler::OnChainBegin_() {}
+inline void TimerScheduler::OnChainEnd_() {}
+inline void TimerScheduler::OnTaskBegin_() {}
+inline void TimerScheduler::OnTaskEnd_() {}
+
 #endif
-    std::atomic<bool> is_over_;
-    std::thread thread_;
-};
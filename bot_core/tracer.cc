@@ -0,0 +1,145 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+#include "bot_core/tracer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+
+#include "utility/log.h"
+
+static void AppendJsonString(std::string& str, const std::string_view value)
+{
+    str += '"';
+    for (const char c : value) {
+        switch (c) {
+        case '"': str += "\\\""; break;
+        case '\\': str += "\\\\"; break;
+        case '\n': str += "\\n"; break;
+        case '\r': str += "\\r"; break;
+        case '\t': str += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buffer[8];
+                std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                str += buffer;
+            } else {
+                str += c;
+            }
+        }
+    }
+    str += '"';
+}
+
+void TraceSpan::AddArg(const std::string_view key, const std::string_view value)
+{
+    if (is_active_) {
+        AppendKey_(key);
+        AppendJsonString(args_, value);
+    }
+}
+
+Tracer::Tracer(std::string path, const uint64_t max_file_bytes) : path_(std::move(path)), max_file_bytes_(max_file_bytes)
+{
+    std::lock_guard<std::mutex> l(file_mutex_);
+    Open_();
+}
+
+Tracer::~Tracer()
+{
+    std::lock_guard<std::mutex> l(file_mutex_);
+    Close_();
+}
+
+void Tracer::SetMatchTraced(const MatchID mid, const bool traced)
+{
+    std::lock_guard<std::mutex> l(match_mutex_);
+    if (traced) {
+        traced_mids_.emplace(mid);
+    } else {
+        traced_mids_.erase(mid);
+    }
+    traced_match_num_.store(traced_mids_.size(), std::memory_order_relaxed);
+}
+
+bool Tracer::IsMatchTraced(const MatchID mid) const
+{
+    if (traced_match_num_.load(std::memory_order_relaxed) == 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> l(match_mutex_);
+    return traced_mids_.contains(mid);
+}
+
+std::vector<MatchID> Tracer::TracedMatches() const
+{
+    std::lock_guard<std::mutex> l(match_mutex_);
+    std::vector<MatchID> mids(traced_mids_.begin(), traced_mids_.end());
+    std::ranges::sort(mids);
+    return mids;
+}
+
+bool Tracer::ShouldSample() const
+{
+    const uint32_t percent = sample_percent_.load(std::memory_order_relaxed);
+    if (percent >= 100) {
+        return true;
+    }
+    thread_local std::minstd_rand rng(std::random_device{}());
+    return std::uniform_int_distribution<uint32_t>(0, 99)(rng) < percent;
+}
+
+void Tracer::Write(const char* const name, const std::chrono::steady_clock::time_point begin,
+                   const std::chrono::steady_clock::time_point end, const uint32_t tid, const std::string_view args)
+{
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    std::string event = "{\"name\":";
+    AppendJsonString(event, name);
+    event.append(",\"cat\":\"lgtbot\",\"ph\":\"X\",\"pid\":1,\"tid\":").append(std::to_string(tid))
+         .append(",\"ts\":").append(std::to_string(duration_cast<microseconds>(begin.time_since_epoch()).count()))
+         .append(",\"dur\":").append(std::to_string(duration_cast<microseconds>(end - begin).count()))
+         .append(",\"args\":{").append(args).append("}}");
+
+    std::lock_guard<std::mutex> l(file_mutex_);
+    if (!file_.is_open()) {
+        return;
+    }
+    if (file_bytes_ > 1 && file_bytes_ + event.size() > max_file_bytes_) {
+        Close_();
+        std::error_code ec;
+        std::filesystem::rename(path_, path_ + ".1", ec);
+        if (ec) {
+            WarnLog() << "Rotate trace file failed path=" << path_ << " reason=" << ec.message();
+        }
+        ++stats_.rotate_count_;
+        Open_();
+    }
+    // Events are separated by commas at the beginning of lines, so the file is a valid JSON array after it is closed,
+    // and chrome://tracing can also open it before the closing bracket is written.
+    file_ << (file_bytes_ > 2 ? ",\n" : "\n") << event;
+    file_bytes_ += event.size() + 2;
+    ++stats_.event_count_;
+}
+
+void Tracer::Open_()
+{
+    file_.open(path_, std::ios::out | std::ios::trunc);
+    if (!file_.is_open()) {
+        ErrorLog() << "Open trace file failed path=" << path_;
+        return;
+    }
+    file_ << "[";
+    file_bytes_ = 1;
+}
+
+void Tracer::Close_()
+{
+    if (file_.is_open()) {
+        file_ << "\n]\n";
+        file_.close();
+    }
+}
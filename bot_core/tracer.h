@@ -0,0 +1,196 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "bot_core/id.h"
+
+// Write the spans of sampled requests and timeouts to a file in the Chrome trace event format, which can be opened by
+// chrome://tracing or https://ui.perfetto.dev.
+//
+// A request is sampled with the probability of |sample_percent_|, and all requests and timeouts of the traced matches
+// are sampled. When the file exceeds |max_file_bytes_|, it is renamed to '<path>.1' (replacing the older one) and a new
+// file is started.
+class Tracer
+{
+  public:
+    struct Stats
+    {
+        uint64_t event_count_ = 0;
+        uint64_t rotate_count_ = 0;
+    };
+
+    static constexpr const uint64_t k_default_max_file_bytes = 64ULL << 20;
+
+    Tracer(std::string path, const uint64_t max_file_bytes = k_default_max_file_bytes);
+
+    Tracer(const Tracer&) = delete;
+    Tracer(Tracer&&) = delete;
+
+    ~Tracer();
+
+    const std::string& path() const { return path_; }
+
+    void SetSamplePercent(const uint32_t percent) { sample_percent_.store(percent, std::memory_order_relaxed); }
+
+    uint32_t sample_percent() const { return sample_percent_.load(std::memory_order_relaxed); }
+
+    void SetMatchTraced(const MatchID mid, const bool traced);
+
+    bool IsMatchTraced(const MatchID mid) const;
+
+    std::vector<MatchID> TracedMatches() const;
+
+    // Return false if no spans can be sampled, so that spans need not record anything.
+    bool IsEnabled() const
+    {
+        return sample_percent_.load(std::memory_order_relaxed) > 0 ||
+            traced_match_num_.load(std::memory_order_relaxed) > 0;
+    }
+
+    bool ShouldSample() const;
+
+    // |args| is the content of a JSON object without braces.
+    void Write(const char* const name, const std::chrono::steady_clock::time_point begin,
+               const std::chrono::steady_clock::time_point end, const uint32_t tid, const std::string_view args);
+
+    Stats GetStats() const
+    {
+        std::lock_guard<std::mutex> l(file_mutex_);
+        return stats_;
+    }
+
+  private:
+    // REQUIRE: should be protected by file_mutex_
+    void Open_();
+
+    // REQUIRE: should be protected by file_mutex_
+    void Close_();
+
+    const std::string path_;
+    const uint64_t max_file_bytes_;
+    std::atomic<uint32_t> sample_percent_{0};
+
+    mutable std::mutex match_mutex_;
+    std::unordered_set<MatchID> traced_mids_; // REQUIRE: should be protected by match_mutex_
+    std::atomic<uint32_t> traced_match_num_{0};
+
+    mutable std::mutex file_mutex_;
+    std::ofstream file_;          // REQUIRE: should be protected by file_mutex_
+    uint64_t file_bytes_ = 0;     // REQUIRE: should be protected by file_mutex_
+    Stats stats_;                 // REQUIRE: should be protected by file_mutex_
+};
+
+// A span written to the tracer when it is destructed, if the trace it belongs to is sampled.
+//
+// The trace is started by a root span created with a tracer, and the spans created without a tracer in the same thread
+// before the root span is destructed are its children. Spans created out of any trace do nothing, so they are cheap
+// when tracing is disabled.
+class TraceSpan
+{
+  public:
+    // Create a root span. If a trace is already started in this thread, it is a child span.
+    TraceSpan(Tracer* const tracer, const char* const name) : name_(name)
+    {
+        Context& ctx = Ctx_();
+        if (ctx.tracer_) {
+            Begin_();
+        } else if (tracer && tracer->IsEnabled()) {
+            is_root_ = true;
+            ctx.tracer_ = tracer;
+            ctx.sampled_ = tracer->ShouldSample();
+            Begin_();
+        }
+    }
+
+    // Create a child span.
+    explicit TraceSpan(const char* const name) : name_(name)
+    {
+        if (Ctx_().tracer_) {
+            Begin_();
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan(TraceSpan&&) = delete;
+
+    ~TraceSpan()
+    {
+        if (!is_active_) {
+            return;
+        }
+        Context& ctx = Ctx_();
+        if (ctx.sampled_) {
+            ctx.tracer_->Write(name_, begin_, std::chrono::steady_clock::now(), ctx.tid_, args_);
+        }
+        if (is_root_) {
+            ctx.tracer_ = nullptr;
+            ctx.sampled_ = false;
+        }
+    }
+
+    void AddArg(const std::string_view key, const std::string_view value);
+
+    void AddArg(const std::string_view key, const uint64_t value)
+    {
+        if (is_active_) {
+            AppendKey_(key);
+            args_ += std::to_string(value);
+        }
+    }
+
+    // Sample the current trace if the match is traced. Spans which have not been destructed are written.
+    static void SampleIfMatchTraced(const MatchID mid)
+    {
+        Context& ctx = Ctx_();
+        if (ctx.tracer_ && !ctx.sampled_ && ctx.tracer_->IsMatchTraced(mid)) {
+            ctx.sampled_ = true;
+        }
+    }
+
+  private:
+    struct Context
+    {
+        Tracer* tracer_ = nullptr;
+        bool sampled_ = false;
+        uint32_t tid_ = 0;
+    };
+
+    static Context& Ctx_()
+    {
+        static std::atomic<uint32_t> next_tid{1};
+        thread_local Context ctx{.tid_ = next_tid.fetch_add(1, std::memory_order_relaxed)};
+        return ctx;
+    }
+
+    void Begin_()
+    {
+        is_active_ = true;
+        begin_ = std::chrono::steady_clock::now();
+    }
+
+    void AppendKey_(const std::string_view key)
+    {
+        if (!args_.empty()) {
+            args_ += ',';
+        }
+        args_.append("\"").append(key).append("\":");
+    }
+
+    const char* const name_;
+    bool is_active_ = false;
+    bool is_root_ = false;
+    std::chrono::steady_clock::time_point begin_;
+    std::string args_;
+};
@@ -0,0 +1,163 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+#pragma once
+
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "bot_core/bot_core.h"
+
+// A cache of user names got by the `get_user_name` and `get_user_name_in_group` callbacks.
+//
+// Names are keyed by (group ID, user ID) and reused until |ttl| passes. The least recently used names are evicted when
+// the number of names exceeds |capacity|. If |capacity| or |ttl| is 0, the callbacks are invoked each time.
+class UserNameCache
+{
+  public:
+    using Duration = std::chrono::steady_clock::duration;
+
+    struct Stats
+    {
+        uint64_t hit_count_ = 0;
+        uint64_t miss_count_ = 0; // the number of invoked callbacks
+        uint64_t evict_count_ = 0;
+        uint64_t invalidate_count_ = 0;
+        uint64_t name_count_ = 0;
+    };
+
+    static constexpr const uint32_t k_default_capacity = 4096;
+    static constexpr const uint32_t k_default_ttl_sec = 600;
+
+    UserNameCache(void* const handler, const LGTBot_Callback& callbacks, const uint32_t capacity = k_default_capacity,
+            const Duration ttl = std::chrono::seconds(k_default_ttl_sec))
+        : handler_(handler), callbacks_(callbacks), capacity_(capacity), ttl_(ttl)
+    {
+    }
+
+    UserNameCache(const UserNameCache&) = delete;
+    UserNameCache(UserNameCache&&) = delete;
+
+    // Get the name of the user in the group, or the name out of any group if |group_id| is NULL.
+    std::string Get(const char* const user_id, const char* const group_id)
+    {
+        if (capacity_ == 0 || ttl_ == Duration::zero()) {
+            {
+                std::lock_guard<std::mutex> l(mutex_);
+                ++stats_.miss_count_;
+            }
+            return Fetch_(user_id, group_id);
+        }
+        const std::string key = Key_(user_id, group_id);
+        std::unique_lock<std::mutex> l(mutex_);
+        if (const auto it = index_.find(key); it != index_.end()) {
+            if (std::chrono::steady_clock::now() < it->second->expire_time_) {
+                lru_.splice(lru_.begin(), lru_, it->second);
+                ++stats_.hit_count_;
+                return it->second->name_;
+            }
+            Erase_(it);
+        }
+        ++stats_.miss_count_;
+        const uint64_t invalidate_count = stats_.invalidate_count_;
+        l.unlock();
+
+        std::string name = Fetch_(user_id, group_id);
+
+        l.lock();
+        if (stats_.invalidate_count_ != invalidate_count) {
+            return name; // the name may be changed when we are fetching it
+        }
+        if (const auto it = index_.find(key); it != index_.end()) {
+            Erase_(it); // another thread fetches the same name concurrently
+        }
+        lru_.emplace_front(Node{.key_ = key, .user_id_ = user_id, .name_ = name,
+                .expire_time_ = std::chrono::steady_clock::now() + ttl_});
+        index_.emplace(key, lru_.begin());
+        ++stats_.name_count_;
+        while (lru_.size() > capacity_) {
+            Erase_(index_.find(lru_.back().key_));
+            ++stats_.evict_count_;
+        }
+        return name;
+    }
+
+    // Invalidate the name of the user in the group, or the names in all groups and out of any group if |group_id| is
+    // NULL.
+    void Invalidate(const char* const user_id, const char* const group_id)
+    {
+        std::lock_guard<std::mutex> l(mutex_);
+        ++stats_.invalidate_count_;
+        if (group_id) {
+            if (const auto it = index_.find(Key_(user_id, group_id)); it != index_.end()) {
+                Erase_(it);
+            }
+            return;
+        }
+        for (auto it = lru_.begin(); it != lru_.end(); ) {
+            const auto next = std::next(it);
+            if (it->user_id_ == user_id) {
+                Erase_(index_.find(it->key_));
+            }
+            it = next;
+        }
+    }
+
+    Stats GetStats() const
+    {
+        std::lock_guard<std::mutex> l(mutex_);
+        return stats_;
+    }
+
+  private:
+    struct Node
+    {
+        std::string key_;
+        std::string user_id_;
+        std::string name_;
+        std::chrono::steady_clock::time_point expire_time_;
+    };
+
+    using LRUList = std::list<Node>; // most recently used first
+
+    // Group IDs and user IDs never contain '\n', and '\n' is the first character for names out of groups.
+    static std::string Key_(const std::string_view user_id, const char* const group_id)
+    {
+        return (group_id ? std::string(group_id) : std::string()).append(1, '\n').append(user_id);
+    }
+
+    std::string Fetch_(const char* const user_id, const char* const group_id) const
+    {
+        constexpr static uint64_t k_buffer_size = 128;
+        char buffer[k_buffer_size] = {0};
+        if (group_id) {
+            callbacks_.get_user_name_in_group(handler_, buffer, k_buffer_size, group_id, user_id);
+        } else {
+            callbacks_.get_user_name(handler_, buffer, k_buffer_size, user_id);
+        }
+        buffer[k_buffer_size - 1] = '\0';
+        return buffer;
+    }
+
+    // REQUIRE: should be protected by mutex_
+    void Erase_(const std::unordered_map<std::string, LRUList::iterator>::iterator it)
+    {
+        --stats_.name_count_;
+        lru_.erase(it->second);
+        index_.erase(it);
+    }
+
+    void* const handler_;
+    const LGTBot_Callback& callbacks_;
+    const uint32_t capacity_;
+    const Duration ttl_;
+    mutable std::mutex mutex_;
+    LRUList lru_;
+    std::unordered_map<std::string, LRUList::iterator> index_;
+    Stats stats_;
+};
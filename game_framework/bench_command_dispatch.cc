@@ -0,0 +1,144 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+// Compare the time cost to dispatch messages between checking all commands one by one (the former implementation of
+// `AtomicStage::HandleRequest`) and checking only the commands indexed by the first argument of the message, over the
+// commands of the main stage of a game.
+//
+// Each message starts with the keyword of a command followed by arguments which the command rejects, so the game is not
+// changed by the messages and the cost is spent in dispatching. Some messages match no command, like chats in a group.
+//
+// Usage: ./bench_command_dispatch_<game> --msg_num=1000000
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gflags/gflags.h>
+
+#include "game_framework/util.h"
+#include "game_framework/game_options.h"
+#include "game_framework/game_main.h"
+#include "game_framework/mock_match.h"
+#include "game_framework/stage.h"
+
+DEFINE_uint64(player, 0, "Player number: if set to 0, best player num will be set");
+DEFINE_string(resource_dir, "./resource_dir/", "The path of game image resources");
+DEFINE_uint32(msg_num, 1000000, "The number of dispatched messages");
+DEFINE_double(miss_ratio, 0.2, "The ratio of messages which match no command");
+
+namespace lgtbot {
+
+namespace game {
+
+namespace GAME_MODULE_NAME {
+
+internal::MainStage* MakeMainStage(MainStageFactory factory);
+
+template <typename Commands>
+static std::vector<std::string> MakeMessages(const Commands& commands)
+{
+    std::vector<std::string> keywords;
+    for (const auto& cmd : commands) {
+        if (const auto cmd_keywords = cmd.LeadingKeywords()) {
+            keywords.insert(keywords.end(), cmd_keywords->begin(), cmd_keywords->end());
+        }
+    }
+    if (keywords.empty()) {
+        throw std::runtime_error{"The main stage has no commands starting with keywords"};
+    }
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<uint32_t> keyword_dist(0, keywords.size() - 1);
+    std::bernoulli_distribution miss_dist(FLAGS_miss_ratio);
+    std::vector<std::string> msgs;
+    for (uint32_t i = 0; i < FLAGS_msg_num; ++i) {
+        msgs.emplace_back((miss_dist(rng) ? "随便聊聊" : keywords[keyword_dist(rng)]) + " 无效参数 " + std::to_string(i));
+    }
+    return msgs;
+}
+
+template <typename Dispatch>
+static void Benchmark(const char* const name, const std::vector<std::string>& msgs, Dispatch&& dispatch)
+{
+    uint64_t matched_count = 0;
+    const auto begin = std::chrono::steady_clock::now();
+    for (const auto& msg : msgs) {
+        MsgReader reader(msg);
+        matched_count += dispatch(reader).has_value();
+    }
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << name << ": matched=" << matched_count << " sec=" << sec
+              << " ns/msg=" << sec * 1e9 / msgs.size() << std::endl;
+}
+
+template <typename Commands>
+static void Benchmark(const Commands& commands)
+{
+    const auto msgs = MakeMessages(commands);
+    std::cout << "game=" << k_game_name << " command_num=" << commands.size() << std::endl;
+    Benchmark("linear", msgs, [&](MsgReader& reader)
+            {
+                for (const auto& cmd : commands) {
+                    if (auto ret = cmd.CallIfValid(reader, 0, false, EmptyMsgSender::Get()); ret.has_value()) {
+                        return ret;
+                    }
+                }
+                return decltype(commands.CallIfValid(reader, 0, false, EmptyMsgSender::Get()))();
+            });
+    Benchmark("indexed", msgs, [&](MsgReader& reader)
+            {
+                return commands.CallIfValid(reader, 0, false, EmptyMsgSender::Get());
+            });
+}
+
+static int Run()
+{
+    const std::string resource_dir = std::filesystem::absolute(FLAGS_resource_dir + "/").string();
+    const std::string saved_image_dir = (std::filesystem::temp_directory_path() / "lgtbot_bench_command_dispatch").string();
+    GameOptions game_options;
+    GenericOptions generic_options{
+        ImmutableGenericOptions{
+            .user_num_ = 0,
+            .resource_dir_ = resource_dir.c_str(),
+            .saved_image_dir_ = saved_image_dir.c_str(),
+        },
+        MutableGenericOptions{}
+    };
+    MockMsgSender sender(saved_image_dir, true);
+    if (FLAGS_player != 0) {
+        generic_options.bench_computers_to_player_num_ = FLAGS_player;
+    } else if (MsgReader reader{"单机"}; std::ranges::none_of(k_init_options_commands,
+                [&](const auto& cmd) { return cmd.CallIfValid(reader, game_options, generic_options).has_value(); })) {
+        std::cerr << "The game does not support single-player mode, please set --player" << std::endl;
+        return 1;
+    }
+    if (!AdaptOptions(sender, game_options, generic_options, generic_options)) {
+        std::cerr << "Invalid options" << std::endl;
+        return 1;
+    }
+    MockMatch match(saved_image_dir, generic_options.bench_computers_to_player_num_, true);
+    const std::unique_ptr<internal::MainStage> main_stage{MakeMainStage(MainStageFactory{game_options, generic_options, match})};
+    if (!main_stage) {
+        std::cerr << "Start game failed" << std::endl;
+        return 1;
+    }
+    main_stage->VisitCommands([](const auto& commands) { Benchmark(commands); });
+    return 0;
+}
+
+} // namespace GAME_MODULE_NAME
+
+} // namespace game
+
+} // namespace lgtbot
+
+int main(int argc, char** argv)
+{
+    gflags::ParseCommandLineFlags(&argc, &argv, true);
+    return lgtbot::game::GAME_MODULE_NAME::Run();
+}
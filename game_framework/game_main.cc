@@ -53,12 +53,18 @@ lgtbot::game::GameInfo GetGameInfo()
 #undef STRING_LITERAL
 #undef STRING_LITERAL2
     game_info.game_name_ = this_module::k_game_name.c_str();
+    game_info.rule_ = nullptr; // generated by `GetGameRule` when it is shown
     game_info.developer_ = this_module::k_developer.c_str();
     game_info.description_ = this_module::k_description.c_str();
     game_info.achievements_.data_ = this_module::k_achievements.data();
     game_info.achievements_.size_ = this_module::k_achievements.size();
     game_info.default_generic_options_ = this_module::k_default_generic_options;
+    return game_info;
+}
 
+// The rule contains the information of commands, which is generated only when the rule is shown.
+const char* GetGameRule()
+{
     static const auto commands_str = [](const auto& commands, const std::string& command_prefix, std::string hint)
         {
             if (commands.empty()) {
@@ -76,9 +82,7 @@ lgtbot::game::GameInfo GetGameInfo()
         commands_str(this_module::k_rule_commands, "#规则 ", "\n\n可以通过以下指令查看规则细节：") +
         commands_str(this_module::k_init_options_commands, "#新游戏 ",
                 "\n\n可以通过以下预设指令开启不同模式的游戏：");
-    game_info.rule_ = rule_str.c_str();
-
-    return game_info;
+    return rule_str.c_str();
 }
 
 uint64_t MaxPlayerNum(const lgtbot::game::GameOptionsBase* const game_options)
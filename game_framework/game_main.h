@@ -99,7 +99,7 @@ struct GameInfo
 {
     const char* game_name_;
     const char* module_name_;
-    const char* rule_;
+    const char* rule_; // NULL if the module exports `GetGameRule`, kept for the layout of the modules built before
     const char* developer_;
     const char* description_;
     struct {
@@ -4,25 +4,31 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <optional>
 
+#include "bot_core/clock.h"
 #include "bot_core/match_base.h"
 #include "bot_core/msg_sender.h"
 
 class MockMsgSender : public MsgSenderBase
 {
   public:
-    MockMsgSender(std::filesystem::path image_dir)
+    // If |is_quiet| is true, the messages are discarded instead of being printed.
+    MockMsgSender(std::filesystem::path image_dir, const bool is_quiet = false)
         : image_dir_(std::move(image_dir))
         , is_public_(true)
+        , is_quiet_(is_quiet)
     {
     }
 
-    MockMsgSender(std::filesystem::path image_dir, const PlayerID pid, const bool is_public)
+    MockMsgSender(std::filesystem::path image_dir, const PlayerID pid, const bool is_public, const bool is_quiet = false)
         : image_dir_(std::move(image_dir))
         , pid_(pid)
         , is_public_(is_public)
+        , is_quiet_(is_quiet)
     {
     }
 
@@ -36,6 +42,8 @@ class MockMsgSender : public MsgSenderBase
         return MsgSenderGuard(*this);
     }
 
+    virtual bool HasReceiver() const override { return !is_quiet_; }
+
   protected:
     virtual void SaveText(const char* const data, const uint64_t len) override
     {
@@ -74,6 +82,10 @@ class MockMsgSender : public MsgSenderBase
 
     virtual void Flush() override
     {
+        if (is_quiet_) {
+            ss_.str("");
+            return;
+        }
         if (is_public_) {
             std::cout << "[BOT -> GROUP]";
         } else if (pid_.has_value()) {
@@ -92,15 +104,17 @@ class MockMsgSender : public MsgSenderBase
     const std::filesystem::path image_dir_;
     const std::optional<PlayerID> pid_;
     const bool is_public_;
+    const bool is_quiet_;
     std::stringstream ss_;
 };
 
 class MockMatch : public MatchBase
 {
   public:
-    MockMatch(const std::filesystem::path& image_dir, const uint64_t player_num)
+    MockMatch(const std::filesystem::path& image_dir, const uint64_t player_num, const bool is_quiet = false)
         : image_dir_(image_dir.string())
-        , boardcast_sender_(image_dir_)
+        , is_quiet_(is_quiet)
+        , boardcast_sender_(image_dir_, is_quiet)
         , is_eliminated_(player_num, false) {}
 
     virtual ~MockMatch() {}
@@ -111,7 +125,7 @@ class MockMatch : public MatchBase
     {
         auto it = tell_senders_.find(pid);
         if (it == tell_senders_.end()) {
-            it = tell_senders_.try_emplace(pid, image_dir_, pid, false).first;
+            it = tell_senders_.try_emplace(pid, image_dir_, pid, false, is_quiet_).first;
         }
         return it->second;
     }
@@ -129,9 +143,32 @@ class MockMatch : public MatchBase
 
     virtual const char* PlayerAvatar(const PlayerID& pid, const int32_t /*size*/) override { return ""; }
 
-    virtual void StartTimer(const uint64_t, void* p, void(*cb)(void*, uint64_t)) override {}
+    // The timer is never fired by itself. Alerts are not sent, and the timeout should be simulated by |SkipToTimeout|.
+    virtual void StartTimer(const uint64_t sec, void* p, void(*cb)(void*, uint64_t)) override
+    {
+        if (sec > 0) {
+            timer_deadline_ = clock_.Now() + std::chrono::seconds(sec);
+        }
+    }
 
-    virtual void StopTimer() override {}
+    virtual void StopTimer() override { timer_deadline_ = std::nullopt; }
+
+    virtual int64_t NowNs() const override
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(clock_.Now().time_since_epoch()).count();
+    }
+
+    // Advance the simulated clock to the deadline of the timer, as if the players waited until the timeout. The caller
+    // should handle the timeout of the main stage then. Return false if the timer is not started.
+    bool SkipToTimeout()
+    {
+        if (!timer_deadline_.has_value()) {
+            return false;
+        }
+        clock_.Advance(*timer_deadline_ - clock_.Now());
+        timer_deadline_ = std::nullopt;
+        return true;
+    }
 
     virtual void Eliminate(const PlayerID pid) override { is_eliminated_[pid] = true; }
 
@@ -143,20 +180,28 @@ class MockMatch : public MatchBase
 
     virtual uint64_t MatchId() const override
     {
-        static uint64_t match_id = 0;
+        static std::atomic<uint64_t> match_id = 0;
         return ++match_id;
     }
 
     virtual const char* GameName() const override { return "测试游戏"; }
 
+    virtual uint64_t RandomSeed() const override { return random_seed_; }
+
+    void SetRandomSeed(const uint64_t seed) { random_seed_ = seed; }
+
     bool IsEliminated(const PlayerID pid) const { return is_eliminated_[pid]; }
 
     const std::filesystem::path image_dir() const { return image_dir_; }
 
   private:
     const std::string image_dir_;
+    const bool is_quiet_;
     MockMsgSender boardcast_sender_;
     std::map<uint64_t, MockMsgSender> tell_senders_;
     std::vector<bool> is_eliminated_;
+    uint64_t random_seed_ = 0;
+    SimulatedClock clock_;
+    std::optional<Clock::TimePoint> timer_deadline_;
 };
 
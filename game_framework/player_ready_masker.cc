@@ -31,39 +31,39 @@ PlayerReadyMasker::PlayerReadyMasker(const uint64_t match_id, const char* const
 //       We can remove this function and check whether the player is controlled by a computer in `SetReady`.
 void PlayerReadyMasker::SilentlySetReady(const size_t index)
 {
-    Log_(DebugLog()) << "Begin setting ready silently, index: " << index << ", " << ToString_();
+    DebugLog() << log_header_ << "Begin setting ready silently, index: " << index << ", " << ToString_();
     states_[index].is_ready_ = true;
     // We do not set `any_ready_` flag when computers completing actions. The reason is computers act before users. If
     // all users are temporarily inactive, we should ensure one of them have the opportunity to take action again. By
     // not setting this flag, stage will not be checked out until timeout or one of the user take action again.
-    Log_(DebugLog()) << "Finish setting ready silently, index: " << index << ", " << ToString_();
+    DebugLog() << log_header_ << "Finish setting ready silently, index: " << index << ", " << ToString_();
 }
 
 void PlayerReadyMasker::SetReady(const size_t index)
 {
-    Log_(DebugLog()) << "Begin setting ready, index: " << index << ", " << ToString_();
+    DebugLog() << log_header_ << "Begin setting ready, index: " << index << ", " << ToString_();
     any_ready_ = true;
     states_[index].is_ready_ = true;
-    Log_(DebugLog()) << "Finish setting ready, index: " << index << ", " << ToString_();
+    DebugLog() << log_header_ << "Finish setting ready, index: " << index << ", " << ToString_();
 }
 
 void PlayerReadyMasker::UnsetReady(const size_t index)
 {
-    Log_(DebugLog()) << "Begin unsetting ready, index: " << index << ", " << ToString_();
+    DebugLog() << log_header_ << "Begin unsetting ready, index: " << index << ", " << ToString_();
     states_[index].is_ready_ = false;
     // If the unset ready player is temporarily inactive, we need wait for him until timeout.
     any_ready_ = false;
-    Log_(DebugLog()) << "Finish unsetting ready, index: " << index << ", " << ToString_();
+    DebugLog() << log_header_ << "Finish unsetting ready, index: " << index << ", " << ToString_();
 }
 
 void PlayerReadyMasker::ClearReady()
 {
-    Log_(DebugLog()) << "Begin clearing ready, " << ToString_();
+    DebugLog() << log_header_ << "Begin clearing ready, " << ToString_();
     for (auto& state : states_) {
         state.is_ready_ = false;
     }
     any_ready_ = false;
-    Log_(DebugLog()) << "Finish clearing ready, " << ToString_();
+    DebugLog() << log_header_ << "Finish clearing ready, " << ToString_();
 }
 
 void PlayerReadyMasker::SetTemporaryInactive(const size_t index)
@@ -76,7 +76,7 @@ void PlayerReadyMasker::SetPermanentInactive(const size_t index)
     Inactivate_(index, ActiveState::PERMANENTLY_INACTIVE);
     if (std::ranges::all_of(states_, [](const State state) { return state.active_state_ == ActiveState::PERMANENTLY_INACTIVE; })) {
         is_all_permanent_inactive_ = true;
-        Log_(WarnLog()) << "Begin deduction, index: " << index << ", " << ToString_();
+        WarnLog() << log_header_ << "Begin deduction, index: " << index << ", " << ToString_();
     }
 }
 
@@ -85,9 +85,9 @@ bool PlayerReadyMasker::SetActive(const size_t index)
     auto& state = states_[index];
     assert(state.active_state_ != ActiveState::PERMANENTLY_INACTIVE);
     if (state.active_state_ == ActiveState::TEMPORARILY_INACTIVE) {
-        Log_(DebugLog()) << "Begin setting active, index: " << index << ", " << ToString_();
+        DebugLog() << log_header_ << "Begin setting active, index: " << index << ", " << ToString_();
         state.active_state_ = ActiveState::ACTIVE;
-        Log_(DebugLog()) << "Finish setting active, index: " << index << ", " << ToString_();
+        DebugLog() << log_header_ << "Finish setting active, index: " << index << ", " << ToString_();
         return true;
     }
     return false;
@@ -108,9 +108,9 @@ void PlayerReadyMasker::Inactivate_(const size_t index, const ActiveState new_ac
     assert(new_active_state != ActiveState::ACTIVE);
     auto& active_state = states_[index].active_state_;
     if (active_state == ActiveState::ACTIVE) {
-        Log_(DebugLog()) << "Inactivate game stage mask begin index: " << index << ", " << ToString_();
+        DebugLog() << log_header_ << "Inactivate game stage mask begin index: " << index << ", " << ToString_();
         any_ready_ = true;
-        Log_(DebugLog()) << "Inactivate game stage mask finish index: " << index << ", " << ToString_();
+        DebugLog() << log_header_ << "Inactivate game stage mask finish index: " << index << ", " << ToString_();
     }
     active_state = new_active_state;
 }
@@ -69,9 +69,6 @@ class PlayerReadyMasker
     static std::string StateToString_(const State state);
     std::string ToString_();
 
-    template <typename Logger>
-    Logger& Log_(Logger&& logger) { return logger << log_header_; }
-
     std::vector<State> states_;
     bool any_ready_{false};                  // be true if any user complete action
     bool is_all_permanent_inactive_{false};  // not necessary, to prevent always checking all ready flags
@@ -2,7 +2,15 @@
 //
 // This source code is licensed under LGPLv2 (found in the LICENSE file).
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <thread>
 
 #include <gflags/gflags.h>
 
@@ -11,13 +19,21 @@
 #include "game_framework/game_main.h"
 #include "game_framework/mock_match.h"
 #include "game_framework/stage.h"
+#include "utility/log.h"
 
 DEFINE_uint64(player, 0, "Player number: if set to 0, best player num will be set");
-DEFINE_uint64(repeat, 1, "Repeat times: if set to 0, will run unlimitedly");
+DEFINE_uint64(repeat, 1, "Repeat times: if set to 0, will run unlimitedly and print the summary every --summary_interval matches");
 DEFINE_string(resource_dir, "./resource_dir/", "The path of game image resources");
 DEFINE_bool(gen_image, false, "Whether generate image or not");
 DEFINE_string(image_dir, "./.lgtbot_image/", "The path of directory to store generated images");
 DEFINE_bool(input_options, false, "Input the game options by stdin");
+DEFINE_uint64(threads, 1, "The number of threads running matches concurrently, messages are not printed if it is larger than 1");
+DEFINE_uint64(summary_interval, 1000, "The number of matches between two summaries printed when running unlimitedly");
+DEFINE_uint64(seed, 0, "The seed of random numbers: the i-th match is seeded with seed + i, if set to 0, the current time will be used");
+DEFINE_string(report_file, "", "The path of the file to write the result of each match: if set to empty, will not write");
+DEFINE_string(report_format, "csv", "The format of the report file: csv or json");
+DEFINE_int32(log_level, 0, "The minimal level of logs to be written: 0-DEBUG 1-INFO 2-WARN 3-ERROR 4-FATAL 5-NONE");
+DEFINE_bool(sync_log, false, "Write logs in the threads running matches instead of a background thread");
 
 extern bool enable_markdown_to_image;
 
@@ -126,17 +142,31 @@ std::unique_ptr<internal::MainStage> StartMainStage(Options& options, RunGameMoc
     return main_stage;
 }
 
-void KeepPlayersActUntilGameOver(const Options& options, const RunGameMockMatch& match, MainStageBase& main_stage)
+// Return the number of computer acts. If all computers are ready but the stage waits for the timeout, the clock of the
+// match is advanced to the deadline at once, so games with timeouts can also be simulated.
+uint64_t KeepPlayersActUntilGameOver(const Options& options, RunGameMockMatch& match, MainStageBase& main_stage)
 {
-    uint64_t ok_count = 0;
-    for (uint64_t i = 0;
-            !main_stage.IsOver() && ok_count < options.generic_options_.bench_computers_to_player_num_;
-            i = (i + 1) % options.generic_options_.bench_computers_to_player_num_) {
-        if (match.IsEliminated(i) || StageErrCode::OK == main_stage.HandleComputerAct(i, true)) {
-            ++ok_count;
-        } else {
-            ok_count = 0;
+    uint64_t act_count = 0;
+    while (true) {
+        uint64_t ok_count = 0;
+        for (uint64_t i = 0;
+                !main_stage.IsOver() && ok_count < options.generic_options_.bench_computers_to_player_num_;
+                i = (i + 1) % options.generic_options_.bench_computers_to_player_num_) {
+            if (match.IsEliminated(i)) {
+                ++ok_count;
+                continue;
+            }
+            ++act_count;
+            if (StageErrCode::OK == main_stage.HandleComputerAct(i, true)) {
+                ++ok_count;
+            } else {
+                ok_count = 0;
+            }
+        }
+        if (main_stage.IsOver() || !match.SkipToTimeout()) {
+            return act_count;
         }
+        main_stage.HandleTimeout();
     }
 }
 
@@ -149,8 +179,18 @@ void ShowScores(MockMsgSender& sender, const Options& options, const MainStageBa
     }
 }
 
-int Run(const uint64_t index)
+struct MatchResult
+{
+    uint64_t index_;
+    uint64_t duration_us_;
+    uint64_t computer_act_num_;
+    std::vector<int64_t> scores_;
+};
+
+MatchResult Run(const uint64_t index, const uint64_t seed)
 {
+    const auto begin = std::chrono::steady_clock::now();
+
     static const auto image_dir_base = std::filesystem::absolute(FLAGS_image_dir) /
         std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
 
@@ -158,17 +198,182 @@ int Run(const uint64_t index)
         .resource_dir_ = std::filesystem::absolute(FLAGS_resource_dir + "/").string(),
         .saved_image_dir_ = (image_dir_base / std::to_string(index)).string(),
     }};
-    MockMsgSender sender(options.generic_options_.saved_image_dir_);
+    const bool is_quiet = FLAGS_threads > 1;
+    MockMsgSender sender(options.generic_options_.saved_image_dir_, is_quiet);
     InitOptions(sender, options);
     RunGameMockMatch match{
         options.generic_options_.saved_image_dir_,
-        options.generic_options_.bench_computers_to_player_num_
+        options.generic_options_.bench_computers_to_player_num_,
+        is_quiet
     };
+    match.SetRandomSeed(seed);
     const auto main_stage = StartMainStage(options, match);
-    KeepPlayersActUntilGameOver(options, match, *main_stage);
+    MatchResult result{.index_ = index};
+    result.computer_act_num_ = KeepPlayersActUntilGameOver(options, match, *main_stage);
     assert(main_stage->IsOver());
     ShowScores(sender, options, *main_stage);
-    return 0;
+    for (PlayerID pid = 0; pid < options.generic_options_.bench_computers_to_player_num_; ++pid) {
+        result.scores_.emplace_back(main_stage->PlayerScore(pid));
+    }
+    result.duration_us_ =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+    return result;
+}
+
+struct PositionSummary
+{
+    double mean_;
+    double stddev_;
+    int64_t min_;
+    std::optional<int64_t> median_; // be empty if the results are not kept
+    int64_t max_;
+    double win_rate_; // the ratio of matches in which the player gets the highest score (including ties)
+};
+
+// The aggregates of the results, which are updated match by match, so that we can summarize unlimited matches without
+// keeping the results.
+class ResultAggregate
+{
+  public:
+    void Add(const MatchResult& result)
+    {
+        ++match_num_;
+        duration_us_sum_ += result.duration_us_;
+        computer_act_num_sum_ += result.computer_act_num_;
+        if (result.scores_.empty()) {
+            return;
+        }
+        if (positions_.size() < result.scores_.size()) {
+            positions_.resize(result.scores_.size());
+        }
+        const int64_t max_score = *std::ranges::max_element(result.scores_);
+        for (size_t pid = 0; pid < result.scores_.size(); ++pid) {
+            positions_[pid].Add(result.scores_[pid], result.scores_[pid] == max_score);
+        }
+    }
+
+    uint64_t match_num() const { return match_num_; }
+    double mean_duration_us() const { return duration_us_sum_ / match_num_; }
+    double mean_computer_act_num() const { return computer_act_num_sum_ / match_num_; }
+
+    std::vector<PositionSummary> Summarize() const
+    {
+        std::vector<PositionSummary> summaries;
+        for (const auto& position : positions_) {
+            summaries.emplace_back(PositionSummary{
+                    .mean_ = position.mean_,
+                    .stddev_ = std::sqrt(position.square_diff_sum_ / position.count_),
+                    .min_ = position.min_,
+                    .max_ = position.max_,
+                    .win_rate_ = static_cast<double>(position.win_count_) / match_num_,
+                });
+        }
+        return summaries;
+    }
+
+  private:
+    struct Position
+    {
+        // Welford's algorithm, which does not lose the precision when the count is large.
+        void Add(const int64_t score, const bool is_win)
+        {
+            ++count_;
+            const double diff = score - mean_;
+            mean_ += diff / count_;
+            square_diff_sum_ += diff * (score - mean_);
+            min_ = std::min(min_, score);
+            max_ = std::max(max_, score);
+            win_count_ += is_win;
+        }
+
+        uint64_t count_ = 0;
+        double mean_ = 0;
+        double square_diff_sum_ = 0;
+        int64_t min_ = std::numeric_limits<int64_t>::max();
+        int64_t max_ = std::numeric_limits<int64_t>::min();
+        uint64_t win_count_ = 0;
+    };
+
+    uint64_t match_num_ = 0;
+    double duration_us_sum_ = 0;
+    double computer_act_num_sum_ = 0;
+    std::vector<Position> positions_;
+};
+
+// Fill the medians from the kept results.
+void FillMedians(std::vector<PositionSummary>& summaries, const std::vector<MatchResult>& results)
+{
+    for (size_t pid = 0; pid < summaries.size(); ++pid) {
+        std::vector<int64_t> scores;
+        for (const auto& result : results) {
+            if (pid < result.scores_.size()) {
+                scores.emplace_back(result.scores_[pid]);
+            }
+        }
+        if (!scores.empty()) {
+            std::ranges::nth_element(scores, scores.begin() + scores.size() / 2);
+            summaries[pid].median_ = scores[scores.size() / 2];
+        }
+    }
+}
+
+void ShowSummary(const ResultAggregate& aggregate, const std::vector<PositionSummary>& summaries, const double seconds,
+        const uint64_t seed)
+{
+    std::cout << "matches=" << aggregate.match_num() << " seed=" << seed << " seconds=" << seconds
+              << " matches/sec=" << aggregate.match_num() / seconds
+              << " mean_duration_ms=" << aggregate.mean_duration_us() / 1000
+              << " mean_computer_acts=" << aggregate.mean_computer_act_num() << std::endl;
+    for (size_t pid = 0; pid < summaries.size(); ++pid) {
+        const auto& summary = summaries[pid];
+        std::cout << "PLAYER_" << pid << ": mean=" << summary.mean_ << " stddev=" << summary.stddev_
+                  << " min=" << summary.min_;
+        if (summary.median_.has_value()) {
+            std::cout << " median=" << *summary.median_;
+        }
+        std::cout << " max=" << summary.max_ << " win_rate=" << summary.win_rate_ << std::endl;
+    }
+}
+
+void WriteCsvReport(std::ostream& os, const std::vector<MatchResult>& results)
+{
+    const size_t player_num = results.empty() ? 0 : results.front().scores_.size();
+    os << "index,duration_us,computer_act_num";
+    for (size_t pid = 0; pid < player_num; ++pid) {
+        os << ",score_" << pid;
+    }
+    os << "\n";
+    for (const auto& result : results) {
+        os << result.index_ << "," << result.duration_us_ << "," << result.computer_act_num_;
+        for (const auto score : result.scores_) {
+            os << "," << score;
+        }
+        os << "\n";
+    }
+}
+
+void WriteJsonReport(std::ostream& os, const std::vector<MatchResult>& results,
+        const std::vector<PositionSummary>& summaries, const double seconds, const uint64_t seed)
+{
+    os << "{\"seed\":" << seed << ",\"seconds\":" << seconds << ",\"matches_per_second\":" << results.size() / seconds
+       << ",\"positions\":[";
+    for (size_t pid = 0; pid < summaries.size(); ++pid) {
+        const auto& summary = summaries[pid];
+        os << (pid == 0 ? "" : ",") << "{\"mean\":" << summary.mean_ << ",\"stddev\":" << summary.stddev_
+           << ",\"min\":" << summary.min_ << ",\"median\":" << summary.median_.value() << ",\"max\":" << summary.max_
+           << ",\"win_rate\":" << summary.win_rate_ << "}";
+    }
+    os << "],\"matches\":[";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& result = results[i];
+        os << (i == 0 ? "" : ",") << "{\"index\":" << result.index_ << ",\"duration_us\":" << result.duration_us_
+           << ",\"computer_act_num\":" << result.computer_act_num_ << ",\"scores\":[";
+        for (size_t pid = 0; pid < result.scores_.size(); ++pid) {
+            os << (pid == 0 ? "" : ",") << result.scores_[pid];
+        }
+        os << "]}";
+    }
+    os << "]}\n";
 }
 
 } // namespace GAME_MODULE_NAME
@@ -179,17 +384,98 @@ int Run(const uint64_t index)
 
 int main(int argc, char** argv)
 {
-    std::srand(std::chrono::steady_clock::now().time_since_epoch().count());
-
 #ifdef __linux__
     std::locale::global(std::locale(""));
 #endif
     gflags::ParseCommandLineFlags(&argc, &argv, true);
 
+    if (FLAGS_threads == 0) {
+        std::cerr << "[ERROR] The number of threads should be positive" << std::endl;
+        return 1;
+    }
+    if (FLAGS_repeat == 0 && !FLAGS_report_file.empty()) {
+        std::cerr << "[ERROR] The report file cannot be written when running unlimitedly" << std::endl;
+        return 1;
+    }
+    if (FLAGS_repeat == 0 && FLAGS_summary_interval == 0) {
+        std::cerr << "[ERROR] The summary interval should be positive when running unlimitedly" << std::endl;
+        return 1;
+    }
+    if (FLAGS_report_format != "csv" && FLAGS_report_format != "json") {
+        std::cerr << "[ERROR] Unknown report format: " << FLAGS_report_format << std::endl;
+        return 1;
+    }
+
+    if (FLAGS_log_level < LOG_LEVEL_DEBUG || FLAGS_log_level > LOG_LEVEL_NONE) {
+        std::cerr << "[ERROR] Unknown log level: " << FLAGS_log_level << std::endl;
+        return 1;
+    }
+
     enable_markdown_to_image = FLAGS_gen_image && !FLAGS_image_dir.empty();
+    GlobalLogBackend().SetLevel(static_cast<LogLevel>(FLAGS_log_level));
+    GlobalLogBackend().SetAsync(!FLAGS_sync_log);
+
+    const uint64_t seed = FLAGS_seed != 0 ? FLAGS_seed : std::chrono::steady_clock::now().time_since_epoch().count();
+    std::mutex mutex;
+    lgtbot::game::GAME_MODULE_NAME::ResultAggregate aggregate; // REQUIRE: should be protected by mutex
+    std::vector<lgtbot::game::GAME_MODULE_NAME::MatchResult> results; // empty when running unlimitedly
+    std::atomic<uint64_t> next_index{0};
+    std::atomic<bool> has_error{false};
+    const auto begin = std::chrono::steady_clock::now();
+    const auto run_matches = [&]
+        {
+            for (uint64_t i = next_index++; (FLAGS_repeat == 0 || i < FLAGS_repeat) && !has_error; i = next_index++) {
+                try {
+                    auto result = lgtbot::game::GAME_MODULE_NAME::Run(i, seed + i);
+                    std::lock_guard<std::mutex> l(mutex);
+                    aggregate.Add(result);
+                    if (FLAGS_repeat != 0) {
+                        results.emplace_back(std::move(result));
+                    } else if (aggregate.match_num() % FLAGS_summary_interval == 0) {
+                        lgtbot::game::GAME_MODULE_NAME::ShowSummary(aggregate, aggregate.Summarize(),
+                                std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count(), seed);
+                    }
+                } catch (const std::exception& e) {
+                    std::cerr << "[ERROR] Match " << i << " failed: " << e.what() << std::endl;
+                    has_error = true;
+                }
+            }
+        };
+
+    if (FLAGS_threads == 1) {
+        run_matches();
+    } else {
+        std::vector<std::thread> threads;
+        for (uint64_t i = 0; i < FLAGS_threads; ++i) {
+            threads.emplace_back(run_matches);
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    // The logs which are still buffered are not counted in the time of matches.
+    GlobalLogBackend().Flush();
+    const double log_flush_seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count() - seconds;
+    if (has_error) {
+        return 1;
+    }
 
-    for (uint64_t i = 0; i < FLAGS_repeat; ++i) {
-        lgtbot::game::GAME_MODULE_NAME::Run(i);
+    std::ranges::sort(results, {}, &lgtbot::game::GAME_MODULE_NAME::MatchResult::index_);
+    auto summaries = aggregate.Summarize();
+    lgtbot::game::GAME_MODULE_NAME::FillMedians(summaries, results);
+    lgtbot::game::GAME_MODULE_NAME::ShowSummary(aggregate, summaries, seconds, seed);
+    const auto log_stats = GlobalLogBackend().Stats();
+    std::cout << "logs=" << log_stats.written_count_ << " log_blocked=" << log_stats.blocked_count_
+              << " log_flush_ms=" << log_flush_seconds * 1000 << std::endl;
+    if (!FLAGS_report_file.empty()) {
+        std::ofstream report_file(FLAGS_report_file);
+        if (FLAGS_report_format == "csv") {
+            lgtbot::game::GAME_MODULE_NAME::WriteCsvReport(report_file, results);
+        } else {
+            lgtbot::game::GAME_MODULE_NAME::WriteJsonReport(report_file, results, summaries, seconds, seed);
+        }
     }
 
     return 0;
@@ -16,8 +16,8 @@ namespace GAME_MODULE_NAME {
 
 namespace internal {
 
-template <typename Command>
-static std::string CommandInfo(const std::vector<Command>& commands, const std::string_view stage_name, const bool text_mode)
+template <typename Commands>
+static std::string CommandInfo(const Commands& commands, const std::string_view stage_name, const bool text_mode)
 {
     if (commands.empty()) {
         return "";
@@ -42,7 +42,7 @@ std::string AtomicStage::StageInfo() const
 {
     std::string info = upper_stage_info_ + fsm_.Name();
     if (const auto& timer_finish_time = fsm_.Global().TimerFinishTime(); timer_finish_time.has_value()) {
-        const auto remain_duration = *timer_finish_time - std::chrono::steady_clock::now();
+        const auto remain_duration = *timer_finish_time - fsm_.Global().Now();
         info += "（剩余时间：";
         info += std::to_string(std::chrono::duration_cast<std::chrono::seconds>(remain_duration).count());
         info += "秒）";
@@ -57,33 +57,31 @@ std::string AtomicStage::CommandInfo(const bool text_mode) const
 
 void AtomicStage::HandleStageBegin()
 {
-    StageLog_(InfoLog()) << "HandleStageBegin begin";
-    fsm_.Global().Boardcast() << "【当前阶段】\n" << StageInfo();
+    InfoLog() << LogHeader_() << "HandleStageBegin begin";
+    fsm_.Global().Boardcast() << "【当前阶段】\n" << [this] { return StageInfo(); };
     fsm_.OnStageBegin();
     Handle_(StageErrCode::OK);
 }
 
 StageErrCode AtomicStage::HandleTimeout()
 {
-    StageLog_(InfoLog()) << "HandleTimeout begin";
+    InfoLog() << LogHeader_() << "HandleTimeout begin";
     return Handle_(fsm_.OnStageTimeout());
 }
 
 StageErrCode AtomicStage::HandleRequest(MsgReader& reader, const uint64_t pid, const bool is_public, MsgSenderBase& reply)
 {
-    for (const auto& cmd : fsm_.Commands()) {
-        if (const auto rc = cmd.CallIfValid(reader, pid, is_public, reply); rc.has_value()) {
-            StageLog_(InfoLog()) << "HandleRequest matched pid=" << pid << " is_public="
-                << Bool2Str(is_public) << " rc=" << *rc;
-            return Handle_(pid, true, *rc);
-        }
+    if (const auto rc = fsm_.Commands().CallIfValid(reader, pid, is_public, reply); rc.has_value()) {
+        InfoLog() << LogHeader_() << "HandleRequest matched pid=" << pid << " is_public="
+            << Bool2Str(is_public) << " rc=" << *rc;
+        return Handle_(pid, true, *rc);
     }
     return StageErrCode::NOT_FOUND;
 }
 
 StageErrCode AtomicStage::HandleLeave(const PlayerID pid)
 {
-    StageLog_(InfoLog()) << "HandleLeave begin pid=" << pid;
+    InfoLog() << LogHeader_() << "HandleLeave begin pid=" << pid;
     fsm_.Global().Leave(pid);
     return Handle_(pid, true, fsm_.OnPlayerLeave(pid));
 }
@@ -91,37 +89,35 @@ StageErrCode AtomicStage::HandleLeave(const PlayerID pid)
 StageErrCode AtomicStage::HandleComputerAct(const uint64_t pid, const bool ready_as_user)
 {
     // For run_game_xxx, the tell msg will be output, so do not use EmptyMsgSender here.
-    StageLog_(InfoLog()) << "HandleComputerAct begin pid=" << pid << " ready_as_user=" << Bool2Str(ready_as_user);
+    InfoLog() << LogHeader_() << "HandleComputerAct begin pid=" << pid << " ready_as_user=" << Bool2Str(ready_as_user);
     return Handle_(pid, ready_as_user, fsm_.OnComputerAct(pid, fsm_.Global().TellMsgSender(pid)));
 }
 
-template <typename Logger>
-Logger& AtomicStage::StageLog_(Logger&& logger) const
-{
-    return fsm_.Global().StageLog(logger, fsm_.Name()) << "[atomic_stage] ";
-}
+StageLogHeader AtomicStage::LogHeader_() const { return fsm_.Global().LogHeader(fsm_.Name(), "atomic_stage"); }
 
 StageErrCode AtomicStage::Handle_(StageErrCode rc)
 {
-    StageLog_(InfoLog()) << "Handle errcode rc=" << rc << " is_ok_to_checkout=" << Bool2Str(fsm_.Global().IsOkToCheckout());
+    InfoLog() << LogHeader_() << "Handle errcode rc=" << rc << " is_ok_to_checkout=" << Bool2Str(fsm_.Global().IsOkToCheckout());
     const auto trigger_all_player_ready = [&]() { return rc != StageErrCode::CHECKOUT && fsm_.Global().IsOkToCheckout(); };
     if (trigger_all_player_ready()) {
         while (true) {
             // We do not check IsReady only when rc is READY to handle all player force exit.
             rc = fsm_.OnStageOver();
-            StageLog_(InfoLog()) << "OnStageOver finish rc=" << rc;
+            InfoLog() << LogHeader_() << "OnStageOver finish rc=" << rc;
             if (!trigger_all_player_ready()) {
                 break;
             }
 #ifndef TEST_BOT
-            std::this_thread::sleep_for(std::chrono::seconds(5)); // prevent frequent messages
+            if (!fsm_.Global().IsInDeduction()) {
+                std::this_thread::sleep_for(std::chrono::seconds(5)); // prevent frequent messages
+            }
 #endif
         }
     }
     if (rc == StageErrCode::CHECKOUT) {
         fsm_.Global().StopTimer();
         SetOver();
-        StageLog_(InfoLog()) << "Over";
+        InfoLog() << LogHeader_() << "Over";
     }
     return rc;
 }
@@ -129,7 +125,7 @@ StageErrCode AtomicStage::Handle_(StageErrCode rc)
 StageErrCode AtomicStage::Handle_(const PlayerID pid, const bool is_user, StageErrCode rc)
 {
     if (rc == StageErrCode::READY) {
-        StageLog_(InfoLog()) << "Handle READY pid=" << pid << " is_user=" << Bool2Str(is_user);
+        InfoLog() << LogHeader_() << "Handle READY pid=" << pid << " is_user=" << Bool2Str(is_user);
         if (is_user) {
             fsm_.Global().SetReady(pid);
         } else {
@@ -138,7 +134,7 @@ StageErrCode AtomicStage::Handle_(const PlayerID pid, const bool is_user, StageE
         rc = StageErrCode::OK;
     }
 #ifndef TEST_BOT
-    if (!is_user && fsm_.Global().IsOkToCheckout()) { // computer action
+    if (!is_user && fsm_.Global().IsOkToCheckout() && !fsm_.Global().IsInDeduction()) { // computer action
         std::this_thread::sleep_for(std::chrono::seconds(5)); // prevent frequent messages
     }
 #endif
@@ -157,25 +153,23 @@ std::string CompoundStage::CommandInfo(const bool text_mode) const
 
 void CompoundStage::HandleStageBegin()
 {
-    StageLog_(InfoLog()) << "HandleStageBegin begin";
+    InfoLog() << LogHeader_() << "HandleStageBegin begin";
     variant_sub_stage_.Init(upper_stage_info_ + fsm_.Name());
     SwitchSubStage_(variant_sub_stage_.Get(), "begin");
 }
 
 StageErrCode CompoundStage::HandleTimeout()
 {
-    StageLog_(InfoLog()) << "HandleTimeout begin";
+    InfoLog() << LogHeader_() << "HandleTimeout begin";
     return PassToSubStage_([](StageBaseInternal& sub_stage) { return sub_stage.HandleTimeout(); }, CheckoutReason::BY_TIMEOUT);
 }
 
 StageErrCode CompoundStage::HandleRequest(MsgReader& reader, const uint64_t pid, const bool is_public, MsgSenderBase& reply)
 {
-    for (const auto& cmd : fsm_.Commands()) {
-        if (const auto rc = cmd.CallIfValid(reader, pid, is_public, reply); rc.has_value()) {
-            StageLog_(InfoLog()) << "handle request pid=" << pid << " is_public="
-                << Bool2Str(is_public) << " rc=" << *rc;
-            return *rc;
-        }
+    if (const auto rc = fsm_.Commands().CallIfValid(reader, pid, is_public, reply); rc.has_value()) {
+        InfoLog() << LogHeader_() << "handle request pid=" << pid << " is_public="
+            << Bool2Str(is_public) << " rc=" << *rc;
+        return *rc;
     }
     return PassToSubStage_(
             [&](StageBaseInternal& sub_stage) { return sub_stage.HandleRequest(reader, pid, is_public, reply); },
@@ -185,7 +179,7 @@ StageErrCode CompoundStage::HandleRequest(MsgReader& reader, const uint64_t pid,
 StageErrCode CompoundStage::HandleLeave(const PlayerID pid)
 {
     // We must call CompoundStage's OnPlayerLeave first so that it can deceide whether to finish game when substage is over.
-    StageLog_(InfoLog()) << "HandleLeave begin pid=" << pid;
+    InfoLog() << LogHeader_() << "HandleLeave begin pid=" << pid;
     fsm_.OnPlayerLeave(pid);
     return PassToSubStage_(
             [pid](StageBaseInternal& sub_stage) { return sub_stage.HandleLeave(pid); },
@@ -195,7 +189,7 @@ StageErrCode CompoundStage::HandleLeave(const PlayerID pid)
 StageErrCode CompoundStage::HandleComputerAct(const uint64_t pid, const bool ready_as_user)
 {
     // For run_game_xxx, the tell msg will be output, so do not use EmptyMsgSender here.
-    StageLog_(InfoLog()) << "HandleComputerAct begin pid=" << pid << " ready_as_user=" << Bool2Str(ready_as_user);
+    InfoLog() << LogHeader_() << "HandleComputerAct begin pid=" << pid << " ready_as_user=" << Bool2Str(ready_as_user);
     const auto rc = fsm_.OnComputerAct(pid, fsm_.Global().TellMsgSender(pid));
     if (rc != StageErrCode::OK) {
         return rc;
@@ -220,22 +214,21 @@ void CompoundStage::CheckoutSubStage_(const CheckoutReason reason)
 void CompoundStage::SwitchSubStage_(StageBaseInternal* const sub_stage, const char* const tag)
 {
     if (!sub_stage) {
-        StageLog_(InfoLog()) << tag << " no more substages";
+        InfoLog() << LogHeader_() << tag << " no more substages";
         SetOver();
-        StageLog_(InfoLog()) << "Over";
+        InfoLog() << LogHeader_() << "Over";
         return;
     }
     sub_stage->HandleStageBegin();
     if (sub_stage->IsOver()) {
-        StageLog_(WarnLog()) << tag << " substage skipped";
+        WarnLog() << LogHeader_() << tag << " substage skipped";
         CheckoutSubStage_(CheckoutReason::SKIP);
     } else {
-        StageLog_(InfoLog()) << tag << " substage to \"" << sub_stage->StageName() << "\"";
+        InfoLog() << LogHeader_() << tag << " substage to \"" << sub_stage->StageName() << "\"";
     }
 }
 
-template <typename Logger>
-Logger& CompoundStage::StageLog_(Logger&& logger) const { return fsm_.Global().StageLog(logger, fsm_.Name()) << "[complex_stage] "; }
+StageLogHeader CompoundStage::LogHeader_() const { return fsm_.Global().LogHeader(fsm_.Name(), "complex_stage"); }
 
 template <typename Task>
 StageErrCode CompoundStage::PassToSubStage_(const Task& internal_task, const CheckoutReason reason)
@@ -55,8 +55,7 @@ class AtomicStage : public StageBaseInternal
     StageErrCode HandleComputerAct(const uint64_t pid, const bool ready_as_user) final;
 
   private:
-    template <typename Logger>
-    Logger& StageLog_(Logger&& logger) const;
+    StageLogHeader LogHeader_() const;
 
     StageErrCode Handle_(StageErrCode rc);
     StageErrCode Handle_(const PlayerID pid, const bool is_user, StageErrCode rc);
@@ -139,8 +138,7 @@ class CompoundStage : public StageBaseInternal
 
     void SwitchSubStage_(StageBaseInternal* const sub_stage, const char* const tag);
 
-    template <typename Logger>
-    Logger& StageLog_(Logger&& logger) const;
+    StageLogHeader LogHeader_() const;
 
     template <typename Task>
     StageErrCode PassToSubStage_(const Task& internal_task, const CheckoutReason reason);
@@ -209,6 +207,17 @@ class MainStage : public MainStageBase
     int64_t PlayerScore(const PlayerID pid) const final;
     const char* const* VerdictateAchievements(const PlayerID pid) const final;
 
+    // Invoke |visitor| with the indexed commands of the main stage. It is exposed for benchmarks.
+    template <typename Visitor>
+    void VisitCommands(Visitor&& visitor) const
+    {
+        if (const auto fsm = dynamic_cast<const AtomicStageFsm*>(fsm_.get())) {
+            visitor(fsm->Commands());
+        } else {
+            visitor(dynamic_cast<const CompoundStageFsmBase&>(*fsm_).Commands());
+        }
+    }
+
   private:
     inline StageBaseInternal& Stage_();
     inline const StageBaseInternal& Stage_() const;
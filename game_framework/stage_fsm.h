@@ -32,6 +32,9 @@ namespace internal {
 template <typename RetType>
 using GameCommand = Command<RetType(const uint64_t pid, const bool is_public, MsgSenderBase& reply)>;
 
+template <typename RetType>
+using IndexedGameCommands = IndexedCommands<RetType(const uint64_t pid, const bool is_public, MsgSenderBase& reply)>;
+
 template <typename ...Fsms>
     requires (sizeof...(Fsms) > 0)
 using VariantStageFsm = std::variant<std::nullopt_t, Fsms...>;
@@ -126,7 +129,7 @@ struct AtomicStageFsm : virtual public StageFsmBase
     //   repeated action, it can be necessary to check whether the player has completed its action by `Global().IsReady(pid)`.
     virtual AtomReqErrCode OnComputerAct(const PlayerID pid, MsgSenderBase& reply) { return StageErrCode::READY; }
 
-    virtual const std::vector<GameCommand<AtomReqErrCode>>& Commands() const = 0;
+    virtual const IndexedGameCommands<AtomReqErrCode>& Commands() const = 0;
 };
 
 template <typename ...Subs>
@@ -170,7 +173,7 @@ struct CompoundStageFsmBase : virtual public StageFsmBase
     // OK or READY for each players controlled by computers.
     virtual CompReqErrCode OnComputerAct(const PlayerID pid, MsgSenderBase& reply) { return StageErrCode::OK; }
 
-    virtual const std::vector<GameCommand<CompReqErrCode>>& Commands() const = 0;
+    virtual const IndexedGameCommands<CompReqErrCode>& Commands() const = 0;
 };
 
 // The finite-state machine corresponding to `CompoundStage`.
@@ -244,7 +247,8 @@ class StageFsm : public internal::StageFsmTypeBaseType<Subs...>::Type
 {
     using TypeBase = internal::StageFsmTypeBaseType<Subs...>::Type;
     using LevelBase = typename internal::StageFsmLevelBaseType<Main>::Type;
-    using Command = internal::GameCommand<std::conditional_t<sizeof...(Subs) == 0, AtomReqErrCode, CompReqErrCode>>;
+    using ReqErrCode = std::conditional_t<sizeof...(Subs) == 0, AtomReqErrCode, CompReqErrCode>;
+    using Command = internal::GameCommand<ReqErrCode>;
 
   public:
     using LevelBase::Global;
@@ -267,14 +271,14 @@ class StageFsm : public internal::StageFsmTypeBaseType<Subs...>::Type
 
     const std::string& Name() const final { return name_; }
 
-    const std::vector<Command>& Commands() const final { return commands_; }
+    const internal::IndexedGameCommands<ReqErrCode>& Commands() const final { return commands_; }
 
   protected:
     using TypeBase::SubStageFsmSetter;
 
   private:
     std::string name_;
-    std::vector<Command> commands_;
+    internal::IndexedGameCommands<ReqErrCode> commands_;
 };
 
 enum CommandFlag : uint8_t
@@ -24,6 +24,7 @@ PublicStageUtility::PublicStageUtility(const MyGameOptions& game_options, const
     , match_(match)
     , masker_(match.MatchId(), match.GameName(), generic_options.PlayerNum())
     , achievement_counts_(generic_options.PlayerNum())
+    , random_engine_(match.RandomSeed())
 {
     std::ranges::for_each(achievement_counts_, [](AchievementCounts& counts) { std::ranges::fill(counts, 0); });
 }
@@ -48,15 +49,6 @@ MsgSenderBase& PublicStageUtility::BoardcastAiInfoMsgSender() const
     return IsInDeduction() ? EmptyMsgSender::Get() : match_.BoardcastAiInfoMsgSender();
 }
 
-void PublicStageUtility::BoardcastAiInfo(nlohmann::json j)
-{
-    BoardcastAiInfoMsgSender()() << nlohmann::json{
-            { "match_id", match_.MatchId() },
-            { "info_id", bot_message_id_++ },
-            { "info", std::move(j) },
-        }.dump();
-}
-
 int PublicStageUtility::SaveMarkdown(const std::string& markdown, const uint32_t width)
 {
     const std::filesystem::path path = std::filesystem::path(generic_options_.saved_image_dir_) /
@@ -87,7 +79,7 @@ void PublicStageUtility::Hook(const PlayerID pid)
 
 void PublicStageUtility::StartTimer(const uint64_t sec)
 {
-    timer_finish_time_ = std::chrono::steady_clock::now() + std::chrono::seconds(sec);
+    timer_finish_time_ = Now() + std::chrono::seconds(sec);
     // cannot pass substage pointer because substage may has been released when alert
     match_.StartTimer(sec, this,
             generic_options_.public_timer_alert_ ? TimerCallbackPublic_ : TimerCallbackPrivate_);
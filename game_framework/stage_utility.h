@@ -10,9 +10,13 @@
 #include "game_framework/game_options.h"
 #include "game_framework/player_ready_masker.h"
 #include "nlohmann/json.hpp"
+#include "utility/log.h"
 #include "utility/msg_checker.h"
 
 #include <array>
+#include <concepts>
+#include <functional>
+#include <random>
 
 #ifndef GAME_MODULE_NAME
 #error GAME_MODULE_NAME is not defined
@@ -28,6 +32,21 @@ class StageUtility;
 
 namespace internal {
 
+// The header of the logs of a stage. Its fields are streamed as separate arguments, so they are formatted by the writer
+// thread.
+struct StageLogHeader
+{
+    const MatchBase& match_;
+    std::string_view stage_name_;
+    const char* stage_type_;
+};
+
+inline LogLine& operator<<(LogLine& line, const StageLogHeader& header)
+{
+    return line << "[mid=" << header.match_.MatchId() << "] [game=" << header.match_.GameName() << "] [stage="
+                << header.stage_name_ << "] [" << header.stage_type_ << "] ";
+}
+
 class PublicStageUtility
 {
     friend class lgtbot::game::GAME_MODULE_NAME::StageUtility;
@@ -47,7 +66,23 @@ class PublicStageUtility
     decltype(auto) Group() const { return GroupMsgSender()(); }
     decltype(auto) Boardcast() const { return BoardcastMsgSender()(); }
     decltype(auto) Tell(const PlayerID pid) const { return TellMsgSender(pid)(); }
-    void BoardcastAiInfo(nlohmann::json j);
+    void BoardcastAiInfo(nlohmann::json j) { BoardcastAiInfo([&j] { return std::move(j); }); }
+
+    // The info is produced by |fn| only if there is any AI receiving it. Games which send large info should prefer this
+    // one, because in most matches there is no AI.
+    template <std::invocable Fn>
+    void BoardcastAiInfo(Fn&& fn)
+    {
+        const int32_t info_id = bot_message_id_++;
+        BoardcastAiInfoMsgSender()() << [&]
+            {
+                return nlohmann::json{
+                    { "match_id", match_.MatchId() },
+                    { "info_id", info_id },
+                    { "info", std::invoke(std::forward<Fn>(fn)) },
+                }.dump();
+            };
+    }
 
     int SaveMarkdown(const std::string& markdown, const uint32_t width = 600);
 
@@ -69,7 +104,9 @@ class PublicStageUtility
 
     bool IsReady(const PlayerID pid) const { return masker_.IsReady(pid); }
     void ClearReady() { masker_.ClearReady(); }
-    bool IsOkToCheckout() const { return IsInDeduction() || masker_.Ok(); }
+    // Eliminated users are permanently inactive, so in deduction the stage still waits for the computers to act, and
+    // the match is fast-forwarded round by round.
+    bool IsOkToCheckout() const { return masker_.Ok(); }
 
     // Timer
 
@@ -78,6 +115,21 @@ class PublicStageUtility
 
     const auto& TimerFinishTime() const { return timer_finish_time_; }
 
+    // The current time of the clock of timers, which should be compared with |TimerFinishTime|.
+    std::chrono::steady_clock::time_point Now() const
+    {
+        return std::chrono::steady_clock::time_point(std::chrono::nanoseconds(match_.NowNs()));
+    }
+
+    // Random numbers
+
+    // The engine is seeded by the match. Games should use it instead of `std::rand()` or `std::random_device`, so that
+    // the match can be replayed with its journal.
+    std::mt19937_64& RandomEngine() { return random_engine_; }
+
+    // Return a random integer in [0, n).
+    uint64_t Rand(const uint64_t n) { return std::uniform_int_distribution<uint64_t>(0, n - 1)(random_engine_); }
+
     // Options
 
     const MyGameOptions& Options() const { return game_options_; }
@@ -86,10 +138,9 @@ class PublicStageUtility
 
     // Log
 
-    template <typename Logger>
-    Logger& StageLog(Logger&& logger, const std::string_view stage_name) const
+    StageLogHeader LogHeader(const std::string_view stage_name, const char* const stage_type) const
     {
-        return logger << "[mid=" << match_.MatchId() << "] [game=" << match_.GameName() << "] [stage=" << stage_name << "] ";
+        return StageLogHeader{match_, stage_name, stage_type};
     }
 
   private:
@@ -109,6 +160,7 @@ class PublicStageUtility
     int32_t bot_message_id_{0}; // the ID of each bot message
     int32_t saved_image_no_{0};
     std::optional<std::chrono::time_point<std::chrono::steady_clock>> timer_finish_time_;
+    std::mt19937_64 random_engine_;
 };
 
 class AtomicStage;
@@ -15,6 +15,7 @@
 #include "game_framework/game_options.h"
 #include "game_framework/game_main.h"
 #include "game_framework/mock_match.h"
+#include "utility/log.h"
 
 namespace lgtbot {
 
@@ -58,6 +59,7 @@ class TestGame : public MockMatch, public testing::Test
     virtual void TearDown() override
     {
 #ifdef WITH_GLOG
+        GlobalLogBackend().Flush();
         google::ShutdownGoogleLogging();
 #endif
     }
@@ -86,9 +88,17 @@ class TestGame : public MockMatch, public testing::Test
 
     auto& actual_achievements() const { return actual_achievements_; }
 
-    virtual void StartTimer(const uint64_t /*sec*/, void* p, void(*cb)(void*, uint64_t)) override { timer_started_ = true; }
+    virtual void StartTimer(const uint64_t sec, void* p, void(*cb)(void*, uint64_t)) override
+    {
+        MockMatch::StartTimer(sec, p, cb);
+        timer_started_ = true;
+    }
 
-    virtual void StopTimer() override { timer_started_ = false; }
+    virtual void StopTimer() override
+    {
+        MockMatch::StopTimer();
+        timer_started_ = false;
+    }
 
    protected:
     StageErrCode Timeout()
@@ -97,6 +107,7 @@ class TestGame : public MockMatch, public testing::Test
             throw std::runtime_error("timer is not started");
         }
         std::cout << "[TIMEOUT]" << std::endl;
+        SkipToTimeout();
         const auto rc = main_stage_->HandleTimeout();
         HandleGameOver_();
         return rc;
@@ -249,7 +249,7 @@ struct KingdomInfo
 class BoardMgr
 {
   public:
-    BoardMgr(const uint32_t player_num, const uint32_t kingdom_num_each_player)
+    BoardMgr(const uint32_t player_num, const uint32_t kingdom_num_each_player, std::mt19937_64& engine)
     {
         assert(player_num * kingdom_num_each_player <= KingdomId::Count());
         for (uint32_t player_id = 0; player_id < player_num; ++player_id) {
@@ -267,9 +267,7 @@ class BoardMgr
             kingdom_oppo_pairs_.emplace_back(kingdom_num - 1 - i);
         }
         if (player_num >= 4) {
-            std::random_device rd;
-            std::mt19937 g(rd());
-            std::shuffle(kingdom_oppo_pairs_.begin(), kingdom_oppo_pairs_.end(), g);
+            std::shuffle(kingdom_oppo_pairs_.begin(), kingdom_oppo_pairs_.end(), engine);
         }
         SetOppoBoards_();
     }
@@ -191,8 +191,9 @@ void swap(Card<k_type>& _1, Card<k_type>& _2)
     std::swap(const_cast<Types<k_type>::SuitType&>(_1.suit_), const_cast<Types<k_type>::SuitType&>(_2.suit_));
 }
 
-template <CardType k_type>
-std::vector<Card<k_type>> ShuffledPokers(const std::string_view& sv = "")
+// If |sv| is not empty, the cards are shuffled with it as the seed, otherwise with |engine|.
+template <CardType k_type, typename RandomEngine>
+std::vector<Card<k_type>> ShuffledPokers(RandomEngine& engine, const std::string_view& sv = "")
 {
     std::vector<Card<k_type>> cards;
     for (const auto& number : Types<k_type>::NumberType::Members()) {
@@ -201,9 +202,7 @@ std::vector<Card<k_type>> ShuffledPokers(const std::string_view& sv = "")
         }
     }
     if (sv.empty()) {
-        std::random_device rd;
-        std::mt19937 g(rd());
-        std::shuffle(cards.begin(), cards.end(), g);
+        std::shuffle(cards.begin(), cards.end(), engine);
     } else {
         std::seed_seq seed(sv.begin(), sv.end());
         std::mt19937 g(seed);
@@ -199,6 +199,8 @@ TEST_F(TestChineseChess_ChessRule, cannot_move_promoted_zu_backward)
     ASSERT_FALSE(chess.CanMove(hb_, Coor{6, 0}, Coor{5, 0}));
 }
 
+static std::mt19937_64 random_engine;
+
 #define ASSERT_FAIL(expr) ASSERT_FALSE((expr).empty())
 #define ASSERT_SUCC(expr) \
     do { \
@@ -208,25 +210,25 @@ TEST_F(TestChineseChess_ChessRule, cannot_move_promoted_zu_backward)
 
 TEST(TestChineseChess, move_chess_not_eat)
 {
-    BoardMgr board(2, 1);
+    BoardMgr board(2, 1, random_engine);
     ASSERT_SUCC(board.Move(0, 0, Coor{0, 0}, Coor{1, 0}));
 }
 
 TEST(TestChineseChess, cannot_move_other_player_chess)
 {
-    BoardMgr board(2, 1);
+    BoardMgr board(2, 1, random_engine);
     ASSERT_FAIL(board.Move(1, 0, Coor{0, 0}, Coor{1, 0}));
 }
 
 TEST(TestChineseChess, cannot_eat_self_chess)
 {
-    BoardMgr board(2, 1);
+    BoardMgr board(2, 1, random_engine);
     ASSERT_FAIL(board.Move(0, 0, Coor{0, 0}, Coor{0, 1}));
 }
 
 TEST(TestChineseChess, eat_other_chess)
 {
-    BoardMgr board(2, 1);
+    BoardMgr board(2, 1, random_engine);
     ASSERT_SUCC(board.Move(0, 0, Coor{2, 1}, Coor{9, 1}));
     board.Settle();
     ASSERT_EQ(17, board.GetScore(0));
@@ -235,7 +237,7 @@ TEST(TestChineseChess, eat_other_chess)
 
 TEST(TestChineseChess, can_continuously_move_same_chess_if_not_eat)
 {
-    BoardMgr board(2, 1);
+    BoardMgr board(2, 1, random_engine);
     ASSERT_SUCC(board.Move(0, 0, Coor{0, 0}, Coor{1, 0}));
     board.Settle();
     ASSERT_SUCC(board.Move(0, 0, Coor{1, 0}, Coor{2, 0}));
@@ -243,7 +245,7 @@ TEST(TestChineseChess, can_continuously_move_same_chess_if_not_eat)
 
 TEST(TestChineseChess, cannot_continuously_move_same_chess_if_eat)
 {
-    BoardMgr board(2, 1);
+    BoardMgr board(2, 1, random_engine);
     ASSERT_SUCC(board.Move(0, 0, Coor{2, 1}, Coor{9, 1}));
     board.Settle();
     ASSERT_FAIL(board.Move(0, 0, Coor{9, 1}, Coor{8, 1}));
@@ -251,7 +253,7 @@ TEST(TestChineseChess, cannot_continuously_move_same_chess_if_eat)
 
 TEST(TestChineseChess, can_move_same_chess_skip_one_round_if_eat)
 {
-    BoardMgr board(2, 1);
+    BoardMgr board(2, 1, random_engine);
     ASSERT_SUCC(board.Move(0, 0, Coor{2, 1}, Coor{9, 1}));
     board.Settle();
     board.Settle();
@@ -260,7 +262,7 @@ TEST(TestChineseChess, can_move_same_chess_skip_one_round_if_eat)
 
 TEST(TestChineseChess, just_moved_chess_cannot_eat)
 {
-    BoardMgr board(2, 1);
+    BoardMgr board(2, 1, random_engine);
     ASSERT_SUCC(board.Move(0, 0, Coor{2, 1}, Coor{1, 1}));
     board.Settle();
     ASSERT_FAIL(board.Move(0, 0, Coor{1, 1}, Coor{9, 1}));
@@ -268,7 +270,7 @@ TEST(TestChineseChess, just_moved_chess_cannot_eat)
 
 TEST(TestChineseChess, just_moved_chess_can_eat_skip_one_round)
 {
-    BoardMgr board(2, 1);
+    BoardMgr board(2, 1, random_engine);
     ASSERT_SUCC(board.Move(0, 0, Coor{2, 1}, Coor{1, 1}));
     board.Settle();
     board.Settle();
@@ -277,7 +279,7 @@ TEST(TestChineseChess, just_moved_chess_can_eat_skip_one_round)
 
 TEST(TestChineseChess, eat_moved_chess_means_eat_failed)
 {
-    BoardMgr board(2, 1);
+    BoardMgr board(2, 1, random_engine);
     ASSERT_SUCC(board.Move(0, 0, Coor{2, 1}, Coor{9, 1}));
     ASSERT_SUCC(board.Move(1, 0, Coor{9, 1}, Coor{7, 0}));
     board.Settle();
@@ -289,7 +291,7 @@ TEST(TestChineseChess, eat_moved_chess_means_eat_failed)
 
 TEST(TestChineseChess, promote_zu)
 {
-    BoardMgr board(2, 1);
+    BoardMgr board(2, 1, random_engine);
     ASSERT_SUCC(board.Move(0, 0, Coor{3, 0}, Coor{4, 0}));
     board.Settle();
     board.Settle();
@@ -301,7 +303,7 @@ TEST(TestChineseChess, promote_zu)
 
 TEST(TestChineseChess, promote_zu_cannot_move_at_immediately)
 {
-    BoardMgr board(2, 1);
+    BoardMgr board(2, 1, random_engine);
     ASSERT_SUCC(board.Move(0, 0, Coor{3, 0}, Coor{4, 0}));
     ASSERT_SUCC(board.Move(1, 0, Coor{6, 0}, Coor{5, 0}));
     board.Settle();
@@ -313,7 +315,7 @@ TEST(TestChineseChess, promote_zu_cannot_move_at_immediately)
 
 TEST(TestChineseChess, chess_crash)
 {
-    BoardMgr board(2, 1);
+    BoardMgr board(2, 1, random_engine);
     ASSERT_SUCC(board.Move(0, 0, Coor{3, 0}, Coor{4, 0}));
     board.Settle();
     board.Settle();
@@ -331,7 +333,7 @@ TEST(TestChineseChess, chess_crash)
 
 TEST(TestChineseChess, chess_eat_jiang_will_occupy)
 {
-    BoardMgr board(2, 1);
+    BoardMgr board(2, 1, random_engine);
     ASSERT_SUCC(board.Move(0, 0, Coor{2, 1}, Coor{9, 1}));
     ASSERT_SUCC(board.Move(1, 0, Coor{9, 3}, Coor{8, 4}));
     board.Settle(); // p1's ma is ate
@@ -356,7 +358,7 @@ TEST(TestChineseChess, chess_eat_jiang_will_occupy)
 
 TEST(TestChineseChess, jiang_eat_jiang_will_occupy)
 {
-    BoardMgr board(2, 1);
+    BoardMgr board(2, 1, random_engine);
     ASSERT_SUCC(board.Move(0, 0, Coor{0, 4}, Coor{1, 4}));
     ASSERT_SUCC(board.Move(1, 0, Coor{9, 4}, Coor{8, 4}));
     board.Settle();
@@ -378,7 +380,7 @@ TEST(TestChineseChess, jiang_eat_jiang_will_occupy)
 
 TEST(TestChineseChess, jiang_crash_will_destroy)
 {
-    BoardMgr board(2, 1);
+    BoardMgr board(2, 1, random_engine);
     ASSERT_SUCC(board.Move(0, 0, Coor{0, 4}, Coor{1, 4}));
     ASSERT_SUCC(board.Move(1, 0, Coor{9, 4}, Coor{8, 4}));
     board.Settle();
@@ -408,7 +410,7 @@ TEST(TestChineseChess, jiang_crash_will_destroy)
 
 TEST(TestChineseChess, switch_board)
 {
-    BoardMgr board(2, 2);
+    BoardMgr board(2, 2, random_engine);
     // 0 - 2
     // 1 - 3
     ASSERT_SUCC(board.Move(1, 0, Coor{9, 0}, Coor{8, 0}));
@@ -429,14 +431,14 @@ TEST(TestChineseChess, switch_board)
 
 TEST(TestChineseChess, cannot_move_one_kingdom_chess_twice)
 {
-    BoardMgr board(2, 1);
+    BoardMgr board(2, 1, random_engine);
     ASSERT_SUCC(board.Move(0, 0, Coor{0, 0}, Coor{1, 0}));
     ASSERT_FAIL(board.Move(0, 0, Coor{0, 8}, Coor{1, 8}));
 }
 
 TEST(TestChineseChess, eat_each_jiang_will_destroy)
 {
-    BoardMgr board(2, 1);
+    BoardMgr board(2, 1, random_engine);
     ASSERT_SUCC(board.Move(0, 0, Coor{2, 1}, Coor{9, 1})); // k0 pao eat k1 ma
     ASSERT_SUCC(board.Move(1, 0, Coor{7, 1}, Coor{0, 1})); // k1 pao eat k0 ma
     board.Settle();
@@ -457,25 +459,25 @@ TEST(TestChineseChess, eat_each_jiang_will_destroy)
 
 TEST(TestChineseChess, pass_kingdom)
 {
-    BoardMgr board(2, 1);
+    BoardMgr board(2, 1, random_engine);
     ASSERT_SUCC(board.Pass(0, KingdomId(0)));
 }
 
 TEST(TestChineseChess, cannot_pass_other_player_kingdom)
 {
-    BoardMgr board(2, 1);
+    BoardMgr board(2, 1, random_engine);
     ASSERT_FAIL(board.Pass(0, KingdomId(1)));
 }
 
 TEST(TestChineseChess, cannot_pass_not_exist_kingdom)
 {
-    BoardMgr board(2, 1);
+    BoardMgr board(2, 1, random_engine);
     ASSERT_FAIL(board.Pass(0, KingdomId(2)));
 }
 
 TEST(TestChineseChess, cannot_move_after_pass)
 {
-    BoardMgr board(2, 1);
+    BoardMgr board(2, 1, random_engine);
     ASSERT_SUCC(board.Pass(0, KingdomId(0)));
     ASSERT_FAIL(board.Move(0, 0, Coor{0, 0}, Coor{1, 0}));
 }
@@ -8,6 +8,7 @@
 #include <cassert>
 #include <cstdint>
 #include <optional>
+#include <random>
 #include <vector>
 #include <string>
 #include <algorithm>
@@ -84,9 +85,10 @@ class Board
         return true;
     }
 
-    void RandomSet(const uint32_t player_id)
+    void RandomSet(const uint32_t player_id, std::mt19937_64& engine)
     {
-        auto available_count = rand() % std::ranges::count_if(board_, &Area::CanBeSetChess);
+        auto available_count = std::uniform_int_distribution<std::ptrdiff_t>(
+                0, std::ranges::count_if(board_, &Area::CanBeSetChess) - 1)(engine);
         for (int32_t row = 0; row < size_; ++row) {
             for (int32_t col = 0; col < size_; ++col) {
                 const Coordinate coordinate(row, col);
@@ -100,17 +100,8 @@ class MainStage : public MainGameStage<RoundStage>
         }
 
         const std::string& seed_str = GAME_OPTION(种子);
-        std::variant<std::random_device, std::seed_seq> rd;
-        std::mt19937 g([&]
-            {
-                if (seed_str.empty()) {
-                    auto& real_rd = rd.emplace<std::random_device>();
-                    return std::mt19937(real_rd());
-                } else {
-                    auto& real_rd = rd.emplace<std::seed_seq>(seed_str.begin(), seed_str.end());
-                    return std::mt19937(real_rd);
-                }
-            }());
+        std::seed_seq seed(seed_str.begin(), seed_str.end());
+        std::mt19937 g = seed_str.empty() ? std::mt19937(Global().RandomEngine()()) : std::mt19937(seed);
 
         if (GAME_OPTION(副数) > 0) {
             for (uint32_t color_idx = 0; color_idx < GAME_OPTION(颜色); ++color_idx) {
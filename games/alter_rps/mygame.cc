@@ -94,7 +94,7 @@ static std::string StarsString(const uint32_t n) {
 
 using CardMap = std::map<Card, CardState>;
 
-static CardMap GetCardMap(const MyGameOptions& option)
+static CardMap GetCardMap(const MyGameOptions& option, std::mt19937_64& engine)
 {
     CardMap cards;
     const auto emplace_card = [&](const auto& card) {
@@ -118,9 +118,7 @@ static CardMap GetCardMap(const MyGameOptions& option)
         Card{ Type::ROCK, 10 }, Card{ Type::PAPER, 10 }, Card{ Type::SCISSOR, 10 },
         Card{ Type::BLANK, 2},  Card{ Type::BLANK, 5 },  Card{ Type::BLANK, 8 },
     };
-    std::random_device rd;
-    std::mt19937 g(rd());
-    std::ranges::shuffle(shuffled_cards, g);
+    std::ranges::shuffle(shuffled_cards, engine);
     uint32_t type_count[k_card_type_num] = {0};
     uint32_t max_num_each_type = 4;
     for (uint32_t i = 0; cards.size() < k_round_num; ++i) {
@@ -293,7 +291,7 @@ class MainStage : public MainGameStage<RoundStage>
     MainStage(StageUtility&& utility)
         : StageFsm(std::move(utility),
                 MakeStageCommand(*this, "查看比赛情况", &MainStage::Info_, VoidChecker("赛况")))
-        , k_origin_card_map_(GetCardMap(Global().Options()))
+        , k_origin_card_map_(GetCardMap(Global().Options(), Global().RandomEngine()))
         , players_{k_origin_card_map_, k_origin_card_map_}
         , round_(1)
         , tables_{ThreeRoundTable(Global().ResourceDir()),
@@ -452,7 +450,7 @@ class ChooseStage : public SubGameStage<>
                 its.emplace_back(it);
             }
         }
-        SetCard_(pid, its[rand() % its.size()]);
+        SetCard_(pid, its[Global().Rand(its.size())]);
 
         return StageErrCode::READY;
     }
@@ -536,7 +534,7 @@ class AlterStage : public SubGameStage<>
             return StageErrCode::OK;
         }
         auto& player = Main().players_[pid];
-        SetAlter_(pid, rand() % 2 ? player.left_ : player.right_);
+        SetAlter_(pid, Global().Rand(2) ? player.left_ : player.right_);
         return StageErrCode::READY;
     }
 
@@ -169,34 +169,34 @@ class RoundStage : public SubGameStage<>
 
             if (Main().round_ == 1) {
 
-                if (rand() % 10 < 8) {
-                    num = rand() % (int)(max * 0.15) + (int)(max * 0.13);
+                if (Global().Rand(10) < 8) {
+                    num = Global().Rand((int)(max * 0.15)) + (int)(max * 0.13);
                 } else {
-                    num = rand() % (max + 1);
+                    num = Global().Rand(max + 1);
                 }
 
             } else {
 
-                if (Main().x < (max * 0.07) && rand() % 10 < 5) {
-                    num = rand() % (int)(max * 0.10) + (int)(max * 0.15);
-                } else if (Main().x > (max * 0.23) && (Main().on_crash == 0 || rand() % 10 < 3)) {
-                    num = rand() % (int)(max * 0.11) + (int)(max * 0.07);
+                if (Main().x < (max * 0.07) && Global().Rand(10) < 5) {
+                    num = Global().Rand((int)(max * 0.10)) + (int)(max * 0.15);
+                } else if (Main().x > (max * 0.23) && (Main().on_crash == 0 || Global().Rand(10) < 3)) {
+                    num = Global().Rand((int)(max * 0.11)) + (int)(max * 0.07);
                 } else if (Main().on_crash == 1 && Main().alive_ >= 8 && max <= 200) {
-                    if (rand() % 10 < 2) {
-                        num = rand() % (int)(max * 0.51) + (int)(max * 0.35);
+                    if (Global().Rand(10) < 2) {
+                        num = Global().Rand((int)(max * 0.51)) + (int)(max * 0.35);
                     } else {
-                        num = rand() % (int)(max * 0.16) + (int)(max * 0.15);
+                        num = Global().Rand((int)(max * 0.16)) + (int)(max * 0.15);
                     }
                 } else {
-                    if (Main().round_ == 2 || rand() % 10 < 7) {
-                        num = rand() % (int)(max * 0.13) + (int)x - (int)(max * 0.06);
+                    if (Main().round_ == 2 || Global().Rand(10) < 7) {
+                        num = Global().Rand((int)(max * 0.13)) + (int)x - (int)(max * 0.06);
                     } else {
                         if (Main().x1 == 0) {
                             x0 = 0;
                         } else {
                             x0 = (int)(Main().x * Main().x / Main().x1);
                         }
-                        num = rand() % (int)(max * 0.13) + x0 - (int)(max * 0.06);
+                        num = Global().Rand((int)(max * 0.13)) + x0 - (int)(max * 0.06);
                     }
                 }
 
@@ -210,7 +210,7 @@ class RoundStage : public SubGameStage<>
                 }
             }
             if (Main().player_hp_[pid] <= 2 && lowhp_count <= 6) {
-                int r = rand() % 4;
+                int r = Global().Rand(4);
                 for (int i = (int)x - (int)(max * 0.02); i <= max; i += (int)(max * 0.01)) {
                     int c = 0;
                     for (int j = 0; j < pid; j++) {
@@ -228,19 +228,19 @@ class RoundStage : public SubGameStage<>
 
             // limit
             if (num < 0)  {
-                num = rand() % (int)(max * 0.05) + (int)(max * 0.95) + 1;
+                num = Global().Rand((int)(max * 0.05)) + (int)(max * 0.95) + 1;
             } else if (num > max) {
-                num = rand() % (int)(max * 0.05);
+                num = Global().Rand((int)(max * 0.05));
             }
 
         } else {
             // 小于100
-            num = rand() % (max + 1);
+            num = Global().Rand(max + 1);
         }
 
         // 2
         if (Main().alive_ == 2) {
-            int r = rand() % 7;
+            int r = Global().Rand(7);
             if (r == 0) num = max * 0.6666;
             else if (r <= 2) num = 0;
             else if (r <= 4) num = 1;
@@ -593,7 +593,6 @@ string MainStage::GetName(std::string x) {
 
 void MainStage::FirstStageFsm(SubStageFsmSetter setter)
 {
-    srand((unsigned int)time(NULL));
     alive_ = Global().PlayerNum();
 
     for (int i = 0; i < Global().PlayerNum(); i++) {
@@ -342,7 +342,7 @@ class BidStage : public SubGameStage<k_type>
     {
         const auto max_bid_coins = this->Main().players()[pid].coins_ / 4;
         if (max_bid_coins > 0) {
-            Bid_(pid, false, reply, std::rand() % max_bid_coins + 1);
+            Bid_(pid, false, reply, this->Global().Rand(max_bid_coins) + 1);
         }
         return StageErrCode::READY;
     }
@@ -543,12 +543,12 @@ class DiscardStage : public SubGameStage<k_type>
 
     virtual AtomReqErrCode OnComputerAct(const PlayerID pid, MsgSenderBase& reply)
     {
-        if (std::rand() % 2) {
+        if (this->Global().Rand(2)) {
             return StageErrCode::READY;
         }
         const auto best_deck = this->Main().players()[pid].hand_.BestDeck();
         std::vector<std::string> discard_poker_strs;
-        std::vector<poker::Card<k_type>> shuffled_pokers = poker::ShuffledPokers<k_type>();
+        std::vector<poker::Card<k_type>> shuffled_pokers = poker::ShuffledPokers<k_type>(this->Global().RandomEngine());
         for (const auto& poker : shuffled_pokers) {
             // should not break the best deck
             if (this->Main().players()[pid].hand_.Has(poker) &&
@@ -679,7 +679,7 @@ template <poker::CardType k_type>
 void MainStage<k_type>::FirstStageFsm(StageFsm::SubStageFsmSetter setter)
 {
     int pos = 0;
-    const auto shuffled_pokers = poker::ShuffledPokers<k_type>(GAME_OPTION(种子));
+    const auto shuffled_pokers = poker::ShuffledPokers<k_type>(this->Global().RandomEngine(), GAME_OPTION(种子));
     const auto emplace_pockers = [this, &shuffled_pokers, &pos](const int num)
         {
             poker_items_.emplace_back(std::nullopt, std::set<poker::Card<k_type>>(shuffled_pokers.begin() + pos, shuffled_pokers.begin() + pos + num));
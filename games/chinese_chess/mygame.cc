@@ -87,7 +87,7 @@ class MainStage : public MainGameStage<>
                 MakeStageCommand(*this, "移动棋子", &MainStage::Move_,
                     ArithChecker<uint32_t>(0, utility.PlayerNum() * GET_OPTION_VALUE(utility.Options(), 阵营), "棋盘编号"),
                     AnyArg("移动前位置", "A1"), AnyArg("移动后位置", "B1")))
-        , board_(Global().PlayerNum(), GAME_OPTION(阵营))
+        , board_(Global().PlayerNum(), GAME_OPTION(阵营), Global().RandomEngine())
         , round_(0)
     {}
 
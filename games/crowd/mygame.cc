@@ -136,7 +136,7 @@ class RoundStage : public SubGameStage<>
         int count = 0;
         while(r == -1 || Main().used.find(r) != Main().used.end())
         {
-            r = rand() % k_question_num;
+            r = Global().Rand(k_question_num);
             if(count++ > 1000) break;
         }
         Main().used.insert(r);
@@ -199,7 +199,7 @@ class RoundStage : public SubGameStage<>
             return;
         }
 
-        q -> init(Main().players);
+        q -> init(Main().players, Global().RandomEngine());
         q -> initTexts();
         q -> initOptions();
         q -> initExpects();
@@ -242,7 +242,7 @@ class RoundStage : public SubGameStage<>
         if(q -> expects.size() == 0 || q -> expects[0].length() == 0)
             return SubmitInternal_(pid, reply, x);
 
-        x[0] = q -> expects[0][rand() % (q -> expects[0].length())];
+        x[0] = q -> expects[0][Global().Rand(q -> expects[0].length())];
         if(x[0] <= 'z' && x[0] >= 'a') x[0] = x[0] - 'a' + 'A';
 
         return SubmitInternal_(pid, reply, x);
@@ -378,8 +378,6 @@ class RoundStage : public SubGameStage<>
 
 void MainStage::FirstStageFsm(SubStageFsmSetter setter)
 {
-    srand((unsigned int)time(NULL));
-
     Player tempP;
     for(int i = 0; i < Global().PlayerNum(); i++)
     {
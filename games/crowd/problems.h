@@ -4,6 +4,7 @@
 #include <set>
 
 #include <map>
+#include <random>
 #include <vector>
 #include <string>
 #include <algorithm>
@@ -128,11 +129,19 @@ public:
 	double minSelect;
 	vector<double> tempScore;
 	
+	std::mt19937_64* randomEngine = nullptr;
 	
-	// init playerNum
-	void init(vector<Player>& players)
+	// init playerNum and the random engine of the match
+	void init(vector<Player>& players, std::mt19937_64& engine)
 	{
 		playerNum = players.size();
+		randomEngine = &engine;
+	}
+	
+	// return a random integer in [0, n)
+	uint64_t Rand(const uint64_t n)
+	{
+		return std::uniform_int_distribution<uint64_t>(0, n - 1)(*randomEngine);
 	}
 	
 	// init texts and options. This function must be overloaded
@@ -616,7 +625,7 @@ public:
 		if(optionCount[1] > 0) tempScore[0] = -2;
 		
 		tempScore[3] -= 0.6;
-		if(rand() % 1000 < 9)
+		if(Rand(1000) < 9)
 		{
 			tempScore[3] = 77;
 		} 
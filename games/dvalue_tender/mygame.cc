@@ -216,36 +216,36 @@ class RoundStage : public SubGameStage<>
             {
                 if(w1 == 0)
                 {
-                    f = rand() % 9;
+                    f = Global().Rand(9);
                 }
                 if(w1 == 1)
                 {
-                    if(rand() % 3) f = rand() % 3 + 3;
-                    else if(rand() % 2) f = rand() % 2 + 9;
+                    if(Global().Rand(3)) f = Global().Rand(3) + 3;
+                    else if(Global().Rand(2)) f = Global().Rand(2) + 9;
                     else f = 0;
                 }
                 if(w1 == 2)
                 {
-                    if(rand() % 2) f = rand() % 3;
-                    else if(rand() % 2) f = rand() % 2 + 5;
-                    else f = rand() % 2 + 9;
+                    if(Global().Rand(2)) f = Global().Rand(3);
+                    else if(Global().Rand(2)) f = Global().Rand(2) + 5;
+                    else f = Global().Rand(2) + 9;
                 }
                 if(w1 == 3)
                 {
-                    if(rand() % 2) f = rand() % 3 + 2;
-                    else f = rand() % 2 + 10;
+                    if(Global().Rand(2)) f = Global().Rand(3) + 2;
+                    else f = Global().Rand(2) + 10;
                 }
                 if(w1 == 4)
                 {
-                    if(rand() % 2)
+                    if(Global().Rand(2))
                     {
                         f = 1;
-                        if(rand() % 2) f = 3;
+                        if(Global().Rand(2)) f = 3;
                     }
                     else
                     {
                         f = c1 + 1;
-                        if(rand() % 2 && c1 > 5) f -= rand() % (c1/2);
+                        if(Global().Rand(2) && c1 > 5) f -= Global().Rand(c1/2);
                     }
                 }
             }
@@ -258,7 +258,7 @@ class RoundStage : public SubGameStage<>
             }
             else
             {
-                f = rand() % (c2 + 1);
+                f = Global().Rand(c2 + 1);
             }
         }
 
@@ -352,8 +352,6 @@ class RoundStage : public SubGameStage<>
 
 void MainStage::FirstStageFsm(SubStageFsmSetter setter)
 {
-    srand((unsigned int)time(NULL));
-
     roundBoard+="当前结果：";
     for(int i = 0; i < Global().PlayerNum(); i++){
         player_coins_[i] = GAME_OPTION(金币);
@@ -62,7 +62,6 @@ int n, m;
 char lines[128][32], lx[128][32], ly[128][32];
 char zero_x, zero_y;
 int line_cnt;
-int random_seed;
 int num_1, num_2;
 struct board {
   int score;
@@ -74,8 +73,9 @@ std::string map_name;
 int offset, initial_random_cnt, turn;
 std::string three_pos;
 
-void generate_two_num(int& a, int& b, int* c) {
-  int x = rand() % 180;
+void generate_two_num(int& a, int& b, int* c, std::mt19937_64& engine) {
+  const auto rand_int = [&engine](const int n) { return std::uniform_int_distribution<int>(0, n - 1)(engine); };
+  int x = rand_int(180);
   if (x == 0) {
     a = 2, b = 9;
   } else if (x == 1) {
@@ -87,7 +87,7 @@ void generate_two_num(int& a, int& b, int* c) {
   } else if (x == 4) {
     a = 2, b = 18;
   } else if (x == 5) {
-    a = 2, b = 10 + rand() % 10;
+    a = 2, b = 10 + rand_int(10);
   } else if (x == 6) {
     a = 3, b = 9;
   } else if (x == 7) {
@@ -101,27 +101,27 @@ void generate_two_num(int& a, int& b, int* c) {
   } else if (x == 11) {
     a = 4, b = 9;
   } else if (x == 12) {
-    if (rand() % 2 == 0) {
+    if (rand_int(2) == 0) {
       a = 9, b = 25;
     } else {
       a = 10, b = 24;
     }
   } else if (x == 13) {
-    if (rand() % 2 == 0) {
-      a = 13, b = 16 + rand() % 2;
+    if (rand_int(2) == 0) {
+      a = 13, b = 16 + rand_int(2);
     } else {
-      a = 11, b = 18 + rand() % 2;
+      a = 11, b = 18 + rand_int(2);
     }
   } else if (x == 14) {
     a = 5, b = 8;
   } else if (x <= 20) {
     a = 1, b = x - 7;
   } else {
-    a = rand() % 6 + 1;
-    b = rand() % 6 + 1;
-    if (rand() % 2 == 1) {
-      a += rand() % 2;
-      b += rand() % 2 + 1;
+    a = rand_int(6) + 1;
+    b = rand_int(6) + 1;
+    if (rand_int(2) == 1) {
+      a += rand_int(2);
+      b += rand_int(2) + 1;
     }
     if (a > b) {
       std::swap(a, b);
@@ -292,8 +292,7 @@ int calc(board& b) {
   return max_score;
 }
 
-void initGame(const std::string& map_path, std::optional<int> seed = std::nullopt) {
-  srand(random_seed = seed.value_or(clock() ^ rand()));
+void initGame(const std::string& map_path) {
   readMap(map_path);
   std::cout << n << " " << m << std::endl;
   for (int i = 0; i < n + 2; i++) {
@@ -418,7 +417,7 @@ class RoundStage : public SubGameStage<> {
                   MakeStageCommand(*this, "跳过", &RoundStage::Pass_, VoidChecker("pass"))) {}
 
   virtual void OnStageBegin() override {
-    generate_two_num(num_1, num_2, number);
+    generate_two_num(num_1, num_2, number, Global().RandomEngine());
     for (int i = 0; i < Main().num_player_; i++) {
       Main().ui_.SetName(i, Global().PlayerName(i));
       Main().ui_.SetBoard(i, Main().boards_[i]);
@@ -504,7 +503,7 @@ MainStage::MainStage(StageUtility&& utility)
   auto map_file = map_files[GAME_OPTION(地图)];
   map_name = map_names[GAME_OPTION(地图)];
   if (map_file == "random") {
-    int index = rand() % (map_files.size() - 1) + 1;
+    int index = Global().Rand(map_files.size() - 1) + 1;
     map_file = map_files[index];
     map_name = map_names[index];
   }
@@ -515,8 +514,8 @@ MainStage::MainStage(StageUtility&& utility)
     initBoard(boards_[i]);
   }
   for (int i = 0; i < initial_random_cnt; i++) {
-    int val = 3 + rand() % 10;
-    int x = 1 + rand() % n, y = 1 + rand() % m;
+    int val = 3 + Global().Rand(10);
+    int x = 1 + Global().Rand(n), y = 1 + Global().Rand(m);
     if ('a' <= map[x][y] && map[x][y] <= 'z') {
       for (int i = 0; i < Global().PlayerNum(); i++) {
         boards_[i].num[x][y] = val;
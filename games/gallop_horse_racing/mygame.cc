@@ -195,29 +195,29 @@ class RoundStage : public SubGameStage<>
         // 最大上限，高速度前进
         else if (Main().player_maxspeed_[pid] == max_speed && Main().player_maxspeed_[pid] >= 3)
         {
-            Main().player_select_[pid] = rand() % 2 + Main().player_maxspeed_[pid] - 1;
+            Main().player_select_[pid] = Global().Rand(2) + Main().player_maxspeed_[pid] - 1;
         }
         // 赛程过半，速度快就赶距离
         else if (Main().player_position_[pid] > GAME_OPTION(目标) * 0.6 && Main().player_maxspeed_[pid] >= 8)
         {
-            Main().player_select_[pid] = rand() % 3 + Main().player_maxspeed_[pid] - 2;
+            Main().player_select_[pid] = Global().Rand(3) + Main().player_maxspeed_[pid] - 2;
         }
         // 比赛初期，加速
         else if (Main().player_position_[pid] <= GAME_OPTION(目标) * 0.6 || Main().player_maxspeed_[pid] <= 6)
         {
             if (min_speed >= 4) {
-                if (rand() % 10 < 9) {
+                if (Global().Rand(10) < 9) {
                     Main().player_select_[pid] = min_speed;
                 } else {
                     Main().player_select_[pid] = min_speed - 1;
                 }
             } else {
-                Main().player_select_[pid] = rand() % 4 + 1;
+                Main().player_select_[pid] = Global().Rand(4) + 1;
             }
         }
         else
         {
-            Main().player_select_[pid] = rand() % Main().player_maxspeed_[pid] + 1;
+            Main().player_select_[pid] = Global().Rand(Main().player_maxspeed_[pid]) + 1;
         }
         return StageErrCode::READY;
     }
@@ -406,8 +406,6 @@ string MainStage::GetStatusBoard() {
 
 void MainStage::FirstStageFsm(SubStageFsmSetter setter)
 {
-    srand((unsigned int)time(NULL));
-
     racing_num = Global().PlayerNum();
     for (int i = 0; i < Global().PlayerNum(); i++) {
         player_maxspeed_[i] = GAME_OPTION(上限);
@@ -146,10 +146,10 @@ class MainStage : public MainGameStage<>
         if (Global().IsReady(pid)) {
             return StageErrCode::OK;
         }
-        auto type = static_cast<AppleType>(rand() % k_apple_type_num);
+        auto type = static_cast<AppleType>(Global().Rand(k_apple_type_num));
         if (type == AppleType::GOLD) {
             if (players_[pid].remain_golden_ == 0) {
-                type = static_cast<AppleType>(rand() % 2 ? AppleType::RED : AppleType::SILVER);
+                type = static_cast<AppleType>(Global().Rand(2) ? AppleType::RED : AppleType::SILVER);
             } else {
                 --players_[pid].remain_golden_;
             }
@@ -267,7 +267,7 @@ MainStage::MainStage(StageUtility&& utility)
       score_(2, 0),
       board_(9, std::vector<int>(9, -1)),
       side_(2, 0) {
-  side_[0] = rand() % 2;
+  side_[0] = Global().Rand(2);
   side_[1] = !side_[0];
 }
 
@@ -86,7 +86,7 @@ class MainStage : public MainGameStage<>
                             { "顺", Choise::CLOCKWISE },
                             { "逆", Choise::ANTICLOCKWISE }}
                         )))
-        , map_(GAME_OPTION(地图) == GameMap::随机 ? GameMap::Members()[rand() % (GameMap::Count() - 1)] : GAME_OPTION(地图))
+        , map_(GAME_OPTION(地图) == GameMap::随机 ? GameMap::Members()[Global().Rand(GameMap::Count() - 1)] : GAME_OPTION(地图))
         , board_(game_map_initers[map_.ToUInt()](Global().ResourceDir()))
         , round_(0)
         , scores_{0}
@@ -107,8 +107,8 @@ class MainStage : public MainGameStage<>
         const Coor coor = [&]() -> Coor
             {
                 while (true) {
-                    const Coor coor(rand() % board_.max_m(), rand() % board_.max_n());
-                    if (Act_(pid, coor, static_cast<Choise>(rand() % static_cast<uint32_t>(Choise::_MAX)), EmptyMsgSender::Get())) {
+                    const Coor coor(Global().Rand(board_.max_m()), Global().Rand(board_.max_n()));
+                    if (Act_(pid, coor, static_cast<Choise>(Global().Rand(static_cast<uint32_t>(Choise::_MAX))), EmptyMsgSender::Get())) {
                         return coor;
                     }
                 }
@@ -171,7 +171,7 @@ struct PlayerRoundInfo
         return Reset_(hand_id, coins, scores, is_mutable ? PlayerHand<k_type>::DISCARD_ALL : PlayerHand<k_type>::DISCARD_ALL_IMMUTBLE);
     }
 
-    void RandomAct(const bool is_first)
+    void RandomAct(const bool is_first, std::mt19937_64& engine)
     {
         for (uint32_t hand_id = 0; remain_coins_ > 0; hand_id = (hand_id + 1) % hands_.size()) {
             auto& hand = hands_[hand_id];
@@ -179,13 +179,13 @@ struct PlayerRoundInfo
                 continue;
             }
             if (hand.discard_idx_ != PlayerHand<k_type>::DISCARD_ALL && hand.discard_idx_ != PlayerHand<k_type>::DISCARD_ALL_IMMUTBLE) {
-                const auto coins =
-                    rand() % ((is_first ? remain_coins_ : std::min(remain_coins_, static_cast<int64_t>(hand.immutable_coins_))) + 1);
+                const int64_t coins = std::uniform_int_distribution<int64_t>(0,
+                        is_first ? remain_coins_ : std::min(remain_coins_, static_cast<int64_t>(hand.immutable_coins_)))(engine);
                 remain_coins_ -= coins;
                 hand.mutable_coins_ += coins;
             }
             if (!is_first && hand.discard_idx_ == PlayerHand<k_type>::DISCARD_NOT_CHOOSE) {
-                hand.discard_idx_ = rand() % k_hand_poker_num; // TODO: choose the best deck
+                hand.discard_idx_ = std::uniform_int_distribution<uint32_t>(0, k_hand_poker_num - 1)(engine); // TODO: choose the best deck
             }
         }
     }
@@ -404,7 +404,7 @@ class BetStage : public SubGameStage<>
 
     virtual AtomReqErrCode OnComputerAct(const PlayerID pid, MsgSenderBase& reply)
     {
-        player_round_infos_[pid].RandomAct(is_first_);
+        player_round_infos_[pid].RandomAct(is_first_, Global().RandomEngine());
         return StageErrCode::READY;
     }
 
@@ -550,7 +550,7 @@ class RoundStage : public SubGameStage<BetStage<k_type>>
                 MakeStageCommand(*this, "通过图片查看各玩家手牌及金币情况", &RoundStage::Status_, VoidChecker("赛况")))
         , is_first_(true), player_htmls_(this->Global().PlayerNum())
     {
-        const auto shuffled_pokers = poker::ShuffledPokers<k_type>(GAME_OPTION(种子).empty() ? "" : GAME_OPTION(种子) + std::to_string(round));
+        const auto shuffled_pokers = poker::ShuffledPokers<k_type>(this->Global().RandomEngine(), GAME_OPTION(种子).empty() ? "" : GAME_OPTION(种子) + std::to_string(round));
         const auto player_num = this->Global().PlayerNum();
         const uint32_t player_hand_num = PlayerHandNum(player_num);
         auto it = shuffled_pokers.cbegin();
@@ -571,9 +571,9 @@ class RoundStage : public SubGameStage<BetStage<k_type>>
             info.SetRemainCoins(GAME_OPTION(首轮筹码) * PlayerHandNum(this->Global().PlayerNum()));
         }
         SavePlayerHtmls_();
-        this->Global().Group() << Markdown{MiddleHtml_(true), k_markdown_width_};
+        this->Global().Group() << LazyMarkdown{[&] { return MiddleHtml_(true); }, k_markdown_width_};
         for (PlayerID pid = 0; pid < this->Global().PlayerNum(); ++pid) {
-            this->Global().Tell(pid) << Markdown{PrivateHtml_(pid, true), k_markdown_width_};
+            this->Global().Tell(pid) << LazyMarkdown{[&] { return PrivateHtml_(pid, true); }, k_markdown_width_};
         }
         this->Global().Boardcast() << "请各位玩家私信裁判进行第一轮下注，您可通过「帮助」命令查看命令格式";
         setter.template Emplace<BetStage<k_type>>(this->Main(), is_first_, hands_, player_round_infos_);
@@ -606,9 +606,9 @@ class RoundStage : public SubGameStage<BetStage<k_type>>
                 }
             }
             this->Global().Boardcast() << "第一轮下注结束，公布各玩家选择：";
-            this->Global().Group() << Markdown{MiddleHtml_(false), k_markdown_width_};
+            this->Global().Group() << LazyMarkdown{[&] { return MiddleHtml_(false); }, k_markdown_width_};
             for (PlayerID pid = 0; pid < this->Global().PlayerNum(); ++pid) {
-                this->Global().Tell(pid) << Markdown{PrivateHtml_(pid, false), k_markdown_width_};
+                this->Global().Tell(pid) << LazyMarkdown{[&] { return PrivateHtml_(pid, false); }, k_markdown_width_};
             }
             this->Global().Boardcast() << "请各位玩家私信裁判进行第二轮下注，并决定**不参与**决胜的卡牌，您可通过「帮助」命令查看命令格式";
             setter.template Emplace<BetStage<k_type>>(this->Main(), is_first_, hands_, player_round_infos_);
@@ -634,9 +634,9 @@ class RoundStage : public SubGameStage<BetStage<k_type>>
                 player_round_infos_[hand.pid_].score_change_ += hand.immutable_score_ + hand.mutable_score_;
             }
             this->Global().Boardcast() << "第二轮下注结束，公布各玩家选择：";
-            this->Global().Group() << Markdown{EndHtml_() + BetResultHtml_(bet_rets), k_markdown_width_};
+            this->Global().Group() << LazyMarkdown{[&] { return EndHtml_() + BetResultHtml_(bet_rets); }, k_markdown_width_};
             for (PlayerID pid = 0; pid < this->Global().PlayerNum(); ++pid) {
-                this->Global().Tell(pid) << Markdown{EndHtml_() + BetResultHtml_(bet_rets), k_markdown_width_};
+                this->Global().Tell(pid) << LazyMarkdown{[&] { return EndHtml_() + BetResultHtml_(bet_rets); }, k_markdown_width_};
             }
             this->Global().Boardcast() << "回合结束";
             for (const auto& info : player_round_infos_) {
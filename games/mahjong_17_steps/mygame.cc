@@ -83,17 +83,8 @@ class MainStage : public MainGameStage<TableStage>
   public:
     MainStage(StageUtility&& utility) : StageFsm(std::move(utility)), table_idx_(0)
     {
-        std::variant<std::random_device, std::seed_seq> rd;
-        std::mt19937 g([&]
-            {
-                if (GAME_OPTION(种子).empty()) {
-                    auto& real_rd = rd.emplace<std::random_device>();
-                    return std::mt19937(real_rd());
-                } else {
-                    auto& real_rd = rd.emplace<std::seed_seq>(GAME_OPTION(种子).begin(), GAME_OPTION(种子).end());
-                    return std::mt19937(real_rd);
-                }
-            }());
+        std::seed_seq seed(GAME_OPTION(种子).begin(), GAME_OPTION(种子).end());
+        std::mt19937 g = GAME_OPTION(种子).empty() ? std::mt19937(Global().RandomEngine()()) : std::mt19937(seed);
         const auto offset = std::uniform_int_distribution<uint32_t>(1, Global().PlayerNum())(g);
         for (uint64_t pid = 0; pid < Global().PlayerNum(); ++pid) {
             players_.emplace_back((pid + offset) % Global().PlayerNum());
@@ -374,7 +365,7 @@ class TableStage : public SubGameStage<PrepareStage, KiriStage>
                     .tile_option_{
                         .with_red_dora_ = GAME_OPTION(赤宝牌),
                         .with_toumei_ = GAME_OPTION(透明牌),
-                        .seed_ = GAME_OPTION(种子).empty() ? "" : GAME_OPTION(种子) + stage_name,
+                        .seed_ = GAME_OPTION(种子).empty() ? std::to_string(Global().RandomEngine()()) : GAME_OPTION(种子) + stage_name,
                     },
                     .name_ = stage_name,
                     .with_inner_dora_ = GAME_OPTION(里宝牌),
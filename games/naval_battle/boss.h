@@ -1,5 +1,6 @@
 
 #include <iomanip>
+#include <random>
 
 class Boss
 {
@@ -14,11 +15,16 @@ public:
     bool overlap{};
     // 是否为BOSS对战（BOSS被动技能判定）
     bool is_boss = false;
+    // 对局的随机数引擎
+    std::mt19937_64* random_engine = nullptr;
 
     // BOSS2 核弹研发中心
     bool RD_is_hit = false;
     const int RDcenter_position[8][2] = {{-2,0}, {-1,0}, {1,0}, {2,0}, {0,-2}, {0,-1}, {0,1}, {0,2}};
 
+    // 返回 [0, n) 中的随机整数
+    int Rand(const int n) const { return std::uniform_int_distribution<int>(0, n - 1)(*random_engine); }
+
     // BOSS简介
     string BossDesc() const
     {
@@ -94,8 +100,8 @@ public:
             // BOSS2 放置核弹研发中心
             if (BossType == 2) {
                 while (!RD_success) {
-                    X = rand() % (board[1].sizeX - 4) + 3;
-                    Y = rand() % (board[1].sizeY - 4) + 3;
+                    X = Rand(board[1].sizeX - 4) + 3;
+                    Y = Rand(board[1].sizeY - 4) + 3;
                     if (board[1].map[X][Y][0] == 0) {
                         board[1].map[X][Y][1] = 3;
                         for (auto position : RDcenter_position) {
@@ -107,10 +113,10 @@ public:
                 }
             }
             // 基础飞机放置
-            X = rand() % board[1].sizeX + 1;
-            Y = rand() % board[1].sizeY + 1;
+            X = Rand(board[1].sizeX) + 1;
+            Y = Rand(board[1].sizeY) + 1;
             str = string(1, 'A' + X - 1) + to_string(Y);
-            direction = rand() % 4 + 1;
+            direction = Rand(4) + 1;
             if (board[1].AddPlane(str, direction, overlap) == "OK") try_count = 0;
 
             if (try_count++ > 5000) {
@@ -122,21 +128,21 @@ public:
     }
 
     // BOSS 普攻
-    static string BossNormalAttack(Board (&board)[2], int round_, int (&attack_count)[2])
+    string BossNormalAttack(Board (&board)[2], int round_, int (&attack_count)[2])
     {
         int X, Y;
         string str;
         int try_count = 0, count = 0;
         int num;
         if (round_ < 18) {
-            num = rand() % 4 + 3;
+            num = Rand(4) + 3;
         } else {
-            num = rand() % 4 + 5;
+            num = Rand(4) + 5;
         }
         for (int i = 0; i < num; i++) {
             if (try_count > 1000) break;
-            X = rand() % board[0].sizeX + 1;
-            Y = rand() % board[0].sizeY + 1;
+            X = Rand(board[0].sizeX) + 1;
+            Y = Rand(board[0].sizeY) + 1;
             str = string(1, 'A' + X - 1) + to_string(Y);
             string result = board[0].Attack(str);
             if (result != "0" && result != "1" && result != "2" ) {
@@ -172,7 +178,7 @@ public:
         int X, Y;
         string str;
 
-        int skill = rand() % 100 + 1;
+        int skill = Rand(100) + 1;
         if (board[1].alive <= board[1].planeNum - 3) add_p = 5;
 
         if (skill > 100 - skill_probability[0] - add_p * 1)
@@ -191,10 +197,10 @@ public:
             int try_count = 0;
             int direction;
             while (board[1].alive < alive_count) {
-                X = rand() % board[1].sizeX + 1;
-                Y = rand() % board[1].sizeY + 1;
+                X = Rand(board[1].sizeX) + 1;
+                Y = Rand(board[1].sizeY) + 1;
                 str = string(1, 'A' + X - 1) + to_string(Y);
-                direction = rand() % 4 + 1;
+                direction = Rand(4) + 1;
                 int found_count = 0;
                 for (int i = 0; i < 9; i++) {
                     if (board[1].map[X + board[1].position[direction][i][0]][Y + board[1].position[direction][i][1]][0] > 0) {
@@ -203,7 +209,7 @@ public:
                 }
                 bool hide = false;
                 for (int i = 0; i <= 9; i++) {
-                    if ((found_count <= i && try_count >= i * 300) || (found_count <= 1 && rand() % 80 == 0)) {
+                    if ((found_count <= i && try_count >= i * 300) || (found_count <= 1 && Rand(80) == 0)) {
                         hide = true; break;
                     }
                 }
@@ -221,8 +227,8 @@ public:
         else if (skill > 100 - skill_probability[1] - add_p * 2)
         {
             // 15%概率触发连环轰炸，打击十字区域
-            X = rand() % board[0].sizeX + 1;
-            Y = rand() % board[0].sizeY + 1;
+            X = Rand(board[0].sizeX) + 1;
+            Y = Rand(board[0].sizeY) + 1;
             for (int i = 0; i < board[0].sizeX; i++) {
                 str = string(1, 'A' + X - 1) + to_string(i + 1);
                 board[0].Attack(str);
@@ -239,8 +245,8 @@ public:
             for (int attempt = 1; attempt <= 30; attempt++) {
                 count = exposed_space_count = exposed_plane_count = 0;
                 remain_head = true;
-                X = rand() % (board[0].sizeX - 4) + 3;
-                Y = rand() % (board[0].sizeY - 4) + 3;
+                X = Rand(board[0].sizeX - 4) + 3;
+                Y = Rand(board[0].sizeY - 4) + 3;
                 for (int i = -2; i <= 2; i++) {
                     for (int j = -2; j <= 2; j++) {
                         if (board[0].map[X + i][Y + j][0] > 0) {
@@ -274,8 +280,8 @@ public:
             // 25%概率触高爆导弹，打击3*3区域
             for (int attempt = 1; attempt <= 30; attempt++) {
                 int exposed_count = 0;
-                X = rand() % (board[0].sizeX - 2) + 2;
-                Y = rand() % (board[0].sizeY - 2) + 2;
+                X = Rand(board[0].sizeX - 2) + 2;
+                Y = Rand(board[0].sizeY - 2) + 2;
                 for (int i = -1; i <= 1; i++) {
                     for (int j = -1; j <= 1; j++) {
                         if (board[0].map[X + i][Y + j][0] > 0) {
@@ -307,7 +313,7 @@ public:
         int X, Y;
         string str;
         
-        int skill = rand() % 100 + 1;
+        int skill = Rand(100) + 1;
 
         // [核弹]
         int percent = round * 5;
@@ -327,7 +333,7 @@ public:
         ostringstream oss;
         oss << fixed << setprecision(1) << percent_d;
         string percent_s = oss.str();
-        if (rand() % 1000 < percent) {
+        if (Rand(1000) < percent) {
             for (int i = 1; i <= board[0].sizeX; i++) {
                 for (int j = 1; j <= board[0].sizeY; j++) {
                     str = string(1, 'A' + i - 1) + to_string(j);
@@ -360,10 +366,10 @@ public:
             int direction;
             bool success = false;
             while (!success) {
-                X = rand() % board[1].sizeX + 1;
-                Y = rand() % board[1].sizeY + 1;
+                X = Rand(board[1].sizeX) + 1;
+                Y = Rand(board[1].sizeY) + 1;
                 str = string(1, 'A' + X - 1) + to_string(Y);
-                direction = rand() % 4 + 1;
+                direction = Rand(4) + 1;
                 int found_count = 0;
                 for (int i = 0; i < 9; i++) {
                     if (board[1].map[X + board[1].position[direction][i][0]][Y + board[1].position[direction][i][1]][0] > 0) {
@@ -409,7 +415,7 @@ public:
         if (is_boss) {
             // BOSS2 [导弹拦截]
             if (BossType == 2) {
-                if (rand() % 100 < 8) {
+                if (Rand(100) < 8) {
                     string ret = board[0].Attack(str);
                     if (ret == "0" || ret == "1" || ret == "2") {
                         return make_pair(ret, "【WARNING】BOSS触发技能 [导弹拦截]，当前导弹被拦截并打击到了玩家的地图上");
@@ -37,7 +37,7 @@ bool AdaptOptions(MsgSenderBase& reply, MyGameOptions& game_options, const Gener
     }
 
     if (GET_OPTION_VALUE(game_options, BOSS挑战).empty()) GET_OPTION_VALUE(game_options, BOSS挑战) = {0};
-    if (GET_OPTION_VALUE(game_options, BOSS挑战)[0] == 0 || GET_OPTION_VALUE(game_options, BOSS挑战)[0] > 2) GET_OPTION_VALUE(game_options, BOSS挑战)[0] = rand() % 2 + 1;
+    if (GET_OPTION_VALUE(game_options, BOSS挑战)[0] > 2) GET_OPTION_VALUE(game_options, BOSS挑战)[0] = 0; // the boss is chosen randomly when the game starts
     if (GET_OPTION_VALUE(game_options, BOSS挑战).size() >= 2) GET_OPTION_VALUE(game_options, 重叠) = GET_OPTION_VALUE(game_options, BOSS挑战)[1] ? true : false;
     if (GET_OPTION_VALUE(game_options, BOSS挑战).size() >= 3) GET_OPTION_VALUE(game_options, 要害) = GET_OPTION_VALUE(game_options, BOSS挑战)[2] < 2 ? GET_OPTION_VALUE(game_options, BOSS挑战)[2] : 2;
     if (GET_OPTION_VALUE(game_options, BOSS挑战).size() >= 4) GET_OPTION_VALUE(game_options, 连发) = GET_OPTION_VALUE(game_options, BOSS挑战)[3] >= 1 && GET_OPTION_VALUE(game_options, BOSS挑战)[3] <= 10 ? GET_OPTION_VALUE(game_options, BOSS挑战)[3] : GET_OPTION_VALUE(game_options, 连发);
@@ -124,8 +124,9 @@ class MainStage : public MainGameStage<PrepareStage, AttackStage>
             attack_count[pid] = timeout[pid] = 0;
         }
         // 初始化BOSS战配置
+        boss.random_engine = &Global().RandomEngine();
         if (Global().PlayerName(1) == "机器人0号") {
-            boss.BossType = GAME_OPTION(BOSS挑战)[0];
+            boss.BossType = GAME_OPTION(BOSS挑战)[0] == 0 ? Global().Rand(2) + 1 : GAME_OPTION(BOSS挑战)[0];
             boss.overlap = GAME_OPTION(重叠);
             boss.is_boss = true;
             board[0].MapName = "<div><b>挑战者</b></div>" + board[0].MapName;
@@ -140,17 +141,17 @@ class MainStage : public MainGameStage<PrepareStage, AttackStage>
                         "\n- 连发 " << to_string(GAME_OPTION(连发)) <<
                         "\n- 侦察 " << to_string(GAME_OPTION(侦察)) << "\n\n";
             }
-            if (GAME_OPTION(BOSS挑战)[0] > 0 && GAME_OPTION(连发) == 3 && GAME_OPTION(侦察) == 100) {
+            if (GAME_OPTION(连发) == 3 && GAME_OPTION(侦察) == 100) {
                 sender << "[提示] 初始化预设BOSS配置成功！";
             } else {
                 sender << "[警告] 当前游戏未使用默认连发或侦察配置";
             }
-            if (GAME_OPTION(BOSS挑战)[0] == 1) {
+            if (boss.BossType == 1) {
                 board[0].sizeX = board[0].sizeY = board[1].sizeX = board[1].sizeY = 14;
                 board[0].planeNum = 3;
                 board[1].planeNum = 6;
             }
-            if (GAME_OPTION(BOSS挑战)[0] == 2) {
+            if (boss.BossType == 2) {
                 board[0].sizeX = board[0].sizeY = board[1].sizeX = board[1].sizeY = 14;
                 board[0].planeNum = 3;
                 board[1].planeNum = 5;
@@ -160,15 +161,14 @@ class MainStage : public MainGameStage<PrepareStage, AttackStage>
         board[1].InitializeMap();
         
         // 随机生成侦察点
-        srand((unsigned int)time(NULL));
         int count = 0, X, Y;
         int investigate = GAME_OPTION(侦察);
         if (investigate == 100) {
-            investigate = rand() % 5 + (board[0].sizeX - 7);
+            investigate = Global().Rand(5) + (board[0].sizeX - 7);
         }
         while (count < investigate) {
-            X = rand() % board[0].sizeX + 1;
-            Y = rand() % board[0].sizeY + 1;
+            X = Global().Rand(board[0].sizeX) + 1;
+            Y = Global().Rand(board[0].sizeY) + 1;
             if (board[0].map[X][Y][0] == 0) {
                 board[0].map[X][Y][0] = board[1].map[X][Y][0] = 2;
                 count++;
@@ -183,7 +183,7 @@ class MainStage : public MainGameStage<PrepareStage, AttackStage>
         if (timeout[0] || timeout[1]) {
             if (timeout[0]) player_scores_[0] = -1;
             if (timeout[1]) player_scores_[1] = -1;
-            Global().Boardcast() << Markdown(GetAllMap(1, 1, 0));
+            Global().Boardcast() << LazyMarkdown{[&] { return GetAllMap(1, 1, 0); }};
             return;
         }
         // UI从转为要害显示
@@ -191,7 +191,7 @@ class MainStage : public MainGameStage<PrepareStage, AttackStage>
         board[1].prepare = 0;
 
         // 展示初始地图
-        Global().Boardcast() << Markdown(GetAllMap(0, 0, GAME_OPTION(要害)));
+        Global().Boardcast() << LazyMarkdown{[&] { return GetAllMap(0, 0, GAME_OPTION(要害)); }};
 
         setter.Emplace<AttackStage>(*this, ++round_);
     }
@@ -234,7 +234,7 @@ class MainStage : public MainGameStage<PrepareStage, AttackStage>
                 }
             }
         }
-        Global().Boardcast() << Markdown(GetAllMap(1, 1, 0));
+        Global().Boardcast() << LazyMarkdown{[&] { return GetAllMap(1, 1, 0); }};
 
         if (round_ == 1 && GAME_OPTION(飞机) >= 3) {
             for (PlayerID pid = 0; pid < Global().PlayerNum(); ++pid) {
@@ -267,7 +267,7 @@ class PrepareStage : public SubGameStage<>
 
     virtual void OnStageBegin() override
     {
-		Global().Boardcast() << Markdown(Main().GetAllMap(0, 0, GAME_OPTION(要害)));
+		Global().Boardcast() << LazyMarkdown{[&] { return Main().GetAllMap(0, 0, GAME_OPTION(要害)); }};
         Global().Boardcast() << "请私信裁判放置飞机，时限 " << GAME_OPTION(放置时限) << " 秒";
         
         // 游戏开始时展示特殊规则
@@ -282,7 +282,7 @@ class PrepareStage : public SubGameStage<>
         }
 
         for (PlayerID pid = 0; pid < Global().PlayerNum(); ++pid) {
-            Global().Tell(pid) << Markdown(Main().board[pid].Getmap(1, GAME_OPTION(要害)));
+            Global().Tell(pid) << LazyMarkdown{[&] { return Main().board[pid].Getmap(1, GAME_OPTION(要害)); }};
             Global().Tell(pid) << "请放置飞机，指令为「坐标 方向」，如：C5 上\n可通过「帮助」查看全部命令格式";
         }
         Global().StartTimer(GAME_OPTION(放置时限));
@@ -413,7 +413,7 @@ class PrepareStage : public SubGameStage<>
 
         Main().boss.BossPrepare(Main().board);
 
-        Global().Boardcast() << "BOSS已抵达战场，请根据BOSS技能选择合适的部署和战术！\n" << Markdown(Main().boss.BossIntro());
+        Global().Boardcast() << "BOSS已抵达战场，请根据BOSS技能选择合适的部署和战术！\n" << LazyMarkdown{[&] { return Main().boss.BossIntro(); }};
         return StageErrCode::READY;
     }
 
@@ -451,7 +451,7 @@ class AttackStage : public SubGameStage<>
 
     virtual CheckoutErrCode OnStageOver() override
     {
-        Global().Boardcast() << Markdown(Main().GetAllMap(0, 0, GAME_OPTION(要害)));
+        Global().Boardcast() << LazyMarkdown{[&] { return Main().GetAllMap(0, 0, GAME_OPTION(要害)); }};
         // 重置上回合打击位置
         for (PlayerID pid = 0; pid < Global().PlayerNum(); ++pid) {
             for(int i = 1; i <= Main().board[pid].sizeX; i++) {
@@ -618,7 +618,7 @@ class AttackStage : public SubGameStage<>
         string roundinfo = "";
         roundinfo += Main().boss.BossNormalAttack(Main().board, Main().round_, Main().attack_count);
         roundinfo += Main().boss.BossSkillAttack(Main().board, Main().round_, Main().timeout, repeated);
-        Global().Boardcast() << roundinfo << "\n" << Markdown(Main().GetAllMap(0, 0, GAME_OPTION(要害)));
+        Global().Boardcast() << roundinfo << "\n" << LazyMarkdown{[&] { return Main().GetAllMap(0, 0, GAME_OPTION(要害)); }};
 
         if (Main().timeout[1] == 1) Global().SetReady(0);
 
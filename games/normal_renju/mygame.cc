@@ -65,7 +65,7 @@ class MainStage : public MainGameStage<>
         , round_(0)
         , player_scores_(Global().PlayerNum(), 0)
         , board_(Global().ResourceDir(), BoardOptions{.to_expand_board_ = false, .is_overline_win_ = false})
-        , turn_pid_(rand() % 2)
+        , turn_pid_(Global().Rand(2))
         , black_pid_(turn_pid_)
         , state_(State::INIT)
         , last_round_passed_(false)
@@ -105,8 +105,8 @@ class MainStage : public MainGameStage<>
             {
                 uint32_t x, y;
                 do {
-                    x = rand() % Board::k_size_;
-                    y = rand() % Board::k_size_;
+                    x = Global().Rand(Board::k_size_);
+                    y = Global().Rand(Board::k_size_);
                 } while (!board_.CanBeSet(x, y));
                 return board_.Set(x, y, type);
             };
@@ -117,7 +117,7 @@ class MainStage : public MainGameStage<>
             set(AreaType::BLACK);
             state_ = State::SWAP_1;
         } else if (state_ == State::SWAP_1) {
-            switch (rand() % 3) {
+            switch (Global().Rand(3)) {
             case 0:
                 set(AreaType::WHITE);
                 state_ = State::PLACE;
@@ -132,7 +132,7 @@ class MainStage : public MainGameStage<>
                 state_ = State::PLACE;
             }
         } else if (state_ == State::SWAP_2) {
-            if (rand() % 2) {
+            if (Global().Rand(2)) {
                 set(AreaType::WHITE);
             } else {
                 HandlePass_();
@@ -73,12 +73,11 @@ class MainStage : public MainGameStage<RoundStage>
         : StageFsm(std::move(utility))
         , round_(0)
     {
-        srand((unsigned int)time(NULL));
         const std::array<const char*, 5> skin_names = {"random", "pure", "green", "pink", "gold"};
         int skin_num = skin_names.size();
         int skin = GAME_OPTION(皮肤);
         if (GAME_OPTION(皮肤) == 0) {
-            skin = rand() % (skin_num - 1) + 1;
+            skin = Global().Rand(skin_num - 1) + 1;
         }
         imageDir = Global().ResourceDir() / std::filesystem::path(skin_names[skin]);
 
@@ -104,9 +103,8 @@ class MainStage : public MainGameStage<RoundStage>
 
         seed_str = GAME_OPTION(种子);
         if (seed_str.empty()) {
-            std::random_device rd;
             std::uniform_int_distribution<unsigned long long> dis;
-            seed_str = std::to_string(dis(rd));
+            seed_str = std::to_string(dis(Global().RandomEngine()));
         }
         std::seed_seq seed(seed_str.begin(), seed_str.end());
         std::mt19937 g(seed);
@@ -65,9 +65,9 @@ class MainStage : public MainGameStage<>
     virtual void OnStageBegin() override
     {
         Global().StartTimer(GAME_OPTION(时限));
-        Global().Group() << Markdown(ToHtml_());
-        Global().Tell(0) << Markdown(ToHtml_());
-        Global().Tell(1) << Markdown(ToHtml_());
+        Global().Group() << LazyMarkdown{[&] { return ToHtml_(); }};
+        Global().Tell(0) << LazyMarkdown{[&] { return ToHtml_(); }};
+        Global().Tell(1) << LazyMarkdown{[&] { return ToHtml_(); }};
         Global().Boardcast() << "游戏开始，请私信裁判坐标以落子（如 C3），时限 " << GAME_OPTION(时限) << " 秒，超时未落子即判负";
     }
 
@@ -148,7 +148,7 @@ class MainStage : public MainGameStage<>
         const auto chess_type = PlayerIDToChessType_(pid);
         const auto avaliable_placements = board_.PlacablePositions(chess_type);
         if (!avaliable_placements.empty()) {
-            const auto coor = avaliable_placements[std::rand() % avaliable_placements.size()];
+            const auto coor = avaliable_placements[Global().Rand(avaliable_placements.size())];
             placed_coors_[pid] = std::pair{static_cast<uint32_t>(coor.row_), static_cast<uint32_t>(coor.col_)};
             const auto ret = board_.Place(coor, chess_type);
             assert(ret);
@@ -174,14 +174,17 @@ class MainStage : public MainGameStage<>
             }
         }
         Global().Boardcast() << "双方落子成功";
-        Global().BoardcastAiInfo(nlohmann::json{
-                    { "player_coordinates", std::move(json_array) },
-                    { "board", board_.ToString() }
+        Global().BoardcastAiInfo([&]
+                {
+                    return nlohmann::json{
+                        { "player_coordinates", std::move(json_array) },
+                        { "board", board_.ToString() }
+                    };
                 });
         ++round_;
-        Global().Group() << Markdown(ToHtml_());
-        Global().Tell(0) << Markdown(ToHtml_());
-        Global().Tell(1) << Markdown(ToHtml_());
+        Global().Group() << LazyMarkdown{[&] { return ToHtml_(); }};
+        Global().Tell(0) << LazyMarkdown{[&] { return ToHtml_(); }};
+        Global().Tell(1) << LazyMarkdown{[&] { return ToHtml_(); }};
         if (!Global().IsReady(0) || !Global().IsReady(1)) {
             Global().StartTimer(GAME_OPTION(时限));
             Global().Boardcast() << "请继续私信裁判坐标以落子（如 C3），时限 " << GAME_OPTION(时限) << " 秒，超时未落子即判负";
@@ -62,7 +62,7 @@ class MainStage : public MainGameStage<>
                 MakeStageCommand(*this, "查看盘面情况，可用于图片重发", &MainStage::Info_, VoidChecker("赛况")),
                 MakeStageCommand(*this, "移动棋子", &MainStage::Set_,
                     ArithChecker<uint32_t>(0, 15, "移动前位置"), ArithChecker<uint32_t>(0, 15, "移动后位置")))
-        , first_turn_(rand() % 2)
+        , first_turn_(Global().Rand(2))
         , board_(Global().ResourceDir())
         , round_(0)
         , scores_{0}
@@ -73,7 +73,7 @@ class MainStage : public MainGameStage<>
     {
         Global().SetReady(1 - cur_pid());
         Global().StartTimer(GAME_OPTION(局时));
-        Global().Boardcast() << Markdown(ShowInfo_());
+        Global().Boardcast() << LazyMarkdown{[&] { return ShowInfo_(); }};
         Global().Boardcast() << "请" << At(cur_pid()) << "行动，" << GAME_OPTION(局时)
                     << "秒未行动自动判负\n格式：移动前位置 移动后位置";
     }
@@ -84,9 +84,9 @@ class MainStage : public MainGameStage<>
             return StageErrCode::OK;
         }
         while (true) {
-            const uint32_t src = rand() % 16;
+            const uint32_t src = Global().Rand(16);
             const auto valid_dsts = board_.ValidDsts(src);
-            const uint32_t dst = valid_dsts[rand() % valid_dsts.size()];
+            const uint32_t dst = valid_dsts[Global().Rand(valid_dsts.size())];
             const auto ret = board_.Push(src, dst, cur_type());
             if (ret == game_util::quixo::ErrCode::OK) {
                 Global().Boardcast() << At(pid) << "将 " << src << " 位置的棋子取出，从 " << dst << " 位置重新推入";
@@ -163,15 +163,15 @@ class MainStage : public MainGameStage<>
     {
         const auto ret = board_.LineCount();
         if (ret[1 - static_cast<uint32_t>(cur_symbol())]) {
-            Global().Boardcast() << Markdown(ShowInfo_());
+            Global().Boardcast() << LazyMarkdown{[&] { return ShowInfo_(); }};
             Global().Boardcast() << At(cur_pid()) << "帮助对手达成了直线，于是，输掉了比赛";
             scores_[1 - cur_pid()] = 1;
         } else if (ret[static_cast<uint32_t>(cur_symbol())]) {
-            Global().Boardcast() << Markdown(ShowInfo_());
+            Global().Boardcast() << LazyMarkdown{[&] { return ShowInfo_(); }};
             Global().Boardcast() << At(cur_pid()) << "达成了直线，于是，赢得了比赛";
             scores_[cur_pid()] = 1;
         } else if ((++round_) / 2 >= GAME_OPTION(回合数)) {
-            Global().Boardcast() << Markdown(ShowInfo_());
+            Global().Boardcast() << LazyMarkdown{[&] { return ShowInfo_(); }};
             const auto chess_counts = ChessCounts_();
             if (chess_counts[0] == chess_counts[1]) {
                 Global().Boardcast() << "游戏达到最大回合数，双方棋子数量相同，游戏平局";
@@ -183,11 +183,11 @@ class MainStage : public MainGameStage<>
                 Global().Boardcast() << "游戏达到最大回合数，玩家" << At(PlayerID(0)) << "棋子数量较少，于是，赢得了比赛";
             }
         } else if (!board_.CanPush(cur_type())) {
-            Global().Boardcast() << Markdown(ShowInfo_());
+            Global().Boardcast() << LazyMarkdown{[&] { return ShowInfo_(); }};
             Global().Boardcast() << At(cur_pid()) << "没有可取出的棋子，于是，输掉了比赛";
             scores_[1 - cur_pid()] = 1;
         } else {
-            Global().Boardcast() << Markdown(ShowInfo_());
+            Global().Boardcast() << LazyMarkdown{[&] { return ShowInfo_(); }};
             Global().ClearReady(cur_pid());
             Global().StartTimer(GAME_OPTION(局时));
             Global().Boardcast() << "请" << At(cur_pid()) << "行动，" << GAME_OPTION(局时)
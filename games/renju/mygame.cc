@@ -89,8 +89,8 @@ class MainStage : public MainGameStage<>
     {
         uint32_t x, y;
         do {
-            x = rand() % Board::k_size_;
-            y = rand() % Board::k_size_;
+            x = Global().Rand(Board::k_size_);
+            y = Global().Rand(Board::k_size_);
         } while (!board_.CanBeSet(x, y));
         player_pos_[pid].emplace_back(x, y);
         return StageErrCode::READY;
@@ -115,7 +115,7 @@ class MainStage : public MainGameStage<TableStage>
 #else
         sync_mahjong_option_.tiles_option_.
 #endif
-        seed_ = GAME_OPTION(种子).empty() ? "" : GAME_OPTION(种子) + std::to_string(sync_mahjong_option_.benchang_);
+        seed_ = GAME_OPTION(种子).empty() ? std::to_string(Global().RandomEngine()()) : GAME_OPTION(种子) + std::to_string(sync_mahjong_option_.benchang_);
     }
 
     game_util::mahjong::SyncMahjongOption sync_mahjong_option_;
@@ -132,10 +132,10 @@ class SingleTileChecker : public AnyArg
         if (!reader.HasNext()) {
             return std::nullopt;
         }
-        const std::string& tile_str = reader.NextArg();
+        const std::string_view tile_str = reader.NextArg();
         if ((tile_str.size() == 2 && std::isdigit(tile_str[0]) && std::isalpha(tile_str[1])) ||
                 (tile_str.size() == 3 && tile_str[0] == 't' && std::isdigit(tile_str[1]) && std::isalpha(tile_str[2])))  {
-            return tile_str;
+            return std::string(tile_str);
         }
         return std::nullopt;
     }
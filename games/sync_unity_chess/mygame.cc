@@ -90,7 +90,7 @@ class MainStage : public MainGameStage<>
         }
         std::vector<uint32_t> coordinates(size * size);
         std::iota(coordinates.begin(), coordinates.end(), 0);
-        std::ranges::shuffle(coordinates, std::mt19937 {std::random_device {}()});
+        std::ranges::shuffle(coordinates, Global().RandomEngine());
 
         const uint32_t bonus_count = size * size * rate / 100;
         std::vector<Coordinate> result(bonus_count);
@@ -180,7 +180,7 @@ class MainStage : public MainGameStage<>
 
     virtual AtomReqErrCode OnComputerAct(const PlayerID pid, MsgSenderBase& reply) override
     {
-        board_.RandomSet(pid);
+        board_.RandomSet(pid, Global().RandomEngine());
         any_player_set_chess_ = true;
         return StageErrCode::READY;
     }
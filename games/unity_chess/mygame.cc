@@ -432,8 +432,7 @@ class RoundStage : public SubGameStage<>
 void MainStage::FirstStageFsm(SubStageFsmSetter setter)
 {
 	// 随机生成先后手 
-	srand((unsigned int)time(NULL));
-	currentPlayer = rand() % 2;
+	currentPlayer = Global().Rand(2);
 	Global().Boardcast() << "先手（黑棋）：" << At(PlayerID(currentPlayer));
 	
 	// 设置读取棋盘大小 
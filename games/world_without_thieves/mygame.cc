@@ -237,20 +237,20 @@ class RoundStage : public SubGameStage<>
         int now = pid;
         if(select[now] == 'S')
         {
-            int r = rand() % 100 + 1;
+            int r = Global().Rand(100) + 1;
             if(r <= 12) S = 'S';
             else if(r <= 100) S = 'N';
         }
         if(select[now] == 'N')
         {
-            int r = rand() % 100 + 1;
+            int r = Global().Rand(100) + 1;
             if(r <= 15) S = 'S';
             else if(r <= 85) S = 'N';
             else if(r <= 100) S = 'P';
         }
         if(select[now] == 'P')
         {
-            int r = rand() % 100 + 1;
+            int r = Global().Rand(100) + 1;
             if(r <= 85) S = 'N';
             else if(r <= 100) S = 'P';
         }
@@ -272,7 +272,7 @@ class RoundStage : public SubGameStage<>
                 S = 'N';
                 return Selected_(pid, reply, S, T + 1);
             }
-            int r = rand() % 100 + 1;
+            int r = Global().Rand(100) + 1;
             if(r <= 75) to = 0;
             else if(r <= 90) to = 1;
             else if(r <= 100) to = 2;
@@ -286,7 +286,7 @@ class RoundStage : public SubGameStage<>
                 S = 'N';
                 return Selected_(pid, reply, S, T + 1);
             }
-            r = rand() % s[to].size();
+            r = Global().Rand(s[to].size());
             while(r != 0)
             {
                 r--;
@@ -303,7 +303,7 @@ class RoundStage : public SubGameStage<>
                 return Selected_(pid, reply, S, T + 1);
             }
 
-            int r = rand() % 100 + 1;
+            int r = Global().Rand(100) + 1;
             if(r <= 30) to = 0;
             else if(r <= 100) to = 1;
 
@@ -316,7 +316,7 @@ class RoundStage : public SubGameStage<>
                 S = 'N';
                 return Selected_(pid, reply, S, T + 1);
             }
-            r = rand() % s[to].size();
+            r = Global().Rand(s[to].size());
             while(r != 0)
             {
                 r--;
@@ -576,7 +576,6 @@ std::string MainStage::GetName(std::string x)
 
 void MainStage::FirstStageFsm(SubStageFsmSetter setter)
 {
-    srand((unsigned int)time(NULL));
     alive_ = Global().PlayerNum();
 
     Pic += "<table><tr>";
@@ -0,0 +1,447 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+// Generate load on a bot through the C API, and report the throughput, the latency of requests for each errcode and the
+// peak RSS, so that we can track the performance across releases.
+//
+// The users are split into groups. Each group plays rounds one after another: the host creates a match of a random
+// game, other users join and the host starts it, then the players send game requests (in the group or privately) mixed
+// with chats, and finally all players interrupt the match. The game requests are the examples in the text help of each
+// game (i.e., the replies of "帮助 文字"), so they come from the command table of the current stage. In some rounds,
+// the host shortens the timers by the option "时限" before others join, and the group becomes idle for longer than the
+// timers after the match starts, so that the timers fire. The number of fired timeouts is reported.
+//
+// Usage: ./bot_loadgen --game_path=./plugins --users=2000 --groups=200 --threads=4 --duration_sec=30
+
+#include <gflags/gflags.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include "bot_core/bot_core.h"
+
+DEFINE_string(game_path, "plugins", "The path of game modules");
+DEFINE_string(image_path, "", "The path of the directory to save images, be empty to use a temporary directory");
+DEFINE_string(games, "", "The names of games to play, separated by comma, be empty to play all loaded games");
+DEFINE_uint32(users, 2000, "The number of users");
+DEFINE_uint32(groups, 200, "The number of groups, users are distributed to groups evenly");
+DEFINE_uint32(threads, 4, "The number of threads sending requests, each of which drives a part of groups");
+DEFINE_uint32(duration_sec, 30, "The seconds to send requests");
+DEFINE_uint32(game_requests_per_match, 50, "The number of game requests sent in a match before it is interrupted");
+DEFINE_double(chat_ratio, 0.2, "The ratio of messages which are chats matching no command during a match");
+DEFINE_double(private_ratio, 0.5, "The ratio of game requests which are sent privately");
+DEFINE_double(idle_ratio, 0.1, "The ratio of matches during which the group becomes idle for a while");
+DEFINE_uint32(idle_sec, 15, "The seconds for which a group is idle, which should be longer than --idle_timer_sec");
+DEFINE_uint32(idle_timer_sec, 10, "The value of the option \"时限\" set in the rounds when the group becomes idle");
+DEFINE_uint32(outbound_threads, 4, "The number of threads to invoke `handle_messages`");
+DEFINE_uint64(seed, 0, "The seed of random numbers");
+
+static constexpr const char* const k_admin_uid = "loadgen_admin";
+static constexpr const char* const k_example_prefix = "- 例如：";
+
+// Collect the texts replied by the bot, which are used to learn the game names and game commands.
+struct Collector
+{
+    std::atomic<uint64_t> message_count_{0};
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::string admin_text_;                                // REQUIRE: should be protected by mutex_
+    std::map<std::string, std::string> help_gid_to_game_;   // REQUIRE: should be protected by mutex_
+    std::map<std::string, std::vector<std::string>> game_examples_; // REQUIRE: should be protected by mutex_
+};
+
+static std::vector<std::string> ParseExamples(const std::string& text)
+{
+    std::vector<std::string> examples;
+    std::istringstream ss(text);
+    for (std::string line; std::getline(ss, line); ) {
+        const auto pos = line.find(k_example_prefix);
+        if (pos == std::string::npos) {
+            continue;
+        }
+        std::string example = line.substr(pos + std::strlen(k_example_prefix));
+        example.erase(example.find_last_not_of(' ') + 1);
+        if (!example.empty() && !example.starts_with("帮助")) {
+            examples.emplace_back(std::move(example));
+        }
+    }
+    return examples;
+}
+
+static void HandleMessages(void* const handler, const char* const id, const int is_to_user,
+        const LGTBot_Message* const messages, const size_t size)
+{
+    auto& collector = *static_cast<Collector*>(handler);
+    collector.message_count_.fetch_add(1, std::memory_order_relaxed);
+    std::string text;
+    for (size_t i = 0; i < size; ++i) {
+        if (messages[i].type_ == LGTBOT_MSG_TEXT) {
+            text += messages[i].str_;
+        }
+    }
+    std::lock_guard<std::mutex> l(collector.mutex_);
+    if (is_to_user && std::strcmp(id, k_admin_uid) == 0) {
+        collector.admin_text_ += text;
+        collector.cv_.notify_all();
+    } else if (const auto it = collector.help_gid_to_game_.find(id);
+            !is_to_user && it != collector.help_gid_to_game_.end()) {
+        if (auto examples = ParseExamples(text); !examples.empty()) {
+            collector.game_examples_[it->second] = std::move(examples);
+            collector.help_gid_to_game_.erase(it);
+        }
+    }
+}
+
+static void HandleMessagesMulti(void* const handler, const char* const* const user_ids, const size_t user_id_num,
+        const LGTBot_Message* const messages, const size_t size)
+{
+    static_cast<Collector*>(handler)->message_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void GetUserName(void* const handler, char* const buffer, const size_t size, const char* const user_id)
+{
+    std::strncpy(buffer, user_id, size);
+}
+
+static void GetUserNameInGroup(void* const handler, char* const buffer, const size_t size, const char* const group_id,
+        const char* const user_id)
+{
+    std::strncpy(buffer, user_id, size);
+}
+
+static int DownloadUserAvatar(void* const handler, const char* const user_id, const char* const dest_filename)
+{
+    return false;
+}
+
+// The latencies of requests grouped by errcodes.
+using LatencyMap = std::map<ErrCode, std::vector<uint32_t>>;
+
+class Group
+{
+  public:
+    Group(void* const bot, Collector& collector, const std::vector<std::string>& games, std::string gid,
+          std::vector<std::string> uids, const uint64_t seed)
+        : bot_(bot), collector_(collector), games_(games), gid_(std::move(gid)), uids_(std::move(uids)), rng_(seed)
+    {
+    }
+
+    // Send a request if the group is not idle. Return false if the group is idle.
+    bool Step(LatencyMap& latencies)
+    {
+        switch (state_) {
+        case State::NO_MATCH:
+            game_ = games_[std::uniform_int_distribution<size_t>(0, games_.size() - 1)(rng_)];
+            if (Public_(latencies, uids_[0], "#新游戏 " + game_) == EC_OK) {
+                is_idle_round_ = std::bernoulli_distribution(FLAGS_idle_ratio)(rng_);
+                if (is_idle_round_) {
+                    // the timers of games without this option are not shortened, so they may not fire
+                    Public_(latencies, uids_[0], "时限 " + std::to_string(FLAGS_idle_timer_sec));
+                }
+                player_num_ = 1;
+                target_player_num_ = std::uniform_int_distribution<uint32_t>(2, uids_.size())(rng_);
+                state_ = State::JOINING;
+            } else {
+                Reset(latencies);
+            }
+            return true;
+        case State::JOINING:
+            if (player_num_ < target_player_num_) {
+                if (Public_(latencies, uids_[player_num_], "#加入") == EC_OK) {
+                    ++player_num_;
+                } else {
+                    target_player_num_ = player_num_; // the match is full
+                }
+            } else if (Public_(latencies, uids_[0], "#开始") == EC_OK) {
+                game_request_num_ = 0;
+                state_ = State::PLAYING;
+                if (is_idle_round_) {
+                    idle_until_ = std::chrono::steady_clock::now() + std::chrono::seconds(FLAGS_idle_sec);
+                    state_ = State::IDLE;
+                }
+            } else if (Public_(latencies, uids_[0], "#替补至 " + std::to_string(player_num_ + 1)) != EC_OK) {
+                Reset(latencies); // the game cannot be started
+            }
+            return true;
+        case State::IDLE:
+            if (std::chrono::steady_clock::now() < idle_until_) {
+                return false;
+            }
+            state_ = State::PLAYING;
+            [[fallthrough]];
+        case State::PLAYING:
+            if (!LGTBot_IsGroupInMatch(bot_, gid_.c_str())) {
+                state_ = State::NO_MATCH; // the game is over
+            } else if (game_request_num_ >= FLAGS_game_requests_per_match) {
+                interrupt_num_ = 0;
+                state_ = State::INTERRUPTING;
+            } else {
+                ++game_request_num_;
+                SendGameRequest_(latencies, uids_[std::uniform_int_distribution<uint32_t>(0, player_num_ - 1)(rng_)]);
+            }
+            return true;
+        case State::INTERRUPTING:
+            if (interrupt_num_ < player_num_) {
+                Public_(latencies, uids_[interrupt_num_++], "#中断");
+            } else {
+                Reset(latencies);
+            }
+            return true;
+        }
+        return true;
+    }
+
+    // Interrupt the match if there is one.
+    void Reset(LatencyMap& latencies)
+    {
+        if (LGTBot_IsGroupInMatch(bot_, gid_.c_str())) {
+            Public_(latencies, k_admin_uid, "%中断");
+        }
+        state_ = State::NO_MATCH;
+    }
+
+  private:
+    enum class State { NO_MATCH, JOINING, PLAYING, IDLE, INTERRUPTING };
+
+    void SendGameRequest_(LatencyMap& latencies, const std::string& uid)
+    {
+        if (std::bernoulli_distribution(FLAGS_chat_ratio)(rng_)) {
+            Public_(latencies, uid, "大家好 " + std::to_string(rng_() % 100));
+            return;
+        }
+        std::string example;
+        {
+            std::lock_guard<std::mutex> l(collector_.mutex_);
+            if (const auto it = collector_.game_examples_.find(game_); it != collector_.game_examples_.end()) {
+                example = it->second[std::uniform_int_distribution<size_t>(0, it->second.size() - 1)(rng_)];
+            } else {
+                collector_.help_gid_to_game_.emplace(gid_, game_);
+            }
+        }
+        if (example.empty()) {
+            Public_(latencies, uid, "帮助 文字");
+        } else if (std::bernoulli_distribution(FLAGS_private_ratio)(rng_)) {
+            Private_(latencies, uid, example);
+        } else {
+            Public_(latencies, uid, example);
+        }
+    }
+
+    template <typename Handle>
+    static ErrCode Measure_(LatencyMap& latencies, Handle&& handle)
+    {
+        const auto begin = std::chrono::steady_clock::now();
+        const ErrCode rc = handle();
+        latencies[rc].emplace_back(std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - begin).count());
+        return rc;
+    }
+
+    ErrCode Public_(LatencyMap& latencies, const std::string& uid, const std::string& msg)
+    {
+        return Measure_(latencies,
+                [&] { return LGTBot_HandlePublicRequest(bot_, gid_.c_str(), uid.c_str(), msg.c_str()); });
+    }
+
+    ErrCode Private_(LatencyMap& latencies, const std::string& uid, const std::string& msg)
+    {
+        return Measure_(latencies, [&] { return LGTBot_HandlePrivateRequest(bot_, uid.c_str(), msg.c_str()); });
+    }
+
+    void* const bot_;
+    Collector& collector_;
+    const std::vector<std::string>& games_;
+    const std::string gid_;
+    const std::vector<std::string> uids_;
+    std::mt19937_64 rng_;
+
+    State state_ = State::NO_MATCH;
+    std::string game_;
+    uint32_t player_num_ = 0;
+    uint32_t target_player_num_ = 0;
+    uint32_t game_request_num_ = 0;
+    uint32_t interrupt_num_ = 0;
+    bool is_idle_round_ = false;
+    std::chrono::steady_clock::time_point idle_until_;
+};
+
+// Get the names of loaded games from the text game list, whose lines are like "1. 猜拳游戏（试玩）".
+static std::vector<std::string> LoadedGames(void* const bot, Collector& collector)
+{
+    const auto rc = LGTBot_HandlePrivateRequest(bot, k_admin_uid, "#游戏列表 文字");
+    if (rc != EC_OK) {
+        std::cerr << "[ERROR] Get game list failed: " << errcode2str(rc) << std::endl;
+        return {};
+    }
+    std::unique_lock<std::mutex> l(collector.mutex_);
+    collector.cv_.wait_for(l, std::chrono::seconds(10), [&] { return !collector.admin_text_.empty(); });
+    std::vector<std::string> games;
+    std::istringstream ss(collector.admin_text_);
+    for (std::string line; std::getline(ss, line); ) {
+        if (const auto pos = line.find(". "); pos != std::string::npos) {
+            std::string name = line.substr(pos + 2);
+            if (const auto trial_pos = name.find("（"); trial_pos != std::string::npos) {
+                name.resize(trial_pos);
+            }
+            games.emplace_back(std::move(name));
+        }
+    }
+    return games;
+}
+
+static std::vector<std::string> SplitByComma(const std::string& str)
+{
+    std::vector<std::string> items;
+    std::istringstream ss(str);
+    for (std::string item; std::getline(ss, item, ','); ) {
+        if (!item.empty()) {
+            items.emplace_back(std::move(item));
+        }
+    }
+    return items;
+}
+
+// Get the value of a counter without labels from the metrics of the bot.
+static uint64_t CounterValue(void* const bot, const std::string& name)
+{
+    std::string text(LGTBot_DumpMetrics(bot, LGTBOT_METRICS_PROMETHEUS, nullptr, 0), '\0');
+    LGTBot_DumpMetrics(bot, LGTBOT_METRICS_PROMETHEUS, text.data(), text.size() + 1);
+    std::istringstream ss(text);
+    for (std::string line; std::getline(ss, line); ) {
+        if (line.starts_with(name + " ")) {
+            return std::stoull(line.substr(name.size() + 1));
+        }
+    }
+    return 0; // the counter is not created until the first timeout
+}
+
+static void PrintReport(const LatencyMap& latencies, const double sec, const uint64_t message_count,
+        const uint64_t timeout_count)
+{
+    uint64_t request_count = 0;
+    for (const auto& [_, values] : latencies) {
+        request_count += values.size();
+    }
+    std::cout << "duration_sec=" << sec << " requests=" << request_count << " requests/sec=" << request_count / sec
+              << " delivered_message_batches=" << message_count << " timeouts=" << timeout_count << std::endl;
+    for (auto [rc, values] : latencies) {
+        std::ranges::sort(values);
+        const auto quantile = [&values](const double q) { return values[static_cast<size_t>(q * (values.size() - 1))]; };
+        std::cout << errcode2str(rc) << ": count=" << values.size() << " p50_us=" << quantile(0.5)
+                  << " p99_us=" << quantile(0.99) << " max_us=" << values.back() << std::endl;
+    }
+#ifndef _WIN32
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    std::cout << "peak_rss_kb=" << usage.ru_maxrss << std::endl; // kilobytes on Linux
+#endif
+}
+
+int main(int argc, char** argv)
+{
+    gflags::ParseCommandLineFlags(&argc, &argv, true);
+    if (FLAGS_groups == 0 || FLAGS_users < FLAGS_groups * 2 || FLAGS_threads == 0) {
+        std::cerr << "[ERROR] There should be at least one group, two users in each group and one thread" << std::endl;
+        return 1;
+    }
+    if (FLAGS_idle_ratio > 0 && FLAGS_idle_sec <= FLAGS_idle_timer_sec) {
+        std::cerr << "[ERROR] The idle seconds should be longer than the timer, or the timers never fire" << std::endl;
+        return 1;
+    }
+    const std::string image_path = FLAGS_image_path.empty() ?
+        (std::filesystem::temp_directory_path() / "lgtbot_loadgen_image").string() : FLAGS_image_path;
+
+    Collector collector;
+    LGTBot_Option options = LGTBot_InitOptions();
+    options.game_path_ = FLAGS_game_path.c_str();
+    options.image_path_ = image_path.c_str();
+    options.admins_ = k_admin_uid;
+    options.handler_ = &collector;
+    options.callbacks_ = LGTBot_Callback{
+        .get_user_name = GetUserName,
+        .get_user_name_in_group = GetUserNameInGroup,
+        .download_user_avatar = DownloadUserAvatar,
+        .handle_messages = HandleMessages,
+    };
+    options.handle_messages_multi_ = HandleMessagesMulti;
+    options.outbound_thread_num_ = FLAGS_outbound_threads;
+    const char* errmsg = nullptr;
+    void* const bot = LGTBot_Create(&options, &errmsg);
+    if (!bot) {
+        std::cerr << "[ERROR] Create bot failed: " << errmsg << std::endl;
+        return 1;
+    }
+
+    const std::vector<std::string> games = FLAGS_games.empty() ? LoadedGames(bot, collector) : SplitByComma(FLAGS_games);
+    if (games.empty()) {
+        std::cerr << "[ERROR] No games to play" << std::endl;
+        LGTBot_Release(bot);
+        return 1;
+    }
+
+    std::vector<Group> groups;
+    for (uint32_t i = 0; i < FLAGS_groups; ++i) {
+        std::vector<std::string> uids;
+        for (uint32_t j = i; j < FLAGS_users; j += FLAGS_groups) {
+            uids.emplace_back("user_" + std::to_string(j));
+        }
+        groups.emplace_back(bot, collector, games, "group_" + std::to_string(i), std::move(uids), FLAGS_seed + i);
+    }
+
+    std::vector<LatencyMap> thread_latencies(FLAGS_threads);
+    const auto begin = std::chrono::steady_clock::now();
+    const auto deadline = begin + std::chrono::seconds(FLAGS_duration_sec);
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < FLAGS_threads; ++i) {
+        threads.emplace_back([&, i]
+                {
+                    while (std::chrono::steady_clock::now() < deadline) {
+                        bool is_all_idle = true;
+                        for (size_t group_idx = i; group_idx < groups.size(); group_idx += FLAGS_threads) {
+                            is_all_idle &= !groups[group_idx].Step(thread_latencies[i]);
+                        }
+                        if (is_all_idle) {
+                            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                        }
+                    }
+                });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    LatencyMap latencies;
+    for (auto& thread_latency : thread_latencies) {
+        for (auto& [rc, values] : thread_latency) {
+            latencies[rc].insert(latencies[rc].end(), values.begin(), values.end());
+        }
+    }
+    const uint64_t timeout_count = CounterValue(bot, "lgtbot_match_timeout_total");
+    LatencyMap cleanup_latencies;
+    for (auto& group : groups) {
+        group.Reset(cleanup_latencies);
+    }
+    LGTBot_Release(bot);
+    PrintReport(latencies, sec, collector.message_count_.load(), timeout_count);
+    return 0;
+}
@@ -0,0 +1,235 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+// Replay a match journal recorded by the bot (see `journal_path_` in bot_core.h) against the game module headlessly,
+// and report the time taken by each step. It re-executes the match exactly as long as the game draws random numbers
+// from `StageUtility` only.
+//
+// Usage: ./replay_match --journal=./journals/xxx.journal --game_path=./plugins [--show_steps] [--show_messages]
+
+#include <gflags/gflags.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif __linux__
+#include <dlfcn.h>
+#define HINSTANCE void*
+#define GetProcAddress dlsym
+#define FreeLibrary dlclose
+#else
+static_assert(false, "Not support OS");
+#endif
+
+#include "bot_core/game_handle.h"
+#include "bot_core/match_journal.h"
+#include "game_framework/mock_match.h"
+
+DEFINE_string(journal, "", "The path of the match journal");
+DEFINE_string(game_path, "plugins", "The path of game modules");
+DEFINE_string(image_dir, "", "The path of the directory to save images, be empty to use a temporary directory");
+DEFINE_bool(gen_image, false, "Whether generate images of markdown messages or not");
+DEFINE_bool(show_steps, false, "Print the time taken by each step");
+DEFINE_bool(show_messages, false, "Print the messages sent by the game");
+
+struct GameModule
+{
+    HINSTANCE mod_;
+    GameHandle::game_options_allocator game_options_allocator_;
+    GameHandle::game_options_deleter game_options_deleter_;
+    GameHandle::main_stage_allocator main_stage_allocator_;
+    GameHandle::main_stage_deleter main_stage_deleter_;
+};
+
+static std::optional<GameModule> LoadGame(const std::string& module_name)
+{
+#ifdef _WIN32
+    const std::string path = FLAGS_game_path + "\\" + module_name + ".dll";
+    HINSTANCE mod = LoadLibrary(path.c_str());
+#else
+    const std::string path = FLAGS_game_path + "/lib" + module_name + ".so";
+    HINSTANCE mod = dlopen(path.c_str(), RTLD_LAZY);
+#endif
+    if (!mod) {
+        std::cerr << "[ERROR] Load module failed: " << path << std::endl;
+        return std::nullopt;
+    }
+    GameModule game_module{
+        .mod_ = mod,
+        .game_options_allocator_ = reinterpret_cast<GameHandle::game_options_allocator>(GetProcAddress(mod, "NewGameOptions")),
+        .game_options_deleter_ = reinterpret_cast<GameHandle::game_options_deleter>(GetProcAddress(mod, "DeleteGameOptions")),
+        .main_stage_allocator_ = reinterpret_cast<GameHandle::main_stage_allocator>(GetProcAddress(mod, "NewMainStage")),
+        .main_stage_deleter_ = reinterpret_cast<GameHandle::main_stage_deleter>(GetProcAddress(mod, "DeleteMainStage")),
+    };
+    if (!game_module.game_options_allocator_ || !game_module.game_options_deleter_ ||
+            !game_module.main_stage_allocator_ || !game_module.main_stage_deleter_) {
+        std::cerr << "[ERROR] Load procs from module failed: " << path << std::endl;
+        FreeLibrary(mod);
+        return std::nullopt;
+    }
+    return game_module;
+}
+
+// The time taken by steps of the same type.
+struct StepStats
+{
+    std::vector<uint64_t> elapsed_us_;
+    std::map<std::string, uint64_t> rc_counts_;
+};
+
+static void ShowStats(const std::map<std::string, StepStats>& stats)
+{
+    for (auto [type, type_stats] : stats) {
+        auto& elapsed_us = type_stats.elapsed_us_;
+        std::ranges::sort(elapsed_us);
+        uint64_t total_us = 0;
+        for (const auto us : elapsed_us) {
+            total_us += us;
+        }
+        const auto quantile = [&elapsed_us](const double q) { return elapsed_us[static_cast<size_t>(q * (elapsed_us.size() - 1))]; };
+        std::cout << type << ": count=" << elapsed_us.size() << " total_us=" << total_us << " p50_us=" << quantile(0.5)
+                  << " p99_us=" << quantile(0.99) << " max_us=" << elapsed_us.back();
+        for (const auto& [rc, count] : type_stats.rc_counts_) {
+            std::cout << " " << rc << "=" << count;
+        }
+        std::cout << std::endl;
+    }
+}
+
+static int Replay(MatchJournalReader& reader, const GameModule& game_module, const std::filesystem::path& image_dir)
+{
+    const auto& header = reader.header();
+    const GameHandle::game_options_ptr game_options(game_module.game_options_allocator_(),
+            game_module.game_options_deleter_);
+    for (const auto& option : header.game_options_) {
+        if (!game_options->SetOption(option.c_str())) {
+            std::cerr << "[WARN] Set option failed: " << option << std::endl;
+        }
+    }
+    const std::string resource_dir = (std::filesystem::absolute(FLAGS_game_path) / header.module_name_ / "").string();
+    const std::string saved_image_dir = image_dir.string();
+    lgtbot::game::GenericOptions generic_options{
+        lgtbot::game::ImmutableGenericOptions{
+            .public_timer_alert_ = header.public_timer_alert_,
+            .user_num_ = header.user_num_,
+            .resource_dir_ = resource_dir.c_str(),
+            .saved_image_dir_ = saved_image_dir.c_str(),
+        },
+        lgtbot::game::MutableGenericOptions{
+            .player_num_each_user_ = header.player_num_each_user_,
+            .bench_computers_to_player_num_ = header.bench_computers_to_player_num_,
+            .is_formal_ = false,
+        }
+    };
+    MockMatch match(image_dir, generic_options.PlayerNum(), !FLAGS_show_messages);
+    match.SetRandomSeed(header.random_seed_);
+    MockMsgSender reply(image_dir, !FLAGS_show_messages);
+
+    std::map<std::string, StepStats> stats;
+    const auto measure = [&stats](const uint64_t index, const char* const type, const auto& fn)
+        {
+            const auto begin = std::chrono::steady_clock::now();
+            const auto rc = fn();
+            const uint64_t elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - begin).count();
+            auto& type_stats = stats[type];
+            type_stats.elapsed_us_.emplace_back(elapsed_us);
+            ++type_stats.rc_counts_[rc];
+            if (FLAGS_show_steps) {
+                std::cout << "step=" << index << " type=" << type << " elapsed_us=" << elapsed_us << " rc=" << rc
+                          << std::endl;
+            }
+        };
+
+    GameHandle::main_stage_ptr main_stage(nullptr, game_module.main_stage_deleter_);
+    measure(0, "begin", [&]() -> std::string
+            {
+                main_stage.reset(game_module.main_stage_allocator_(&reply, game_options.get(), &generic_options, &match));
+                if (!main_stage) {
+                    return "FAILED";
+                }
+                main_stage->HandleStageBegin();
+                return "OK";
+            });
+    if (!main_stage) {
+        std::cerr << "[ERROR] Start game failed, the options may not be expected" << std::endl;
+        return 1;
+    }
+
+    uint64_t index = 0;
+    uint64_t journal_us = 0;
+    const auto replay_begin = std::chrono::steady_clock::now();
+    for (auto record = reader.Next(); record.has_value(); record = reader.Next()) {
+        ++index;
+        journal_us = record->time_us_;
+        if (main_stage->IsOver()) {
+            std::cerr << "[WARN] The game is over before step " << index << ", the replay may diverge" << std::endl;
+            break;
+        }
+        if (FLAGS_show_steps) {
+            std::cout << "step=" << index << " journal_time_us=" << record->time_us_ << " pid=" << record->pid_;
+            if (record->type_ == MatchJournalRecord::Type::REQUEST) {
+                std::cout << " is_public=" << record->is_public_ << " msg=" << record->msg_;
+            }
+            std::cout << std::endl;
+        }
+        measure(index, MatchJournalRecordTypeName(record->type_), [&]() -> std::string
+                {
+                    switch (record->type_) {
+                    case MatchJournalRecord::Type::REQUEST:
+                        return main_stage->HandleRequest(record->msg_.c_str(), record->pid_, record->is_public_, reply)
+                            .ToString();
+                    case MatchJournalRecord::Type::LEAVE:
+                        return main_stage->HandleLeave(record->pid_).ToString();
+                    case MatchJournalRecord::Type::TIMEOUT:
+                        match.SkipToTimeout(); // the timeout happens at the deadline of the simulated clock
+                        return main_stage->HandleTimeout().ToString();
+                    case MatchJournalRecord::Type::COMPUTER_ACT:
+                        return main_stage->HandleComputerAct(record->pid_, false).ToString();
+                    }
+                    return "UNKNOWN";
+                });
+    }
+    const auto replay_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - replay_begin).count();
+
+    std::cout << "game=" << header.module_name_ << " random_seed=" << header.random_seed_ << " steps=" << index
+              << " journal_us=" << journal_us << " replay_us=" << replay_us
+              << " is_over=" << std::boolalpha << main_stage->IsOver() << std::endl;
+    ShowStats(stats);
+    if (main_stage->IsOver()) {
+        for (PlayerID pid = 0; pid < generic_options.PlayerNum(); ++pid) {
+            std::cout << "PLAYER_" << pid << ": score=" << main_stage->PlayerScore(pid) << std::endl;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    gflags::ParseCommandLineFlags(&argc, &argv, true);
+    enable_markdown_to_image = FLAGS_gen_image;
+
+    std::string errmsg;
+    const auto reader = MatchJournalReader::Open(FLAGS_journal, errmsg);
+    if (!reader) {
+        std::cerr << "[ERROR] Open journal " << FLAGS_journal << " failed: " << errmsg << std::endl;
+        return 1;
+    }
+    const auto game_module = LoadGame(reader->header().module_name_);
+    if (!game_module) {
+        return 1;
+    }
+    const auto image_dir = FLAGS_image_dir.empty() ?
+        std::filesystem::temp_directory_path() / "lgtbot_replay_match" : std::filesystem::path(FLAGS_image_dir);
+    const int ret = Replay(*reader, *game_module, image_dir);
+    FreeLibrary(game_module->mod_);
+    return ret;
+}
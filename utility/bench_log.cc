@@ -0,0 +1,87 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+// Measure the time taken by the threads which generate logs, with logs written synchronously, asynchronously or
+// filtered by the level. Logs are written to a file like glog does.
+//
+// Usage: ./bench_log --threads=4 --logs=100000 --path=/tmp/bench_log.txt
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <gflags/gflags.h>
+
+#include "utility/log.h"
+
+DEFINE_uint32(threads, 4, "The number of threads generating logs");
+DEFINE_uint32(logs, 100000, "The number of logs generated by each thread");
+DEFINE_string(path, "/dev/null", "The path of the file which logs are written to");
+
+static FILE* file = nullptr;
+
+static void FileSink(const LogRecord& record)
+{
+    const auto time_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(record.time_.time_since_epoch()).count();
+    std::fprintf(file, "%c %lld %s:%u] %.*s\n", "DIWEF"[record.level_], static_cast<long long>(time_us), record.file_,
+            record.line_, static_cast<int>(record.msg_.size()), record.msg_.data());
+}
+
+// Similar to the logs of a stage.
+static void GenerateLogs()
+{
+    const std::string stage_name = "主阶段";
+    for (uint32_t i = 0; i < FLAGS_logs; ++i) {
+        InfoLog() << "[mid=" << i << "] [game=测试游戏] [stage=" << stage_name << "] [atomic_stage] HandleRequest pid="
+                  << i % 5 << " is_public=" << (i % 2 == 0) << " msg=" << "A1 上";
+    }
+}
+
+static void Bench(const char* const name, const bool is_async, const LogLevel level)
+{
+    GlobalLogBackend().SetAsync(is_async);
+    GlobalLogBackend().SetLevel(level);
+    const auto written_count = GlobalLogBackend().Stats().written_count_;
+    const auto blocked_count = GlobalLogBackend().Stats().blocked_count_;
+
+    const auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < FLAGS_threads; ++i) {
+        threads.emplace_back(GenerateLogs);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const auto generated = std::chrono::steady_clock::now();
+    GlobalLogBackend().Flush();
+    std::fflush(file);
+    const auto flushed = std::chrono::steady_clock::now();
+
+    const auto to_ns = [](const auto duration) { return std::chrono::duration<double, std::nano>(duration).count(); };
+    const auto stats = GlobalLogBackend().Stats();
+    std::cout << name << ": generate_ns_per_log=" << to_ns(generated - begin) / FLAGS_threads / FLAGS_logs
+              << " total_ms=" << to_ns(flushed - begin) / 1e6
+              << " written=" << stats.written_count_ - written_count
+              << " blocked=" << stats.blocked_count_ - blocked_count << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    gflags::ParseCommandLineFlags(&argc, &argv, true);
+    file = std::fopen(FLAGS_path.c_str(), "w");
+    if (!file) {
+        std::cerr << "[ERROR] Open file failed: " << FLAGS_path << std::endl;
+        return 1;
+    }
+    GlobalLogBackend().SetSink(FileSink);
+    Bench("sync", false, LOG_LEVEL_DEBUG);
+    Bench("async", true, LOG_LEVEL_DEBUG);
+    Bench("filtered", true, LOG_LEVEL_WARN);
+    GlobalLogBackend().SetSink(nullptr);
+    std::fclose(file);
+    return 0;
+}
@@ -99,9 +99,9 @@ class name \
 \
     inline static const std::array<name, static_cast<uint32_t>(INNER_ENUM(name)::name##_MAX_)>& Members(); \
 \
-    inline static const std::map<std::string, name>& ParseMap(); \
+    inline static const std::map<std::string, name, std::less<>>& ParseMap(); \
 \
-    inline static std::optional<name> Parse(const std::string& str); \
+    inline static std::optional<name> Parse(const std::string_view str); \
 \
     constexpr static name Condition(const bool cond, const name _1, const name _2) { return cond ? _1 : _2; } \
 \
@@ -207,9 +207,9 @@ inline const std::array<name, static_cast<uint32_t>(INNER_ENUM(name)::name##_MAX
 #undef ENUM_END
 
 #define ENUM_BEGIN(name) \
-inline const std::map<std::string, name>& name::ParseMap() \
+inline const std::map<std::string, name, std::less<>>& name::ParseMap() \
 { \
-    static std::map<std::string, name> parser = {
+    static std::map<std::string, name, std::less<>> parser = {
 #define ENUM_MEMBER(name, member)  { #member, name::member },
 #define ENUM_END(name) \
     }; \
@@ -221,7 +221,7 @@ inline const std::map<std::string, name>& name::ParseMap() \
 #undef ENUM_END
 
 #define ENUM_BEGIN(name) \
-inline std::optional<name> name::Parse(const std::string& str) \
+inline std::optional<name> name::Parse(const std::string_view str) \
 { \
     const auto it = ParseMap().find(str); \
     if (it == ParseMap().end()) { \
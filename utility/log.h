@@ -4,34 +4,605 @@
 
 #pragma once
 
-inline const char* Bool2Str(const bool ret) { return ret ? "true" : "false"; }
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
-#if WITH_GLOG
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
+#if WITH_GLOG
 #ifndef GLOG_NO_ABBREVIATED_SEVERITIES
 #define GLOG_NO_ABBREVIATED_SEVERITIES
 #endif
 #include <glog/logging.h>
+#endif
+
+inline const char* Bool2Str(const bool ret) { return ret ? "true" : "false"; }
 
-#define DebugLog() LOG(INFO)
-#define InfoLog() LOG(INFO)
-#define WarnLog() LOG(WARNING)
-#define ErrorLog() LOG(ERROR)
-#define FatalLog() LOG(FATAL)
+// Logs are not formatted or written in the threads which generate them. Each thread appends the arguments of its logs
+// in binary to its own ring buffer, and a background thread formats them and passes them to the sink, which is glog
+// if built with glog. Logs of the same thread are written in order.
+//
+// A log below the level is dropped before its arguments are evaluated, e.g. `DebugLog() << ToString()` does not invoke
+// `ToString` if the debug level is disabled. Logs below `LGTBOT_MIN_LOG_LEVEL` are removed at compile time.
+//
+// Arithmetic values, pointers and strings are copied and formatted by the background thread. Other types are formatted
+// with `std::ostream` when they are passed.
+
+#ifndef LGTBOT_MIN_LOG_LEVEL
+#define LGTBOT_MIN_LOG_LEVEL 0
+#endif
+
+enum LogLevel : int32_t
+{
+    LOG_LEVEL_DEBUG = 0,
+    LOG_LEVEL_INFO = 1,
+    LOG_LEVEL_WARN = 2,
+    LOG_LEVEL_ERROR = 3,
+    LOG_LEVEL_FATAL = 4,
+    LOG_LEVEL_NONE = 5, // no logs are written
+};
+
+struct LogRecord
+{
+    LogLevel level_;
+    std::chrono::system_clock::time_point time_; // the time when the log is generated rather than written
+    const char* file_;                           // the base name of the source file
+    uint32_t line_;
+    std::string_view msg_;
+    uint64_t thread_id_;                         // the thread which generates the log rather than writes it
+};
+
+// The sink is invoked one log at a time. It should not write logs itself.
+using LogSink = void(*)(const LogRecord& record);
+
+struct LogStats
+{
+    uint64_t written_count_; // the number of logs passed to the sink
+    uint64_t blocked_count_; // the number of times a thread waits for the background thread because its buffer is full
+    uint64_t buffer_count_;  // the number of ring buffers of threads
+};
+
+namespace log_internal {
+
+enum ArgType : char
+{
+    ARG_INT = 'i',
+    ARG_UINT = 'u',
+    ARG_FLOAT = 'f',
+    ARG_CHAR = 'c',
+    ARG_POINTER = 'p',
+    ARG_STRING = 's',
+};
 
+template <typename T>
+void AppendRaw(std::string& buffer, const T& value)
+{
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+T ReadRaw(std::string_view& remain)
+{
+    T value;
+    std::memcpy(&value, remain.data(), sizeof(value));
+    remain.remove_prefix(sizeof(value));
+    return value;
+}
+
+inline void AppendStringData(std::string& buffer, const std::string_view str)
+{
+    AppendRaw(buffer, static_cast<uint32_t>(str.size()));
+    buffer.append(str);
+}
+
+inline void AppendString(std::string& buffer, const std::string_view str)
+{
+    buffer += ARG_STRING;
+    AppendStringData(buffer, str);
+}
+
+inline std::string_view ReadString(std::string_view& remain)
+{
+    const auto size = ReadRaw<uint32_t>(remain);
+    const auto str = remain.substr(0, size);
+    remain.remove_prefix(size);
+    return str;
+}
+
+template <typename T>
+void AppendArg(std::string& buffer, const T& arg)
+{
+    using U = std::decay_t<T>;
+    using P = std::remove_cv_t<T>; // char arrays are not decayed, so they are not compared with NULL
+    if constexpr (std::is_same_v<U, char> || std::is_same_v<U, signed char> || std::is_same_v<U, unsigned char>) {
+        buffer += ARG_CHAR;
+        buffer += static_cast<char>(arg);
+    } else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) {
+        buffer += ARG_INT;
+        AppendRaw(buffer, static_cast<int64_t>(arg));
+    } else if constexpr (std::is_integral_v<U>) { // bool is printed as 1 or 0 like std::ostream
+        buffer += ARG_UINT;
+        AppendRaw(buffer, static_cast<uint64_t>(arg));
+    } else if constexpr (std::is_floating_point_v<U>) {
+        buffer += ARG_FLOAT;
+        AppendRaw(buffer, static_cast<double>(arg));
+    } else if constexpr (std::is_same_v<P, const char*> || std::is_same_v<P, char*>) {
+        AppendString(buffer, arg ? std::string_view(arg) : std::string_view("(null)"));
+    } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+        AppendString(buffer, std::string_view(arg));
+    } else if constexpr (std::is_pointer_v<U>) {
+        buffer += ARG_POINTER;
+        AppendRaw(buffer, reinterpret_cast<const void*>(arg));
+    } else {
+        thread_local std::ostringstream ss;
+        ss.str("");
+        ss.clear();
+        ss << arg;
+        AppendString(buffer, ss.view());
+    }
+}
+
+// The ID of the current thread, which is the same as the thread ID in the logs of glog on Linux.
+inline uint64_t CurrentThreadId()
+{
+#ifdef __linux__
+    thread_local const uint64_t thread_id = syscall(SYS_gettid);
+#else
+    thread_local const uint64_t thread_id = std::hash<std::thread::id>{}(std::this_thread::get_id());
+#endif
+    return thread_id;
+}
+
+inline void FormatArgs(std::string_view remain, std::ostream& os)
+{
+    while (!remain.empty()) {
+        const auto type = remain.front();
+        remain.remove_prefix(1);
+        switch (type) {
+        case ARG_INT: os << ReadRaw<int64_t>(remain); break;
+        case ARG_UINT: os << ReadRaw<uint64_t>(remain); break;
+        case ARG_FLOAT: os << ReadRaw<double>(remain); break;
+        case ARG_CHAR: os << ReadRaw<char>(remain); break;
+        case ARG_POINTER: os << ReadRaw<const void*>(remain); break;
+        case ARG_STRING: os << ReadString(remain); break;
+        default: return;
+        }
+    }
+}
+
+#if WITH_GLOG
+// The header of glog has the time and the thread when the log is written by the background thread, so the ones when the
+// log is generated are prefixed to the message in the same format, e.g. "[1017 12:34:56.789012 1234] ".
+inline void GlogSink(const LogRecord& record)
+{
+    static constexpr const google::LogSeverity k_severities[] = {
+        google::GLOG_INFO, google::GLOG_INFO, google::GLOG_WARNING, google::GLOG_ERROR, google::GLOG_FATAL};
+    const std::time_t time = std::chrono::system_clock::to_time_t(record.time_);
+    std::tm tm;
+#ifdef _WIN32
+    localtime_s(&tm, &time);
 #else
+    localtime_r(&time, &tm);
+#endif
+    const auto us =
+        std::chrono::duration_cast<std::chrono::microseconds>(record.time_.time_since_epoch()).count() % 1000000;
+    char prefix[64];
+    std::snprintf(prefix, sizeof(prefix), "[%02d%02d %02d:%02d:%02d.%06d %llu] ", tm.tm_mon + 1, tm.tm_mday, tm.tm_hour,
+            tm.tm_min, tm.tm_sec, static_cast<int>(us), static_cast<unsigned long long>(record.thread_id_));
+    google::LogMessage(record.file_, record.line_, k_severities[record.level_]).stream() << prefix << record.msg_;
+}
+#endif
+
+} // namespace log_internal
 
-class EmptyLogger
+class LogBackend
 {
   public:
-    template <typename Arg>
-    EmptyLogger& operator <<(Arg&& arg) { return *this; } 
-};
+    static constexpr const uint32_t k_default_buffer_bytes = 256 * 1024;
+    static constexpr const std::chrono::milliseconds k_idle_wait{50};
 
-#define DebugLog EmptyLogger
-#define InfoLog EmptyLogger
-#define WarnLog EmptyLogger
-#define ErrorLog EmptyLogger
-#define FatalLog EmptyLogger
+    LogBackend(const LogBackend&) = delete;
+    LogBackend(LogBackend&&) = delete;
 
+    ~LogBackend()
+    {
+        // logs generated after the background thread exits are written at once
+        is_async_.store(false, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> l(mutex_);
+            is_stopping_ = true;
+        }
+        cv_.notify_all();
+        if (writer_.joinable()) {
+            writer_.join();
+        }
+    }
+
+    void SetLevel(const LogLevel level)
+    {
+        std::lock_guard<std::mutex> l(sink_mutex_);
+        level_ = level;
+        UpdateThreshold_();
+    }
+
+    LogLevel Level() const
+    {
+        std::lock_guard<std::mutex> l(sink_mutex_);
+        return level_;
+    }
+
+    // Be NULL if we want to drop all logs.
+    void SetSink(const LogSink sink)
+    {
+        std::lock_guard<std::mutex> l(sink_mutex_);
+        sink_ = sink;
+        UpdateThreshold_();
+    }
+
+    // If |is_async| is false, logs are formatted and passed to the sink in the threads which generate them, which is
+    // slower but loses no logs if the process crashes.
+    void SetAsync(const bool is_async)
+    {
+        is_async_.store(is_async, std::memory_order_relaxed);
+        if (!is_async) {
+            Flush();
+        }
+    }
+
+    // Only take effect on the threads which have not written logs. It is rounded up to a power of 2.
+    void SetBufferBytes(const uint32_t bytes) { buffer_bytes_.store(std::bit_ceil(bytes), std::memory_order_relaxed); }
+
+    // Block until the logs generated before are passed to the sink.
+    void Flush()
+    {
+        std::unique_lock<std::mutex> l(mutex_);
+        if (!writer_.joinable()) {
+            return;
+        }
+        const uint64_t flush_seq = ++flush_requested_seq_;
+        cv_.notify_all();
+        flushed_cv_.wait(l, [&] { return flushed_seq_ >= flush_seq; });
+    }
+
+    LogStats Stats() const
+    {
+        std::lock_guard<std::mutex> l(mutex_);
+        return LogStats{
+            .written_count_ = written_count_.load(std::memory_order_relaxed),
+            .blocked_count_ = blocked_count_.load(std::memory_order_relaxed),
+            .buffer_count_ = buffers_.size(),
+        };
+    }
+
+    bool IsEnabled(const LogLevel level) const { return level >= threshold_.load(std::memory_order_relaxed); }
+
+    // Invoked by `LogLine` with the encoded log.
+    void Submit(const LogLevel level, const std::string_view record)
+    {
+        if (level < LOG_LEVEL_FATAL && is_async_.load(std::memory_order_relaxed)) {
+            auto& buffer = LocalBuffer_();
+            if (sizeof(uint32_t) + record.size() <= buffer.data_.size()) {
+                Push_(buffer, record);
+                return;
+            }
+        }
+        // Fatal logs are written at once because the sink may abort the process.
+        Flush();
+        std::lock_guard<std::mutex> l(sink_mutex_);
+        Write_(record);
+    }
+
+  private:
+    friend LogBackend& GlobalLogBackend();
+
+    // A single-producer single-consumer ring buffer. Each record is the 4-byte size followed by the encoded log.
+    struct ThreadBuffer
+    {
+        explicit ThreadBuffer(const uint32_t size) : data_(size) {}
+
+        uint64_t FreeBytes(const uint64_t tail) const
+        {
+            return data_.size() - (tail - head_.load(std::memory_order_acquire));
+        }
+
+        void Write(const uint64_t pos, const char* const data, const size_t size)
+        {
+            const size_t offset = pos & (data_.size() - 1);
+            const size_t first_size = std::min(size, data_.size() - offset);
+            std::memcpy(data_.data() + offset, data, first_size);
+            std::memcpy(data_.data(), data + first_size, size - first_size);
+        }
+
+        void Read(const uint64_t pos, char* const data, const size_t size) const
+        {
+            const size_t offset = pos & (data_.size() - 1);
+            const size_t first_size = std::min(size, data_.size() - offset);
+            std::memcpy(data, data_.data() + offset, first_size);
+            std::memcpy(data + first_size, data_.data(), size - first_size);
+        }
+
+        std::vector<char> data_;
+        alignas(64) std::atomic<uint64_t> head_{0}; // updated by the background thread
+        alignas(64) std::atomic<uint64_t> tail_{0}; // updated by the owner thread
+        std::atomic<bool> is_closed_{false};        // be true if the owner thread exits
+    };
+
+    struct ThreadBufferHolder
+    {
+        ~ThreadBufferHolder()
+        {
+            if (buffer_) {
+                buffer_->is_closed_.store(true, std::memory_order_release);
+            }
+        }
+
+        std::shared_ptr<ThreadBuffer> buffer_;
+    };
+
+    LogBackend()
+#if WITH_GLOG
+        : sink_(log_internal::GlogSink)
 #endif
+    {
+        UpdateThreshold_();
+    }
+
+    // REQUIRE: should be protected by sink_mutex_
+    void UpdateThreshold_() { threshold_.store(sink_ ? level_ : LOG_LEVEL_NONE, std::memory_order_relaxed); }
+
+    ThreadBuffer& LocalBuffer_()
+    {
+        thread_local ThreadBufferHolder holder;
+        if (!holder.buffer_) {
+            holder.buffer_ = std::make_shared<ThreadBuffer>(buffer_bytes_.load(std::memory_order_relaxed));
+            std::lock_guard<std::mutex> l(mutex_);
+            buffers_.emplace_back(holder.buffer_);
+            if (!writer_.joinable() && !is_stopping_) {
+                writer_ = std::thread([this] { Run_(); });
+            }
+        }
+        return *holder.buffer_;
+    }
+
+    void Push_(ThreadBuffer& buffer, const std::string_view record)
+    {
+        const uint32_t record_size = record.size();
+        const uint64_t size = sizeof(record_size) + record_size;
+        const uint64_t tail = buffer.tail_.load(std::memory_order_relaxed);
+        if (buffer.FreeBytes(tail) < size) {
+            blocked_count_.fetch_add(1, std::memory_order_relaxed);
+            Wake_();
+            while (buffer.FreeBytes(tail) < size) {
+                std::this_thread::yield();
+            }
+        }
+        buffer.Write(tail, reinterpret_cast<const char*>(&record_size), sizeof(record_size));
+        buffer.Write(tail + sizeof(record_size), record.data(), record_size);
+        buffer.tail_.store(tail + size, std::memory_order_release);
+        if (buffer.FreeBytes(tail + size) < buffer.data_.size() / 2) {
+            Wake_();
+        }
+    }
+
+    void Wake_()
+    {
+        if (!is_woken_.exchange(true, std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> l(mutex_);
+            cv_.notify_all();
+        }
+    }
+
+    void Drain_(ThreadBuffer& buffer, std::string& record)
+    {
+        const uint64_t tail = buffer.tail_.load(std::memory_order_acquire);
+        uint64_t head = buffer.head_.load(std::memory_order_relaxed);
+        if (head == tail) {
+            return;
+        }
+        std::lock_guard<std::mutex> l(sink_mutex_);
+        while (head != tail) {
+            uint32_t record_size = 0;
+            buffer.Read(head, reinterpret_cast<char*>(&record_size), sizeof(record_size));
+            record.resize(record_size);
+            buffer.Read(head + sizeof(record_size), record.data(), record_size);
+            Write_(record);
+            head += sizeof(record_size) + record_size;
+            buffer.head_.store(head, std::memory_order_release);
+        }
+    }
+
+    // REQUIRE: should be protected by sink_mutex_
+    void Write_(std::string_view record)
+    {
+        if (!sink_) {
+            return;
+        }
+        thread_local std::ostringstream ss;
+        ss.str("");
+        ss.clear();
+        const auto level = static_cast<LogLevel>(log_internal::ReadRaw<int32_t>(record));
+        const auto time_ns = log_internal::ReadRaw<int64_t>(record);
+        const auto thread_id = log_internal::ReadRaw<uint64_t>(record);
+        const auto line = log_internal::ReadRaw<uint32_t>(record);
+        const std::string file(log_internal::ReadString(record));
+        log_internal::FormatArgs(record, ss);
+        sink_(LogRecord{
+                .level_ = level,
+                .time_ = std::chrono::system_clock::time_point(
+                        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(time_ns))),
+                .file_ = file.c_str(),
+                .line_ = line,
+                .msg_ = ss.view(),
+                .thread_id_ = thread_id,
+            });
+        written_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void Run_()
+    {
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        std::string record;
+        while (true) {
+            uint64_t flush_seq = 0;
+            bool is_stopping = false;
+            {
+                std::unique_lock<std::mutex> l(mutex_);
+                cv_.wait_for(l, k_idle_wait, [&]
+                        {
+                            return is_woken_.load(std::memory_order_relaxed) || is_stopping_ ||
+                                flush_requested_seq_ != flushed_seq_;
+                        });
+                is_woken_.store(false, std::memory_order_relaxed);
+                flush_seq = flush_requested_seq_;
+                is_stopping = is_stopping_;
+                // A closed buffer receives no more logs, so it can be removed once it is drained.
+                std::erase_if(buffers_, [](const auto& buffer)
+                        {
+                            return buffer->is_closed_.load(std::memory_order_acquire) &&
+                                buffer->head_.load(std::memory_order_relaxed) ==
+                                    buffer->tail_.load(std::memory_order_acquire);
+                        });
+                buffers = buffers_;
+            }
+            for (const auto& buffer : buffers) {
+                Drain_(*buffer, record);
+            }
+            {
+                std::lock_guard<std::mutex> l(mutex_);
+                flushed_seq_ = flush_seq;
+            }
+            flushed_cv_.notify_all();
+            if (is_stopping) {
+                return;
+            }
+        }
+    }
+
+    std::atomic<int32_t> threshold_{LOG_LEVEL_NONE};
+    std::atomic<bool> is_async_{true};
+    std::atomic<uint32_t> buffer_bytes_{k_default_buffer_bytes};
+    std::atomic<bool> is_woken_{false};
+    std::atomic<uint64_t> written_count_{0};
+    std::atomic<uint64_t> blocked_count_{0};
+
+    mutable std::mutex sink_mutex_; // serializes invoking the sink
+    LogLevel level_{LOG_LEVEL_DEBUG}; // REQUIRE: should be protected by sink_mutex_
+    LogSink sink_{nullptr};           // REQUIRE: should be protected by sink_mutex_
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable flushed_cv_;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers_; // REQUIRE: should be protected by mutex_
+    uint64_t flush_requested_seq_{0};                    // REQUIRE: should be protected by mutex_
+    uint64_t flushed_seq_{0};                            // REQUIRE: should be protected by mutex_
+    bool is_stopping_{false};                            // REQUIRE: should be protected by mutex_
+    std::thread writer_;
+};
+
+// The backend shared by all threads in the process. Game modules share the backend of the bot if the symbols of the
+// bot are visible to them.
+inline LogBackend& GlobalLogBackend()
+{
+    static LogBackend backend;
+    return backend;
+}
+
+// Encodes a log into the thread-local buffer and submits it to the backend when destructed.
+class LogLine
+{
+  public:
+    LogLine(const LogLevel level, const char* const file, const uint32_t line) : level_(level)
+    {
+        auto& local = LocalRecord_();
+        if (local.is_used_) {
+            // the log is generated when evaluating the arguments of another log
+            record_ = &nested_record_;
+        } else {
+            local.is_used_ = true;
+            local.record_.clear();
+            record_ = &local.record_;
+        }
+        const std::string_view file_path(file);
+        const auto slash_pos = file_path.find_last_of("/\\");
+        log_internal::AppendRaw(*record_, static_cast<int32_t>(level));
+        log_internal::AppendRaw(*record_, static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::system_clock::now().time_since_epoch()).count()));
+        log_internal::AppendRaw(*record_, log_internal::CurrentThreadId());
+        log_internal::AppendRaw(*record_, line);
+        log_internal::AppendStringData(*record_,
+                slash_pos == std::string_view::npos ? file_path : file_path.substr(slash_pos + 1));
+    }
+
+    LogLine(const LogLine&) = delete;
+    LogLine(LogLine&&) = delete;
+
+    ~LogLine()
+    {
+        GlobalLogBackend().Submit(level_, *record_);
+        if (record_ != &nested_record_) {
+            LocalRecord_().is_used_ = false;
+        }
+    }
+
+    // A type can be logged as several arguments by defining `LogLine& operator<<(LogLine&, const T&)`, which is
+    // preferred to this template. The arguments are streamed into `Self()` so that it also applies to the first one.
+    template <typename T>
+    LogLine& operator<<(const T& arg)
+    {
+        log_internal::AppendArg(*record_, arg);
+        return *this;
+    }
+
+    LogLine& Self() { return *this; }
+
+  private:
+    struct LocalRecord
+    {
+        std::string record_;
+        bool is_used_ = false;
+    };
+
+    static LocalRecord& LocalRecord_()
+    {
+        thread_local LocalRecord local;
+        return local;
+    }
+
+    const LogLevel level_;
+    std::string* record_;
+    std::string nested_record_;
+};
+
+// Makes the log statement an expression of void, so that it can be a branch of the conditional operator.
+struct LogVoidify
+{
+    void operator&(const LogLine&) {}
+};
+
+#define LGTBOT_LOG(level) \
+    ((level) < LGTBOT_MIN_LOG_LEVEL || !GlobalLogBackend().IsEnabled(level)) ? (void)0 : \
+        LogVoidify() & LogLine((level), __FILE__, __LINE__).Self()
+
+#define DebugLog() LGTBOT_LOG(LOG_LEVEL_DEBUG)
+#define InfoLog() LGTBOT_LOG(LOG_LEVEL_INFO)
+#define WarnLog() LGTBOT_LOG(LOG_LEVEL_WARN)
+#define ErrorLog() LGTBOT_LOG(LOG_LEVEL_ERROR)
+#define FatalLog() LGTBOT_LOG(LOG_LEVEL_FATAL)
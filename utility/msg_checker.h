@@ -5,6 +5,7 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <functional>
 #include <iostream>
 #include <map>
@@ -12,7 +13,9 @@
 #include <optional>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <tuple>
+#include <unordered_map>
 #include <vector>
 #include <sstream>
 #include <bitset>
@@ -22,43 +25,108 @@
 
 // TODO: check callback parameters
 
+// Split a message into arguments separated by whitespaces. The arguments are views of the message, so the message
+// should outlive the reader. No memory is allocated unless there are more than `k_inline_arg_num` arguments.
 class MsgReader final
 {
    public:
-    using IterType = std::vector<std::string>::iterator;
+    using IterType = const std::string_view*;
 
-    MsgReader(const std::string& msg)
+    static constexpr const uint32_t k_inline_arg_num = 16;
+
+    MsgReader(const std::string_view msg)
+    {
+        for (size_t end = 0; ; ) {
+            const size_t begin = msg.find_first_not_of(k_spaces, end);
+            if (begin == std::string_view::npos) {
+                break;
+            }
+            end = std::min(msg.find_first_of(k_spaces, begin), msg.size());
+            Append_(msg.substr(begin, end - begin));
+        }
+        Finish_();
+    }
+
+    MsgReader(const char* const msg) : MsgReader(std::string_view(msg)) {}
+
+    MsgReader(const std::string& msg) : MsgReader(std::string_view(msg)) {}
+
+    MsgReader(const std::vector<std::string>& args)
     {
-        std::istringstream ss(msg);
-        for (std::string arg; ss >> arg;) {
-            args_.push_back(arg);
+        for (const auto& arg : args) {
+            Append_(arg);
         }
-        iter_ = args_.begin();
+        Finish_();
     }
 
-    MsgReader(std::vector<std::string> args) : args_(std::move(args)), iter_(args_.begin()) {}
+    // The arguments would refer to a destroyed temporary.
+    MsgReader(std::string&&) = delete;
+    MsgReader(std::vector<std::string>&&) = delete;
+
+    // The iterators refer to the inline buffer.
+    MsgReader(const MsgReader&) = delete;
+    MsgReader& operator=(const MsgReader&) = delete;
 
     ~MsgReader() {}
 
-    bool HasNext() const { return iter_ != args_.end(); }
+    bool HasNext() const { return iter_ != end_; }
 
     IterType Iterator() const { return iter_; }
 
-    const std::string& NextArg()
-    {
-        static const std::string k_empty;
-        return iter_ == args_.end() ? k_empty : *(iter_++);
-    }
+    std::string_view NextArg() { return iter_ == end_ ? std::string_view() : *(iter_++); }
+
+    void Reset(const IterType iter) { iter_ = iter; }
 
-    void Reset(const std::vector<std::string>::iterator iter) { iter_ = iter; }
+    void Reset() { Reset(begin_); }
 
-    void Reset() { Reset(args_.begin()); }
+    // The same characters as the whitespaces for `std::istream` in the "C" locale.
+    static constexpr const char* const k_spaces = " \t\n\v\f\r";
 
    private:
-    std::vector<std::string> args_;
-    std::vector<std::string>::iterator iter_;
+    void Append_(const std::string_view arg)
+    {
+        if (arg_num_ < k_inline_arg_num) {
+            inline_args_[arg_num_] = arg;
+        } else {
+            if (overflow_args_.empty()) {
+                overflow_args_.assign(inline_args_.begin(), inline_args_.end());
+            }
+            overflow_args_.emplace_back(arg);
+        }
+        ++arg_num_;
+    }
+
+    void Finish_()
+    {
+        begin_ = overflow_args_.empty() ? inline_args_.data() : overflow_args_.data();
+        end_ = begin_ + arg_num_;
+        iter_ = begin_;
+    }
+
+    std::array<std::string_view, k_inline_arg_num> inline_args_;
+    std::vector<std::string_view> overflow_args_; // used only if there are more than `k_inline_arg_num` arguments
+    uint32_t arg_num_{0};
+    IterType begin_;
+    IterType end_;
+    IterType iter_;
 };
 
+// Parse the whole |str| as a number. Return an empty std::optional if there are other characters. A leading '+' is
+// allowed, which is rejected by std::from_chars.
+template <typename T> requires (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>)
+std::optional<T> ParseNumber(std::string_view str)
+{
+    if (str.size() > 1 && str[0] == '+' && str[1] != '-') {
+        str.remove_prefix(1);
+    }
+    T result{};
+    const auto [ptr, ec] { std::from_chars(str.data(), str.data() + str.size(), result) };
+    if (ec == std::errc() && ptr == str.data() + str.size()) {
+        return result;
+    }
+    return std::nullopt;
+}
+
 class MsgArgCheckerBase
 {
   public:
@@ -100,7 +168,7 @@ class AnyArg : public MsgArgChecker<std::string>
         if (!reader.HasNext()) {
             return std::nullopt;
         }
-        return reader.NextArg();
+        return std::string(reader.NextArg());
     }
     virtual std::string ArgString(const std::string& value) const { return value; }
 
@@ -133,7 +201,7 @@ class BoolChecker : public MsgArgChecker<bool>
         if (!reader.HasNext()) {
             return std::nullopt;
         }
-        const std::string str = reader.NextArg();
+        const std::string_view str = reader.NextArg();
         if (str == true_str_) {
             return true;
         } else if (str == false_str_) {
@@ -157,9 +225,9 @@ template <typename T>
 class AlterChecker : public MsgArgChecker<T>
 {
   public:
-    template <typename String = const char* const>
-    AlterChecker(std::map<std::string, T> arg_map)
-            : arg_map_(std::move(arg_map))
+    template <typename Compare = std::less<>>
+    AlterChecker(const std::map<std::string, T, Compare>& arg_map)
+            : arg_map_(arg_map.begin(), arg_map.end())
             , format_info_(FormatInfoInternal_(arg_map_))
             , colored_format_info_(HTML_COLOR_FONT_HEADER(purple) + format_info_ + HTML_FONT_TAIL)
     {}
@@ -176,8 +244,7 @@ class AlterChecker : public MsgArgChecker<T>
         if (!reader.HasNext()) {
             return std::nullopt;
         }
-        std::string s = reader.NextArg();
-        const auto it = arg_map_.find(s);
+        const auto it = arg_map_.find(reader.NextArg());
         return it == arg_map_.end() ? std::optional<T>() : it->second;
     }
     virtual std::string ArgString(const T& value) const
@@ -191,7 +258,7 @@ class AlterChecker : public MsgArgChecker<T>
     }
 
   private:
-    static std::string FormatInfoInternal_(const std::map<std::string, T>& arg_map)
+    static std::string FormatInfoInternal_(const std::map<std::string, T, std::less<>>& arg_map)
     {
         if (arg_map.empty()) {
             return "(错误，可选项为空)";
@@ -209,7 +276,7 @@ class AlterChecker : public MsgArgChecker<T>
         return outstr;
     }
 
-    const std::map<std::string, T> arg_map_;
+    const std::map<std::string, T, std::less<>> arg_map_;
     const std::string format_info_;
     const std::string colored_format_info_;
 };
@@ -239,11 +306,10 @@ class ArithChecker : public MsgArgChecker<T>
         }
         return Check(reader.NextArg());
     }
-    virtual std::optional<T> Check(const std::string& str) const
+    virtual std::optional<T> Check(const std::string_view str) const
     {
-        T result{};
-        const auto [ptr, ec] { std::from_chars(str.data(), str.data() + str.size(), result) };
-        if (ec == std::errc() && ptr == str.data() + str.size() && min_ <= result && result <= max_) {
+        const auto result = ParseNumber<T>(str);
+        if (result.has_value() && min_ <= *result && *result <= max_) {
             return result;
         } else {
             return {};
@@ -291,11 +357,21 @@ class BasicChecker : public MsgArgChecker<T>
         if (!reader.HasNext()) {
             return std::nullopt;
         }
-        if (T value; std::stringstream(reader.NextArg()) >> value) {
+        return Check(reader.NextArg());
+    }
+    virtual std::optional<T> Check(const std::string_view str) const
+    {
+        if constexpr (requires { ParseNumber<T>(str); }) {
+            return ParseNumber<T>(str);
+        } else if constexpr (requires (const T& value) { ParseNumber<std::decay_t<decltype(value.Get())>>(str); }) {
+            // the integer IDs
+            const auto number = ParseNumber<std::decay_t<decltype(std::declval<const T&>().Get())>>(str);
+            return number.has_value() ? std::optional<T>(T(*number)) : std::nullopt;
+        } else if (T value; std::istringstream(std::string(str)) >> value) {
             return value;
         } else {
             return std::nullopt;
-        };
+        }
     }
     virtual std::string ArgString(const T& value) const
     {
@@ -340,6 +416,7 @@ class MsgArgChecker<void> final
     std::string EscapedFormatInfo() const { return format_info_; };
     std::string ColoredFormatInfo() const { return format_info_; };
     std::string ExampleInfo() const { return optional_strs_.front(); };
+    const std::vector<std::string>& Keywords() const { return optional_strs_; }
 
    private:
     const std::vector<std::string> optional_strs_;
@@ -612,7 +689,7 @@ class EnumChecker : public MsgArgChecker<Enum>
         }
         return Check(reader.NextArg());
     }
-    virtual std::optional<Enum> Check(const std::string& str) const { return Enum::Parse(str); }
+    virtual std::optional<Enum> Check(const std::string_view str) const { return Enum::Parse(str); }
     virtual std::string ArgString(const Enum& value) const { return value.ToString(); }
 
   private:
@@ -718,6 +795,7 @@ class Command<UserResult(UserArgs...)>
         virtual ~Base_() {}
         virtual CommandResult CallIfValid(MsgReader& msg_reader, UserArgs... user_args) const = 0;
         virtual std::string Info(const bool with_example, const bool with_html_color, const std::string& prefix) const = 0;
+        virtual const std::vector<std::string>* LeadingKeywords() const = 0;
     };
 
     template <typename Callback, typename... Checkers>
@@ -801,6 +879,16 @@ class Command<UserResult(UserArgs...)>
             return outstr;
         }
 
+        virtual const std::vector<std::string>* LeadingKeywords() const override
+        {
+            if constexpr (sizeof...(Checkers) > 0) {
+                if constexpr (std::is_same_v<std::decay_t<std::tuple_element_t<0, std::tuple<Checkers...>>>, VoidChecker>) {
+                    return &std::get<0>(checkers_).Keywords();
+                }
+            }
+            return nullptr;
+        }
+
       private:
         const char* const description_;
         const std::decay_t<Callback> callback_;
@@ -822,7 +910,80 @@ class Command<UserResult(UserArgs...)>
 
     auto Info(const bool with_example, const bool with_html_color, const std::string& prefix = "") const { return cmd_->Info(with_example, with_html_color, prefix); }
 
+    // The first argument of the messages which can match the command, or NULL if the first checker is not a
+    // `VoidChecker`, in which case the command can match any message.
+    const std::vector<std::string>* LeadingKeywords() const { return cmd_->LeadingKeywords(); }
+
   private:
     std::shared_ptr<Base_> cmd_;
 };
 
+template <typename> class IndexedCommands;
+
+// The commands indexed by their leading keywords. A message is checked only by the commands whose leading keywords
+// contain the first argument of the message and the commands without leading keywords, in the order they are passed
+// in, so the result is the same as checking all commands one by one.
+template <typename UserResult, typename ...UserArgs>
+class IndexedCommands<UserResult(UserArgs...)>
+{
+  public:
+    using CommandType = Command<UserResult(UserArgs...)>;
+    using CommandResult = typename std::conditional_t<std::is_void_v<UserResult>, bool, std::optional<UserResult>>;
+
+    IndexedCommands(std::vector<CommandType> commands) : commands_(std::move(commands))
+    {
+        for (uint32_t i = 0; i < commands_.size(); ++i) {
+            const auto keywords = commands_[i].LeadingKeywords();
+            if (!keywords) {
+                unindexed_.emplace_back(i);
+                continue;
+            }
+            for (const auto& keyword : *keywords) {
+                if (auto& indexes = keyword_indexes_[keyword]; indexes.empty() || indexes.back() != i) {
+                    indexes.emplace_back(i);
+                }
+            }
+        }
+    }
+
+    template <typename ...Commands> requires ((std::is_same_v<CommandType, std::decay_t<Commands>> && ...))
+    IndexedCommands(Commands&& ...commands) : IndexedCommands(std::vector<CommandType>{std::forward<Commands>(commands)...})
+    {
+    }
+
+    // Return the result of the first matched command.
+    CommandResult CallIfValid(MsgReader& msg_reader, UserArgs... user_args) const
+    {
+        static const std::vector<uint32_t> k_empty;
+        msg_reader.Reset();
+        const auto it = keyword_indexes_.find(msg_reader.NextArg());
+        const auto& indexed = it == keyword_indexes_.end() ? k_empty : it->second;
+        // Merge the two sorted lists to keep the order of commands.
+        for (auto indexed_it = indexed.begin(), unindexed_it = unindexed_.begin();
+                indexed_it != indexed.end() || unindexed_it != unindexed_.end(); ) {
+            const uint32_t i = unindexed_it == unindexed_.end() || (indexed_it != indexed.end() && *indexed_it < *unindexed_it)
+                ? *(indexed_it++) : *(unindexed_it++);
+            if (auto result = commands_[i].CallIfValid(msg_reader, user_args...); result) {
+                return result;
+            }
+        }
+        return CommandResult{};
+    }
+
+    auto begin() const { return commands_.begin(); }
+    auto end() const { return commands_.end(); }
+    bool empty() const { return commands_.empty(); }
+    size_t size() const { return commands_.size(); }
+
+  private:
+    struct StringHash
+    {
+        using is_transparent = void;
+        size_t operator()(const std::string_view& sv) const { return std::hash<std::string_view>{}(sv); }
+    };
+
+    std::vector<CommandType> commands_;
+    std::unordered_map<std::string, std::vector<uint32_t>, StringHash, std::equal_to<>> keyword_indexes_;
+    std::vector<uint32_t> unindexed_;
+};
+
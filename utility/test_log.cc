@@ -0,0 +1,210 @@
+// Copyright (c) 2018-present, Chang Liu <github.com/slontia>. All rights reserved.
+//
+// This source code is licensed under LGPLv2 (found in the LICENSE file).
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "utility/log.h"
+
+struct Point
+{
+    int x_;
+    int y_;
+};
+
+std::ostream& operator<<(std::ostream& os, const Point& point) { return os << "(" << point.x_ << "," << point.y_ << ")"; }
+
+struct Header
+{
+    int id_;
+    const char* name_;
+};
+
+LogLine& operator<<(LogLine& line, const Header& header) { return line << "[id=" << header.id_ << "] [name=" << header.name_ << "] "; }
+
+class TestLog : public testing::Test
+{
+  protected:
+    struct WrittenLog
+    {
+        LogLevel level_;
+        std::string file_;
+        std::string msg_;
+        std::thread::id thread_id_;
+        std::chrono::system_clock::time_point time_;
+        uint64_t producer_thread_id_;
+    };
+
+    void SetUp() override
+    {
+        written_logs_.clear();
+        GlobalLogBackend().SetSink(&TestLog::Sink_);
+        GlobalLogBackend().SetLevel(LOG_LEVEL_DEBUG);
+        GlobalLogBackend().SetAsync(true);
+    }
+
+    void TearDown() override
+    {
+        GlobalLogBackend().Flush();
+        GlobalLogBackend().SetSink(nullptr);
+    }
+
+    static std::vector<WrittenLog> WrittenLogs(const bool flush = true)
+    {
+        if (flush) {
+            GlobalLogBackend().Flush();
+        }
+        std::lock_guard<std::mutex> l(mutex_);
+        return written_logs_;
+    }
+
+    static std::string ToString(int& evaluated_count)
+    {
+        ++evaluated_count;
+        return "evaluated";
+    }
+
+  private:
+    static void Sink_(const LogRecord& record)
+    {
+        std::lock_guard<std::mutex> l(mutex_);
+        written_logs_.emplace_back(record.level_, record.file_, std::string(record.msg_), std::this_thread::get_id(),
+                record.time_, record.thread_id_);
+    }
+
+    static inline std::mutex mutex_;
+    static inline std::vector<WrittenLog> written_logs_;
+};
+
+TEST_F(TestLog, format_arguments)
+{
+    const char* const null_str = nullptr;
+    const std::string str = "str";
+    InfoLog() << "int=" << -1 << " uint64=" << UINT64_MAX << " double=" << 1.5 << " bool=" << true << " char=" << 'c'
+              << " null=" << null_str << " string=" << str << " view=" << std::string_view("view")
+              << " point=" << Point{1, 2};
+    const auto logs = WrittenLogs();
+    ASSERT_EQ(1, logs.size());
+    ASSERT_EQ(LOG_LEVEL_INFO, logs[0].level_);
+    ASSERT_EQ("test_log.cc", logs[0].file_);
+    ASSERT_EQ("int=-1 uint64=18446744073709551615 double=1.5 bool=1 char=c null=(null) string=str view=view point=(1,2)",
+              logs[0].msg_);
+    ASSERT_NE(std::this_thread::get_id(), logs[0].thread_id_);
+}
+
+TEST_F(TestLog, format_char_arrays_and_types_logged_as_several_arguments)
+{
+    char buffer[16] = "buffer";
+    InfoLog() << Header{1, "first"} << "array=" << buffer << " " << Header{2, "second"};
+    const auto logs = WrittenLogs();
+    ASSERT_EQ(1, logs.size());
+    ASSERT_EQ("[id=1] [name=first] array=buffer [id=2] [name=second] ", logs[0].msg_);
+}
+
+TEST_F(TestLog, keep_time_and_thread_of_producer)
+{
+    const auto begin = std::chrono::system_clock::now();
+    InfoLog() << "main";
+    uint64_t thread_id = 0;
+    std::thread([&] { thread_id = log_internal::CurrentThreadId(); InfoLog() << "thread"; }).join();
+    const auto end = std::chrono::system_clock::now();
+    const auto logs = WrittenLogs();
+    ASSERT_EQ(2, logs.size());
+    ASSERT_EQ(log_internal::CurrentThreadId(), logs[0].producer_thread_id_);
+    ASSERT_EQ(thread_id, logs[1].producer_thread_id_);
+    ASSERT_NE(logs[0].producer_thread_id_, logs[1].producer_thread_id_);
+    for (const auto& log : logs) {
+        ASSERT_LE(begin, log.time_);
+        ASSERT_GE(end, log.time_);
+    }
+}
+
+TEST_F(TestLog, do_not_evaluate_arguments_below_level)
+{
+    int evaluated_count = 0;
+    GlobalLogBackend().SetLevel(LOG_LEVEL_WARN);
+    DebugLog() << ToString(evaluated_count);
+    InfoLog() << ToString(evaluated_count);
+    WarnLog() << ToString(evaluated_count);
+    ErrorLog() << ToString(evaluated_count);
+    ASSERT_EQ(2, evaluated_count);
+    const auto logs = WrittenLogs();
+    ASSERT_EQ(2, logs.size());
+    ASSERT_EQ(LOG_LEVEL_WARN, logs[0].level_);
+    ASSERT_EQ(LOG_LEVEL_ERROR, logs[1].level_);
+}
+
+TEST_F(TestLog, do_not_evaluate_arguments_without_sink)
+{
+    int evaluated_count = 0;
+    GlobalLogBackend().SetSink(nullptr);
+    ErrorLog() << ToString(evaluated_count);
+    ASSERT_EQ(0, evaluated_count);
+}
+
+TEST_F(TestLog, log_when_evaluating_arguments)
+{
+    const auto inner = [] { InfoLog() << "inner"; return "outer"; };
+    InfoLog() << "log " << inner();
+    const auto logs = WrittenLogs();
+    ASSERT_EQ(2, logs.size());
+    ASSERT_EQ("inner", logs[0].msg_);
+    ASSERT_EQ("log outer", logs[1].msg_);
+}
+
+TEST_F(TestLog, write_synchronously)
+{
+    GlobalLogBackend().SetAsync(false);
+    InfoLog() << "sync";
+    const auto logs = WrittenLogs(false);
+    ASSERT_EQ(1, logs.size());
+    ASSERT_EQ("sync", logs[0].msg_);
+    ASSERT_EQ(std::this_thread::get_id(), logs[0].thread_id_);
+}
+
+TEST_F(TestLog, keep_order_of_each_thread_when_buffers_are_full)
+{
+    constexpr const uint32_t k_thread_num = 4;
+    constexpr const uint32_t k_log_num = 10000;
+    GlobalLogBackend().SetBufferBytes(1024);
+    const auto blocked_count = GlobalLogBackend().Stats().blocked_count_;
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < k_thread_num; ++i) {
+        threads.emplace_back([i] { for (uint32_t j = 0; j < k_log_num; ++j) { InfoLog() << i << " " << j; } });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    GlobalLogBackend().SetBufferBytes(LogBackend::k_default_buffer_bytes);
+    const auto logs = WrittenLogs();
+    ASSERT_EQ(k_thread_num * k_log_num, logs.size());
+    std::vector<uint32_t> next_index(k_thread_num, 0);
+    for (const auto& log : logs) {
+        const auto space_pos = log.msg_.find(' ');
+        const auto thread_index = std::stoul(log.msg_.substr(0, space_pos));
+        ASSERT_EQ(next_index[thread_index]++, std::stoul(log.msg_.substr(space_pos + 1)));
+    }
+    ASSERT_LT(blocked_count, GlobalLogBackend().Stats().blocked_count_);
+}
+
+TEST_F(TestLog, write_log_larger_than_buffer)
+{
+    const std::string long_str(LogBackend::k_default_buffer_bytes, 'a');
+    InfoLog() << "short";
+    InfoLog() << long_str;
+    const auto logs = WrittenLogs();
+    ASSERT_EQ(2, logs.size());
+    ASSERT_EQ("short", logs[0].msg_);
+    ASSERT_EQ(long_str, logs[1].msg_);
+}
+
+int main(int argc, char** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
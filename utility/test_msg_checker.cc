@@ -137,6 +137,11 @@ TEST_F(TestMsgChecker, test_arith_checker)
     ASSERT_ARG(checker, "0", 0);
     ASSERT_ARG(checker, "-0", 0);
     ASSERT_ARG(checker, "1", 1);
+    ASSERT_ARG(checker, "+1", 1);
+    ASSERT_ARG(checker, "+0", 0);
+    ASSERT_FAIL(checker, "+");
+    ASSERT_FAIL(checker, "++1");
+    ASSERT_FAIL(checker, "+-1");
     ASSERT_EQ("0", checker.ArgString(0));
 }
 
@@ -175,6 +180,18 @@ TEST_F(TestMsgChecker, test_basic_checker)
     ASSERT_EQ("1", checker.ArgString(Obj{2}));
 }
 
+TEST_F(TestMsgChecker, test_basic_checker_number)
+{
+    BasicChecker<int> checker;
+    ASSERT_FAIL(checker, "zero");
+    ASSERT_FAIL(checker, "1zero");
+    ASSERT_FAIL(checker, "1.5");
+    ASSERT_ARG(checker, "-1", -1);
+    ASSERT_ARG(checker, "+1", 1);
+    ASSERT_ARG(checker, "10 zero", 10);
+    ASSERT_EQ("10", checker.ArgString(10));
+}
+
 TEST_F(TestMsgChecker, test_void_checker)
 {
     VoidChecker checker("test");
@@ -270,6 +287,80 @@ TEST_F(TestMsgChecker, test_batch_checker)
     ASSERT_ARG(checker, "0 true", (std::tuple<int, bool>{0, true}));
 }
 
+TEST_F(TestMsgChecker, test_msg_reader_more_args_than_inline_buffer)
+{
+    std::string msg;
+    for (uint32_t i = 0; i < MsgReader::k_inline_arg_num * 2; ++i) {
+        msg += " " + std::to_string(i) + "\t";
+    }
+    MsgReader reader(msg);
+    for (uint32_t i = 0; i < MsgReader::k_inline_arg_num; ++i) {
+        ASSERT_EQ(std::to_string(i), reader.NextArg());
+    }
+    const auto iter = reader.Iterator();
+    for (uint32_t i = MsgReader::k_inline_arg_num; i < MsgReader::k_inline_arg_num * 2; ++i) {
+        ASSERT_EQ(std::to_string(i), reader.NextArg());
+    }
+    ASSERT_FALSE(reader.HasNext());
+    ASSERT_EQ("", reader.NextArg());
+    reader.Reset(iter);
+    ASSERT_EQ(std::to_string(MsgReader::k_inline_arg_num), reader.NextArg());
+    reader.Reset();
+    ASSERT_EQ("0", reader.NextArg());
+}
+
+TEST_F(TestMsgChecker, test_leading_keywords)
+{
+    using TestCommand = Command<int()>;
+    const TestCommand cmd_1("", [](const std::string&) { return 1; }, VoidChecker("a", "b"), AnyArg());
+    ASSERT_EQ((std::vector<std::string>{"a", "b"}), *cmd_1.LeadingKeywords());
+    const TestCommand cmd_2("", [](const std::string&) { return 2; }, AnyArg(), VoidChecker("a"));
+    ASSERT_EQ(nullptr, cmd_2.LeadingKeywords());
+    const TestCommand cmd_3("", [] { return 3; });
+    ASSERT_EQ(nullptr, cmd_3.LeadingKeywords());
+}
+
+TEST_F(TestMsgChecker, test_indexed_commands_keep_order)
+{
+    IndexedCommands<int()> cmds(
+            Command<int()>("", [] { return 1; }, VoidChecker("a"), VoidChecker("x")),
+            Command<int()>("", [](const int) { return 2; }, ArithChecker<int>(0, 10)),
+            Command<int()>("", [] { return 3; }, VoidChecker("a", "b")),
+            Command<int()>("", [](const std::string&) { return 4; }, AnyArg()),
+            Command<int()>("", [] { return 5; }, VoidChecker("c")),
+            Command<int()>("", [] { return 6; }));
+    const auto call = [&](const std::string& msg)
+        {
+            MsgReader reader(msg);
+            return cmds.CallIfValid(reader);
+        };
+    ASSERT_EQ(1, call("a x"));
+    ASSERT_EQ(2, call("5"));
+    ASSERT_EQ(3, call("a"));
+    ASSERT_EQ(3, call("b"));
+    ASSERT_EQ(4, call("c")); // the command without leading keywords takes precedence
+    ASSERT_EQ(4, call("d"));
+    ASSERT_EQ(6, call(""));
+    ASSERT_EQ(std::nullopt, call("a y"));
+    ASSERT_EQ(6, cmds.size());
+}
+
+TEST_F(TestMsgChecker, test_indexed_commands_without_result)
+{
+    int result = 0;
+    IndexedCommands<void(int&)> cmds(
+            Command<void(int&)>("", [](int& result) { result = 1; }, VoidChecker("a")),
+            Command<void(int&)>("", [](int& result, const int value) { result = value; }, ArithChecker<int>(0, 10)));
+    MsgReader reader_1("a");
+    ASSERT_TRUE(cmds.CallIfValid(reader_1, result));
+    ASSERT_EQ(1, result);
+    MsgReader reader_2("5");
+    ASSERT_TRUE(cmds.CallIfValid(reader_2, result));
+    ASSERT_EQ(5, result);
+    MsgReader reader_3("b");
+    ASSERT_FALSE(cmds.CallIfValid(reader_3, result));
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);